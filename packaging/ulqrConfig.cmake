@@ -1 +1,4 @@
-include(${CMAKE_CURRENT_LIST_DIR}/ulqr.cmake)
\ No newline at end of file
+include(CMakeFindDependencyMacro)
+find_dependency(Threads)  # riccati_parallel
+
+include(${CMAKE_CURRENT_LIST_DIR}/ulqr.cmake)
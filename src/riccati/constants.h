@@ -1,5 +1,9 @@
 #pragma once
 
+#ifdef SLAP_USE_FLOAT
+#include "riccati/float_names.h"
+#endif
+
 /**
  * @brief Return codes for the ulqr package
  *
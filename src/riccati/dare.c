@@ -0,0 +1,190 @@
+#include "dare.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "riccati/riccati_solver.h"
+#include "slap/linalg.h"
+#include "slap/matrix.h"
+
+static const int kDAREMaxIters = 50;
+#ifdef SLAP_USE_FLOAT
+static const sfloat kDARETolerance = 1e-5;
+#else
+static const sfloat kDARETolerance = 1e-12;
+#endif
+
+/* Replace a square matrix with its symmetric part, to keep round-off from building up */
+static void Symmetrize(Matrix* X) {
+  int n = X->rows;
+  int ld = slap_MatrixLeadingDim(X);
+  for (int j = 0; j < n; ++j) {
+    for (int i = j + 1; i < n; ++i) {
+      sfloat avg = (X->data[i + j * ld] + X->data[j + i * ld]) / 2;
+      X->data[i + j * ld] = avg;
+      X->data[j + i * ld] = avg;
+    }
+  }
+}
+
+DARESolver* ulqr_NewDARESolver(int nstates, int ninputs) {
+  if (nstates < 1 || ninputs < 1) {
+    printf("ERROR: Invalid size (%d,%d) for DARESolver.\n", nstates, ninputs);
+    return NULL;
+  }
+  int n = nstates;
+  int m = ninputs;
+  int nn_size = slap_AlignedLength(n * n);
+  int P_size = slap_AlignedLength(n * (n + 1) / 2);
+  int K_size = slap_AlignedLength(m * n);
+  int S_size = slap_AlignedLength(m * m);
+  int total_size = P_size + 2 * K_size + 8 * nn_size + S_size;
+
+  DARESolver* dare = (DARESolver*)malloc(sizeof(DARESolver));
+  sfloat* data = (sfloat*)slap_AlignedAlloc(total_size * sizeof(sfloat));
+  int* ipiv = (int*)malloc(n * sizeof(int));
+  if (!dare || !data || !ipiv) {
+    printf("ERROR: Failed to allocate memory for DARESolver.\n");
+    free(dare);
+    free(data);
+    free(ipiv);
+    return NULL;
+  }
+  memset(data, 0, total_size * sizeof(sfloat));
+
+  dare->nstates = n;
+  dare->ninputs = m;
+  dare->max_iters = kDAREMaxIters;
+  dare->tolerance = kDARETolerance;
+  dare->iters = 0;
+  dare->data = data;
+  dare->ipiv = ipiv;
+
+  sfloat* ptr = data;
+  dare->P = (SymMatrix){n, ptr};
+  ptr += P_size;
+  dare->K = (Matrix){m, n, ptr, 0};
+  ptr += K_size;
+  Matrix* nn_blocks[8] = {&dare->Ak, &dare->Gk, &dare->Hk, &dare->W,
+                          &dare->T1, &dare->T2, &dare->T3, &dare->T4};
+  for (int i = 0; i < 8; ++i) {
+    *nn_blocks[i] = (Matrix){n, n, ptr, 0};
+    ptr += nn_size;
+  }
+  dare->Y = (Matrix){m, n, ptr, 0};
+  ptr += K_size;
+  dare->S = (Matrix){m, m, ptr, 0};
+  return dare;
+}
+
+int ulqr_FreeDARESolver(DARESolver** dare_ptr) {
+  DARESolver* dare = *dare_ptr;
+  if (!dare) {
+    return -1;
+  }
+  free(dare->data);
+  free(dare->ipiv);
+  free(dare);
+  *dare_ptr = NULL;
+  return 0;
+}
+
+int ulqr_SolveDARE(DARESolver* dare, Matrix* A, Matrix* B, SymMatrix* Q, SymMatrix* R) {
+  int n = dare->nstates;
+  int m = dare->ninputs;
+  if (A->rows != n || A->cols != n || B->rows != n || B->cols != m || Q->n != n || R->n != m) {
+    printf("ERROR: Problem size doesn't match the size of the DARESolver.\n");
+    return -1;
+  }
+  Matrix* S = &dare->S;
+  Matrix* Y = &dare->Y;
+  dare->iters = 0;
+
+  // G = B R^{-1} B' = Y'Y, with Y = L^{-1} B' and R = L L'
+  slap_SymMatrixUnpack(S, R);
+  if (slap_CholeskyFactorize(S) != slap_kCholeskySuccess) {
+    printf("ERROR: R is not positive definite in ulqr_SolveDARE.\n");
+    return -1;
+  }
+  slap_MatrixCopyTranspose(Y, B);
+  slap_LowerTriBackSub(S, Y, false);
+  slap_MatrixMultiply(Y, Y, &dare->Gk, true, false, 1.0, 0.0);
+  slap_MatrixCopy(&dare->Ak, A);
+  slap_SymMatrixUnpack(&dare->Hk, Q);
+
+  // Each step doubles the horizon of H
+  bool converged = false;
+  while (!converged && dare->iters < dare->max_iters) {
+    Matrix* W = &dare->W;
+    Matrix* T1 = &dare->T1;
+    Matrix* T2 = &dare->T2;
+    Matrix* T3 = &dare->T3;
+    Matrix* T4 = &dare->T4;
+
+    // W = I + G H
+    slap_MatrixMultiply(&dare->Gk, &dare->Hk, W, false, false, 1.0, 0.0);
+    slap_AddDiagonal(W, 1.0);
+    if (slap_LUFactorize(W, dare->ipiv) != 0) {
+      printf("ERROR: Singular doubling step in ulqr_SolveDARE.\n");
+      return -1;
+    }
+
+    // T1 = W \ A, T2 = W \ G
+    slap_MatrixCopy(T1, &dare->Ak);
+    slap_LUSolve(W, dare->ipiv, T1);
+    slap_MatrixCopy(T2, &dare->Gk);
+    slap_LUSolve(W, dare->ipiv, T2);
+
+    // H += A' H T1
+    slap_MatrixMultiply(&dare->Hk, T1, T3, false, false, 1.0, 0.0);
+    slap_MatrixMultiply(&dare->Ak, T3, T4, true, false, 1.0, 0.0);
+    slap_MatrixAddition(T4, &dare->Hk, 1.0);
+    Symmetrize(&dare->Hk);
+    sfloat dH = slap_TwoNorm(T4);
+
+    // G += A T2 A'
+    slap_MatrixMultiply(&dare->Ak, T2, T3, false, false, 1.0, 0.0);
+    slap_MatrixMultiply(T3, &dare->Ak, T4, false, true, 1.0, 0.0);
+    slap_MatrixAddition(T4, &dare->Gk, 1.0);
+    Symmetrize(&dare->Gk);
+
+    // A = A T1
+    slap_MatrixMultiply(&dare->Ak, T1, T3, false, false, 1.0, 0.0);
+    Matrix A_next = *T3;
+    *T3 = dare->Ak;
+    dare->Ak = A_next;
+
+    ++dare->iters;
+    converged = dH <= dare->tolerance * slap_TwoNorm(&dare->Hk);
+  }
+  if (!converged) {
+    printf("ERROR: ulqr_SolveDARE didn't converge in %d iterations.\n", dare->max_iters);
+    return -1;
+  }
+  slap_SymMatrixPack(&dare->P, &dare->Hk);
+
+  // K = -(R + B'P B)^{-1} B'P A
+  slap_MatrixMultiply(B, &dare->Hk, Y, true, false, 1.0, 0.0);
+  slap_SymMatrixUnpack(S, R);
+  slap_MatrixMultiply(Y, B, S, false, false, 1.0, 1.0);
+  if (slap_CholeskyFactorize(S) != slap_kCholeskySuccess) {
+    printf("ERROR: R + B'P B is not positive definite in ulqr_SolveDARE.\n");
+    return -1;
+  }
+  slap_MatrixMultiply(Y, A, &dare->K, false, false, -1.0, 0.0);
+  slap_CholeskySolve(S, &dare->K);
+  return 0;
+}
+
+int ulqr_SetDARETerminalCost(RiccatiSolver* solver, const DARESolver* dare) {
+  int n = dare->nstates;
+  if (solver->nstates != n || solver->ninputs != dare->ninputs) {
+    printf("ERROR: Size of the DARESolver doesn't match the size of the RiccatiSolver.\n");
+    return -1;
+  }
+  SymMatrix* Qf = ulqr_GetQ(solver, solver->nhorizon - 1);
+  memcpy(Qf->data, dare->P.data, n * (n + 1) / 2 * sizeof(sfloat));
+  return 0;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file dare.h
+ * @author Brian Jackson (bjack205@gmail.com)
+ * @brief Infinite-horizon LQR gain from the discrete algebraic Riccati equation
+ * @version 0.1
+ * @date 2022-02-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * @addtogroup riccati
+ * @{
+ */
+#pragma once
+
+#include "riccati_solver.h"
+#include "slap/matrix.h"
+#include "slap/symmatrix.h"
+
+/**
+ * @brief Solver for the steady-state cost-to-go and gain of a time-invariant LQR problem
+ *
+ * Finds the stabilizing solution \f$ P \f$ of the discrete algebraic Riccati equation
+ * \f[
+ * P = Q + A^T P A - A^T P B (R + B^T P B)^{-1} B^T P A
+ * \f]
+ * which is the limit of the cost-to-go Hessians of the backward pass as the horizon
+ * grows, along with the feedback gain \f$ K = -(R + B^T P B)^{-1} B^T P A \f$ of the
+ * control law \f$ u = K x \f$. As in the backward pass, there is no cross term between
+ * the states and inputs in the cost.
+ *
+ * The equation is solved with the structure-preserving doubling algorithm. Starting
+ * from \f$ A_0 = A, G_0 = B R^{-1} B^T, H_0 = Q \f$, each step
+ * \f{align*}{
+ * A_{k+1} &= A_k (I + G_k H_k)^{-1} A_k \\
+ * G_{k+1} &= G_k + A_k (I + G_k H_k)^{-1} G_k A_k^T \\
+ * H_{k+1} &= H_k + A_k^T H_k (I + G_k H_k)^{-1} A_k
+ * \f}
+ * doubles the horizon: \f$ H_k \f$ is the cost-to-go Hessian of the backward pass
+ * \f$ 2^k \f$ steps away from a terminal cost of \f$ Q \f$. Convergence is quadratic,
+ * so a few tens of \f$ O(n^3) \f$ steps replace a backward pass over an arbitrarily long
+ * horizon. Requires \f$ R \f$ to be positive definite, \f$ (A, B) \f$ to be stabilizable
+ * and \f$ Q \f$ to be positive semi-definite, with no unobservable mode on the unit
+ * circle.
+ *
+ * The solution is kept in the solver until the next solve, so it can be reused, e.g. as
+ * the terminal cost of a finite-horizon problem with ulqr_SetDARETerminalCost(), which
+ * makes the cost-to-go of that problem the steady-state one at every knot point.
+ *
+ * ## Construction and destruction
+ * Use ulqr_NewDARESolver() to allocate a solver for a given problem size, which must be
+ * paired with a call to ulqr_FreeDARESolver().
+ *
+ * ## Typical Usage
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * DARESolver* dare = ulqr_NewDARESolver(nstates, ninputs);
+ * ulqr_SolveDARE(dare, ulqr_GetA(solver, 0), ulqr_GetB(solver, 0), ulqr_GetQ(solver, 0),
+ *                ulqr_GetR(solver, 0));
+ * ulqr_SetDARETerminalCost(solver, dare);
+ * ulqr_FreeDARESolver(&dare);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+typedef struct {
+  // clang-format off
+  int nstates;        ///< size of state vector (n)
+  int ninputs;        ///< number of control inputs (m)
+  int max_iters;      ///< maximum number of doubling steps (default 50)
+  sfloat tolerance;   ///< stop once the relative change of P is below this
+  int iters;          ///< number of doubling steps taken by the last solve
+  SymMatrix P;        ///< steady-state cost-to-go Hessian
+  Matrix K;           ///< (m,n) steady-state feedback gain
+  sfloat* data;       ///< pointer to the beginning of the workspace
+  int* ipiv;          ///< pivots of the LU factorization of I + G H
+  Matrix Ak;          ///< (n,n) A of the doubling step
+  Matrix Gk;          ///< (n,n) G of the doubling step
+  Matrix Hk;          ///< (n,n) H of the doubling step
+  Matrix W;           ///< (n,n) LU factors of I + G H
+  Matrix T1;          ///< (n,n) temporary matrix
+  Matrix T2;          ///< (n,n) temporary matrix
+  Matrix T3;          ///< (n,n) temporary matrix
+  Matrix T4;          ///< (n,n) temporary matrix
+  Matrix Y;           ///< (m,n) temporary matrix
+  Matrix S;           ///< (m,m) factor of R, then of R + B'P B
+  // clang-format on
+} DARESolver;
+
+/**
+ * @brief Allocate a new solver for the DARE of a given size
+ *
+ * @param nstates Number of states
+ * @param ninputs Number of inputs
+ * @return A new solver, or NULL if the allocation failed
+ */
+DARESolver* ulqr_NewDARESolver(int nstates, int ninputs);
+
+/**
+ * @brief Free the memory for a DARE solver
+ *
+ * @param dare Pointer to an initialized solver
+ * @post dare will be NULL
+ * @return 0 if successful
+ */
+int ulqr_FreeDARESolver(DARESolver** dare);
+
+/**
+ * @brief Solve the DARE for the steady-state cost-to-go and gain
+ *
+ * The results are stored in `dare->P` and `dare->K`.
+ *
+ * @param dare An initialized solver of the same size as the problem
+ * @param A    (n,n) dynamics matrix
+ * @param B    (n,m) input matrix
+ * @param Q    State cost Hessian
+ * @param R    Input cost Hessian, positive definite
+ * @return 0 if successful, or -1 if @p R isn't positive definite, a doubling step is
+ *         singular, or the iteration doesn't converge within `max_iters` steps
+ */
+int ulqr_SolveDARE(DARESolver* dare, Matrix* A, Matrix* B, SymMatrix* Q, SymMatrix* R);
+
+/**
+ * @brief Use the steady-state cost-to-go as the terminal cost of a Riccati solver
+ *
+ * Copies the solution of the last call to ulqr_SolveDARE() into the cost Hessian of the
+ * last knot point of @p solver, which approximates the cost of the infinite horizon
+ * after it.
+ *
+ * @param solver An initialized Riccati solver of the same size
+ * @param dare   A solver whose last solve succeeded
+ * @return 0 if successful
+ */
+int ulqr_SetDARETerminalCost(RiccatiSolver* solver, const DARESolver* dare);
+
+/**@} */
@@ -0,0 +1,66 @@
+/**
+ * @file float_names.h
+ * @brief Maps the public riccati symbols to the ones of the single-precision library
+ *
+ * Included by the riccati headers when `SLAP_USE_FLOAT` is defined.
+ * See slap/scalar.h.
+ */
+#pragma once
+
+#define LQRDataSize ulqrf_LQRDataSize
+#define ulqr_BackwardPass ulqrf_BackwardPass
+#define ulqr_BackwardPassSqrt ulqrf_BackwardPassSqrt
+#define ulqr_BackwardStep ulqrf_BackwardStep
+#define ulqr_CalcCost ulqrf_CalcCost
+#define ulqr_CopyLQRData ulqrf_CopyLQRData
+#define ulqr_CopyLQRSolution ulqrf_CopyLQRSolution
+#define ulqr_CostFactorsSize ulqrf_CostFactorsSize
+#define ulqr_ForwardPass ulqrf_ForwardPass
+#define ulqr_ForwardPassBatch ulqrf_ForwardPassBatch
+#define ulqr_FreeDARESolver ulqrf_FreeDARESolver
+#define ulqr_FreeRiccatiSolver ulqrf_FreeRiccatiSolver
+#define ulqr_GetA ulqrf_GetA
+#define ulqr_GetAB ulqrf_GetAB
+#define ulqr_GetB ulqrf_GetB
+#define ulqr_GetCostToGoGradient ulqrf_GetCostToGoGradient
+#define ulqr_GetCostToGoHessian ulqrf_GetCostToGoHessian
+#define ulqr_GetDual ulqrf_GetDual
+#define ulqr_GetFeedbackGain ulqrf_GetFeedbackGain
+#define ulqr_GetFeedforwardGain ulqrf_GetFeedforwardGain
+#define ulqr_GetGains ulqrf_GetGains
+#define ulqr_GetH ulqrf_GetH
+#define ulqr_GetInput ulqrf_GetInput
+#define ulqr_GetKnotpointInput ulqrf_GetKnotpointInput
+#define ulqr_GetKnotpointState ulqrf_GetKnotpointState
+#define ulqr_GetNumVars ulqrf_GetNumVars
+#define ulqr_GetQ ulqrf_GetQ
+#define ulqr_GetQu ulqrf_GetQu
+#define ulqr_GetQuu ulqrf_GetQuu
+#define ulqr_GetQux ulqrf_GetQux
+#define ulqr_GetQx ulqrf_GetQx
+#define ulqr_GetQxx ulqrf_GetQxx
+#define ulqr_GetR ulqrf_GetR
+#define ulqr_GetRegularizationRetries ulqrf_GetRegularizationRetries
+#define ulqr_GetRegularizationShift ulqrf_GetRegularizationShift
+#define ulqr_GetState ulqrf_GetState
+#define ulqr_GetTime ulqrf_GetTime
+#define ulqr_GetTimestep ulqrf_GetTimestep
+#define ulqr_Getc ulqrf_Getc
+#define ulqr_Getf ulqrf_Getf
+#define ulqr_Getq ulqrf_Getq
+#define ulqr_Getr ulqrf_Getr
+#define ulqr_InitializeKnotPoint ulqrf_InitializeKnotPoint
+#define ulqr_InitializeLQRData ulqrf_InitializeLQRData
+#define ulqr_IsLQRProblemEqual ulqrf_IsLQRProblemEqual
+#define ulqr_NewDARESolver ulqrf_NewDARESolver
+#define ulqr_NewRiccatiSolver ulqrf_NewRiccatiSolver
+#define ulqr_PrintRiccatiSummary ulqrf_PrintRiccatiSummary
+#define ulqr_ReserveCostFactors ulqrf_ReserveCostFactors
+#define ulqr_ReuseSteadyState ulqrf_ReuseSteadyState
+#define ulqr_RiccatiScratchSize ulqrf_RiccatiScratchSize
+#define ulqr_SetCost ulqrf_SetCost
+#define ulqr_SetDARETerminalCost ulqrf_SetDARETerminalCost
+#define ulqr_SetDynamics ulqrf_SetDynamics
+#define ulqr_SetInitialState ulqrf_SetInitialState
+#define ulqr_SolveDARE ulqrf_SolveDARE
+#define ulqr_SolveRiccati ulqrf_SolveRiccati
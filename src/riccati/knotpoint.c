@@ -6,8 +6,8 @@
 #include "constants.h"
 #include "slap/matrix.h"
 
-enum ulqr_ReturnCode ulqr_InitializeKnotPoint(KnotPoint* z, int nstates, int ninputs, double* data,
-                                              double t, double h) {
+enum ulqr_ReturnCode ulqr_InitializeKnotPoint(KnotPoint* z, int nstates, int ninputs, sfloat* data,
+                                              sfloat t, sfloat h) {
   // Input validation
   if (!z) {
     printf("ERROR: Can't pass null point to knot point when initializing.\n");
@@ -38,5 +38,5 @@ enum ulqr_ReturnCode ulqr_InitializeKnotPoint(KnotPoint* z, int nstates, int nin
 
 Matrix* ulqr_GetKnotpointState(KnotPoint* z) { return &z->x; }
 Matrix* ulqr_GetKnotpointInput(KnotPoint* z) { return &z->u; }
-double ulqr_GetTime(KnotPoint* z) { return z->t; }
-double ulqr_GetTimestep(KnotPoint* z) { return z->h; }
+sfloat ulqr_GetTime(KnotPoint* z) { return z->t; }
+sfloat ulqr_GetTimestep(KnotPoint* z) { return z->h; }
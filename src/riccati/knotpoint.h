@@ -11,8 +11,8 @@
 typedef struct {
   Matrix x;  ///< state vector
   Matrix u;  ///< control input vector
-  double t;  ///< time
-  double h;  ///< time step
+  sfloat t;  ///< time
+  sfloat h;  ///< time step
 } KnotPoint;
 
 /**
@@ -30,10 +30,10 @@ typedef struct {
  * @param h       Time step, cannot be negative.
  * @return
  */
-enum ulqr_ReturnCode ulqr_InitializeKnotPoint(KnotPoint* z, int nstates, int ninputs, double* data,
-                                              double t, double h);
+enum ulqr_ReturnCode ulqr_InitializeKnotPoint(KnotPoint* z, int nstates, int ninputs, sfloat* data,
+                                              sfloat t, sfloat h);
 
 Matrix* ulqr_GetKnotpointState(KnotPoint* z);
 Matrix* ulqr_GetKnotpointInput(KnotPoint* z);
-double ulqr_GetTime(KnotPoint* z);
-double ulqr_GetTimestep(KnotPoint* z);
+sfloat ulqr_GetTime(KnotPoint* z);
+sfloat ulqr_GetTimestep(KnotPoint* z);
@@ -7,8 +7,72 @@
 #include "riccati/constants.h"
 #include "slap/matrix.h"
 
+/* Leading dimension of the dense blocks with the given number of rows */
+static int BlockLeadingDim(int rows) {
+#ifdef ULQR_PAD_COLUMNS
+  return slap_PaddedLeadingDim(rows);
+#else
+  return rows;
+#endif
+}
+
+enum {
+  kBlockQ = 0,
+  kBlockR,
+  kBlockH,
+  kBlockq,
+  kBlockr,
+  kBlockc,
+  kBlockAB,
+  kBlockf,
+  kBlockKd,
+  kBlockP,
+  kBlockp,
+  kBlockQxx,
+  kBlockQuu,
+  kBlockQux,
+  kBlockQx,
+  kBlockQu,
+  kBlocky,
+  kNumBlocks,
+};
+
+/*
+ * Lay out the blocks back to back, each one starting on an aligned boundary. Stores the
+ * offset of each block and returns the total size.
+ */
+static int LQRDataLayout(int nstates, int ninputs, int* offsets) {
+  int nstates_sym = nstates * (nstates + 1) / 2;
+  int ninputs_sym = ninputs * (ninputs + 1) / 2;
+  const int lens[kNumBlocks] = {
+      [kBlockQ] = nstates_sym,
+      [kBlockR] = ninputs_sym,
+      [kBlockH] = BlockLeadingDim(ninputs) * nstates,
+      [kBlockq] = nstates,
+      [kBlockr] = ninputs,
+      [kBlockc] = 1,
+      [kBlockAB] = BlockLeadingDim(nstates) * (nstates + ninputs),
+      [kBlockf] = nstates,
+      [kBlockKd] = BlockLeadingDim(ninputs) * (nstates + 1),
+      [kBlockP] = nstates_sym,
+      [kBlockp] = nstates,
+      [kBlockQxx] = nstates_sym,
+      [kBlockQuu] = ninputs_sym,
+      [kBlockQux] = BlockLeadingDim(ninputs) * nstates,
+      [kBlockQx] = nstates,
+      [kBlockQu] = ninputs,
+      [kBlocky] = nstates,
+  };
+  int offset = 0;
+  for (int i = 0; i < kNumBlocks; ++i) {
+    offsets[i] = offset;
+    offset += slap_AlignedLength(lens[i]);
+  }
+  return offset;
+}
+
 enum ulqr_ReturnCode ulqr_InitializeLQRData(LQRData* lqrdata, int nstates, int ninputs,
-                                            double* data) {
+                                            sfloat* data) {
   if (nstates < 1 || ninputs < 1) {
     printf("ERROR: nstates and ninputs must be positive integers.\n");
     return kBadInput;
@@ -22,71 +86,63 @@ enum ulqr_ReturnCode ulqr_InitializeLQRData(LQRData* lqrdata, int nstates, int n
     return kBadInput;
   }
 
-  // Assign the memory into chunks
-  double* Q = data;
-  double* R = Q + nstates * nstates;
-  double* H = R + ninputs * ninputs;
-  double* q = H + nstates * ninputs;
-  double* r = q + nstates;
-  double* c = r + ninputs;
-  double* A = c + 1;
-  double* B = A + nstates * nstates;
-  double* f = B + nstates * ninputs;
-  double* K = f + nstates;
-  double* d = K + nstates * ninputs;
-  double* P = d + ninputs;
-  double* p = P + nstates * nstates;
-  double* Qxx = p + nstates;
-  double* Quu = Qxx + nstates * nstates;
-  double* Qux = Quu + ninputs * ninputs;
-  double* Qx = Qux + ninputs * nstates;
-  double* Qu = Qx + nstates;
-  double* y = Qu + ninputs;
+  // Assign the memory into chunks, each starting on an aligned boundary
+  // Symmetric blocks only store their lower triangle
+  int offsets[kNumBlocks];
+  int datasize = LQRDataLayout(nstates, ninputs, offsets);
 
   // Initialize the struct
   lqrdata->nstates = nstates;
   lqrdata->ninputs = ninputs;
-  lqrdata->Q.data = Q;
-  lqrdata->R.data = R;
-  lqrdata->H.data = H;
-  lqrdata->q.data = q;
-  lqrdata->r.data = r;
-  lqrdata->c = c;
-  lqrdata->A.data = A;
-  lqrdata->B.data = B;
-  lqrdata->f.data = f;
-  lqrdata->K.data = K;
-  lqrdata->d.data = d;
-  lqrdata->P.data = P;
-  lqrdata->p.data = p;
-  lqrdata->Qxx.data = Qxx;
-  lqrdata->Quu.data = Quu;
-  lqrdata->Qux.data = Qux;
-  lqrdata->Qx.data = Qx;
-  lqrdata->Qu.data = Qu;
-  lqrdata->y.data = y;
-  lqrdata->datasize = LQRDataSize(nstates, ninputs);
+  lqrdata->Q.data = data + offsets[kBlockQ];
+  lqrdata->R.data = data + offsets[kBlockR];
+  lqrdata->H.data = data + offsets[kBlockH];
+  lqrdata->q.data = data + offsets[kBlockq];
+  lqrdata->r.data = data + offsets[kBlockr];
+  lqrdata->c = data + offsets[kBlockc];
+  lqrdata->AB.data = data + offsets[kBlockAB];
+  lqrdata->f.data = data + offsets[kBlockf];
+  lqrdata->Kd.data = data + offsets[kBlockKd];
+  lqrdata->P.data = data + offsets[kBlockP];
+  lqrdata->p.data = data + offsets[kBlockp];
+  lqrdata->Qxx.data = data + offsets[kBlockQxx];
+  lqrdata->Quu.data = data + offsets[kBlockQuu];
+  lqrdata->Qux.data = data + offsets[kBlockQux];
+  lqrdata->Qx.data = data + offsets[kBlockQx];
+  lqrdata->Qu.data = data + offsets[kBlockQu];
+  lqrdata->y.data = data + offsets[kBlocky];
+  lqrdata->datasize = datasize;
+  lqrdata->reg_shift = 0.0;
+  lqrdata->reg_retries = 0;
 
   // Set matrix sizes
-  slap_SetMatrixSize(&lqrdata->Q, nstates, nstates);
-  slap_SetMatrixSize(&lqrdata->R, ninputs, ninputs);
+  lqrdata->Q.n = nstates;
+  lqrdata->R.n = ninputs;
   slap_SetMatrixSize(&lqrdata->H, ninputs, nstates);
+  lqrdata->H.ld = BlockLeadingDim(ninputs);
   slap_SetMatrixSize(&lqrdata->q, nstates, 1);
   slap_SetMatrixSize(&lqrdata->r, ninputs, 1);
-  slap_SetMatrixSize(&lqrdata->A, nstates, nstates);
-  slap_SetMatrixSize(&lqrdata->B, nstates, ninputs);
+  slap_SetMatrixSize(&lqrdata->AB, nstates, nstates + ninputs);
+  lqrdata->AB.ld = BlockLeadingDim(nstates);
   slap_SetMatrixSize(&lqrdata->f, nstates, 1);
-  slap_SetMatrixSize(&lqrdata->K, ninputs, nstates);
-  slap_SetMatrixSize(&lqrdata->d, ninputs, 1);
-  slap_SetMatrixSize(&lqrdata->P, nstates, nstates);
+  slap_SetMatrixSize(&lqrdata->Kd, ninputs, nstates + 1);
+  lqrdata->Kd.ld = BlockLeadingDim(ninputs);
+  lqrdata->P.n = nstates;
   slap_SetMatrixSize(&lqrdata->p, nstates, 1);
-  slap_SetMatrixSize(&lqrdata->Qxx, nstates, nstates);
-  slap_SetMatrixSize(&lqrdata->Quu, ninputs, ninputs);
+  lqrdata->Qxx.n = nstates;
+  lqrdata->Quu.n = ninputs;
   slap_SetMatrixSize(&lqrdata->Qux, ninputs, nstates);
+  lqrdata->Qux.ld = BlockLeadingDim(ninputs);
   slap_SetMatrixSize(&lqrdata->Qx, nstates, 1);
   slap_SetMatrixSize(&lqrdata->Qu, ninputs, 1);
   slap_SetMatrixSize(&lqrdata->y, nstates, 1);
 
+  // Stacked blocks
+  lqrdata->A = slap_MatrixView(&lqrdata->AB, 0, 0, nstates, nstates);
+  lqrdata->B = slap_MatrixView(&lqrdata->AB, 0, nstates, nstates, ninputs);
+  lqrdata->K = slap_MatrixView(&lqrdata->Kd, 0, 0, ninputs, nstates);
+  lqrdata->d = slap_MatrixView(&lqrdata->Kd, 0, nstates, ninputs, 1);
+
   return 0;
 }
 
@@ -97,18 +153,40 @@ int ulqr_CopyLQRData(LQRData* dest, LQRData* src) {
     return -1;
   }
   int total_size = src->datasize;
-  memcpy(dest->Q.data, src->Q.data, total_size * sizeof(double));
+  memcpy(dest->Q.data, src->Q.data, total_size * sizeof(sfloat));
+  return 0;
+}
+
+bool ulqr_IsLQRProblemEqual(const LQRData* a, const LQRData* b) {
+  if (a->nstates != b->nstates || a->ninputs != b->ninputs) {
+    return false;
+  }
+  // The problem data is laid out first, with the constant cost c in the middle
+  int offsets[kNumBlocks];
+  LQRDataLayout(a->nstates, a->ninputs, offsets);
+  int cost_size = offsets[kBlockc] - offsets[kBlockQ];
+  int dynamics_size = offsets[kBlockKd] - offsets[kBlockAB];
+  return memcmp(a->Q.data, b->Q.data, cost_size * sizeof(sfloat)) == 0 &&
+         memcmp(a->AB.data, b->AB.data, dynamics_size * sizeof(sfloat)) == 0;
+}
+
+int ulqr_CopyLQRSolution(LQRData* dest, const LQRData* src) {
+  if (dest->nstates != src->nstates || dest->ninputs != src->ninputs) {
+    fprintf(stderr, "Can't copy LQRData of different sizes: (%d,%d) and (%d,%d).\n", dest->nstates,
+            dest->ninputs, src->nstates, src->ninputs);
+    return -1;
+  }
+  // The blocks from [K d] up to the dual are all computed by the backward pass
+  int offsets[kNumBlocks];
+  LQRDataLayout(src->nstates, src->ninputs, offsets);
+  int solution_size = offsets[kBlocky] - offsets[kBlockKd];
+  memcpy(dest->Kd.data, src->Kd.data, solution_size * sizeof(sfloat));
+  dest->reg_shift = src->reg_shift;
+  dest->reg_retries = src->reg_retries;
   return 0;
 }
 
 int LQRDataSize(int nstates, int ninputs) {
-  int cost_size =
-      (nstates + 1) * nstates + (ninputs + 1) * ninputs + nstates * ninputs + 1;  // Q,R,q,r,c
-  int dynamics_size = nstates * nstates + nstates * ninputs + nstates;            // A,B,d
-  int gains_size = ninputs * (nstates + 1);
-  int ctg_size = nstates * (nstates + 1);
-  int action_value_size = cost_size - 1;
-  int vec_size = nstates;
-  int total_size = cost_size + dynamics_size + gains_size + ctg_size + action_value_size + vec_size;
-  return total_size + 1;
+  int offsets[kNumBlocks];
+  return LQRDataLayout(nstates, ninputs, offsets);
 }
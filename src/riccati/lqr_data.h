@@ -15,6 +15,7 @@
 #include "lqr_data.h"
 #include "riccati/constants.h"
 #include "slap/matrix.h"
+#include "slap/symmatrix.h"
 
 /**
  * @brief Holds the data for a single time step of LQR
@@ -38,6 +39,8 @@
  * -  ulqr_FreeLQRData()
  * -  ulqr_InitializeLQRData()
  * -  ulqr_CopyLQRData()
+ * -  ulqr_CopyLQRSolution()
+ * -  ulqr_IsLQRProblemEqual()
  * -  ulqr_PrintLQRData()
  *
  * ## Getters
@@ -52,31 +55,46 @@
  * -  ulqr_Getq()
  * -  ulqr_Getr()
  *
+ * ## Storage
+ * The symmetric blocks \f$ Q, R, P, Q_{xx}, Q_{uu} \f$ are stored as packed
+ * SymMatrix objects, which need about half the memory of a dense matrix.
+ * The dynamics Jacobians and the gains are each stored as a single block,
+ * \f$ [A \; B] \f$ and \f$ [K \; d] \f$, so they can be used together without copies.
+ *
+ * Every block starts on a `SLAP_ALIGNMENT` byte boundary of the data, so the data passed to
+ *  ulqr_InitializeLQRData() should itself be aligned, e.g. allocated with slap_AlignedAlloc().
+ * If the library is built with the `ULQR_PAD_COLUMNS` CMake option, the columns of
+ * \f$ H, [A \; B], [K \; d] \f$ and \f$ Q_{ux} \f$ are also padded to `SLAP_PADDING` bytes,
+ * so those matrices are not contiguous and their leading dimension must be respected.
  */
 typedef struct {
   int nstates;
   int ninputs;
-  Matrix Q;
-  Matrix R;
+  SymMatrix Q;
+  SymMatrix R;
   Matrix H;
   Matrix q;
   Matrix r;
-  double* c;
+  sfloat* c;
   Matrix A;
   Matrix B;
   Matrix f;
-  Matrix K;    ///< Feedback gain
-  Matrix d;    ///< Feedforward gain
-  Matrix P;    ///< Hessian of the cost-to-go
-  Matrix p;    ///< gradient fo the cost-to-go
-  Matrix Qxx;  ///< Action-value state Hessian
-  Matrix Quu;  ///< Action-value control Hessian
-  Matrix Qux;  ///< Action-value Hessian cross-term
-  Matrix Qx;   ///< Action-value state gradient
-  Matrix Qu;   ///< Action-value control gradient
-  Matrix y;    ///< dual variable
+  Matrix AB;      ///< [A B], of which A and B are views
+  Matrix K;       ///< Feedback gain
+  Matrix d;       ///< Feedforward gain
+  Matrix Kd;      ///< [K d], of which K and d are views
+  SymMatrix P;    ///< Hessian of the cost-to-go
+  Matrix p;       ///< gradient fo the cost-to-go
+  SymMatrix Qxx;  ///< Action-value state Hessian
+  SymMatrix Quu;  ///< Action-value control Hessian
+  Matrix Qux;     ///< Action-value Hessian cross-term
+  Matrix Qx;      ///< Action-value state gradient
+  Matrix Qu;      ///< Action-value control gradient
+  Matrix y;       ///< dual variable
+  sfloat reg_shift;  ///< Diagonal shift added to Quu by the last backward pass
+  int reg_retries;   ///< Number of shifts tried by the last backward pass
 
-  int datasize;  ///< number of doubles needed to store the data
+  int datasize;  ///< number of values needed to store the data
 } LQRData;
 
 /**
@@ -88,7 +106,7 @@ typedef struct {
  * @return 0 if successful
  */
 enum ulqr_ReturnCode ulqr_InitializeLQRData(LQRData* lqrdata, int nstates, int ninputs,
-                                            double* data);
+                                            sfloat* data);
 
 /**
  * @brief Copies one LQRData object to another
@@ -101,6 +119,34 @@ enum ulqr_ReturnCode ulqr_InitializeLQRData(LQRData* lqrdata, int nstates, int n
  */
 int ulqr_CopyLQRData(LQRData* dest, LQRData* src);
 
+/**
+ * @brief Copies the values computed by the backward pass from one LQRData object to another
+ *
+ * Copies the gains, the cost-to-go, the action-value terms and the regularization of
+ * the backward pass, but not the problem data or the dual. The two objects must have
+ * equivalent dimensionality.
+ *
+ * @param dest Copy destination
+ * @param src  Source data
+ * @return 0 if successful
+ */
+int ulqr_CopyLQRSolution(LQRData* dest, const LQRData* src);
+
+/**
+ * @brief Check if two knot points have exactly the same cost and dynamics
+ *
+ * Compares every value of \f$ Q, R, H, q, r, A, B \f$ and \f$ f \f$, which are
+ * all that the backward pass reads. The constant term of the cost isn't compared.
+ *
+ * @return true if the two objects have the same size and problem data
+ */
+bool ulqr_IsLQRProblemEqual(const LQRData* a, const LQRData* b);
+
+/**
+ * @brief Number of values needed to store the data for a single knot point
+ *
+ * Includes the padding between the blocks, so it is always a multiple of the alignment.
+ */
 int LQRDataSize(int nstates, int ninputs);
 
 /**@} */
@@ -0,0 +1,348 @@
+#include "riccati_mixed.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "riccati/riccati_mixed_float.h"
+#include "riccati/riccati_solve.h"
+#include "slap/linalg.h"
+#include "slap/matrix.h"
+
+static const int kMixedMaxRefinements = 10;
+static const double kMixedTolerance = 1e-10;
+
+/* Block of the data of knot point k, with the packed blocks and vectors as a single column */
+static Matrix GetBlock(RiccatiSolver* solver, int k, enum ulqr_MixedBlock block) {
+  LQRData* lqrdata = solver->lqrdata + k;
+  int n = solver->nstates;
+  int m = solver->ninputs;
+  int nsym = n * (n + 1) / 2;
+  int msym = m * (m + 1) / 2;
+  Matrix column = {0, 1, NULL, 0};
+  switch (block) {
+    case kMixedQ:
+      column.rows = nsym;
+      column.data = lqrdata->Q.data;
+      return column;
+    case kMixedR:
+      column.rows = msym;
+      column.data = lqrdata->R.data;
+      return column;
+    case kMixedq:
+      return lqrdata->q;
+    case kMixedr:
+      return lqrdata->r;
+    case kMixedAB:
+      return lqrdata->AB;
+    case kMixedf:
+      return lqrdata->f;
+    case kMixedKd:
+      return lqrdata->Kd;
+    case kMixedP:
+      column.rows = nsym;
+      column.data = lqrdata->P.data;
+      return column;
+    case kMixedp:
+      return lqrdata->p;
+    case kMixedQxx:
+      column.rows = nsym;
+      column.data = lqrdata->Qxx.data;
+      return column;
+    case kMixedQuu:
+      column.rows = msym;
+      column.data = lqrdata->Quu.data;
+      return column;
+    case kMixedQux:
+      return lqrdata->Qux;
+    case kMixedQx:
+      return lqrdata->Qx;
+    case kMixedQu:
+      return lqrdata->Qu;
+    default:
+      return column;
+  }
+}
+
+MixedRiccatiSolver* ulqr_NewMixedRiccatiSolver(RiccatiSolver* solver) {
+  if (!solver) {
+    return NULL;
+  }
+  int nstates = solver->nstates;
+  int ninputs = solver->ninputs;
+  int nhorizon = solver->nhorizon;
+  int chol_size = ninputs * (ninputs + 1) / 2 * nhorizon;
+  int traj_size = (5 * nstates + 3 * ninputs) * nhorizon;
+  int total_size = chol_size + traj_size + nstates;
+
+  MixedRiccatiSolver* mixed = (MixedRiccatiSolver*)malloc(sizeof(MixedRiccatiSolver));
+  sfloat* data = (sfloat*)calloc(total_size, sizeof(sfloat));
+  void* solver_float = ulqr_NewFloatSolver(nstates, ninputs, nhorizon);
+  if (!mixed || !data || !solver_float) {
+    printf("ERROR: Failed to allocate memory for MixedRiccatiSolver.\n");
+    free(mixed);
+    free(data);
+    if (solver_float) {
+      ulqr_FreeFloatSolver(solver_float);
+    }
+    return NULL;
+  }
+
+  mixed->solver = solver;
+  mixed->solver_float = solver_float;
+  mixed->max_refinements = kMixedMaxRefinements;
+  mixed->tolerance = kMixedTolerance;
+  mixed->refinements = 0;
+  mixed->residual = INFINITY;
+  mixed->data = data;
+  mixed->Quu_chol = data;
+
+  // Each knot point is a column of the trajectory-sized blocks
+  sfloat* ptr = data + chol_size;
+  Matrix* blocks[8] = {&mixed->rx, &mixed->ru, &mixed->rf, &mixed->dx,
+                       &mixed->du, &mixed->dy, &mixed->dd, &mixed->dp};
+  const int rows[8] = {nstates, ninputs, nstates, nstates, ninputs, nstates, ninputs, nstates};
+  for (int i = 0; i < 8; ++i) {
+    blocks[i]->data = ptr;
+    slap_SetMatrixSize(blocks[i], rows[i], nhorizon);
+    ptr += rows[i] * nhorizon;
+  }
+  mixed->g.data = ptr;
+  slap_SetMatrixSize(&mixed->g, nstates, 1);
+  return mixed;
+}
+
+int ulqr_FreeMixedRiccatiSolver(MixedRiccatiSolver** solver_ptr) {
+  MixedRiccatiSolver* mixed = *solver_ptr;
+  if (!mixed) {
+    return -1;
+  }
+  ulqr_FreeFloatSolver(mixed->solver_float);
+  free(mixed->data);
+  free(mixed);
+  *solver_ptr = NULL;
+  return 0;
+}
+
+/*
+ * Backward pass for the affine terms only, at knot point k < N-1, using the gains and
+ * the cost-to-go Hessians already in the solver:
+ *   g = P' f + p',  p = q + A'g + K'(r + B'g),  d = -Quu \ (r + B'g)
+ * which is the same as the full backward pass for p and d, since Qux = -Quu K.
+ */
+static void AffineStep(MixedRiccatiSolver* mixed, int k, Matrix* q, Matrix* r, Matrix* f,
+                       Matrix* pn, Matrix* d, Matrix* p) {
+  RiccatiSolver* solver = mixed->solver;
+  int ninputs = solver->ninputs;
+  Matrix* g = &mixed->g;
+  SymMatrix Lquu = {ninputs, mixed->Quu_chol + ninputs * (ninputs + 1) / 2 * k};
+
+  slap_MatrixCopy(g, pn);
+  slap_SymMatrixMultiply(ulqr_GetCostToGoHessian(solver, k + 1), f, g, 1.0, 1.0);
+  slap_MatrixCopy(p, q);
+  slap_MatrixMultiply(ulqr_GetA(solver, k), g, p, 1, 0, 1.0, 1.0);
+  slap_MatrixCopy(d, r);
+  slap_MatrixMultiply(ulqr_GetB(solver, k), g, d, 1, 0, 1.0, 1.0);
+  slap_MatrixMultiply(ulqr_GetFeedbackGain(solver, k), d, p, 1, 0, 1.0, 1.0);
+  slap_SymCholeskySolve(&Lquu, d);
+  slap_MatrixScaleByConst(d, -1.0);
+}
+
+/*
+ * Largest 2-norm of any block of the right-hand side of the KKT system, i.e. of the
+ * initial state and the affine terms, which scales the refinement tolerance.
+ */
+static double CalcRHSNorm(RiccatiSolver* solver) {
+  int nhorizon = solver->nhorizon;
+  double norm = slap_TwoNorm(&solver->x0);
+  for (int k = 0; k < nhorizon; ++k) {
+    norm = fmax(norm, slap_TwoNorm(ulqr_Getq(solver, k)));
+    if (k < nhorizon - 1) {
+      norm = fmax(norm, slap_TwoNorm(ulqr_Getr(solver, k)));
+      norm = fmax(norm, slap_TwoNorm(ulqr_Getf(solver, k)));
+    }
+  }
+  return norm;
+}
+
+/*
+ * Evaluate the KKT conditions at the current solution, storing the residuals and
+ * returning the largest 2-norm of any of them:
+ *   Q x + q + A'y' - y,  (R + s I) u + r + B'y',  A x + B u + f - x',  x0 - x_1
+ * where s is the regularization shift of the knot point, if any.
+ */
+static double CalcResidual(MixedRiccatiSolver* mixed) {
+  RiccatiSolver* solver = mixed->solver;
+  int nstates = solver->nstates;
+  int ninputs = solver->ninputs;
+  int nhorizon = solver->nhorizon;
+
+  Matrix r0 = slap_MatrixView(&mixed->dx, 0, 0, nstates, 1);
+  slap_MatrixCopy(&r0, &solver->x0);
+  slap_MatrixAddition(ulqr_GetState(solver, 0), &r0, -1.0);
+  double res = slap_TwoNorm(&r0);
+
+  for (int k = 0; k < nhorizon; ++k) {
+    Matrix* x = ulqr_GetState(solver, k);
+    Matrix* y = ulqr_GetDual(solver, k);
+    Matrix rx = slap_MatrixView(&mixed->rx, 0, k, nstates, 1);
+    slap_MatrixCopy(&rx, ulqr_Getq(solver, k));
+    slap_SymMatrixMultiply(ulqr_GetQ(solver, k), x, &rx, 1.0, 1.0);
+    slap_MatrixAddition(y, &rx, -1.0);
+    if (k < nhorizon - 1) {
+      Matrix* u = ulqr_GetInput(solver, k);
+      Matrix* yn = ulqr_GetDual(solver, k + 1);
+      slap_MatrixMultiply(ulqr_GetA(solver, k), yn, &rx, 1, 0, 1.0, 1.0);
+
+      Matrix ru = slap_MatrixView(&mixed->ru, 0, k, ninputs, 1);
+      slap_MatrixCopy(&ru, ulqr_Getr(solver, k));
+      slap_SymMatrixMultiply(ulqr_GetR(solver, k), u, &ru, 1.0, 1.0);
+      slap_MatrixAddition(u, &ru, ulqr_GetRegularizationShift(solver, k));
+      slap_MatrixMultiply(ulqr_GetB(solver, k), yn, &ru, 1, 0, 1.0, 1.0);
+      res = fmax(res, slap_TwoNorm(&ru));
+
+      Matrix rf = slap_MatrixView(&mixed->rf, 0, k, nstates, 1);
+      slap_MatrixCopy(&rf, ulqr_Getf(solver, k));
+      slap_MatrixMultiply(ulqr_GetA(solver, k), x, &rf, 0, 0, 1.0, 1.0);
+      slap_MatrixMultiply(ulqr_GetB(solver, k), u, &rf, 0, 0, 1.0, 1.0);
+      slap_MatrixAddition(ulqr_GetState(solver, k + 1), &rf, -1.0);
+      res = fmax(res, slap_TwoNorm(&rf));
+    }
+    res = fmax(res, slap_TwoNorm(&rx));
+  }
+  return res;
+}
+
+/*
+ * Solve for the correction to the solution, i.e. the solution of the LQR problem with
+ * the residuals from CalcResidual() as its affine terms, and add it to the solution.
+ */
+static void Refine(MixedRiccatiSolver* mixed) {
+  RiccatiSolver* solver = mixed->solver;
+  int nstates = solver->nstates;
+  int ninputs = solver->ninputs;
+  int nhorizon = solver->nhorizon;
+
+  // Backward pass
+  int k = nhorizon - 1;
+  Matrix pn = slap_MatrixView(&mixed->dp, 0, k, nstates, 1);
+  Matrix rx = slap_MatrixView(&mixed->rx, 0, k, nstates, 1);
+  slap_MatrixCopy(&pn, &rx);
+  for (--k; k >= 0; --k) {
+    Matrix p = slap_MatrixView(&mixed->dp, 0, k, nstates, 1);
+    Matrix d = slap_MatrixView(&mixed->dd, 0, k, ninputs, 1);
+    Matrix ru = slap_MatrixView(&mixed->ru, 0, k, ninputs, 1);
+    Matrix rf = slap_MatrixView(&mixed->rf, 0, k, nstates, 1);
+    rx = slap_MatrixView(&mixed->rx, 0, k, nstates, 1);
+    AffineStep(mixed, k, &rx, &ru, &rf, &pn, &d, &p);
+    pn = p;
+  }
+
+  // Forward pass, starting from the initial state residual left in dx by CalcResidual()
+  for (k = 0; k < nhorizon; ++k) {
+    Matrix dx = slap_MatrixView(&mixed->dx, 0, k, nstates, 1);
+    Matrix dy = slap_MatrixView(&mixed->dy, 0, k, nstates, 1);
+    Matrix p = slap_MatrixView(&mixed->dp, 0, k, nstates, 1);
+    slap_MatrixCopy(&dy, &p);
+    slap_SymMatrixMultiply(ulqr_GetCostToGoHessian(solver, k), &dx, &dy, 1.0, 1.0);
+    slap_MatrixAddition(&dy, ulqr_GetDual(solver, k), 1.0);
+    slap_MatrixAddition(&dx, ulqr_GetState(solver, k), 1.0);
+    if (k < nhorizon - 1) {
+      Matrix du = slap_MatrixView(&mixed->du, 0, k, ninputs, 1);
+      Matrix d = slap_MatrixView(&mixed->dd, 0, k, ninputs, 1);
+      Matrix rf = slap_MatrixView(&mixed->rf, 0, k, nstates, 1);
+      Matrix dxn = slap_MatrixView(&mixed->dx, 0, k + 1, nstates, 1);
+      slap_MatrixCopy(&du, &d);
+      slap_MatrixMultiply(ulqr_GetFeedbackGain(solver, k), &dx, &du, 0, 0, 1.0, 1.0);
+      slap_MatrixAddition(&du, ulqr_GetInput(solver, k), 1.0);
+      slap_MatrixCopy(&dxn, &rf);
+      slap_MatrixMultiply(ulqr_GetA(solver, k), &dx, &dxn, 0, 0, 1.0, 1.0);
+      slap_MatrixMultiply(ulqr_GetB(solver, k), &du, &dxn, 0, 0, 1.0, 1.0);
+    }
+  }
+}
+
+int ulqr_SolveRiccatiMixed(MixedRiccatiSolver* mixed) {
+  if (!mixed) {
+    return -1;
+  }
+  RiccatiSolver* solver = mixed->solver;
+  int ninputs = solver->ninputs;
+  int nhorizon = solver->nhorizon;
+
+  // Backward pass in single precision, with the same regularization settings
+  ulqr_SetFloatRegularization(mixed->solver_float, solver->reg_min, solver->reg_max);
+  for (int k = 0; k < nhorizon; ++k) {
+    for (int b = 0; b < kMixedNumInputBlocks; ++b) {
+      Matrix src = GetBlock(solver, k, b);
+      int ld_src = slap_MatrixLeadingDim(&src);
+      int ld_dst;
+      float* dst = ulqr_GetFloatBlock(mixed->solver_float, k, b, &ld_dst);
+      for (int j = 0; j < src.cols; ++j) {
+        for (int i = 0; i < src.rows; ++i) {
+          dst[i + j * ld_dst] = (float)src.data[i + j * ld_src];
+        }
+      }
+    }
+  }
+  if (ulqr_FloatBackwardPass(mixed->solver_float) != 0) {
+    return -1;
+  }
+  for (int k = 0; k < nhorizon; ++k) {
+    for (int b = kMixedNumInputBlocks; b < kMixedNumBlocks; ++b) {
+      Matrix dst = GetBlock(solver, k, b);
+      int ld_dst = slap_MatrixLeadingDim(&dst);
+      int ld_src;
+      const float* src = ulqr_GetFloatBlock(mixed->solver_float, k, b, &ld_src);
+      for (int j = 0; j < dst.cols; ++j) {
+        for (int i = 0; i < dst.rows; ++i) {
+          dst.data[i + j * ld_dst] = src[i + j * ld_src];
+        }
+      }
+    }
+  }
+
+  for (int k = 0; k < nhorizon - 1; ++k) {
+    LQRData* lqrdata = solver->lqrdata + k;
+    lqrdata->reg_shift =
+        ulqr_GetFloatRegularizationShift(mixed->solver_float, k, &lqrdata->reg_retries);
+  }
+
+  // The terminal cost-to-go is exactly the terminal cost
+  slap_SymMatrixCopy(ulqr_GetCostToGoHessian(solver, nhorizon - 1),
+                     ulqr_GetQ(solver, nhorizon - 1));
+  slap_MatrixCopy(ulqr_GetCostToGoGradient(solver, nhorizon - 1),
+                  ulqr_Getq(solver, nhorizon - 1));
+
+  // Factor Quu once for all the affine backward passes, with the shift of the gains
+  for (int k = 0; k < nhorizon - 1; ++k) {
+    SymMatrix Lquu = {ninputs, mixed->Quu_chol + ninputs * (ninputs + 1) / 2 * k};
+    slap_SymMatrixCopy(&Lquu, ulqr_GetQuu(solver, k));
+    for (int i = 0; i < ninputs; ++i) {
+      *slap_SymMatrixAt(&Lquu, i, i) += ulqr_GetRegularizationShift(solver, k);
+    }
+    if (slap_SymCholeskyFactorize(&Lquu) != slap_kCholeskySuccess) {
+      printf("ERROR: Quu is not positive definite at knot point %d.\n", k);
+      return -1;
+    }
+  }
+
+  // Affine terms in double precision, followed by the usual forward pass
+  for (int k = nhorizon - 2; k >= 0; --k) {
+    AffineStep(mixed, k, ulqr_Getq(solver, k), ulqr_Getr(solver, k), ulqr_Getf(solver, k),
+               ulqr_GetCostToGoGradient(solver, k + 1), ulqr_GetFeedforwardGain(solver, k),
+               ulqr_GetCostToGoGradient(solver, k));
+  }
+  ulqr_ForwardPass(solver);
+
+  // Iterative refinement, to a tolerance relative to the right-hand side
+  double tolerance = mixed->tolerance * CalcRHSNorm(solver);
+  mixed->refinements = 0;
+  mixed->residual = CalcResidual(mixed);
+  while (mixed->residual > tolerance && mixed->refinements < mixed->max_refinements) {
+    Refine(mixed);
+    mixed->residual = CalcResidual(mixed);
+    ++mixed->refinements;
+  }
+  return mixed->residual <= tolerance ? 0 : -1;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file riccati_mixed.h
+ * @author Brian Jackson (bjack205@gmail.com)
+ * @brief Mixed-precision Riccati solve with iterative refinement
+ * @version 0.1
+ * @date 2022-02-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * @addtogroup riccati
+ * @{
+ */
+#pragma once
+
+#include "riccati_solver.h"
+
+#ifdef SLAP_USE_FLOAT
+#error "The mixed-precision solver is only available in double precision."
+#endif
+
+/**
+ * @brief Riccati solver that runs the backward pass in single precision
+ *
+ * The \f$ O(N n^3) \f$ backward pass is run on a single-precision copy of the problem,
+ * and its gains and cost-to-go Hessians are copied back to a double-precision solver.
+ * The affine terms and the forward pass are then computed in double precision, after
+ * which the solution is refined by a few \f$ O(N n^2) \f$ sweeps. Each sweep computes
+ * the KKT residual of the LQR problem in double precision and solves for the correction
+ * with the stored gains: the correction is the solution of the same LQR problem with the
+ * residuals as the affine terms, which only needs the affine part of the backward pass.
+ *
+ * Each sweep reduces the residual by roughly the relative accuracy of the gains, so on
+ * well-conditioned problems a few sweeps recover double-precision accuracy. The sweeps stop
+ * once the residual is below `tolerance` times the largest 2-norm of the initial state and
+ * the affine terms, so the tolerance doesn't depend on the scaling of the problem.
+ *
+ * The single-precision backward pass uses the `reg_min` and `reg_max` settings of the
+ * wrapped solver. If it shifts \f$ Q_{uu} \f$ at any knot point, the shift is stored in
+ * the wrapped solver as well, and the solution is refined to that of the regularized
+ * problem, i.e. with \f$ R + s I \f$ as the input cost, the same problem solved by
+ * ulqr_SolveRiccati() with regularization.
+ *
+ * Only available when the single-precision libraries are built (`ULQR_BUILD_FLOAT`).
+ *
+ * ## Construction and destruction
+ * Use ulqr_NewMixedRiccatiSolver() to wrap an existing solver, which must be paired
+ * with a call to ulqr_FreeMixedRiccatiSolver(). The wrapped solver still belongs to
+ * the caller, and is where the problem data is set and the solution is read.
+ *
+ * ## Typical Usage
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * RiccatiSolver* solver = ulqr_NewRiccatiSolver(nstates, ninputs, nhorizon);
+ * // set the problem data
+ * MixedRiccatiSolver* mixed = ulqr_NewMixedRiccatiSolver(solver);
+ * ulqr_SolveRiccatiMixed(mixed);
+ * printf("KKT residual: %g\n", mixed->residual);
+ * ulqr_FreeMixedRiccatiSolver(&mixed);
+ * ulqr_FreeRiccatiSolver(&solver);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+typedef struct {
+  // clang-format off
+  RiccatiSolver* solver;  ///< double-precision solver with the problem data and the solution
+  void* solver_float;     ///< single-precision copy of the problem, used for the backward pass
+  int max_refinements;    ///< maximum number of refinement sweeps (default 10)
+  double tolerance;       ///< relative KKT residual at which refinement stops (default 1e-10)
+  int refinements;        ///< number of refinement sweeps done by the last solve
+  double residual;        ///< KKT residual of the solution from the last solve
+  sfloat* data;     ///< pointer to the beginning of the workspace
+  sfloat* Quu_chol; ///< packed Cholesky factors of Quu, for each knot point
+  Matrix rx;  ///< (n,N) KKT residual of the stationarity wrt the states, per knot point
+  Matrix ru;  ///< (m,N) KKT residual of the stationarity wrt the inputs, per knot point
+  Matrix rf;  ///< (n,N) KKT residual of the dynamics, per knot point
+  Matrix dx;  ///< (n,N) state correction
+  Matrix du;  ///< (m,N) input correction
+  Matrix dy;  ///< (n,N) dual correction
+  Matrix dd;  ///< (m,N) feedforward gains of the correction
+  Matrix dp;  ///< (n,N) cost-to-go gradients of the correction
+  Matrix g;   ///< (n,) temporary vector
+  // clang-format on
+} MixedRiccatiSolver;
+
+/**
+ * @brief Create a mixed-precision solver for an existing Riccati solver
+ *
+ * Allocates all the memory needed by ulqr_SolveRiccatiMixed(), including a
+ * single-precision copy of the problem.
+ *
+ * @param solver An initialized RiccatiSolver, which must outlive the mixed-precision one
+ * @return A new mixed-precision solver, or NULL if the allocation failed
+ */
+MixedRiccatiSolver* ulqr_NewMixedRiccatiSolver(RiccatiSolver* solver);
+
+/**
+ * @brief Free the memory for a mixed-precision solver
+ *
+ * Does not free the wrapped RiccatiSolver.
+ *
+ * @param solver Pointer to an initialized mixed-precision solver
+ * @post solver will be NULL
+ * @return 0 if successful
+ */
+int ulqr_FreeMixedRiccatiSolver(MixedRiccatiSolver** solver);
+
+/**
+ * @brief Solve the LQR problem, with the backward pass in single precision
+ *
+ * The solution, gains, and cost-to-go are stored in the wrapped solver, as for
+ * ulqr_SolveRiccati(). The number of refinement sweeps and the final KKT residual, i.e.
+ * the largest 2-norm of the residual of any of the KKT conditions at any knot point, are
+ * stored in @p solver.
+ *
+ * @param solver An initialized mixed-precision solver
+ * @return 0 if the residual is below the tolerance times the norm of the right-hand side,
+ *         and -1 otherwise, or if the single-precision backward pass failed.
+ */
+int ulqr_SolveRiccatiMixed(MixedRiccatiSolver* solver);
+
+/**@} */
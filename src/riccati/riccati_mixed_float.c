@@ -0,0 +1,74 @@
+// Compiled with SLAP_USE_FLOAT, against the single-precision libraries
+#include "riccati_mixed_float.h"
+
+#include <stddef.h>
+
+#include "riccati/riccati_solve.h"
+#include "riccati/riccati_solver.h"
+#include "slap/matrix.h"
+
+void* ulqr_NewFloatSolver(int nstates, int ninputs, int nhorizon) {
+  return ulqr_NewRiccatiSolver(nstates, ninputs, nhorizon);
+}
+
+void ulqr_FreeFloatSolver(void* solver) {
+  RiccatiSolver* fsolver = (RiccatiSolver*)solver;
+  ulqr_FreeRiccatiSolver(&fsolver);
+}
+
+/* Data of a dense block, along with its leading dimension */
+static float* DenseBlock(const Matrix* mat, int* ld) {
+  *ld = slap_MatrixLeadingDim(mat);
+  return mat->data;
+}
+
+float* ulqr_GetFloatBlock(void* solver, int k, enum ulqr_MixedBlock block, int* ld) {
+  RiccatiSolver* fsolver = (RiccatiSolver*)solver;
+  *ld = 0;
+  switch (block) {
+    case kMixedQ:
+      return ulqr_GetQ(fsolver, k)->data;
+    case kMixedR:
+      return ulqr_GetR(fsolver, k)->data;
+    case kMixedq:
+      return ulqr_Getq(fsolver, k)->data;
+    case kMixedr:
+      return ulqr_Getr(fsolver, k)->data;
+    case kMixedAB:
+      return DenseBlock(ulqr_GetAB(fsolver, k), ld);
+    case kMixedf:
+      return ulqr_Getf(fsolver, k)->data;
+    case kMixedKd:
+      return DenseBlock(ulqr_GetGains(fsolver, k), ld);
+    case kMixedP:
+      return ulqr_GetCostToGoHessian(fsolver, k)->data;
+    case kMixedp:
+      return ulqr_GetCostToGoGradient(fsolver, k)->data;
+    case kMixedQxx:
+      return ulqr_GetQxx(fsolver, k)->data;
+    case kMixedQuu:
+      return ulqr_GetQuu(fsolver, k)->data;
+    case kMixedQux:
+      return DenseBlock(ulqr_GetQux(fsolver, k), ld);
+    case kMixedQx:
+      return ulqr_GetQx(fsolver, k)->data;
+    case kMixedQu:
+      return ulqr_GetQu(fsolver, k)->data;
+    default:
+      return NULL;
+  }
+}
+
+void ulqr_SetFloatRegularization(void* solver, double reg_min, double reg_max) {
+  RiccatiSolver* fsolver = (RiccatiSolver*)solver;
+  fsolver->reg_min = (float)reg_min;
+  fsolver->reg_max = (float)reg_max;
+}
+
+double ulqr_GetFloatRegularizationShift(void* solver, int k, int* retries) {
+  RiccatiSolver* fsolver = (RiccatiSolver*)solver;
+  *retries = ulqr_GetRegularizationRetries(fsolver, k);
+  return ulqr_GetRegularizationShift(fsolver, k);
+}
+
+int ulqr_FloatBackwardPass(void* solver) { return ulqr_BackwardPass((RiccatiSolver*)solver); }
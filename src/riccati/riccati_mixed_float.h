@@ -0,0 +1,64 @@
+/**
+ * @file riccati_mixed_float.h
+ * @author Brian Jackson (bjack205@gmail.com)
+ * @brief Interface to the single-precision solver used by the mixed-precision solve
+ * @version 0.1
+ * @date 2022-02-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * The headers of the two precisions can't be included in the same translation unit, so
+ * the single-precision side is wrapped by riccati_mixed_float.c, which is compiled with
+ * `SLAP_USE_FLOAT`, behind this interface of plain C types.
+ *
+ * This header is internal to riccati_mixed.
+ */
+#pragma once
+
+/** @brief Blocks of the data of a knot point */
+enum ulqr_MixedBlock {
+  kMixedQ = 0,
+  kMixedR,
+  kMixedq,
+  kMixedr,
+  kMixedAB,
+  kMixedf,
+  kMixedKd,
+  kMixedP,
+  kMixedp,
+  kMixedQxx,
+  kMixedQuu,
+  kMixedQux,
+  kMixedQx,
+  kMixedQu,
+  kMixedNumBlocks,
+};
+
+/** @brief Number of blocks read by the backward pass, which all come first */
+static const int kMixedNumInputBlocks = kMixedKd;
+
+/** @brief Allocate a new single-precision solver, returning NULL on failure */
+void* ulqr_NewFloatSolver(int nstates, int ninputs, int nhorizon);
+
+void ulqr_FreeFloatSolver(void* solver);
+
+/**
+ * @brief Pointer to the data for @p block of knot point @p k
+ *
+ * @param ld Set to the leading dimension of the dense blocks (AB, Kd and Qux). The others
+ *           are stored contiguously, as a single column.
+ */
+float* ulqr_GetFloatBlock(void* solver, int k, enum ulqr_MixedBlock block, int* ld);
+
+/** @brief Set the `reg_min` and `reg_max` regularization settings of the solver */
+void ulqr_SetFloatRegularization(void* solver, double reg_min, double reg_max);
+
+/**
+ * @brief Diagonal shift of Quu at knot point @p k from the last backward pass
+ *
+ * @param retries Set to the number of shifts tried, as ulqr_GetRegularizationRetries()
+ */
+double ulqr_GetFloatRegularizationShift(void* solver, int k, int* retries);
+
+/** @brief Run ulqr_BackwardPass() on the single-precision solver */
+int ulqr_FloatBackwardPass(void* solver);
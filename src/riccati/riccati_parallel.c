@@ -0,0 +1,650 @@
+#include "riccati_parallel.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "riccati/riccati_solve.h"
+#include "riccati/thread_pool.h"
+#include "slap/linalg.h"
+#include "slap/matrix.h"
+
+/* Workspace of the segment of knot points [start, end) */
+struct ParallelSegment {
+  int start;
+  int end;
+  int status;     ///< result of the backward pass of the segment
+  Matrix P_work;  ///< (n,n) workspace of ulqr_BackwardStep()
+  Matrix Qzz_work;
+  Arena scratch;
+  Matrix Phi_work;  ///< (n,n) other half of the ping-pong for Phi
+  Matrix Acl;       ///< (n,n) closed-loop dynamics A + B K
+  Matrix W;         ///< (m,n) Lu \ B' Phi
+  Matrix x;         ///< (n,) temporary vector
+  Matrix xn;        ///< (n,) temporary vector
+  Matrix u;         ///< (m,) temporary vector
+  SymMatrix P_end;  ///< cost-to-go Hessian of the full problem after the segment
+  Matrix p_end;     ///< (n,) cost-to-go gradient of the full problem after the segment
+};
+
+/*
+ * Relation between the boundary values of the segments [lo, hi):
+ *   lambda_lo = P xi_lo + Phi lambda_hi + p,  xi_hi = Phi' xi_lo - G lambda_hi + c
+ * Leaves are single segments. Other nodes merge their children, [lo, mid) and [mid, hi),
+ * and keep the LU factors of I + G_left P_right to recover the values at mid.
+ */
+struct ParallelNode {
+  int lo;
+  int mid;
+  int hi;
+  int left;
+  int right;
+  Matrix P;    ///< (n,n)
+  Matrix Phi;  ///< (n,n)
+  Matrix G;    ///< (n,n)
+  Matrix p;    ///< (n,)
+  Matrix c;    ///< (n,)
+  Matrix M;    ///< (n,n) factors of I + G_left P_right
+  int* ipiv;
+};
+
+/*
+ * Default shortest horizon for ulqr_ForwardPassParallel(). Handing out its two batches
+ * of tasks takes tens of microseconds, already a tenth of the sequential forward pass of
+ * 512 knot points with a handful of states.
+ */
+static const int kForwardMinHorizon = 512;
+
+/* Take an aligned matrix from a block of memory allocated with slap_AlignedAlloc() */
+static Matrix TakeMatrix(sfloat** ptr, int rows, int cols) {
+  Matrix mat = {rows, cols, *ptr, rows};
+  *ptr += slap_AlignedLength(rows * cols);
+  return mat;
+}
+
+static int SegmentSize(int n, int m) {
+  return slap_AlignedLength(n * n) + slap_AlignedLength((n + m) * (n + m)) +
+         ulqr_RiccatiScratchSize(n, m) + 2 * slap_AlignedLength(n * n) +
+         slap_AlignedLength(m * n) + 3 * slap_AlignedLength(n) + slap_AlignedLength(m) +
+         slap_AlignedLength(n * (n + 1) / 2);
+}
+
+static int NodeSize(int n) { return 4 * slap_AlignedLength(n * n) + 2 * slap_AlignedLength(n); }
+
+/* Build the merge tree of the segments [lo, hi), returning the index of its root */
+static int BuildTree(ParallelRiccatiSolver* par, int lo, int hi, int* nnodes) {
+  if (hi - lo == 1) {
+    par->nodes[lo].lo = lo;
+    par->nodes[lo].hi = hi;
+    return lo;
+  }
+  int mid = (lo + hi) / 2;
+  int left = BuildTree(par, lo, mid, nnodes);
+  int right = BuildTree(par, mid, hi, nnodes);
+  int index = (*nnodes)++;
+  struct ParallelNode* node = par->nodes + index;
+  node->lo = lo;
+  node->mid = mid;
+  node->hi = hi;
+  node->left = left;
+  node->right = right;
+  return index;
+}
+
+ParallelRiccatiSolver* ulqr_NewParallelRiccatiSolver(RiccatiSolver* solver, int nthreads) {
+  if (!solver) {
+    return NULL;
+  }
+  int n = solver->nstates;
+  int m = solver->ninputs;
+  int nhorizon = solver->nhorizon;
+  ThreadPool* pool = ulqr_NewThreadPool(nthreads);
+  if (!pool) {
+    return NULL;
+  }
+  nthreads = ulqr_ThreadPoolSize(pool);
+  int nsegments = nthreads < nhorizon ? nthreads : nhorizon;
+  int nnodes = 2 * nsegments - 1;
+
+  int total_size = nsegments * SegmentSize(n, m) + nnodes * NodeSize(n) +
+                   2 * slap_AlignedLength(n * nsegments) +
+                   slap_AlignedLength(n * (n + 1) / 2) + slap_AlignedLength(n) +
+                   slap_AlignedLength(n * (2 * n + 2));
+
+  ParallelRiccatiSolver* par = (ParallelRiccatiSolver*)malloc(sizeof(ParallelRiccatiSolver));
+  sfloat* data = (sfloat*)slap_AlignedAlloc(total_size * sizeof(sfloat));
+  int* ipiv = (int*)malloc(nnodes * n * sizeof(int));
+  struct ParallelSegment* segments =
+      (struct ParallelSegment*)malloc(nsegments * sizeof(struct ParallelSegment));
+  struct ParallelNode* nodes = (struct ParallelNode*)malloc(nnodes * sizeof(struct ParallelNode));
+  if (!par || !data || !ipiv || !segments || !nodes) {
+    printf("ERROR: Failed to allocate memory for ParallelRiccatiSolver.\n");
+    free(par);
+    free(data);
+    free(ipiv);
+    free(segments);
+    free(nodes);
+    ulqr_FreeThreadPool(&pool);
+    return NULL;
+  }
+  memset(data, 0, total_size * sizeof(sfloat));
+
+  par->solver = solver;
+  par->nthreads = nthreads;
+  par->nsegments = nsegments;
+  par->forward_min_horizon = kForwardMinHorizon;
+  par->pool = pool;
+  par->data = data;
+  par->ipiv = ipiv;
+  par->segments = segments;
+  par->nodes = nodes;
+
+  sfloat* ptr = data;
+  for (int j = 0; j < nsegments; ++j) {
+    struct ParallelSegment* seg = segments + j;
+    seg->start = (int)((long)j * nhorizon / nsegments);
+    seg->end = (int)((long)(j + 1) * nhorizon / nsegments);
+    seg->status = 0;
+    seg->P_work = TakeMatrix(&ptr, n, n);
+    seg->Qzz_work = TakeMatrix(&ptr, n + m, n + m);
+    int scratch_size = ulqr_RiccatiScratchSize(n, m);
+    seg->scratch = slap_InitArena(ptr, scratch_size);
+    ptr += scratch_size;
+    seg->Phi_work = TakeMatrix(&ptr, n, n);
+    seg->Acl = TakeMatrix(&ptr, n, n);
+    seg->W = TakeMatrix(&ptr, m, n);
+    seg->x = TakeMatrix(&ptr, n, 1);
+    seg->xn = TakeMatrix(&ptr, n, 1);
+    seg->u = TakeMatrix(&ptr, m, 1);
+    seg->P_end.n = n;
+    seg->P_end.data = ptr;
+    ptr += slap_AlignedLength(n * (n + 1) / 2);
+    seg->p_end = TakeMatrix(&ptr, n, 1);
+  }
+  for (int i = 0; i < nnodes; ++i) {
+    struct ParallelNode* node = nodes + i;
+    node->lo = 0;
+    node->mid = 0;
+    node->hi = 0;
+    node->left = -1;
+    node->right = -1;
+    node->P = TakeMatrix(&ptr, n, n);
+    node->Phi = TakeMatrix(&ptr, n, n);
+    node->G = TakeMatrix(&ptr, n, n);
+    node->M = TakeMatrix(&ptr, n, n);
+    node->p = TakeMatrix(&ptr, n, 1);
+    node->c = TakeMatrix(&ptr, n, 1);
+    node->ipiv = ipiv + i * n;
+  }
+  int count = nsegments;
+  par->root = BuildTree(par, 0, nsegments, &count);
+
+  par->xi = TakeMatrix(&ptr, n, nsegments);
+  par->lambda = TakeMatrix(&ptr, n, nsegments);
+  par->P_zero.n = n;
+  par->P_zero.data = ptr;
+  ptr += slap_AlignedLength(n * (n + 1) / 2);
+  par->p_zero = TakeMatrix(&ptr, n, 1);
+  par->merge_work = TakeMatrix(&ptr, n, 2 * n + 2);
+  return par;
+}
+
+int ulqr_FreeParallelRiccatiSolver(ParallelRiccatiSolver** solver_ptr) {
+  ParallelRiccatiSolver* par = *solver_ptr;
+  if (!par) {
+    return -1;
+  }
+  ThreadPool* pool = (ThreadPool*)par->pool;
+  ulqr_FreeThreadPool(&pool);
+  free(par->data);
+  free(par->ipiv);
+  free(par->segments);
+  free(par->nodes);
+  free(par);
+  *solver_ptr = NULL;
+  return 0;
+}
+
+/*
+ * Backward pass of segment j, with a zero cost-to-go after its last knot point unless it
+ * ends the horizon. Also forms the leaf of the merge tree for the segment, propagating
+ *   Phi_k = (A_k + B_k K_k)' Phi_{k+1},  G += W_k' W_k,  W_k = Lu_k \ B_k' Phi_{k+1}
+ * from Phi = I after the segment, and simulating the segment from a zero state for c.
+ * The gains and cost-to-go of every segment but the last are only those of the segment's
+ * own problem until SegmentForwardPass() runs it again.
+ */
+static void SegmentBackwardPass(void* context, int j) {
+  ParallelRiccatiSolver* par = (ParallelRiccatiSolver*)context;
+  RiccatiSolver* solver = par->solver;
+  struct ParallelSegment* seg = par->segments + j;
+  struct ParallelNode* leaf = par->nodes + j;
+  int n = solver->nstates;
+  int m = solver->ninputs;
+  bool last = seg->end == solver->nhorizon;
+  Matrix Lquu_dense = slap_MatrixView(&seg->Qzz_work, n, n, m, m);
+
+  int k = seg->end - 1;
+  if (last) {
+    slap_SymMatrixCopy(ulqr_GetCostToGoHessian(solver, k), ulqr_GetQ(solver, k));
+    slap_MatrixCopy(ulqr_GetCostToGoGradient(solver, k), ulqr_Getq(solver, k));
+    --k;
+
+    // There is no dual after the horizon, so the terms of the leaf that multiply it, and
+    // the state after the horizon, are zero
+    slap_MatrixSetConst(&leaf->Phi, 0.0);
+    slap_MatrixSetConst(&leaf->G, 0.0);
+    slap_MatrixSetConst(&leaf->c, 0.0);
+  } else {
+    slap_MatrixSetConst(&leaf->Phi, 0.0);
+    for (int i = 0; i < n; ++i) {
+      *slap_MatrixAt(&leaf->Phi, i, i) = 1.0;
+    }
+    slap_MatrixSetConst(&leaf->G, 0.0);
+  }
+
+  // Phi ping-pongs between the leaf and the segment workspace
+  Matrix* Phi = &leaf->Phi;
+  Matrix* Phi_next = &seg->Phi_work;
+  for (; k >= seg->start; --k) {
+    bool after_end = k + 1 == seg->end;
+    SymMatrix* Pn = after_end ? &par->P_zero : ulqr_GetCostToGoHessian(solver, k + 1);
+    Matrix* pn = after_end ? &par->p_zero : ulqr_GetCostToGoGradient(solver, k + 1);
+    if (ulqr_BackwardStep(solver, k, Pn, pn, &seg->P_work, &seg->Qzz_work, &seg->scratch)) {
+      seg->status = -1;
+      return;
+    }
+    if (last) {
+      continue;
+    }
+
+    Matrix* A = ulqr_GetA(solver, k);
+    Matrix* B = ulqr_GetB(solver, k);
+    slap_MatrixMultiply(B, Phi, &seg->W, 1, 0, 1.0, 0.0);  // W = B' Phi
+    slap_LowerTriBackSub(&Lquu_dense, &seg->W, false);    // W = Lu \ B' Phi
+    slap_SymmetricRankKUpdate(&seg->W, &leaf->G, 1.0, 1.0, k == seg->start);
+    slap_MatrixCopy(&seg->Acl, A);
+    slap_MatrixMultiply(B, ulqr_GetFeedbackGain(solver, k), &seg->Acl, 0, 0, 1.0, 1.0);
+    slap_MatrixMultiply(&seg->Acl, Phi, Phi_next, 1, 0, 1.0, 0.0);  // Phi = (A + B K)' Phi
+    Matrix* tmp = Phi;
+    Phi = Phi_next;
+    Phi_next = tmp;
+  }
+  if (!last && Phi != &leaf->Phi) {
+    slap_MatrixCopy(&leaf->Phi, Phi);
+  }
+  slap_SymMatrixUnpack(&leaf->P, ulqr_GetCostToGoHessian(solver, seg->start));
+  slap_MatrixCopy(&leaf->p, ulqr_GetCostToGoGradient(solver, seg->start));
+  if (last) {
+    return;
+  }
+
+  // State after the segment, starting from zero
+  slap_MatrixSetConst(&seg->x, 0.0);
+  for (k = seg->start; k < seg->end; ++k) {
+    slap_MatrixCopy(&seg->u, ulqr_GetFeedforwardGain(solver, k));
+    slap_MatrixMultiply(ulqr_GetFeedbackGain(solver, k), &seg->x, &seg->u, 0, 0, 1.0, 1.0);
+    slap_MatrixCopy(&seg->xn, ulqr_Getf(solver, k));
+    slap_MatrixMultiply(ulqr_GetA(solver, k), &seg->x, &seg->xn, 0, 0, 1.0, 1.0);
+    slap_MatrixMultiply(ulqr_GetB(solver, k), &seg->u, &seg->xn, 0, 0, 1.0, 1.0);
+    slap_MatrixCopy(&seg->x, &seg->xn);
+  }
+  slap_MatrixCopy(&leaf->c, &seg->x);
+}
+
+/* Copy the average of the two triangles of a square matrix into both */
+static void Symmetrize(Matrix* A) {
+  for (int j = 0; j < A->cols; ++j) {
+    for (int i = j + 1; i < A->rows; ++i) {
+      sfloat a = 0.5 * (*slap_MatrixAt(A, i, j) + *slap_MatrixAt(A, j, i));
+      *slap_MatrixAt(A, i, j) = a;
+      *slap_MatrixAt(A, j, i) = a;
+    }
+  }
+}
+
+/*
+ * Merge the children of a node, eliminating the boundary values at mid. With
+ * M = I + G1 P2, the state at mid is
+ *   xi_mid = M \ (Phi1' xi_lo - G1 (Phi2 lambda_hi + p2) + c1)
+ * which, substituted back, gives
+ *   P = P1 + Phi1 P2 (M \ Phi1'),  Phi = Phi1 (Phi2 - P2 (M \ G1 Phi2)),
+ *   G = G2 + Phi2' (M \ G1 Phi2),  c = c2 + Phi2' v,  p = p1 + Phi1 (P2 v + p2)
+ * with v = M \ (c1 - G1 p2).
+ */
+static int MergeTree(ParallelRiccatiSolver* par, int index) {
+  struct ParallelNode* node = par->nodes + index;
+  if (node->hi - node->lo == 1) {
+    return 0;
+  }
+  if (MergeTree(par, node->left) || MergeTree(par, node->right)) {
+    return -1;
+  }
+  struct ParallelNode* n1 = par->nodes + node->left;
+  struct ParallelNode* n2 = par->nodes + node->right;
+  int n = par->solver->nstates;
+  Matrix X = slap_MatrixView(&par->merge_work, 0, 0, n, n);
+  Matrix Y = slap_MatrixView(&par->merge_work, 0, n, n, n);
+  Matrix v = slap_MatrixView(&par->merge_work, 0, 2 * n, n, 1);
+  Matrix w = slap_MatrixView(&par->merge_work, 0, 2 * n + 1, n, 1);
+
+  slap_MatrixSetConst(&node->M, 0.0);
+  for (int i = 0; i < n; ++i) {
+    *slap_MatrixAt(&node->M, i, i) = 1.0;
+  }
+  slap_MatrixMultiply(&n1->G, &n2->P, &node->M, 0, 0, 1.0, 1.0);  // M = I + G1 P2
+  if (slap_LUFactorize(&node->M, node->ipiv)) {
+    printf("ERROR: Failed to merge the segments starting at knot points %d and %d.\n",
+           par->segments[node->lo].start, par->segments[node->mid].start);
+    return -1;
+  }
+
+  slap_MatrixCopyTranspose(&X, &n1->Phi);
+  slap_LUSolve(&node->M, node->ipiv, &X);                      // X = M \ Phi1'
+  slap_MatrixMultiply(&n2->P, &X, &Y, 0, 0, 1.0, 0.0);         // Y = P2 X
+  slap_MatrixCopy(&node->P, &n1->P);                           // P = P1 + Phi1 Y
+  slap_MatrixMultiply(&n1->Phi, &Y, &node->P, 0, 0, 1.0, 1.0);
+
+  slap_MatrixMultiply(&n1->G, &n2->Phi, &X, 0, 0, 1.0, 0.0);  // X = M \ G1 Phi2
+  slap_LUSolve(&node->M, node->ipiv, &X);
+  slap_MatrixCopy(&node->G, &n2->G);                           // G = G2 + Phi2' X
+  slap_MatrixMultiply(&n2->Phi, &X, &node->G, 1, 0, 1.0, 1.0);
+  slap_MatrixCopy(&Y, &n2->Phi);                               // Phi = Phi1 (Phi2 - P2 X)
+  slap_MatrixMultiply(&n2->P, &X, &Y, 0, 0, -1.0, 1.0);
+  slap_MatrixMultiply(&n1->Phi, &Y, &node->Phi, 0, 0, 1.0, 0.0);
+
+  slap_MatrixCopy(&v, &n1->c);                                 // v = M \ (c1 - G1 p2)
+  slap_MatrixMultiply(&n1->G, &n2->p, &v, 0, 0, -1.0, 1.0);
+  slap_LUSolve(&node->M, node->ipiv, &v);
+  slap_MatrixCopy(&node->c, &n2->c);                           // c = c2 + Phi2' v
+  slap_MatrixMultiply(&n2->Phi, &v, &node->c, 1, 0, 1.0, 1.0);
+  slap_MatrixCopy(&w, &n2->p);                                 // p = p1 + Phi1 (P2 v + p2)
+  slap_MatrixMultiply(&n2->P, &v, &w, 0, 0, 1.0, 1.0);
+  slap_MatrixCopy(&node->p, &n1->p);
+  slap_MatrixMultiply(&n1->Phi, &w, &node->p, 0, 0, 1.0, 1.0);
+
+  Symmetrize(&node->P);
+  Symmetrize(&node->G);
+  return 0;
+}
+
+/* Recover the boundary values at mid of every node below this one, given xi_lo and lambda_hi */
+static void SplitTree(ParallelRiccatiSolver* par, int index) {
+  struct ParallelNode* node = par->nodes + index;
+  if (node->hi - node->lo == 1) {
+    return;
+  }
+  struct ParallelNode* n1 = par->nodes + node->left;
+  struct ParallelNode* n2 = par->nodes + node->right;
+  int n = par->solver->nstates;
+  Matrix xi_lo = slap_MatrixView(&par->xi, 0, node->lo, n, 1);
+  Matrix xi_mid = slap_MatrixView(&par->xi, 0, node->mid, n, 1);
+  Matrix lambda_mid = slap_MatrixView(&par->lambda, 0, node->mid - 1, n, 1);
+  Matrix lambda_hi = slap_MatrixView(&par->lambda, 0, node->hi - 1, n, 1);
+
+  // lambda_mid = P2 xi_mid + (Phi2 lambda_hi + p2)
+  slap_MatrixCopy(&lambda_mid, &n2->p);
+  slap_MatrixMultiply(&n2->Phi, &lambda_hi, &lambda_mid, 0, 0, 1.0, 1.0);
+  slap_MatrixCopy(&xi_mid, &n1->c);
+  slap_MatrixMultiply(&n1->Phi, &xi_lo, &xi_mid, 1, 0, 1.0, 1.0);
+  slap_MatrixMultiply(&n1->G, &lambda_mid, &xi_mid, 0, 0, -1.0, 1.0);
+  slap_LUSolve(&node->M, node->ipiv, &xi_mid);
+  slap_MatrixMultiply(&n2->P, &xi_mid, &lambda_mid, 0, 0, 1.0, 1.0);
+
+  SplitTree(par, node->left);
+  SplitTree(par, node->right);
+}
+
+/*
+ * Forward pass over the knot points [start, end), from the state already stored at start.
+ * Sets the duals and inputs of the knot points, and the states up to end - 1.
+ */
+static void Rollout(RiccatiSolver* solver, int start, int end) {
+  for (int k = start; k < end; ++k) {
+    Matrix* x = ulqr_GetState(solver, k);
+    Matrix* y = ulqr_GetDual(solver, k);
+    slap_MatrixCopy(y, ulqr_GetCostToGoGradient(solver, k));
+    slap_SymMatrixMultiply(ulqr_GetCostToGoHessian(solver, k), x, y, 1.0, 1.0);  // y = P x + p
+    if (k == solver->nhorizon - 1) {
+      break;
+    }
+    Matrix* u = ulqr_GetInput(solver, k);
+    slap_MatrixCopy(u, ulqr_GetFeedforwardGain(solver, k));
+    slap_MatrixMultiply(ulqr_GetFeedbackGain(solver, k), x, u, 0, 0, 1.0, 1.0);  // u = K x + d
+    if (k + 1 < end) {
+      Matrix* xn = ulqr_GetState(solver, k + 1);
+      slap_MatrixCopy(xn, ulqr_Getf(solver, k));
+      slap_MatrixMultiply(ulqr_GetA(solver, k), x, xn, 0, 0, 1.0, 1.0);  // xn = A x + B u + f
+      slap_MatrixMultiply(ulqr_GetB(solver, k), u, xn, 0, 0, 1.0, 1.0);
+    }
+  }
+}
+
+/*
+ * Cost-to-go Hessian of the full problem after every segment but the last, merging the
+ * leaves from the end of the horizon. With P_next the Hessian after segment j and
+ * M = I + G P_next, the one at its start is
+ *   P_j + Phi_j P_next (M \ Phi_j')
+ * The factors of M are kept in the leaf, which doesn't otherwise use them.
+ */
+static int BoundaryCostToGo(ParallelRiccatiSolver* par) {
+  int n = par->solver->nstates;
+  int nsegments = par->nsegments;
+  if (nsegments < 2) {
+    return 0;
+  }
+  Matrix Pn = slap_MatrixView(&par->merge_work, 0, 0, n, n);
+  Matrix X = slap_MatrixView(&par->merge_work, 0, n, n, n);
+  slap_MatrixCopy(&Pn, &par->nodes[nsegments - 1].P);
+  slap_SymMatrixPack(&par->segments[nsegments - 2].P_end, &Pn);
+  for (int j = nsegments - 2; j > 0; --j) {
+    struct ParallelNode* leaf = par->nodes + j;
+    slap_MatrixSetConst(&leaf->M, 0.0);
+    for (int i = 0; i < n; ++i) {
+      *slap_MatrixAt(&leaf->M, i, i) = 1.0;
+    }
+    slap_MatrixMultiply(&leaf->G, &Pn, &leaf->M, 0, 0, 1.0, 1.0);  // M = I + G Pn
+    if (slap_LUFactorize(&leaf->M, leaf->ipiv)) {
+      printf("ERROR: Failed to find the cost-to-go after knot point %d.\n",
+             par->segments[j].end - 1);
+      return -1;
+    }
+    slap_MatrixCopyTranspose(&X, &leaf->Phi);
+    slap_LUSolve(&leaf->M, leaf->ipiv, &X);                        // X = M \ Phi'
+    slap_MatrixMultiply(&Pn, &X, &leaf->M, 0, 0, 1.0, 0.0);        // M = Pn X
+    slap_MatrixCopy(&Pn, &leaf->P);                                // Pn = P + Phi M
+    slap_MatrixMultiply(&leaf->Phi, &leaf->M, &Pn, 0, 0, 1.0, 1.0);
+    Symmetrize(&Pn);
+    slap_SymMatrixPack(&par->segments[j - 1].P_end, &Pn);
+  }
+  return 0;
+}
+
+/*
+ * Run the backward pass of segment j again, with the cost-to-go of the full problem after
+ * its end, so its gains and cost-to-go are those of the full problem, then its forward
+ * pass. The gradient after the end follows from the boundary values, lambda = P xi + p.
+ * The last segment already has them.
+ */
+static void SegmentForwardPass(void* context, int j) {
+  ParallelRiccatiSolver* par = (ParallelRiccatiSolver*)context;
+  RiccatiSolver* solver = par->solver;
+  struct ParallelSegment* seg = par->segments + j;
+  int n = solver->nstates;
+  bool last = seg->end == solver->nhorizon;
+
+  if (!last) {
+    Matrix lambda = slap_MatrixView(&par->lambda, 0, j, n, 1);
+    Matrix xi_next = slap_MatrixView(&par->xi, 0, j + 1, n, 1);
+    slap_MatrixCopy(&seg->p_end, &lambda);
+    slap_SymMatrixMultiply(&seg->P_end, &xi_next, &seg->p_end, -1.0, 1.0);
+    for (int k = seg->end - 1; k >= seg->start; --k) {
+      bool after_end = k + 1 == seg->end;
+      SymMatrix* Pn = after_end ? &seg->P_end : ulqr_GetCostToGoHessian(solver, k + 1);
+      Matrix* pn = after_end ? &seg->p_end : ulqr_GetCostToGoGradient(solver, k + 1);
+      if (ulqr_BackwardStep(solver, k, Pn, pn, &seg->P_work, &seg->Qzz_work, &seg->scratch)) {
+        seg->status = -1;
+        return;
+      }
+    }
+  }
+
+  Matrix xi = slap_MatrixView(&par->xi, 0, j, n, 1);
+  slap_MatrixCopy(ulqr_GetState(solver, seg->start), &xi);
+  Rollout(solver, seg->start, seg->end);
+}
+
+int ulqr_SolveRiccatiParallel(ParallelRiccatiSolver* par) {
+  if (!par) {
+    return -1;
+  }
+  ThreadPool* pool = (ThreadPool*)par->pool;
+  for (int j = 0; j < par->nsegments; ++j) {
+    par->segments[j].status = 0;
+  }
+  ulqr_ThreadPoolRun(pool, par->nsegments, SegmentBackwardPass, par);
+  for (int j = 0; j < par->nsegments; ++j) {
+    if (par->segments[j].status != 0) {
+      return -1;
+    }
+  }
+
+  // Boundary values at the ends of the horizon, then the ones in between
+  int n = par->solver->nstates;
+  Matrix xi0 = slap_MatrixView(&par->xi, 0, 0, n, 1);
+  Matrix lambda_end = slap_MatrixView(&par->lambda, 0, par->nsegments - 1, n, 1);
+  slap_MatrixCopy(&xi0, &par->solver->x0);
+  slap_MatrixSetConst(&lambda_end, 0.0);
+  if (MergeTree(par, par->root)) {
+    return -1;
+  }
+  SplitTree(par, par->root);
+  if (BoundaryCostToGo(par)) {
+    return -1;
+  }
+
+  ulqr_ThreadPoolRun(pool, par->nsegments, SegmentForwardPass, par);
+  for (int j = 0; j < par->nsegments; ++j) {
+    if (par->segments[j].status != 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/*
+ * Knot points in each chunk of the scan forward pass but the first, which is ScanWeight()
+ * times longer. Composing the maps of a chunk costs about ScanWeight() times more flops
+ * per knot point than the forward pass run by the first chunk at the same time.
+ */
+static double ScanWeight(const RiccatiSolver* solver) {
+  int n = solver->nstates;
+  int m = solver->ninputs;
+  return (double)(n * n * (n + m) + 2 * n * (n + m)) / (2 * n * (n + m));
+}
+
+static double ScanLength(const ParallelRiccatiSolver* par) {
+  return par->solver->nhorizon / (ScanWeight(par->solver) + par->nsegments - 1);
+}
+
+/* First knot point of chunk j of the scan forward pass, or the horizon if j = nsegments */
+static int ScanStart(const ParallelRiccatiSolver* par, int j) {
+  if (j == 0) {
+    return 0;
+  }
+  return par->solver->nhorizon - (int)((par->nsegments - j) * ScanLength(par));
+}
+
+/*
+ * Phase 1 of the scan forward pass. Chunk j > 0 composes the closed-loop affine maps of
+ * its knot points into xi_{j+1} = Phi xi_j + c, stored in its leaf of the merge tree,
+ *   Phi = prod (A_k + B_k K_k),  c = state after the chunk from a zero state.
+ * The first chunk knows its initial state, so it runs its forward pass instead, and the
+ * map of the last chunk isn't needed.
+ */
+static void ScanTransition(void* context, int j) {
+  ParallelRiccatiSolver* par = (ParallelRiccatiSolver*)context;
+  RiccatiSolver* solver = par->solver;
+  struct ParallelSegment* seg = par->segments + j;
+  struct ParallelNode* leaf = par->nodes + j;
+  int n = solver->nstates;
+  int start = ScanStart(par, j);
+  int end = ScanStart(par, j + 1);
+  if (j == 0) {
+    slap_MatrixCopy(ulqr_GetState(solver, 0), &solver->x0);
+    Rollout(solver, start, end);
+    return;
+  }
+  if (j == par->nsegments - 1) {
+    return;
+  }
+
+  // Phi ping-pongs between the leaf and the segment workspace
+  Matrix* Phi = &leaf->Phi;
+  Matrix* Phi_next = &seg->Phi_work;
+  slap_MatrixSetConst(Phi, 0.0);
+  for (int i = 0; i < n; ++i) {
+    *slap_MatrixAt(Phi, i, i) = 1.0;
+  }
+  slap_MatrixSetConst(&seg->x, 0.0);
+  for (int k = start; k < end; ++k) {
+    Matrix* A = ulqr_GetA(solver, k);
+    Matrix* B = ulqr_GetB(solver, k);
+    Matrix* K = ulqr_GetFeedbackGain(solver, k);
+    slap_MatrixCopy(&seg->Acl, A);
+    slap_MatrixMultiply(B, K, &seg->Acl, 0, 0, 1.0, 1.0);
+    slap_MatrixMultiply(&seg->Acl, Phi, Phi_next, 0, 0, 1.0, 0.0);  // Phi = (A + B K) Phi
+    Matrix* tmp = Phi;
+    Phi = Phi_next;
+    Phi_next = tmp;
+
+    slap_MatrixCopy(&seg->u, ulqr_GetFeedforwardGain(solver, k));
+    slap_MatrixMultiply(K, &seg->x, &seg->u, 0, 0, 1.0, 1.0);
+    slap_MatrixCopy(&seg->xn, ulqr_Getf(solver, k));
+    slap_MatrixMultiply(A, &seg->x, &seg->xn, 0, 0, 1.0, 1.0);
+    slap_MatrixMultiply(B, &seg->u, &seg->xn, 0, 0, 1.0, 1.0);
+    slap_MatrixCopy(&seg->x, &seg->xn);
+  }
+  if (Phi != &leaf->Phi) {
+    slap_MatrixCopy(&leaf->Phi, Phi);
+  }
+  slap_MatrixCopy(&leaf->c, &seg->x);
+}
+
+/* Phase 3 of the scan forward pass: the forward pass of chunk j > 0, from its first state */
+static void ScanRollout(void* context, int j) {
+  ParallelRiccatiSolver* par = (ParallelRiccatiSolver*)context;
+  if (j > 0) {
+    Rollout(par->solver, ScanStart(par, j), ScanStart(par, j + 1));
+  }
+}
+
+int ulqr_ForwardPassParallel(ParallelRiccatiSolver* par) {
+  if (!par) {
+    return -1;
+  }
+  RiccatiSolver* solver = par->solver;
+  int nsegments = par->nsegments;
+  if (nsegments < 3 || solver->nhorizon < par->forward_min_horizon || ScanLength(par) < 1) {
+    return ulqr_ForwardPass(solver);
+  }
+
+  ThreadPool* pool = (ThreadPool*)par->pool;
+  ulqr_ThreadPoolRun(pool, nsegments, ScanTransition, par);
+
+  // Phase 2: the first state of each chunk, from the end of the first one
+  int k = ScanStart(par, 1) - 1;
+  Matrix* x = ulqr_GetState(solver, k + 1);
+  slap_MatrixCopy(x, ulqr_Getf(solver, k));
+  slap_MatrixMultiply(ulqr_GetA(solver, k), ulqr_GetState(solver, k), x, 0, 0, 1.0, 1.0);
+  slap_MatrixMultiply(ulqr_GetB(solver, k), ulqr_GetInput(solver, k), x, 0, 0, 1.0, 1.0);
+  for (int j = 1; j < nsegments - 1; ++j) {
+    struct ParallelNode* leaf = par->nodes + j;
+    Matrix* xn = ulqr_GetState(solver, ScanStart(par, j + 1));
+    slap_MatrixCopy(xn, &leaf->c);
+    slap_MatrixMultiply(&leaf->Phi, x, xn, 0, 0, 1.0, 1.0);  // xn = Phi x + c
+    x = xn;
+  }
+
+  ulqr_ThreadPoolRun(pool, nsegments, ScanRollout, par);
+  return 0;
+}
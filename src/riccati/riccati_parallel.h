@@ -0,0 +1,153 @@
+/**
+ * @file riccati_parallel.h
+ * @author Brian Jackson (bjack205@gmail.com)
+ * @brief Parallel-in-time Riccati solve, splitting the horizon across threads
+ * @version 0.1
+ * @date 2022-02-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * @addtogroup riccati
+ * @{
+ */
+#pragma once
+
+#include "riccati_solver.h"
+
+struct ParallelSegment;
+struct ParallelNode;
+
+/**
+ * @brief Riccati solver that splits the horizon into segments solved in parallel
+ *
+ * The horizon is split into one segment of consecutive knot points per thread. The
+ * segments are coupled only through the state \f$ \xi_j \f$ at the start of each segment
+ * and the dual \f$ \lambda_{j+1} \f$ of the dynamics constraint that leads into the next
+ * one. Given \f$ \lambda_{j+1} \f$, segment \f$ j \f$ is an LQR problem of its own, with
+ * a linear terminal cost \f$ \lambda_{j+1}^T x \f$ on the state after its last knot point.
+ * The backward passes of all the segments are run at once, with the affine terms for
+ * \f$ \lambda_{j+1} = 0 \f$. Along with them, each segment computes how the dual at its
+ * start and the state after its end depend on its boundary values:
+ * \f{align*}{
+ * \lambda_j &= P \xi_j + \Phi \lambda_{j+1} + p \\
+ * \xi_{j+1} &= \Phi^T \xi_j - G \lambda_{j+1} + c
+ * \f}
+ * where \f$ \Phi \f$ is the transpose of the closed-loop state transition over the
+ * segment and \f$ G \f$ is a symmetric positive semi-definite matrix, the gramian of the
+ * inputs. The coupling variables of adjacent segments are then eliminated by a recursive
+ * Schur complement: merging two segments gives a relation of the same form for the
+ * combined segment, so they are merged pairwise along a binary tree up to the whole
+ * horizon, which gives \f$ \lambda_0 \f$ and, going back down the tree, the boundary
+ * values of every segment. Merging the leaves from the end of the horizon also gives the
+ * cost-to-go Hessian of the full problem after each segment. Finally, each segment runs
+ * its backward pass again with the cost-to-go of the full problem after its end, and
+ * then its forward pass, again all at once.
+ *
+ * The segments cost about three times as much per knot point as the sequential backward
+ * pass, to propagate \f$ \Phi \f$ and \f$ G \f$ and to run the backward pass twice, and
+ * the \f$ O(n^3) \f$ merges are done on the calling thread, so the solve is faster than
+ * ulqr_SolveRiccati() when the horizon is long compared to the number of threads.
+ *
+ * The states, inputs and duals, as well as the gains, cost-to-go and action-value terms
+ * left in the wrapped solver, are those of the full problem, the same as after
+ * ulqr_SolveRiccati().
+ *
+ * ## Construction and destruction
+ * Use ulqr_NewParallelRiccatiSolver() to wrap an existing solver, which must be paired
+ * with a call to ulqr_FreeParallelRiccatiSolver(). The wrapped solver still belongs to
+ * the caller, and is where the problem data is set and the solution is read. Its
+ * regularization settings are used by the backward passes of the segments.
+ *
+ * ## Typical Usage
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * RiccatiSolver* solver = ulqr_NewRiccatiSolver(nstates, ninputs, nhorizon);
+ * // set the problem data
+ * ParallelRiccatiSolver* par = ulqr_NewParallelRiccatiSolver(solver, 16);
+ * ulqr_SolveRiccatiParallel(par);
+ * ulqr_FreeParallelRiccatiSolver(&par);
+ * ulqr_FreeRiccatiSolver(&solver);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+typedef struct {
+  // clang-format off
+  RiccatiSolver* solver;  ///< solver with the problem data and the solution
+  int nthreads;           ///< number of threads used by the solve, including the calling one
+  int nsegments;          ///< number of segments the horizon is split into
+  int forward_min_horizon;  ///< shortest horizon ulqr_ForwardPassParallel() splits up
+  void* pool;             ///< ThreadPool that runs the segments
+  sfloat* data;           ///< pointer to the beginning of the workspace
+  int* ipiv;              ///< pivots of the LU factorizations of the merges
+  struct ParallelSegment* segments;  ///< workspace of each segment
+  struct ParallelNode* nodes;        ///< relations between the boundary values of the merge tree
+  int root;               ///< index of the root of the merge tree
+  Matrix xi;              ///< (n,nsegments) state at the start of each segment
+  Matrix lambda;          ///< (n,nsegments) dual at the end of each segment
+  SymMatrix P_zero;       ///< zero cost-to-go Hessian after the end of a segment
+  Matrix p_zero;          ///< zero cost-to-go gradient after the end of a segment
+  Matrix merge_work;      ///< (n,2n+2) temporaries of the merges
+  // clang-format on
+} ParallelRiccatiSolver;
+
+/**
+ * @brief Create a parallel solver for an existing Riccati solver
+ *
+ * Starts the threads and allocates all the memory needed by ulqr_SolveRiccatiParallel().
+ *
+ * @param solver   An initialized RiccatiSolver, which must outlive the parallel one
+ * @param nthreads Number of threads, including the calling one. If less than 1, one per
+ *                 processor. The horizon is split into as many segments, or one per
+ *                 knot point if it is shorter.
+ * @return A new parallel solver, or NULL if the allocation failed
+ */
+ParallelRiccatiSolver* ulqr_NewParallelRiccatiSolver(RiccatiSolver* solver, int nthreads);
+
+/**
+ * @brief Stop the threads and free the memory for a parallel solver
+ *
+ * Does not free the wrapped RiccatiSolver.
+ *
+ * @param solver Pointer to an initialized parallel solver
+ * @post solver will be NULL
+ * @return 0 if successful
+ */
+int ulqr_FreeParallelRiccatiSolver(ParallelRiccatiSolver** solver);
+
+/**
+ * @brief Solve the LQR problem, splitting the horizon across threads
+ *
+ * The states, inputs, and duals are stored in the wrapped solver, along with the gains
+ * and cost-to-go, as for ulqr_SolveRiccati().
+ *
+ * @param solver An initialized parallel solver
+ * @return 0 if successful, or -1 if the backward pass of a segment or a merge failed
+ */
+int ulqr_SolveRiccatiParallel(ParallelRiccatiSolver* solver);
+
+/**
+ * @brief Run the forward pass of the wrapped solver, splitting the horizon across threads
+ *
+ * The closed-loop dynamics \f$ x_{k+1} = (A_k + B_k K_k) x_k + B_k d_k + f_k \f$ are a
+ * chain of affine maps, which can be composed in any order. The horizon is split into one
+ * chunk per thread. First, each chunk composes the maps of its knot points into a single
+ * map from its first state to the state after it, while the first chunk, whose initial
+ * state is known, runs its forward pass. The first state of every chunk is then found by
+ * applying these maps in turn, on the calling thread, after which all the chunks run their
+ * forward passes at once.
+ *
+ * Composing the maps costs \f$ O(n^3) \f$ per knot point, against \f$ O(n^2) \f$ for
+ * the forward pass, so the first chunk is made longer to balance the work. This is only
+ * faster than ulqr_ForwardPass() with many more threads than states, on long horizons.
+ * Below `forward_min_horizon` knot points, or with fewer than 3 threads, it just calls
+ * ulqr_ForwardPass().
+ *
+ * Unlike ulqr_SolveRiccatiParallel(), this uses the gains and cost-to-go already stored in
+ * the wrapped solver, and gives the same states, inputs, and duals as ulqr_ForwardPass().
+ *
+ * @pre The LQR gains must have been computed using ulqr_BackwardPass(), or by
+ *      ulqr_SolveRiccatiParallel(), which leaves the gains of the full problem
+ * @param solver An initialized parallel solver
+ * @return 0 if successful
+ */
+int ulqr_ForwardPassParallel(ParallelRiccatiSolver* solver);
+
+/**@} */
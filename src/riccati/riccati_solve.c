@@ -6,118 +6,184 @@
 
 #include "lqr_data.h"
 #include "riccati/riccati_solver.h"
+#include "slap/arena.h"
+#include "slap/linalg.h"
 #include "slap/matrix.h"
 
+/*
+ * Wall-clock time in milliseconds. Unlike clock(), which counts the processor time of
+ * every thread of the process, it isn't affected by solves running on other threads.
+ */
+static double TimeMs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+}
+
 int ulqr_SolveRiccati(RiccatiSolver* solver) {
   if (!solver) {
     return -1;
   }
-  clock_t t_start_total = clock();
+  double t_start_total = TimeMs();
 
-  ulqr_BackwardPass(solver);
-  clock_t t_start_fp = clock();
+  int out = solver->sqrt_backward_pass ? ulqr_BackwardPassSqrt(solver) : ulqr_BackwardPass(solver);
+  if (out != 0) {
+    return -1;
+  }
+  double t_start_fp = TimeMs();
   ulqr_ForwardPass(solver);
 
   // Calculate timing
-  const double milliseconds2seconds = 1000.0;
-  clock_t t_stop = clock();
-  clock_t diff_bp = t_start_fp - t_start_total;
-  clock_t diff_fp = t_stop - t_start_fp;
-  clock_t diff_total = t_stop - t_start_total;
-  solver->t_solve_ms = diff_total * milliseconds2seconds / (double)CLOCKS_PER_SEC;
-  solver->t_backward_pass_ms = diff_bp * milliseconds2seconds / (double)CLOCKS_PER_SEC;
-  solver->t_forward_pass_ms = diff_fp * milliseconds2seconds / (double)CLOCKS_PER_SEC;
+  double t_stop = TimeMs();
+  solver->t_solve_ms = t_stop - t_start_total;
+  solver->t_backward_pass_ms = t_start_fp - t_start_total;
+  solver->t_forward_pass_ms = t_stop - t_start_fp;
   return 0;
 }
 
-int ulqr_BackwardPass(RiccatiSolver* solver) {
-  int nhorizon = solver->nhorizon;
+/* Whether the relative change from b to a, of length len, is below tol */
+static bool IsSmallChange(const sfloat* a, const sfloat* b, int len, sfloat tol) {
+  double diff = 0.0;
+  double norm = 0.0;
+  for (int i = 0; i < len; ++i) {
+    double delta = a[i] - b[i];
+    diff += delta * delta;
+    norm += (double)a[i] * a[i];
+  }
+  return diff <= tol * tol * norm;
+}
+
+bool ulqr_ReuseSteadyState(RiccatiSolver* solver, int k) {
+  sfloat tol = solver->steady_state_tol;
+  if (tol <= 0 || k + 2 >= solver->nhorizon) {
+    return false;
+  }
+  const LQRData* next = solver->lqrdata + k + 1;
+  const LQRData* after = solver->lqrdata + k + 2;
+  int len = slap_SymMatrixNumElements(&next->P);
+  if (!IsSmallChange(next->P.data, after->P.data, len, tol) ||
+      !IsSmallChange(next->p.data, after->p.data, solver->nstates, tol) ||
+      !ulqr_IsLQRProblemEqual(solver->lqrdata + k, next)) {
+    return false;
+  }
+  ulqr_CopyLQRSolution(solver->lqrdata + k, next);
+  ++solver->steady_state_count;
+  return true;
+}
+
+// The fixed-dimension build has its own passes, in riccati_solve_fixed.c
+#ifndef ULQR_FIXED_NSTATES
+int ulqr_BackwardStep(RiccatiSolver* solver, int k, SymMatrix* Pn, Matrix* pn, Matrix* Pn_dense,
+                      Matrix* Qzz_dense, Arena* scratch) {
+  int nstates = solver->nstates;
+  int ninputs = solver->ninputs;
+  Matrix Qxx_dense = slap_MatrixView(Qzz_dense, 0, 0, nstates, nstates);
+  Matrix Qux_dense = slap_MatrixView(Qzz_dense, nstates, 0, ninputs, nstates);
+  Matrix Quu_dense = slap_MatrixView(Qzz_dense, nstates, nstates, ninputs, ninputs);
+  slap_SymMatrixUnpack(Pn_dense, Pn);
 
-  int k = nhorizon - 1;
-  Matrix* Q = ulqr_GetQ(solver, k);
+  Matrix* A = ulqr_GetA(solver, k);
+  Matrix* B = ulqr_GetB(solver, k);
+  Matrix* AB = ulqr_GetAB(solver, k);
+  Matrix* f = ulqr_Getf(solver, k);
+  SymMatrix* Q = ulqr_GetQ(solver, k);
   Matrix* q = ulqr_Getq(solver, k);
-  Matrix* Pn = ulqr_GetCostToGoHessian(solver, k);
-  Matrix* pn = ulqr_GetCostToGoGradient(solver, k);
-  slap_MatrixCopy(Pn, Q);
-  slap_MatrixCopy(pn, q);
+  SymMatrix* R = ulqr_GetR(solver, k);
+  Matrix* r = ulqr_Getr(solver, k);
 
-  // Create a matrix that treats both gains as one matrix to save an extra Cholesky solve
-  // This works as long as their data is adjacent in memory
-  Matrix Kd = {solver->ninputs, solver->nstates + 1, NULL};
+  // Temporaries, released at the end of the step
+  int mark = slap_ArenaPush(scratch);
+  Matrix Qx_tmp = slap_ArenaMatrix(scratch, nstates, 1);
+  if (!Qx_tmp.data) {
+    slap_ArenaPop(scratch, mark);
+    return -1;
+  }
 
-  for (--k; k >= 0; --k) {
-    Pn = ulqr_GetCostToGoHessian(solver, k);
-    pn = ulqr_GetCostToGoGradient(solver, k);
+  // Calculate gradient terms
+  Matrix* Qx = ulqr_GetQx(solver, k);
+  Matrix* Qu = ulqr_GetQu(solver, k);
+  slap_MatrixCopy(&Qx_tmp, pn);                               // Qx = p
+  slap_MatrixMultiply(Pn_dense, f, &Qx_tmp, 0, 0, 1.0, 1.0);  // Qx = P * f + p
 
-    Matrix* A = ulqr_GetA(solver, k);
-    Matrix* B = ulqr_GetB(solver, k);
-    Matrix* f = ulqr_Getf(solver, k);
-    Matrix* Q = ulqr_GetQ(solver, k);
-    Matrix* q = ulqr_Getq(solver, k);
-    Matrix* R = ulqr_GetR(solver, k);
-    Matrix* r = ulqr_Getr(solver, k);
-
-    // Calculate gradient terms
-    Matrix* Qx = ulqr_GetQx(solver, k);
-    Matrix* Qu = ulqr_GetQu(solver, k);
-    Matrix* Qx_tmp = Qx + 1;
-    Matrix* Qu_tmp = Qu + 1;
-    slap_MatrixCopy(Qx_tmp, pn);                         // Qx = p
-    slap_MatrixMultiply(Pn, f, Qx_tmp, 0, 0, 1.0, 1.0);  // Qx = P * f + p
-
-    slap_MatrixMultiply(B, Qx_tmp, Qu, 1, 0, 1.0, 0.0);  // Qu = B' * (P * f + p)
-    slap_MatrixMultiply(A, Qx_tmp, Qx, 1, 0, 1.0, 0.0);  // Qx = A' * (P * f + p)
-    slap_MatrixAddition(r, Qu, 1.0);                     // Qu = r + B' * (P * f + p)
-    slap_MatrixAddition(q, Qx, 1.0);                     // Qx = q + A' * (P * f + p)
-
-    // Calculate Hessian terms
-    Matrix* Qxx = ulqr_GetQxx(solver, k);
-    Matrix* Qux = ulqr_GetQux(solver, k);
-    Matrix* Quu = ulqr_GetQuu(solver, k);
-    Matrix* Qxx_tmp = ulqr_GetQxx(solver, k + 1);
-    Matrix* Qux_tmp = ulqr_GetQux(solver, k + 1);
-    Matrix* Quu_tmp = ulqr_GetQuu(solver, k + 1);
-
-    slap_MatrixCopy(Qxx, Q);
-    slap_MatrixCopy(Quu, R);
-
-    slap_MatrixMultiply(A, Pn, Qxx_tmp, 1, 0, 1.0, 0.0);   // Qxx = A'P
-    slap_MatrixMultiply(B, Pn, Qux_tmp, 1, 0, 1.0, 0.0);   // Qux = B'P
-    slap_MatrixMultiply(Qxx_tmp, A, Qxx, 0, 0, 1.0, 1.0);  // Qxx = Q + A'P*A
-    slap_MatrixMultiply(Qux_tmp, B, Quu, 0, 0, 1.0, 1.0);  // Quu = R + B'P*B
-    slap_MatrixMultiply(Qux_tmp, A, Qux, 0, 0, 1.0, 0.0);  // Qux = B'P*A
-
-    // Calculate Gains
-    Matrix* K = ulqr_GetFeedbackGain(solver, k);
-    Matrix* d = ulqr_GetFeedforwardGain(solver, k);
-    slap_MatrixCopy(Quu_tmp, Quu);
-    slap_MatrixCopy(K, Qux);
-    slap_MatrixCopy(d, Qu);
-
-    int info = slap_CholeskyFactorize(Quu_tmp);
-    if (info == slap_kCholeskyFail) {
-      // TODO (sam): handle regularization
+  slap_MatrixMultiply(B, &Qx_tmp, Qu, 1, 0, 1.0, 0.0);  // Qu = B' * (P * f + p)
+  slap_MatrixMultiply(A, &Qx_tmp, Qx, 1, 0, 1.0, 0.0);  // Qx = A' * (P * f + p)
+  slap_MatrixAddition(r, Qu, 1.0);                      // Qu = r + B' * (P * f + p)
+  slap_MatrixAddition(q, Qx, 1.0);                      // Qx = q + A' * (P * f + p)
+
+  // Calculate Hessian terms
+  SymMatrix* Qxx = ulqr_GetQxx(solver, k);
+  Matrix* Qux = ulqr_GetQux(solver, k);
+  SymMatrix* Quu = ulqr_GetQuu(solver, k);
+
+  // [Qxx Qux'; Qux Quu] = [Q 0; 0 R] + [A B]'P*[A B], of which only the lower triangle
+  // is computed or ever read
+  slap_SymMatrixUnpack(&Qxx_dense, Q);
+  slap_SymMatrixUnpack(&Quu_dense, R);
+  slap_MatrixSetConst(&Qux_dense, 0.0);
+  slap_SymmetricTripleProduct(AB, Pn_dense, Qzz_dense, 1.0, 1.0, false);
+  slap_SymMatrixPack(Qxx, &Qxx_dense);
+  slap_SymMatrixPack(Quu, &Quu_dense);
+  slap_MatrixCopy(Qux, &Qux_dense);
+
+  // Calculate Gains, solving for both with a single Cholesky solve. The forward
+  // substitution gives [W w] = Lu \ [Qux Qu], with Quu = Lu Lu', which is kept in Kd for
+  // the cost-to-go before the backward substitution finishes the gains.
+  Matrix* K = ulqr_GetFeedbackGain(solver, k);
+  Matrix* d = ulqr_GetFeedforwardGain(solver, k);
+  Matrix* Kd = ulqr_GetGains(solver, k);
+  slap_MatrixCopy(K, Qux);
+  slap_MatrixCopy(d, Qu);
+
+  // Shifts the diagonal of Quu if it isn't positive definite, when regularization is on
+  LQRData* lqrdata = solver->lqrdata + k;
+  lqrdata->reg_shift = 0.0;
+  lqrdata->reg_retries = 0;
+  int info = slap_CholeskyFactorize(&Quu_dense);
+  if (info != slap_kCholeskySuccess && solver->reg_max > 0) {
+    info = slap_CholeskyFactorizeRegularized(&Quu_dense, Quu, solver->reg_min, solver->reg_max,
+                                             &lqrdata->reg_shift, &lqrdata->reg_retries);
+  }
+  if (info == slap_kCholeskyFail) {
+    printf("ERROR: Quu is not positive definite at knot point %d.\n", k);
+    slap_ArenaPop(scratch, mark);
+    return -1;
+  }
+  slap_LowerTriBackSub(&Quu_dense, Kd, false);  // [W w] = Lu \ [Qux Qu]
+
+  // Calulate Cost-to-Go. Substituting the gains, P = Qxx + K'Quu K + K'Qux + Qux'K
+  // collapses to Qxx - Qux'Quu^-1 Qux = Qxx - W'W, and p to Qx - W'w. Only the lower
+  // triangle of P is formed, in the dense copy of Qxx.
+  SymMatrix* P = ulqr_GetCostToGoHessian(solver, k);
+  Matrix* p = ulqr_GetCostToGoGradient(solver, k);
+
+  slap_SymmetricRankKUpdate(K, &Qxx_dense, -1.0, 1.0, false);  // P = Qxx - W'W
+  slap_SymMatrixPack(P, &Qxx_dense);
+
+  slap_MatrixCopy(p, Qx);
+  slap_MatrixMultiply(K, d, p, 1, 0, -1.0, 1.0);  // p = Qx - W'w
+
+  slap_LowerTriBackSub(&Quu_dense, Kd, true);  // [K d] = Lu' \ [W w]
+  slap_MatrixScaleByConst(Kd, -1);
+  slap_ArenaPop(scratch, mark);
+  return 0;
+}
+
+int ulqr_BackwardPass(RiccatiSolver* solver) {
+  int k = solver->nhorizon - 1;
+  slap_SymMatrixCopy(ulqr_GetCostToGoHessian(solver, k), ulqr_GetQ(solver, k));
+  slap_MatrixCopy(ulqr_GetCostToGoGradient(solver, k), ulqr_Getq(solver, k));
+
+  solver->steady_state_count = 0;
+  for (--k; k >= 0; --k) {
+    if (ulqr_ReuseSteadyState(solver, k)) {
+      continue;
+    }
+    int out = ulqr_BackwardStep(solver, k, ulqr_GetCostToGoHessian(solver, k + 1),
+                                ulqr_GetCostToGoGradient(solver, k + 1), &solver->P_work,
+                                &solver->Qzz_work, &solver->scratch);
+    if (out != 0) {
+      return -1;
     }
-    Kd.data = K->data;
-    slap_CholeskySolve(Quu_tmp, &Kd);
-    slap_MatrixScaleByConst(K, -1);
-    slap_MatrixScaleByConst(d, -1);
-
-    // Calulate Cost-to-Go
-    Matrix* P = ulqr_GetCostToGoHessian(solver, k);
-    Matrix* p = ulqr_GetCostToGoGradient(solver, k);
-
-    slap_MatrixCopy(P, Qxx);
-    slap_MatrixMultiply(Quu, K, Qux_tmp, 0, 0, 1.0, 0.0);  // Qux_tmp = Quu * K
-    slap_MatrixMultiply(K, Qux_tmp, P, 1, 0, 1.0, 1.0);    // P = Qxx + K'Quu*K
-    slap_MatrixMultiply(K, Qux, P, 1, 0, 1.0, 1.0);        // P = Quu + K'Quu*K + K'Qux
-    slap_MatrixMultiply(Qux, K, P, 1, 0, 1.0, 1.0);        // P = Quu + K'Quu*K + K'Qux + Qux'K
-
-    slap_MatrixCopy(p, Qx);
-    slap_MatrixMultiply(Quu, d, Qu_tmp, 0, 0, 1.0, 0.0);  // Qu_tmp = Quu * d
-    slap_MatrixMultiply(K, Qu_tmp, p, 1, 0, 1.0, 1.0);    // p = Qx + K'Quu*d
-    slap_MatrixMultiply(K, Qu, p, 1, 0, 1.0, 1.0);        // p = Qx + K'Quu*d + K'Qu
-    slap_MatrixMultiply(Qux, d, p, 1, 0, 1.0, 1.0);       // p = Qx + K'Quu*d + K'Qu + Qux'd
   }
   return 0;
 }
@@ -135,7 +201,7 @@ int ulqr_ForwardPass(RiccatiSolver* solver) {
     Matrix* A = ulqr_GetA(solver, k);
     Matrix* B = ulqr_GetB(solver, k);
     Matrix* f = ulqr_Getf(solver, k);
-    Matrix* Pk = ulqr_GetCostToGoHessian(solver, k);
+    SymMatrix* Pk = ulqr_GetCostToGoHessian(solver, k);
     Matrix* pk = ulqr_GetCostToGoGradient(solver, k);
     Matrix* Kk = ulqr_GetFeedbackGain(solver, k);
     Matrix* dk = ulqr_GetFeedforwardGain(solver, k);
@@ -145,18 +211,67 @@ int ulqr_ForwardPass(RiccatiSolver* solver) {
     Matrix* xn = ulqr_GetState(solver, k + 1);
 
     slap_MatrixCopy(yk, pk);
-    slap_MatrixMultiply(Pk, xk, yk, 0, 0, 1.0, 1.0);  // y = P * x + p
+    slap_SymMatrixMultiply(Pk, xk, yk, 1.0, 1.0);  // y = P * x + p
     slap_MatrixCopy(uk, dk);
     slap_MatrixMultiply(Kk, xk, uk, 0, 0, 1.0, 1.0);  // un = K * x + d
     slap_MatrixCopy(xn, f);
     slap_MatrixMultiply(A, xk, xn, 0, 0, 1.0, 1.0);  // xn = A * x + f
     slap_MatrixMultiply(B, uk, xn, 0, 0, 1.0, 1.0);  // xn = A * x + B * u + f
   }
-  Matrix* Pk = ulqr_GetCostToGoHessian(solver, k);
+  SymMatrix* Pk = ulqr_GetCostToGoHessian(solver, k);
   Matrix* pk = ulqr_GetCostToGoGradient(solver, k);
   Matrix* xk = ulqr_GetState(solver, k);
   Matrix* yk = ulqr_GetDual(solver, k);
   slap_MatrixCopy(yk, pk);
-  slap_MatrixMultiply(Pk, xk, yk, 0, 0, 1.0, 1.0);  // y = P * x + p
+  slap_SymMatrixMultiply(Pk, xk, yk, 1.0, 1.0);  // y = P * x + p
+  return 0;
+}
+#endif
+
+/* Copy the vector v into every column of dest */
+static void SetColumns(Matrix* dest, Matrix* v) {
+  for (int j = 0; j < dest->cols; ++j) {
+    Matrix col = slap_MatrixView(dest, 0, j, dest->rows, 1);
+    slap_MatrixCopy(&col, v);
+  }
+}
+
+int ulqr_ForwardPassBatch(RiccatiSolver* solver, Matrix* X0, Matrix* X, Matrix* U, Matrix* Y) {
+  if (!solver || !X0 || !X || !U) {
+    return -1;
+  }
+  int nstates = solver->nstates;
+  int ninputs = solver->ninputs;
+  int nhorizon = solver->nhorizon;
+  int nbatch = X0->cols;
+  if (X0->rows != nstates || X->rows != nstates || X->cols != nbatch * nhorizon ||
+      U->rows != ninputs || U->cols != nbatch * (nhorizon - 1) ||
+      (Y && (Y->rows != nstates || Y->cols != nbatch * nhorizon))) {
+    printf("ERROR: Incompatible sizes for the batched forward pass.\n");
+    return -1;
+  }
+
+  // The states, inputs and duals of knot point k are the k-th block of nbatch columns
+  Matrix Xk = slap_MatrixView(X, 0, 0, nstates, nbatch);
+  slap_MatrixCopy(&Xk, X0);
+  for (int k = 0; k < nhorizon; ++k) {
+    Xk = slap_MatrixView(X, 0, k * nbatch, nstates, nbatch);
+    if (Y) {
+      Matrix Yk = slap_MatrixView(Y, 0, k * nbatch, nstates, nbatch);
+      SymMatrix* Pk = ulqr_GetCostToGoHessian(solver, k);
+      SetColumns(&Yk, ulqr_GetCostToGoGradient(solver, k));
+      slap_SymMatrixMultiply(Pk, &Xk, &Yk, 1.0, 1.0);  // Y = P X + p
+    }
+    if (k == nhorizon - 1) {
+      break;
+    }
+    Matrix Uk = slap_MatrixView(U, 0, k * nbatch, ninputs, nbatch);
+    Matrix Xn = slap_MatrixView(X, 0, (k + 1) * nbatch, nstates, nbatch);
+    SetColumns(&Uk, ulqr_GetFeedforwardGain(solver, k));
+    slap_MatrixMultiply(ulqr_GetFeedbackGain(solver, k), &Xk, &Uk, 0, 0, 1.0, 1.0);  // U = K X + d
+    SetColumns(&Xn, ulqr_Getf(solver, k));
+    slap_MatrixMultiply(ulqr_GetA(solver, k), &Xk, &Xn, 0, 0, 1.0, 1.0);  // Xn = A X + B U + f
+    slap_MatrixMultiply(ulqr_GetB(solver, k), &Uk, &Xn, 0, 0, 1.0, 1.0);
+  }
   return 0;
 }
@@ -36,6 +36,65 @@ int ulqr_SolveRiccati(RiccatiSolver* solver);
  */
 int ulqr_BackwardPass(RiccatiSolver* solver);
 
+/**
+ * @brief Run the backward pass at a single knot point
+ *
+ * Computes the gains, the cost-to-go and the expansions of the action-value function at
+ * knot point @p k from the cost-to-go at the next knot point, which doesn't have to be
+ * the one stored in the solver. ulqr_BackwardPass() is a loop over this, and it lets
+ * other solvers run the recursion over part of the horizon with their own workspace.
+ *
+ * @param solver    An initialized RiccatiSolver, where the results are stored
+ * @param k         Knot point index, less than `nhorizon - 1`
+ * @param Pn        Cost-to-go Hessian at knot point `k + 1`
+ * @param pn        Cost-to-go gradient at knot point `k + 1`
+ * @param Pn_dense  (n,n) workspace for a dense copy of @p Pn
+ * @param Qzz_dense (n+m,n+m) workspace for the action-value Hessian. Holds the
+ *                  (regularized) Cholesky factor of \f$ Q_{uu} \f$ in its lower-right
+ *                  block on return.
+ * @param scratch   Arena for the temporaries, with at least ulqr_RiccatiScratchSize() free
+ * @return 0 if successful
+ */
+int ulqr_BackwardStep(RiccatiSolver* solver, int k, SymMatrix* Pn, Matrix* pn, Matrix* Pn_dense,
+                      Matrix* Qzz_dense, Arena* scratch);
+
+/**
+ * @brief Run the square-root version of the backward pass
+ *
+ * Computes the same gains and cost-to-go as ulqr_BackwardPass(), but propagates the
+ * Cholesky factor \f$ S \f$ of the cost-to-go Hessian \f$ P = S S^T \f$ instead of
+ * \f$ P \f$ itself. The factor of the action-value Hessian is obtained with triangular
+ * multiplies and a rank-n Cholesky update of the factors of \f$ Q \f$ and \f$ R \f$,
+ * so no matrix is ever formed by subtraction and symmetrized. This keeps the recursion
+ * accurate over long horizons, especially in single precision. The factors of \f$ Q \f$
+ * and \f$ R \f$ are kept in `cost_factors` between solves, and only computed again for
+ * the knot points where they changed.
+ *
+ * The cost-to-go Hessians are still stored as \f$ P \f$, for use by the forward pass,
+ * along with the action-value Hessians \f$ Q_{xx}, Q_{uu}, Q_{ux} \f$. All of them are
+ * formed from the factors with symmetric or triangular products.
+ *
+ * @pre  The cost Hessians \f$ Q \f$ and \f$ R \f$ are positive definite at every knot
+ *       point.
+ * @param solver An initialized RiccatiSolver
+ * @return 0 if successful
+ */
+int ulqr_BackwardPassSqrt(RiccatiSolver* solver);
+
+/**
+ * @brief Copy the gains and cost-to-go of knot point k + 1 to k, if they have converged
+ *
+ * Used by the backward passes to skip the steady state of time-invariant stretches, when
+ * `steady_state_tol` is positive (see RiccatiSolver). The recursion has converged if the
+ * relative change of both \f$ P \f$ and \f$ p \f$ from knot point k + 2 to k + 1 is
+ * below the tolerance, and knot point k has the same cost and dynamics as k + 1.
+ *
+ * @param solver An initialized RiccatiSolver, in the middle of its backward pass
+ * @param k      Knot point to be computed next, with k + 2 already computed
+ * @return true if the values were copied, so the backward step at k can be skipped
+ */
+bool ulqr_ReuseSteadyState(RiccatiSolver* solver, int k);
+
 /**
  * @brief Run the Riccati forward pass to solve for the solution vector
  *
@@ -48,4 +107,27 @@ int ulqr_BackwardPass(RiccatiSolver* solver);
  */
 int ulqr_ForwardPass(RiccatiSolver* solver);
 
+/**
+ * @brief Run the Riccati forward pass from many initial states at once
+ *
+ * Simulates the same feedback law as ulqr_ForwardPass() from every column of @p X0,
+ * propagating all the trajectories together, so the matrix-vector products of each knot
+ * point become matrix-matrix products with one column per initial state. The gains
+ * are computed once by the backward pass, which doesn't depend on the initial state.
+ *
+ * The trajectories are stored knot point by knot point: the states at knot point
+ * \f$ k \f$ are the columns `[k * b, (k + 1) * b)` of @p X, where `b` is the number of
+ * initial states, in the same order as in @p X0. Likewise for the inputs and duals.
+ * The trajectory stored in the solver is not modified.
+ *
+ * @pre The LQR gains must have been computed using ulqr_BackwardPass()
+ * @param      solver An initialized RiccatiSolver
+ * @param[in]  X0     (n,b) initial states, one per column
+ * @param[out] X      (n,b*N) states
+ * @param[out] U      (m,b*(N-1)) inputs
+ * @param[out] Y      (n,b*N) duals, or NULL if they aren't needed
+ * @return 0 if successful, or -1 if the sizes don't match
+ */
+int ulqr_ForwardPassBatch(RiccatiSolver* solver, Matrix* X0, Matrix* X, Matrix* U, Matrix* Y);
+
 /**@} */
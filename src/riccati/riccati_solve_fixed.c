@@ -0,0 +1,159 @@
+/*
+ * Backward and forward passes of the fixed-dimension build, which replace the ones in
+ * riccati_solve.c when ULQR_FIXED_NSTATES is defined.
+ *
+ * Every size is a compile-time constant, and all the linear algebra is done with the
+ * inline kernels of small_kernels.h directly on the data of the LQRData blocks, so the
+ * loops are fully unrolled without any calls through the Matrix API.
+ */
+#include "riccati_solve.h"
+
+#include "lqr_data.h"
+#include "riccati/riccati_solver.h"
+#include "slap/arena.h"
+#include "slap/small_kernels.h"
+
+#if !defined(ULQR_FIXED_NSTATES) || !defined(ULQR_FIXED_NINPUTS) || \
+    !defined(ULQR_FIXED_NHORIZON)
+#error "riccati_solve_fixed.c is only part of the fixed-dimension build"
+#endif
+
+/* Leading dimension of the dense LQRData blocks with the given number of rows */
+#ifdef ULQR_PAD_COLUMNS
+#define BLOCK_LEADING_DIM(rows) \
+  (((rows) + kPaddingLength - 1) / kPaddingLength * kPaddingLength)
+#else
+#define BLOCK_LEADING_DIM(rows) (rows)
+#endif
+
+enum {
+  kPaddingLength = SLAP_PADDING / sizeof(sfloat),
+  kNx = ULQR_FIXED_NSTATES,
+  kNu = ULQR_FIXED_NINPUTS,
+  kNz = kNx + kNu,
+  kNh = ULQR_FIXED_NHORIZON,
+  kNxSym = kNx * (kNx + 1) / 2,
+  kLdX = BLOCK_LEADING_DIM(kNx),  ///< leading dimension of [A B]
+  kLdU = BLOCK_LEADING_DIM(kNu),  ///< leading dimension of [K d], H and Qux
+};
+
+int ulqr_BackwardPass(RiccatiSolver* solver) {
+  LQRData* lqrdata = solver->lqrdata;
+  Arena* scratch = &solver->scratch;
+
+  // Dense copies of P and [Qxx Qux'; Qux Quu], as in the general backward pass
+  sfloat* Pn = solver->P_work.data;
+  sfloat* Qzz = solver->Qzz_work.data;
+  sfloat* Qxx_dense = Qzz;
+  sfloat* Qux_dense = Qzz + kNx;
+  sfloat* Quu_dense = Qzz + kNx + kNx * kNz;
+
+  LQRData* last = lqrdata + kNh - 1;
+  slap_SmallAxpby(kNxSym, 1, 1, last->Q.data, kNxSym, 0, last->P.data, kNxSym);
+  slap_SmallAxpby(kNx, 1, 1, last->q.data, kNx, 0, last->p.data, kNx);
+
+  solver->steady_state_count = 0;
+  for (int k = kNh - 2; k >= 0; --k) {
+    if (ulqr_ReuseSteadyState(solver, k)) {
+      continue;
+    }
+    const LQRData* next = lqrdata + k + 1;
+    LQRData* data = lqrdata + k;
+    const sfloat* A = data->AB.data;
+    const sfloat* B = data->AB.data + kNx * kLdX;
+    sfloat* K = data->Kd.data;
+    sfloat* d = data->Kd.data + kNx * kLdU;
+
+    // Temporaries, released at the end of the iteration
+    int mark = slap_ArenaPush(scratch);
+    sfloat* g = slap_ArenaAlloc(scratch, kNx);        // P * f + p
+    sfloat* W = slap_ArenaAlloc(scratch, kNx * kNz);  // P * [A B]
+    if (!g || !W) {
+      return -1;
+    }
+    slap_SmallSymUnpack(kNx, next->P.data, Pn, kNx);
+
+    // Gradient terms
+    slap_SmallAxpby(kNx, 1, 1, next->p.data, kNx, 0, g, kNx);
+    slap_SmallGemm(false, false, kNx, 1, kNx, 1, Pn, kNx, data->f.data, kNx, 1, g, kNx);
+    slap_SmallAxpby(kNx, 1, 1, data->q.data, kNx, 0, data->Qx.data, kNx);
+    slap_SmallAxpby(kNu, 1, 1, data->r.data, kNu, 0, data->Qu.data, kNu);
+    slap_SmallGemm(true, false, kNx, 1, kNx, 1, A, kLdX, g, kNx, 1, data->Qx.data, kNx);
+    slap_SmallGemm(true, false, kNu, 1, kNx, 1, B, kLdX, g, kNx, 1, data->Qu.data, kNu);
+
+    // Hessian terms [Qxx Qux'; Qux Quu] = [Q 0; 0 R] + [A B]'P*[A B], without the upper
+    // off-diagonal block
+    slap_SmallSymUnpack(kNx, data->Q.data, Qxx_dense, kNz);
+    slap_SmallSymUnpack(kNu, data->R.data, Quu_dense, kNz);
+    slap_SmallGemm(false, false, kNx, kNz, kNx, 1, Pn, kNx, A, kLdX, 0, W, kNx);
+    slap_SmallGemm(true, false, kNx, kNx, kNx, 1, A, kLdX, W, kNx, 1, Qxx_dense, kNz);
+    slap_SmallGemm(true, false, kNu, kNx, kNx, 1, B, kLdX, W, kNx, 0, Qux_dense, kNz);
+    slap_SmallGemm(true, false, kNu, kNu, kNx, 1, B, kLdX, W + kNx * kNx, kNx, 1, Quu_dense,
+                   kNz);
+    slap_SmallSymPack(kNx, Qxx_dense, kNz, data->Qxx.data);
+    slap_SmallSymPack(kNu, Quu_dense, kNz, data->Quu.data);
+    slap_SmallAxpby(kNu, kNx, 1, Qux_dense, kNz, 0, data->Qux.data, kLdU);
+
+    // Gains [K d] = -Quu \ [Qux Qu]
+    slap_SmallAxpby(kNu, kNx, -1, Qux_dense, kNz, 0, K, kLdU);
+    slap_SmallAxpby(kNu, 1, -1, data->Qu.data, kNu, 0, d, kLdU);
+    data->reg_shift = 0.0;
+    data->reg_retries = 0;
+    int info = slap_SmallPotrf(kNu, Quu_dense, kNz);
+    if (info != 0 && solver->reg_max > 0) {
+      info = slap_SmallPotrfRegularized(kNu, data->Quu.data, Quu_dense, kNz, solver->reg_min,
+                                        solver->reg_max, &data->reg_shift, &data->reg_retries);
+    }
+    if (info != 0) {
+      slap_ArenaPop(scratch, mark);
+      return -1;
+    }
+    slap_SmallTrsm(false, kNu, kNx + 1, Quu_dense, kNz, K, kLdU);
+
+    // Cost-to-go P = Qxx - Qux'Quu^-1 Qux and p = Qx - Qux'Quu^-1 Qu, as in the general
+    // backward pass, from Lu \ -[Qux Qu] left in [K d] by the forward substitution
+    slap_SmallSyrk(false, kNx, kNu, -1, K, kLdU, 1, Qxx_dense, kNz);
+    slap_SmallSymPack(kNx, Qxx_dense, kNz, data->P.data);
+
+    sfloat* p = data->p.data;
+    slap_SmallAxpby(kNx, 1, 1, data->Qx.data, kNx, 0, p, kNx);
+    slap_SmallGemm(true, false, kNx, 1, kNu, -1, K, kLdU, d, kLdU, 1, p, kNx);
+
+    slap_SmallTrsm(true, kNu, kNx + 1, Quu_dense, kNz, K, kLdU);
+    slap_ArenaPop(scratch, mark);
+  }
+  return 0;
+}
+
+int ulqr_ForwardPass(RiccatiSolver* solver) {
+  if (!solver) {
+    return -1;
+  }
+  LQRData* lqrdata = solver->lqrdata;
+  KnotPoint* Z = solver->Z;
+
+  slap_SmallAxpby(kNx, 1, 1, solver->x0.data, kNx, 0, Z[0].x.data, kNx);
+  for (int k = 0; k < kNh; ++k) {
+    const LQRData* data = lqrdata + k;
+    const sfloat* x = Z[k].x.data;
+    sfloat* y = data->y.data;
+    slap_SmallSpmm(kNx, 1, 1, data->P.data, x, kNx, 0, y, kNx);  // y = P * x + p
+    slap_SmallAxpby(kNx, 1, 1, data->p.data, kNx, 1, y, kNx);
+    if (k == kNh - 1) {
+      break;
+    }
+
+    const sfloat* A = data->AB.data;
+    const sfloat* B = data->AB.data + kNx * kLdX;
+    const sfloat* K = data->Kd.data;
+    const sfloat* d = data->Kd.data + kNx * kLdU;
+    sfloat* u = Z[k].u.data;
+    sfloat* xn = Z[k + 1].x.data;
+    slap_SmallAxpby(kNu, 1, 1, d, kLdU, 0, u, kNu);  // u = K * x + d
+    slap_SmallGemm(false, false, kNu, 1, kNx, 1, K, kLdU, x, kNx, 1, u, kNu);
+    slap_SmallAxpby(kNx, 1, 1, data->f.data, kNx, 0, xn, kNx);  // xn = A * x + B * u + f
+    slap_SmallGemm(false, false, kNx, 1, kNx, 1, A, kLdX, x, kNx, 1, xn, kNx);
+    slap_SmallGemm(false, false, kNx, 1, kNu, 1, B, kLdX, u, kNu, 1, xn, kNx);
+  }
+  return 0;
+}
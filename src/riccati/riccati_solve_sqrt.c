@@ -0,0 +1,180 @@
+/*
+ * Square-root backward pass, which propagates the Cholesky factor S of the cost-to-go
+ * Hessian P = S S' instead of P itself.
+ *
+ * Ordering the action-value Hessian as [Quu Qux; Qxu Qxx], it is the factor of
+ * [R 0; 0 Q] updated by the n columns of [B A]'S, so the factor [Lu 0; Lxu Lx] is obtained
+ * with a single rank-n Cholesky update of [chol(R) 0; 0 chol(Q)]. Then
+ *   Quu = Lu Lu',  Qxu = Lxu Lu',  Qxx - Qxu Quu^{-1} Qux = Lx Lx',
+ * so Lx is the factor of the cost-to-go Hessian of the previous knot point, and the gains
+ * only need triangular solves with Lu.
+ */
+#include "riccati_solve.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "lqr_data.h"
+#include "riccati/riccati_solver.h"
+#include "slap/arena.h"
+#include "slap/linalg.h"
+#include "slap/matrix.h"
+
+/*
+ * Cholesky factor of a cost Hessian, from a cache holding a copy of the Hessian followed by
+ * its packed factor. It is only refactored if the cache isn't valid, or the Hessian changed
+ * since it was cached.
+ */
+static int CachedFactor(const SymMatrix* A, sfloat* cache, bool* valid, SymMatrix* L) {
+  int len = slap_SymMatrixNumElements(A);
+  L->n = A->n;
+  L->data = cache + slap_AlignedLength(len);
+  if (*valid && memcmp(cache, A->data, len * sizeof(sfloat)) == 0) {
+    return 0;
+  }
+  memcpy(cache, A->data, len * sizeof(sfloat));
+  memcpy(L->data, A->data, len * sizeof(sfloat));
+  *valid = slap_SymCholeskyFactorize(L) == slap_kCholeskySuccess;
+  return *valid ? 0 : -1;
+}
+
+/* Set the strict upper triangle of a square matrix to zero */
+static void ZeroUpperTriangle(Matrix* L) {
+  for (int j = 1; j < L->cols; ++j) {
+    for (int i = 0; i < j; ++i) {
+      *slap_MatrixAt(L, i, j) = 0.0;
+    }
+  }
+}
+
+int ulqr_BackwardPassSqrt(RiccatiSolver* solver) {
+  int nhorizon = solver->nhorizon;
+  int nstates = solver->nstates;
+  int ninputs = solver->ninputs;
+  int nz = nstates + ninputs;
+  int LQ_size = 2 * slap_AlignedLength(nstates * (nstates + 1) / 2);
+  int factors_size = ulqr_CostFactorsSize(nstates, ninputs);
+  Arena* scratch = &solver->scratch;
+
+  // Factor of the cost-to-go Hessian of the next knot point, and of the action-value Hessian
+  Matrix* S = &solver->P_work;
+  Matrix* Lz = &solver->Qzz_work;
+  Matrix Lu = slap_MatrixView(Lz, 0, 0, ninputs, ninputs);
+  Matrix Lxu = slap_MatrixView(Lz, ninputs, 0, nstates, ninputs);
+  Matrix Lx = slap_MatrixView(Lz, ninputs, ninputs, nstates, nstates);
+  SymMatrix LQ;
+  SymMatrix LR;
+
+  if (ulqr_ReserveCostFactors(solver) != 0) {
+    return -1;
+  }
+  int k = nhorizon - 1;
+  sfloat* factors = solver->cost_factors + k * factors_size;
+  slap_SymMatrixCopy(ulqr_GetCostToGoHessian(solver, k), ulqr_GetQ(solver, k));
+  slap_MatrixCopy(ulqr_GetCostToGoGradient(solver, k), ulqr_Getq(solver, k));
+  bool* valid = solver->cost_factors_valid;
+  if (CachedFactor(ulqr_GetQ(solver, k), factors, valid + 2 * k, &LQ) != 0) {
+    printf("ERROR: The square-root backward pass needs a positive-definite terminal cost.\n");
+    return -1;
+  }
+  slap_SymMatrixUnpack(S, &LQ);
+  ZeroUpperTriangle(S);
+
+  // S stays the factor of the last computed cost-to-go over the knot points that reuse it
+  solver->steady_state_count = 0;
+  for (--k; k >= 0; --k) {
+    if (ulqr_ReuseSteadyState(solver, k)) {
+      continue;
+    }
+    Matrix* A = ulqr_GetA(solver, k);
+    Matrix* B = ulqr_GetB(solver, k);
+    Matrix* f = ulqr_Getf(solver, k);
+    Matrix* pn = ulqr_GetCostToGoGradient(solver, k + 1);
+
+    // Temporaries, released at the end of the iteration or on failure
+    int mark = slap_ArenaPush(scratch);
+    factors = solver->cost_factors + k * factors_size;
+    if (CachedFactor(ulqr_GetQ(solver, k), factors, valid + 2 * k, &LQ) != 0 ||
+        CachedFactor(ulqr_GetR(solver, k), factors + LQ_size, valid + 2 * k + 1, &LR) != 0) {
+      printf("ERROR: The square-root backward pass needs positive-definite Q and R.\n");
+      slap_ArenaPop(scratch, mark);
+      return -1;
+    }
+    Matrix g = slap_ArenaMatrix(scratch, nstates, 1);              // P * f + p
+    Matrix M = slap_ArenaMatrix(scratch, nstates, nz);             // S'[B A]
+    Matrix X = slap_ArenaMatrix(scratch, nz, nstates);             // M'
+    Matrix P_dense = slap_ArenaMatrix(scratch, nstates, nstates);  // S S'
+    Matrix Quu_dense = slap_ArenaMatrix(scratch, ninputs, ninputs);
+    if (!g.data || !M.data || !X.data || !P_dense.data || !Quu_dense.data) {
+      slap_ArenaPop(scratch, mark);
+      return -1;
+    }
+
+    // Gradient terms, applying P as S * S'
+    Matrix* Qx = ulqr_GetQx(solver, k);
+    Matrix* Qu = ulqr_GetQu(solver, k);
+    slap_MatrixCopy(&g, f);
+    slap_LowerTriMultiply(S, &g, true);
+    slap_LowerTriMultiply(S, &g, false);
+    slap_MatrixAddition(pn, &g, 1.0);
+    slap_MatrixCopy(Qu, ulqr_Getr(solver, k));
+    slap_MatrixCopy(Qx, ulqr_Getq(solver, k));
+    slap_MatrixMultiply(B, &g, Qu, 1, 0, 1.0, 1.0);  // Qu = r + B' * (P * f + p)
+    slap_MatrixMultiply(A, &g, Qx, 1, 0, 1.0, 1.0);  // Qx = q + A' * (P * f + p)
+
+    // Factor of [Quu Qux; Qxu Qxx], updating the factor of [R 0; 0 Q] by the rows of S'[B A]
+    Matrix MB = slap_MatrixView(&M, 0, 0, nstates, ninputs);
+    Matrix MA = slap_MatrixView(&M, 0, ninputs, nstates, nstates);
+    slap_MatrixCopy(&MB, B);
+    slap_MatrixCopy(&MA, A);
+    slap_LowerTriMultiply(S, &M, true);
+    slap_MatrixCopyTranspose(&X, &M);
+    slap_MatrixSetConst(Lz, 0.0);
+    slap_SymMatrixUnpack(&Lu, &LR);
+    slap_SymMatrixUnpack(&Lx, &LQ);
+    ZeroUpperTriangle(&Lu);
+    ZeroUpperTriangle(&Lx);
+    slap_CholeskyUpdate(Lz, &X);
+
+    // Gains [K d] = -Lu' \ [Lxu' Lu \ Qu]
+    Matrix* K = ulqr_GetFeedbackGain(solver, k);
+    Matrix* d = ulqr_GetFeedforwardGain(solver, k);
+    Matrix* Kd = ulqr_GetGains(solver, k);
+    slap_MatrixCopyTranspose(K, &Lxu);
+    slap_MatrixCopy(d, Qu);
+    slap_LowerTriBackSub(&Lu, d, false);
+
+    // Cost-to-go, with p = Qx + Qux'd = Qx - Lxu * (Lu \ Qu)
+    Matrix* p = ulqr_GetCostToGoGradient(solver, k);
+    slap_MatrixCopy(p, Qx);
+    slap_MatrixMultiply(&Lxu, d, p, 0, 0, -1.0, 1.0);
+
+    // Action-value Hessian from its factor, with Qxx = Lx Lx' + Lxu Lxu' and Qux = Lu Lxu'.
+    // X is free after the update, and holds [Lx'; Lxu'].
+    Matrix St = slap_MatrixView(&X, 0, 0, nstates, nstates);
+    Matrix LxuT = slap_MatrixView(&X, nstates, 0, ninputs, nstates);
+    slap_MatrixCopyTranspose(&St, &Lx);
+    slap_MatrixCopy(&LxuT, K);
+    slap_MatrixCopy(ulqr_GetQux(solver, k), &LxuT);
+    slap_LowerTriMultiply(&Lu, ulqr_GetQux(solver, k), false);
+    slap_MatrixCopyTranspose(&Quu_dense, &Lu);
+    slap_LowerTriMultiply(&Lu, &Quu_dense, false);
+    slap_SymMatrixPack(ulqr_GetQuu(solver, k), &Quu_dense);
+
+    // Only the lower triangles of P and Qxx are formed
+    slap_SymmetricRankKUpdate(&St, &P_dense, 1.0, 0.0, false);
+    slap_SymMatrixPack(ulqr_GetCostToGoHessian(solver, k), &P_dense);
+    slap_SymmetricRankKUpdate(&LxuT, &P_dense, 1.0, 1.0, false);
+    slap_SymMatrixPack(ulqr_GetQxx(solver, k), &P_dense);
+
+    slap_LowerTriBackSub(&Lu, Kd, true);
+    slap_MatrixScaleByConst(Kd, -1);
+    slap_MatrixCopy(S, &Lx);
+    ZeroUpperTriangle(S);
+
+    solver->lqrdata[k].reg_shift = 0.0;
+    solver->lqrdata[k].reg_retries = 0;
+    slap_ArenaPop(scratch, mark);
+  }
+  return 0;
+}
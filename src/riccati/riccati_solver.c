@@ -9,7 +9,7 @@
 #include "slap/linalg.h"
 #include "slap/matrix.h"
 
-bool CheckBadIndex(const RiccatiSolver* solver, int k) {
+static bool CheckBadIndex(const RiccatiSolver* solver, int k) {
   if (k < 0 || k > solver->nhorizon) {
     printf("ERROR: Invalid knot point range. Must be in interval [0,%d)\n", solver->nhorizon);
     return true;
@@ -17,69 +17,135 @@ bool CheckBadIndex(const RiccatiSolver* solver, int k) {
   return false;
 }
 
+#ifdef ULQR_FIXED_NSTATES
+/*
+ * Upper bound on the number of values needed by ulqr_NewRiccatiSolver(), allowing every
+ * block to be padded by up to a full alignment and every column of the dense blocks by up
+ * to a full SLAP_PADDING
+ */
+#define FIXED_NX ULQR_FIXED_NSTATES
+#define FIXED_NU ULQR_FIXED_NINPUTS
+#define FIXED_NH ULQR_FIXED_NHORIZON
+#define ALIGNED_BOUND(len) ((len) + (int)(SLAP_ALIGNMENT / sizeof(sfloat)))
+#define PADDED_BOUND(rows) ((rows) + (int)(SLAP_PADDING / sizeof(sfloat)))
+#define SYM_SIZE(n) ((n) * ((n) + 1) / 2)
+#define FIXED_LQRDATA_SIZE                                                         \
+  (4 * ALIGNED_BOUND(SYM_SIZE(FIXED_NX)) + 2 * ALIGNED_BOUND(SYM_SIZE(FIXED_NU)) + \
+   2 * ALIGNED_BOUND(PADDED_BOUND(FIXED_NU) * FIXED_NX) +                          \
+   ALIGNED_BOUND(PADDED_BOUND(FIXED_NX) * (FIXED_NX + FIXED_NU)) +                 \
+   ALIGNED_BOUND(PADDED_BOUND(FIXED_NU) * (FIXED_NX + 1)) +                        \
+   5 * ALIGNED_BOUND(FIXED_NX) + 2 * ALIGNED_BOUND(FIXED_NU) + ALIGNED_BOUND(1))
+#ifdef ULQR_FIXED_SQRT_BACKWARD_PASS
+#define FIXED_SCRATCH_SIZE                                                           \
+  (ALIGNED_BOUND(FIXED_NX) + 2 * ALIGNED_BOUND(FIXED_NX * (FIXED_NX + FIXED_NU)) + \
+   ALIGNED_BOUND(FIXED_NX * FIXED_NX) + ALIGNED_BOUND(FIXED_NU * FIXED_NU))
+#else
+#define FIXED_SCRATCH_SIZE \
+  (ALIGNED_BOUND(FIXED_NX) + ALIGNED_BOUND(FIXED_NX * (FIXED_NX + FIXED_NU)))
+#endif
+#define FIXED_WORK_SIZE                                           \
+  (ALIGNED_BOUND(FIXED_NX) + ALIGNED_BOUND(FIXED_NX * FIXED_NX) + \
+   ALIGNED_BOUND((FIXED_NX + FIXED_NU) * (FIXED_NX + FIXED_NU)) + \
+   ALIGNED_BOUND(FIXED_NH * (FIXED_NX + FIXED_NU)) + FIXED_SCRATCH_SIZE)
+#define FIXED_DATA_SIZE (FIXED_LQRDATA_SIZE * FIXED_NH + FIXED_WORK_SIZE)
+
+// Storage for the one solver of the fixed-dimension build
+static _Alignas(SLAP_ALIGNMENT) sfloat fixed_data[FIXED_DATA_SIZE];
+#ifdef ULQR_FIXED_SQRT_BACKWARD_PASS
+#define FIXED_FACTORS_SIZE \
+  (2 * ALIGNED_BOUND(SYM_SIZE(FIXED_NX)) + 2 * ALIGNED_BOUND(SYM_SIZE(FIXED_NU)))
+static _Alignas(SLAP_ALIGNMENT) sfloat fixed_cost_factors[FIXED_FACTORS_SIZE * FIXED_NH];
+static bool fixed_cost_factors_valid[2 * FIXED_NH];
+#endif
+static RiccatiSolver fixed_solver;
+static KnotPoint fixed_trajectory[FIXED_NH];
+static LQRData fixed_lqrdata[FIXED_NH];
+static bool fixed_solver_in_use = false;
+#endif
+
+/* Release the memory of a solver, any of which may be NULL */
+static void FreeSolverMemory(sfloat* data, RiccatiSolver* solver, KnotPoint* trajectory,
+                             LQRData* lqrdata) {
+#ifdef ULQR_FIXED_NSTATES
+  (void)data;
+  (void)solver;
+  (void)trajectory;
+  (void)lqrdata;
+  fixed_solver_in_use = false;
+#else
+  free(data);
+  free(solver);
+  free(trajectory);
+  free(lqrdata);
+#endif
+}
+
 RiccatiSolver* ulqr_NewRiccatiSolver(int nstates, int ninputs, int nhorizon) {
   int nvars = (2 * nstates + ninputs) * nhorizon - ninputs;
 
+  // Every chunk starts on a cache line, as does the data of every knot point, since the
+  // size of the LQRData is always a multiple of the alignment
   int lqrdata_size = LQRDataSize(nstates, ninputs);
-  int x0_size = ninputs;  // TODO (brian): avoid allocating extra data at last time step?
-  int traj_size = nhorizon * (nstates + ninputs);
-  int total_size = lqrdata_size * nhorizon + x0_size + traj_size;
-
-  // Allocate all the numeric data
-  // double* data = (double*)malloc(total_size * sizeof(double));
-  double* data = (double*)calloc(total_size, sizeof(double));
-  if (!data) {
-    printf("ERROR: Failed to allocate memory for RiccatiSolver.\n");
+  int x0_size = slap_AlignedLength(nstates);
+  int P_work_size = slap_AlignedLength(nstates * nstates);
+  int work_size = P_work_size + slap_AlignedLength((nstates + ninputs) * (nstates + ninputs));
+  int traj_size = slap_AlignedLength(nhorizon * (nstates + ninputs));
+  int scratch_size = ulqr_RiccatiScratchSize(nstates, ninputs);
+  int total_size = lqrdata_size * nhorizon + x0_size + work_size + traj_size + scratch_size;
+
+  // Allocate all the memory
+#ifdef ULQR_FIXED_NSTATES
+  if (nstates != FIXED_NX || ninputs != FIXED_NU || nhorizon != FIXED_NH) {
+    printf("ERROR: This solver was built for nstates = %d, ninputs = %d and nhorizon = %d.\n",
+           FIXED_NX, FIXED_NU, FIXED_NH);
     return NULL;
   }
-  memset(data, 0, total_size * sizeof(double));
-
-  // Separate into chunks
-  double* lqrdata_data = data;
-  double* x0_data = lqrdata_data + lqrdata_size * nhorizon;
-  double* traj_data = x0_data + x0_size;
-
-  // Allocate the solver
-  RiccatiSolver* solver = (RiccatiSolver*)malloc(sizeof(RiccatiSolver));
-  if (!solver) {
-    printf("ERROR: Failed to allocate memory for RiccatiSolver.\n");
-    free(data);
+  if (fixed_solver_in_use) {
+    printf("ERROR: The fixed-dimension build only supports a single RiccatiSolver.\n");
     return NULL;
   }
-
-  // Allocate the trajectory
+  if (total_size > FIXED_DATA_SIZE) {
+    printf("ERROR: Not enough static memory for RiccatiSolver.\n");
+    return NULL;
+  }
+  fixed_solver_in_use = true;
+  sfloat* data = fixed_data;
+  RiccatiSolver* solver = &fixed_solver;
+  KnotPoint* trajectory = fixed_trajectory;
+  LQRData* lqrdata = fixed_lqrdata;
+#else
+  sfloat* data = (sfloat*)slap_AlignedAlloc(total_size * sizeof(sfloat));
+  RiccatiSolver* solver = (RiccatiSolver*)malloc(sizeof(RiccatiSolver));
   KnotPoint* trajectory = (KnotPoint*)malloc(sizeof(KnotPoint) * nhorizon);
-  if (!trajectory) {
-    printf("ERROR: Failed to allocated memory for trajectory.\n");
-    free(data);
-    free(solver);
+  LQRData* lqrdata = (LQRData*)malloc(nhorizon * sizeof(LQRData));
+  if (!data || !solver || !trajectory || !lqrdata) {
+    printf("ERROR: Failed to allocate memory for RiccatiSolver.\n");
+    FreeSolverMemory(data, solver, trajectory, lqrdata);
     return NULL;
   }
-  const double h = 0.1;  // TODO (brian): pull this from an input
+#endif
+  memset(data, 0, total_size * sizeof(sfloat));
+
+  // Separate into chunks
+  sfloat* lqrdata_data = data;
+  sfloat* x0_data = lqrdata_data + lqrdata_size * nhorizon;
+  sfloat* work_data = x0_data + x0_size;
+  sfloat* traj_data = work_data + work_size;
+  sfloat* scratch_data = traj_data + traj_size;
+
+  // Initialize the trajectory
+  const sfloat h = 0.1;  // TODO (brian): pull this from an input
   for (int k = 0; k < nhorizon; ++k) {
     ulqr_InitializeKnotPoint(trajectory + k, nstates, ninputs, traj_data + (nstates + ninputs) * k,
                              h * k, h);
   }
 
-  // Allocate space for LQRData array
-  LQRData* lqrdata = (LQRData*)malloc(nhorizon * sizeof(LQRData));
-  if (!lqrdata) {
-    printf("ERROR: Failed to allocate LQR Data for RiccatiSolver.\n");
-    free(data);
-    free(solver);
-    free(trajectory);
-    return NULL;
-  }
-
   // Initialize all the LQRData
   for (int k = 0; k < nhorizon; ++k) {
     int out =
         ulqr_InitializeLQRData(lqrdata + k, nstates, ninputs, lqrdata_data + lqrdata_size * k);
     if (out != kOk) {
-      free(data);
-      free(solver);
-      free(lqrdata);
-      free(trajectory);
+      FreeSolverMemory(data, solver, trajectory, lqrdata);
       return NULL;
     }
   }
@@ -94,26 +160,95 @@ RiccatiSolver* ulqr_NewRiccatiSolver(int nstates, int ninputs, int nhorizon) {
   solver->data = data;
   solver->x0.data = x0_data;
   slap_SetMatrixSize(&solver->x0, nstates, 1);
+  solver->P_work.data = work_data;
+  slap_SetMatrixSize(&solver->P_work, nstates, nstates);
+  solver->Qzz_work.data = solver->P_work.data + P_work_size;
+  slap_SetMatrixSize(&solver->Qzz_work, nstates + ninputs, nstates + ninputs);
+  solver->scratch = slap_InitArena(scratch_data, scratch_size);
+  solver->cost_factors = NULL;
+  solver->cost_factors_valid = NULL;
+  solver->reg_min = 1e-8;
+  solver->reg_max = 0.0;
+  solver->sqrt_backward_pass = false;
+  solver->steady_state_tol = 0.0;
+  solver->steady_state_count = 0;
   solver->t_solve_ms = 0.0;
   solver->t_backward_pass_ms = 0.0;
   solver->t_forward_pass_ms = 0.0;
   return solver;
 }
 
+int ulqr_RiccatiScratchSize(int nstates, int ninputs) {
+  // Temporaries of the backward pass
+  int size = slap_AlignedLength(nstates);
+#ifdef ULQR_FIXED_NSTATES
+  // The fixed-dimension backward pass also forms P * [A B]
+  size += slap_AlignedLength(nstates * (nstates + ninputs));
+#endif
+
+#if !defined(ULQR_FIXED_NSTATES) || defined(ULQR_FIXED_SQRT_BACKWARD_PASS)
+  // Temporaries of the square-root backward pass
+  int sqrt_size = slap_AlignedLength(nstates) +
+                  2 * slap_AlignedLength(nstates * (nstates + ninputs)) +
+                  slap_AlignedLength(nstates * nstates) + slap_AlignedLength(ninputs * ninputs);
+  size = size > sqrt_size ? size : sqrt_size;
+#endif
+  return size;
+}
+
+int ulqr_CostFactorsSize(int nstates, int ninputs) {
+  return 2 * slap_AlignedLength(nstates * (nstates + 1) / 2) +
+         2 * slap_AlignedLength(ninputs * (ninputs + 1) / 2);
+}
+
+int ulqr_ReserveCostFactors(RiccatiSolver* solver) {
+  if (solver->cost_factors) {
+    return 0;
+  }
+#if defined(ULQR_FIXED_NSTATES) && !defined(ULQR_FIXED_SQRT_BACKWARD_PASS)
+  printf("ERROR: riccati_fixed was built without ULQR_FIXED_SQRT_BACKWARD_PASS.\n");
+  return -1;
+#else
+  int size = ulqr_CostFactorsSize(solver->nstates, solver->ninputs) * solver->nhorizon;
+#ifdef ULQR_FIXED_NSTATES
+  sfloat* factors = fixed_cost_factors;
+  bool* valid = fixed_cost_factors_valid;
+#else
+  sfloat* factors = (sfloat*)slap_AlignedAlloc(size * sizeof(sfloat));
+  bool* valid = (bool*)malloc(2 * solver->nhorizon * sizeof(bool));
+  if (!factors || !valid) {
+    printf("ERROR: Failed to allocate memory for the factors of the cost.\n");
+    free(factors);
+    free(valid);
+    return -1;
+  }
+#endif
+  memset(factors, 0, size * sizeof(sfloat));
+  for (int i = 0; i < 2 * solver->nhorizon; ++i) {
+    valid[i] = false;
+  }
+  solver->cost_factors = factors;
+  solver->cost_factors_valid = valid;
+  return 0;
+#endif
+}
+
 int ulqr_FreeRiccatiSolver(RiccatiSolver** solver_ptr) {
   RiccatiSolver* solver = *solver_ptr;
   if (!solver) {
     return -1;
   }
-  free(solver->data);
-  free(solver->lqrdata);
-  free(solver->Z);
-  free(solver);
+  slap_FreeArena(&solver->scratch);
+#ifndef ULQR_FIXED_NSTATES
+  free(solver->cost_factors);
+  free(solver->cost_factors_valid);
+#endif
+  FreeSolverMemory(solver->data, solver, solver->Z, solver->lqrdata);
   *solver_ptr = NULL;
   return 0;
 }
 
-enum ulqr_ReturnCode ulqr_SetInitialState(RiccatiSolver* solver, double* x0) {
+enum ulqr_ReturnCode ulqr_SetInitialState(RiccatiSolver* solver, sfloat* x0) {
   int out = kOk;
   if (solver) {
     int slap_out = slap_MatrixCopyFromArray(&solver->x0, x0);
@@ -131,9 +266,9 @@ int ulqr_PrintRiccatiSummary(RiccatiSolver* solver) {
     return -1;
   }
   printf("NDLQR Riccati Solve Summary\n");
-  double t_solve = solver->t_solve_ms;
-  double t_bp = solver->t_backward_pass_ms;
-  double t_fp = solver->t_forward_pass_ms;
+  sfloat t_solve = solver->t_solve_ms;
+  sfloat t_bp = solver->t_backward_pass_ms;
+  sfloat t_fp = solver->t_forward_pass_ms;
   printf("  Solve time:    %.2f ms\n", t_solve);
   printf("  Backward Pass: %.2f ms (%.1f %% of total)\n", t_bp, t_bp / t_solve * 100.0);
   printf("  Foward Pass:   %.2f ms (%.1f %% of total)\n", t_fp, t_fp / t_solve * 100.0);
@@ -142,8 +277,8 @@ int ulqr_PrintRiccatiSummary(RiccatiSolver* solver) {
 
 int ulqr_GetNumVars(RiccatiSolver* solver) { return solver->nvars; }
 
-enum ulqr_ReturnCode ulqr_SetCost(RiccatiSolver* solver, const double* Q, const double* R,
-                                  const double* H, const double* q, const double* r, double c,
+enum ulqr_ReturnCode ulqr_SetCost(RiccatiSolver* solver, const sfloat* Q, const sfloat* R,
+                                  const sfloat* H, const sfloat* q, const sfloat* r, sfloat c,
                                   int k_start, int k_end) {
   // Check inputs
   if (!solver) {
@@ -163,11 +298,17 @@ enum ulqr_ReturnCode ulqr_SetCost(RiccatiSolver* solver, const double* Q, const
     printf("WARNING: Specified an empty knot point interval: [%d,%d).\n", k_start, k_end);
   }
 
-  // Copy into problem
+  // Copy into problem, only keeping the lower triangle of Q and R
+  Matrix Qmat = {solver->nstates, solver->nstates, (sfloat*)Q, solver->nstates};
+  Matrix Rmat = {solver->ninputs, solver->ninputs, (sfloat*)R, solver->ninputs};
   for (int k = k_start; k < k_end; ++k) {
     LQRData* lqrdata = solver->lqrdata + k;
-    slap_MatrixCopyFromArray(&lqrdata->Q, Q);
-    slap_MatrixCopyFromArray(&lqrdata->R, R);
+    slap_SymMatrixPack(&lqrdata->Q, &Qmat);
+    slap_SymMatrixPack(&lqrdata->R, &Rmat);
+    if (solver->cost_factors_valid) {
+      solver->cost_factors_valid[2 * k] = false;
+      solver->cost_factors_valid[2 * k + 1] = false;
+    }
     if (H) {
       slap_MatrixCopyFromArray(&lqrdata->H, H);
     }
@@ -183,8 +324,8 @@ enum ulqr_ReturnCode ulqr_SetCost(RiccatiSolver* solver, const double* Q, const
   return kOk;
 }
 
-enum ulqr_ReturnCode ulqr_SetDynamics(RiccatiSolver* solver, const double* A, const double* B,
-                                      const double* f, int k_start, int k_end) {
+enum ulqr_ReturnCode ulqr_SetDynamics(RiccatiSolver* solver, const sfloat* A, const sfloat* B,
+                                      const sfloat* f, int k_start, int k_end) {
   // Check inputs
   if (!solver) {
     return kBadInput;
@@ -219,20 +360,24 @@ enum ulqr_ReturnCode ulqr_SetDynamics(RiccatiSolver* solver, const double* A, co
 Matrix* ulqr_GetA(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->A; }
 Matrix* ulqr_GetB(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->B; }
 Matrix* ulqr_Getf(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->f; }
-Matrix* ulqr_GetQ(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->Q; }
-Matrix* ulqr_GetR(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->R; }
+Matrix* ulqr_GetAB(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->AB; }
+SymMatrix* ulqr_GetQ(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->Q; }
+SymMatrix* ulqr_GetR(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->R; }
 Matrix* ulqr_GetH(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->H; }
 Matrix* ulqr_Getq(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->q; }
 Matrix* ulqr_Getr(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->r; }
-double ulqr_Getc(RiccatiSolver* solver, int k) { return *(solver->lqrdata[k]).c; }
+sfloat ulqr_Getc(RiccatiSolver* solver, int k) { return *(solver->lqrdata[k]).c; }
 
 Matrix* ulqr_GetFeedbackGain(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->K; }
 Matrix* ulqr_GetFeedforwardGain(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->d; }
-Matrix* ulqr_GetCostToGoHessian(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->P; }
+Matrix* ulqr_GetGains(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->Kd; }
+SymMatrix* ulqr_GetCostToGoHessian(RiccatiSolver* solver, int k) {
+  return &(solver->lqrdata + k)->P;
+}
 Matrix* ulqr_GetCostToGoGradient(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->p; }
 
-Matrix* ulqr_GetQxx(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->Qxx; }
-Matrix* ulqr_GetQuu(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->Quu; }
+SymMatrix* ulqr_GetQxx(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->Qxx; }
+SymMatrix* ulqr_GetQuu(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->Quu; }
 Matrix* ulqr_GetQux(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->Qux; }
 Matrix* ulqr_GetQx(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->Qx; }
 Matrix* ulqr_GetQu(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->Qu; }
@@ -247,25 +392,32 @@ Matrix* ulqr_GetInput(RiccatiSolver* solver, int k) {
 
 Matrix* ulqr_GetDual(RiccatiSolver* solver, int k) { return &(solver->lqrdata + k)->y; }
 
+sfloat ulqr_GetRegularizationShift(RiccatiSolver* solver, int k) {
+  return solver->lqrdata[k].reg_shift;
+}
+int ulqr_GetRegularizationRetries(RiccatiSolver* solver, int k) {
+  return solver->lqrdata[k].reg_retries;
+}
+
 /*************************
  *       Methods
  *************************/
-double ulqr_CalcCost(RiccatiSolver* solver) {
-  double cost = 0.0;
-  const double half = 0.5;
+sfloat ulqr_CalcCost(RiccatiSolver* solver) {
+  sfloat cost = 0.0;
+  const sfloat half = 0.5;
   for (int k = 0; k < solver->nhorizon; ++k) {
     Matrix* x = ulqr_GetState(solver, k);
-    Matrix* Q = ulqr_GetQ(solver, k);
+    SymMatrix* Q = ulqr_GetQ(solver, k);
     Matrix* q = ulqr_Getq(solver, k);
 
-    cost += half * slap_QuadraticForm(x, Q, x);
+    cost += half * slap_SymQuadraticForm(x, Q);
     cost += slap_DotProduct(q, x);
 
     if (k < solver->nhorizon - 1) {
       Matrix* u = ulqr_GetInput(solver, k);
-      Matrix* R = ulqr_GetR(solver, k);
+      SymMatrix* R = ulqr_GetR(solver, k);
       Matrix* r = ulqr_Getr(solver, k);
-      cost += half * slap_QuadraticForm(u, R, u);
+      cost += half * slap_SymQuadraticForm(u, R);
       cost += slap_DotProduct(r, u);
     }
 
@@ -15,6 +15,7 @@
 #include "knotpoint.h"
 #include "lqr_data.h"
 #include "riccati/constants.h"
+#include "slap/arena.h"
 
 /**
  * @brief Solver that uses Riccati recursion to solve an LQR problem.
@@ -34,6 +35,12 @@
  * is initialized upon the creation of the solver to avoid any dynamic memory allocations
  * during the solve.
  *
+ * The symmetric blocks of the problem data are stored in packed form (see LQRData).
+ * The backward pass expands the ones it is working on into a few dense workspace
+ * matrices, so that the dense kernels can be used for the heavy lifting. Any other
+ * temporaries are drawn from a scratch arena, so the solve never touches the data of
+ * knot points other than the one it is working on.
+ *
  * ## Construction and destruction
  * Use  ulqr_NewRiccatiSolver() to initialize a new solver, which much be paired
  * with a single call to  ulqr_FreeRiccatiSolver() to free all of solver's memory.
@@ -45,13 +52,44 @@
  * RiccatiSolver* solver =  ulqr_NewRiccatiSolver(lqrprob);
  *  ulqr_SolveRiccati(solver);
  *  ulqr_PrintRiccatiSummary(solver);
- * double* soln = (double*) malloc(solver->nvars * sizeof(double));
+ * sfloat* soln = (sfloat*) malloc(solver->nvars * sizeof(sfloat));
  *  ulqr_CopyRiccatiSolution(solver, soln);
  *  ulqr_FreeRiccatiSolver();
  *  ulqr_FreeLQRProblem();
  * free(soln);
  * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
  *
+ * ## Fixed-dimension build
+ * If the problem size is known ahead of time, setting the `ULQR_FIXED_NSTATES`,
+ * `ULQR_FIXED_NINPUTS` and `ULQR_FIXED_NHORIZON` CMake variables builds the `riccati_fixed`
+ * library, with the same API, for that size only. Its backward and forward passes use the
+ * inline kernels of small_kernels.h with compile-time constant sizes, and all its memory
+ * is allocated statically, so ulqr_NewRiccatiSolver() never calls `malloc`. As a result,
+ * it only supports one solver at a time, and returns NULL for a problem of any other size.
+ *
+ * ## Regularization
+ * By default the backward pass fails if the action-value Hessian \f$ Q_{uu} \f$ of any
+ * knot point isn't positive definite. Setting `reg_max` to a positive value instead
+ * regularizes the factorization of \f$ Q_{uu} \f$: if it fails, \f$ Q_{uu} + s I \f$ is
+ * factored instead, with a shift \f$ s \f$ starting at `reg_min` and growing tenfold
+ * until the factorization succeeds or the shift exceeds `reg_max` (see
+ * slap_CholeskyFactorizeRegularized()). The gains and the cost-to-go are then those of
+ * \f$ Q_{uu} + s I \f$, with the same shift on every input.
+ * The shift and the number of shifts tried at each knot point are available from
+ * ulqr_GetRegularizationShift() and ulqr_GetRegularizationRetries().
+ *
+ * ## Steady state
+ * For a time-invariant stretch of the horizon, the Riccati recursion converges to a fixed
+ * point long before it reaches the start of the stretch. Setting `steady_state_tol` to a
+ * positive value lets the backward pass stop there: once the relative change of both
+ * \f$ P_k \f$ and \f$ p_k \f$ from one knot point to the next is below the tolerance,
+ * the gains and cost-to-go are copied to every earlier knot point with exactly the same
+ * cost and dynamics (see ulqr_IsLQRProblemEqual()), instead of being computed. The
+ * recursion picks up again at the first knot point with different data. The number of
+ * knot points copied by the last backward pass is stored in `steady_state_count`.
+ * The recursion converges at the rate of the closed-loop dynamics, so the error of the
+ * copied values is about the tolerance divided by one minus that rate.
+ *
  * ## Methods
  * -  ulqr_NewRiccatiSolver()
  * -  ulqr_FreeRiccatiSolver()
@@ -68,8 +106,18 @@ typedef struct {
   int nvars;     ///< total number of decision variables, including the dual variables
   KnotPoint* Z;  ///< state and control trajectory
   LQRData* lqrdata;  ///< LQR Problem data
-  double* data;  ///< pointer to the beginning of the single block of memory allocated by the solver
+  sfloat* data;  ///< pointer to the beginning of the single block of memory allocated by the solver
   Matrix x0;    ///< Initial state
+  Matrix P_work;    ///< (n,n) dense copy of the cost-to-go Hessian used by the backward pass
+  Matrix Qzz_work;  ///< (n+m,n+m) dense action-value Hessian [Qxx Qux'; Qux Quu]
+  Arena scratch;    ///< Workspace for the temporaries of the solve
+  sfloat* cost_factors;  ///< Factors of Q and R cached by ulqr_BackwardPassSqrt(), or NULL
+  bool* cost_factors_valid;  ///< (2N,) whether each cached factor of Q and R is up to date
+  sfloat reg_min;   ///< First diagonal shift tried when Quu isn't positive definite
+  sfloat reg_max;   ///< Largest shift allowed. Zero disables regularization.
+  bool sqrt_backward_pass;  ///< Use ulqr_BackwardPassSqrt() in ulqr_SolveRiccati()
+  sfloat steady_state_tol;  ///< Change in the cost-to-go below which it's reused. Zero disables.
+  int steady_state_count;   ///< Knot points copied by the last backward pass
   double t_solve_ms;          ///< Total solve time in milliseconds
   double t_backward_pass_ms;  ///< Time spent in the backward pass in milliseconds
   double t_forward_pass_ms;   ///< Time spent in the forward pass in milliseconds
@@ -86,6 +134,36 @@ typedef struct {
  */
 RiccatiSolver* ulqr_NewRiccatiSolver(int nstates, int ninputs, int nhorizon);
 
+/**
+ * @brief Number of values in the scratch arena of the solver
+ *
+ * The largest amount of temporary workspace needed by any of the solver's methods.
+ */
+int ulqr_RiccatiScratchSize(int nstates, int ninputs);
+
+/**
+ * @brief Number of values per knot point of `cost_factors`
+ *
+ * Each knot point keeps a copy of \f$ Q \f$ and its packed Cholesky factor, followed by
+ * the same for \f$ R \f$, so ulqr_BackwardPassSqrt() only factors them again when they
+ * change. A factor is only used if its flag in `cost_factors_valid` is set, which
+ * ulqr_SetCost() clears, and the copy still matches the cost, which catches changes made
+ * through ulqr_GetQ() or ulqr_GetR().
+ */
+int ulqr_CostFactorsSize(int nstates, int ninputs);
+
+/**
+ * @brief Allocate `cost_factors`, if it isn't already
+ *
+ * Called by ulqr_BackwardPassSqrt() on its first run, so solvers that only use the usual
+ * backward pass don't hold the factors. The fixed-dimension build only has static storage
+ * for them when compiled with `ULQR_FIXED_SQRT_BACKWARD_PASS`.
+ *
+ * @param solver An initialized RiccatiSolver
+ * @return 0 if successful, or -1 if the memory couldn't be allocated
+ */
+int ulqr_ReserveCostFactors(RiccatiSolver* solver);
+
 /**
  * @brief Free the memory for a Riccati solver
  *
@@ -123,42 +201,51 @@ int ulqr_GetNumVars(RiccatiSolver* solver);
  * @param x0     Initial state. Length must be at least solver->nstates
  * @return       Info code
  */
-enum ulqr_ReturnCode ulqr_SetInitialState(RiccatiSolver* solver, double* x0);
+enum ulqr_ReturnCode ulqr_SetInitialState(RiccatiSolver* solver, sfloat* x0);
 
-enum ulqr_ReturnCode ulqr_SetCost(RiccatiSolver* solver, const double* Q, const double* R,
-                                  const double* H, const double* q, const double* r, double c,
+/**
+ * @brief Set the cost for the knot points in the interval [k_start, k_end)
+ *
+ * @p Q and @p R are given as dense column-major matrices, of which only the lower
+ * triangle is read. The other arguments, except for the constant @p c, can be NULL.
+ */
+enum ulqr_ReturnCode ulqr_SetCost(RiccatiSolver* solver, const sfloat* Q, const sfloat* R,
+                                  const sfloat* H, const sfloat* q, const sfloat* r, sfloat c,
                                   int k_start, int k_end);
 
-enum ulqr_ReturnCode ulqr_SetDynamics(RiccatiSolver* solver, const double* A, const double* B,
-                                      const double* f, int k_start, int k_end);
+enum ulqr_ReturnCode ulqr_SetDynamics(RiccatiSolver* solver, const sfloat* A, const sfloat* B,
+                                      const sfloat* f, int k_start, int k_end);
 
 /*************************
  *       Getters
  *************************/
 Matrix* ulqr_GetA(RiccatiSolver* solver,
-                  int k);                         ///< @brief Get (n,n) state transition matrix
-Matrix* ulqr_GetB(RiccatiSolver* solver, int k);  ///< @brief Get (n,m) control input matrix
-Matrix* ulqr_Getf(RiccatiSolver* solver, int k);  ///< @brief Get (n,) affine dynamice term
-Matrix* ulqr_GetQ(RiccatiSolver* solver, int k);  ///< @brief Get state cost Hessian
-Matrix* ulqr_GetR(RiccatiSolver* solver, int k);  ///< @brief Get control cost Hessian
+                  int k);                            ///< @brief Get (n,n) state transition matrix
+Matrix* ulqr_GetB(RiccatiSolver* solver, int k);     ///< @brief Get (n,m) control input matrix
+Matrix* ulqr_Getf(RiccatiSolver* solver, int k);     ///< @brief Get (n,) affine dynamice term
+Matrix* ulqr_GetAB(RiccatiSolver* solver, int k);    ///< @brief Get (n,n+m) stacked [A B]
+SymMatrix* ulqr_GetQ(RiccatiSolver* solver, int k);  ///< @brief Get state cost Hessian
+SymMatrix* ulqr_GetR(RiccatiSolver* solver, int k);  ///< @brief Get control cost Hessian
 Matrix* ulqr_GetH(RiccatiSolver* solver,
-                  int k);                         ///< @brief Get cost Hessian cross-term (m,n)
-Matrix* ulqr_Getq(RiccatiSolver* solver, int k);  ///< @brief Get affine state cost
-Matrix* ulqr_Getr(RiccatiSolver* solver, int k);  ///< @brief Get affine control cost
-double ulqr_Getc(RiccatiSolver* solver, int k);   ///< @brief Get cost constant
+                  int k);                            ///< @brief Get cost Hessian cross-term (m,n)
+Matrix* ulqr_Getq(RiccatiSolver* solver, int k);     ///< @brief Get affine state cost
+Matrix* ulqr_Getr(RiccatiSolver* solver, int k);     ///< @brief Get affine control cost
+sfloat ulqr_Getc(RiccatiSolver* solver, int k);      ///< @brief Get cost constant
 
 Matrix* ulqr_GetFeedbackGain(RiccatiSolver* solver,
                              int k);  ///< @brief Get (m,n) feedback gain
 Matrix* ulqr_GetFeedforwardGain(RiccatiSolver* solver,
                                 int k);  ///< @brief Get (m,) feedforward gain
-Matrix* ulqr_GetCostToGoHessian(RiccatiSolver* solver,
-                                int k);  ///< @brief Get (n,n) Hessian of the cost-to-go
+Matrix* ulqr_GetGains(RiccatiSolver* solver,
+                      int k);  ///< @brief Get (m,n+1) stacked gains [K d]
+SymMatrix* ulqr_GetCostToGoHessian(RiccatiSolver* solver,
+                                   int k);  ///< @brief Get (n,n) Hessian of the cost-to-go
 Matrix* ulqr_GetCostToGoGradient(RiccatiSolver* solver,
                                  int k);  ///< @brief Get (n,) Gradient of the cost-to-go
-Matrix* ulqr_GetQxx(RiccatiSolver* solver,
-                    int k);  ///< @brief Get (n,n) Action-value state Hessian
-Matrix* ulqr_GetQuu(RiccatiSolver* solver,
-                    int k);  ///< @brief Get (m,m) Action-value control Hessian
+SymMatrix* ulqr_GetQxx(RiccatiSolver* solver,
+                       int k);  ///< @brief Get (n,n) Action-value state Hessian
+SymMatrix* ulqr_GetQuu(RiccatiSolver* solver,
+                       int k);  ///< @brief Get (m,m) Action-value control Hessian
 Matrix* ulqr_GetQux(RiccatiSolver* solver,
                     int k);  ///< @brief Get (m,n) Action-value Hessian cross-term
 Matrix* ulqr_GetQx(RiccatiSolver* solver,
@@ -168,10 +255,14 @@ Matrix* ulqr_GetQu(RiccatiSolver* solver,
 Matrix* ulqr_GetState(RiccatiSolver* solver, int k);  ///< @brief Get (n,) state vector
 Matrix* ulqr_GetInput(RiccatiSolver* solver, int k);  ///< @brief Get (m,) input vector
 Matrix* ulqr_GetDual(RiccatiSolver* solver, int k);   ///< @brief Get (n,) dual vector
+sfloat ulqr_GetRegularizationShift(RiccatiSolver* solver,
+                                   int k);  ///< @brief Get the shift added to Quu
+int ulqr_GetRegularizationRetries(RiccatiSolver* solver,
+                                  int k);  ///< @brief Get the number of increases of the shift
 
 /*************************
  *       Methods
  *************************/
-double ulqr_CalcCost(RiccatiSolver* solver);
+sfloat ulqr_CalcCost(RiccatiSolver* solver);
 
 /**@} */
@@ -0,0 +1,324 @@
+#include "solver_pool.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "riccati/riccati_solve.h"
+#include "slap/arena.h"
+#include "slap/matrix.h"
+
+struct SolverJob {
+  RiccatiSolver* solver;
+  SolverPoolCallback callback;
+  void* userdata;
+};
+
+/* Ring buffer of jobs, grown when full. The owner takes from the front, thieves the back. */
+struct JobQueue {
+  pthread_mutex_t lock;
+  struct SolverJob* jobs;
+  int capacity;
+  int head;   ///< index of the front job
+  int count;  ///< number of queued jobs
+};
+
+struct PoolWorker {
+  SolverPool* pool;
+  int index;
+  pthread_t thread;
+  struct JobQueue queue;
+
+  // Scratch space lent to the solvers, sized for nstates and ninputs
+  sfloat* data;
+  int nstates;
+  int ninputs;
+  Matrix P_work;
+  Matrix Qzz_work;
+  Arena scratch;
+};
+
+struct SolverPool {
+  int nthreads;
+  struct PoolWorker* workers;
+  pthread_mutex_t lock;
+  pthread_cond_t work;  ///< signaled when a job is queued, or the pool is stopped
+  pthread_cond_t idle;  ///< signaled when the last pending job is done
+
+  // Guarded by the lock
+  int nqueued;   ///< jobs in the queues not yet reserved by a worker
+  int npending;  ///< jobs submitted but not done
+  int nfailed;   ///< failed jobs since the last call to ulqr_SolverPoolWait()
+  int next;      ///< queue of the next submitted job
+  bool stop;
+};
+
+static int PushJob(struct JobQueue* queue, struct SolverJob job) {
+  pthread_mutex_lock(&queue->lock);
+  if (queue->count == queue->capacity) {
+    int capacity = queue->capacity > 0 ? 2 * queue->capacity : 16;
+    struct SolverJob* jobs = (struct SolverJob*)malloc(capacity * sizeof(struct SolverJob));
+    if (!jobs) {
+      pthread_mutex_unlock(&queue->lock);
+      return -1;
+    }
+    for (int i = 0; i < queue->count; ++i) {
+      jobs[i] = queue->jobs[(queue->head + i) % queue->capacity];
+    }
+    free(queue->jobs);
+    queue->jobs = jobs;
+    queue->capacity = capacity;
+    queue->head = 0;
+  }
+  queue->jobs[(queue->head + queue->count) % queue->capacity] = job;
+  ++queue->count;
+  pthread_mutex_unlock(&queue->lock);
+  return 0;
+}
+
+/* Take the front (or back) job of a queue. Returns false if it's empty. */
+static bool PopJob(struct JobQueue* queue, bool back, struct SolverJob* job) {
+  pthread_mutex_lock(&queue->lock);
+  bool found = queue->count > 0;
+  if (found) {
+    --queue->count;
+    if (back) {
+      *job = queue->jobs[(queue->head + queue->count) % queue->capacity];
+    } else {
+      *job = queue->jobs[queue->head];
+      queue->head = (queue->head + 1) % queue->capacity;
+    }
+  }
+  pthread_mutex_unlock(&queue->lock);
+  return found;
+}
+
+/* Take a job from the worker's own queue, or else steal one from the others */
+static bool FindJob(struct PoolWorker* worker, struct SolverJob* job) {
+  SolverPool* pool = worker->pool;
+  if (PopJob(&worker->queue, false, job)) {
+    return true;
+  }
+  for (int i = 1; i < pool->nthreads; ++i) {
+    struct PoolWorker* victim = pool->workers + (worker->index + i) % pool->nthreads;
+    if (PopJob(&victim->queue, true, job)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Make sure the scratch space of a worker fits a problem of the given size */
+static int ReserveScratch(struct PoolWorker* worker, int nstates, int ninputs) {
+  if (worker->data && nstates <= worker->nstates && ninputs <= worker->ninputs) {
+    return 0;
+  }
+  nstates = nstates > worker->nstates ? nstates : worker->nstates;
+  ninputs = ninputs > worker->ninputs ? ninputs : worker->ninputs;
+  int P_work_size = slap_AlignedLength(nstates * nstates);
+  int Qzz_work_size = slap_AlignedLength((nstates + ninputs) * (nstates + ninputs));
+  int scratch_size = ulqr_RiccatiScratchSize(nstates, ninputs);
+  int total_size = P_work_size + Qzz_work_size + scratch_size;
+  sfloat* data = (sfloat*)slap_AlignedAlloc(total_size * sizeof(sfloat));
+  if (!data) {
+    return -1;
+  }
+  free(worker->data);
+  worker->data = data;
+  worker->nstates = nstates;
+  worker->ninputs = ninputs;
+  worker->P_work.data = data;
+  worker->Qzz_work.data = data + P_work_size;
+  worker->scratch = slap_InitArena(data + P_work_size + Qzz_work_size, scratch_size);
+  return 0;
+}
+
+/* Solve with the scratch space of the worker, or the solver's own if it can't be grown */
+static int RunJob(struct PoolWorker* worker, RiccatiSolver* solver) {
+  int nstates = solver->nstates;
+  int ninputs = solver->ninputs;
+  if (ReserveScratch(worker, nstates, ninputs) != 0) {
+    return ulqr_SolveRiccati(solver);
+  }
+  Matrix P_work = solver->P_work;
+  Matrix Qzz_work = solver->Qzz_work;
+  Arena scratch = solver->scratch;
+  solver->P_work.data = worker->P_work.data;
+  solver->Qzz_work.data = worker->Qzz_work.data;
+  solver->scratch = worker->scratch;
+
+  int status = ulqr_SolveRiccati(solver);
+
+  solver->P_work = P_work;
+  solver->Qzz_work = Qzz_work;
+  solver->scratch = scratch;
+  return status;
+}
+
+static void* Worker(void* arg) {
+  struct PoolWorker* worker = (struct PoolWorker*)arg;
+  SolverPool* pool = worker->pool;
+  for (;;) {
+    pthread_mutex_lock(&pool->lock);
+    while (pool->nqueued <= 0 && !pool->stop) {
+      pthread_cond_wait(&pool->work, &pool->lock);
+    }
+    if (pool->nqueued <= 0) {
+      pthread_mutex_unlock(&pool->lock);
+      break;
+    }
+    --pool->nqueued;
+    pthread_mutex_unlock(&pool->lock);
+
+    // A job is only counted once it is pushed, and only taken once reserved, so there are
+    // always at least as many jobs in the queues as reservations
+    struct SolverJob job;
+    while (!FindJob(worker, &job)) {
+    }
+
+    int status = RunJob(worker, job.solver);
+    if (job.callback) {
+      job.callback(job.solver, status, job.userdata);
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    if (status != 0) {
+      ++pool->nfailed;
+    }
+    if (--pool->npending == 0) {
+      pthread_cond_broadcast(&pool->idle);
+    }
+    pthread_mutex_unlock(&pool->lock);
+  }
+  return NULL;
+}
+
+/* Stop and join the first nstarted workers, once the queues are empty */
+static void StopWorkers(SolverPool* pool, int nstarted) {
+  pthread_mutex_lock(&pool->lock);
+  pool->stop = true;
+  pthread_cond_broadcast(&pool->work);
+  pthread_mutex_unlock(&pool->lock);
+  for (int i = 0; i < nstarted; ++i) {
+    pthread_join(pool->workers[i].thread, NULL);
+  }
+}
+
+static void FreeWorkers(SolverPool* pool) {
+  for (int i = 0; i < pool->nthreads; ++i) {
+    struct PoolWorker* worker = pool->workers + i;
+    pthread_mutex_destroy(&worker->queue.lock);
+    free(worker->queue.jobs);
+    free(worker->data);
+  }
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->work);
+  pthread_cond_destroy(&pool->idle);
+  free(pool->workers);
+  free(pool);
+}
+
+SolverPool* ulqr_NewSolverPool(int nthreads) {
+  if (nthreads < 1) {
+    long nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+    nthreads = nprocs > 0 ? (int)nprocs : 1;
+  }
+  SolverPool* pool = (SolverPool*)malloc(sizeof(SolverPool));
+  struct PoolWorker* workers = (struct PoolWorker*)malloc(nthreads * sizeof(struct PoolWorker));
+  if (!pool || !workers) {
+    printf("ERROR: Failed to allocate memory for SolverPool.\n");
+    free(pool);
+    free(workers);
+    return NULL;
+  }
+  pool->nthreads = nthreads;
+  pool->workers = workers;
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->work, NULL);
+  pthread_cond_init(&pool->idle, NULL);
+  pool->nqueued = 0;
+  pool->npending = 0;
+  pool->nfailed = 0;
+  pool->next = 0;
+  pool->stop = false;
+
+  for (int i = 0; i < nthreads; ++i) {
+    struct PoolWorker* worker = workers + i;
+    worker->pool = pool;
+    worker->index = i;
+    pthread_mutex_init(&worker->queue.lock, NULL);
+    worker->queue.jobs = NULL;
+    worker->queue.capacity = 0;
+    worker->queue.head = 0;
+    worker->queue.count = 0;
+    worker->data = NULL;
+    worker->nstates = 0;
+    worker->ninputs = 0;
+  }
+  for (int i = 0; i < nthreads; ++i) {
+    if (pthread_create(&workers[i].thread, NULL, Worker, workers + i) != 0) {
+      printf("ERROR: Failed to start the threads of SolverPool.\n");
+      StopWorkers(pool, i);
+      FreeWorkers(pool);
+      return NULL;
+    }
+  }
+  return pool;
+}
+
+int ulqr_FreeSolverPool(SolverPool** pool_ptr) {
+  SolverPool* pool = *pool_ptr;
+  if (!pool) {
+    return -1;
+  }
+  StopWorkers(pool, pool->nthreads);
+  FreeWorkers(pool);
+  *pool_ptr = NULL;
+  return 0;
+}
+
+int ulqr_SolverPoolSize(const SolverPool* pool) { return pool->nthreads; }
+
+int ulqr_SolverPoolSubmit(SolverPool* pool, RiccatiSolver* solver, SolverPoolCallback callback,
+                          void* userdata) {
+  if (!pool || !solver) {
+    return -1;
+  }
+  struct SolverJob job = {solver, callback, userdata};
+  pthread_mutex_lock(&pool->lock);
+  int index = pool->next;
+  pool->next = (pool->next + 1) % pool->nthreads;
+  ++pool->npending;
+  pthread_mutex_unlock(&pool->lock);
+
+  // Workers can only reserve the job once it is pushed
+  int status = PushJob(&pool->workers[index].queue, job);
+  pthread_mutex_lock(&pool->lock);
+  if (status == 0) {
+    ++pool->nqueued;
+    pthread_cond_signal(&pool->work);
+  } else if (--pool->npending == 0) {
+    pthread_cond_broadcast(&pool->idle);
+  }
+  pthread_mutex_unlock(&pool->lock);
+  if (status != 0) {
+    printf("ERROR: Failed to allocate memory for the queue of SolverPool.\n");
+  }
+  return status;
+}
+
+int ulqr_SolverPoolWait(SolverPool* pool) {
+  if (!pool) {
+    return -1;
+  }
+  pthread_mutex_lock(&pool->lock);
+  while (pool->npending > 0) {
+    pthread_cond_wait(&pool->idle, &pool->lock);
+  }
+  int nfailed = pool->nfailed;
+  pool->nfailed = 0;
+  pthread_mutex_unlock(&pool->lock);
+  return nfailed > 0 ? -1 : 0;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file solver_pool.h
+ * @author Brian Jackson (bjack205@gmail.com)
+ * @brief Pool of worker threads that solve many independent LQR problems
+ * @version 0.1
+ * @date 2022-02-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * @addtogroup riccati
+ * @{
+ */
+#pragma once
+
+#include "riccati_solver.h"
+
+/**
+ * @brief Called by a worker thread when it is done with a solve
+ *
+ * @param solver   The solver that was submitted
+ * @param status   Value returned by ulqr_SolveRiccati()
+ * @param userdata Pointer passed to ulqr_SolverPoolSubmit()
+ */
+typedef void (*SolverPoolCallback)(RiccatiSolver* solver, int status, void* userdata);
+
+/**
+ * @brief A fixed set of worker threads that run ulqr_SolveRiccati() on submitted solvers
+ *
+ * Every worker has its own queue of solves. Submitted solvers are handed out to the
+ * queues in turn, and a worker whose queue is empty takes the newest solve from the queue
+ * of another one, so a few long solves don't hold up the short ones queued behind them
+ * while other workers are idle.
+ *
+ * Each worker has its own scratch space, which replaces the work matrices and arena of
+ * the solver for the duration of the solve. It is grown as needed to fit the largest
+ * problem the worker has solved, so thousands of small solvers share a handful of
+ * workspaces that stay in the caches of their threads.
+ *
+ * The solve times are measured with a monotonic clock, so they are those of each solve,
+ * regardless of what the other workers are doing.
+ *
+ * ## Construction and destruction
+ * Use ulqr_NewSolverPool() to start the threads, which must be paired with a call to
+ * ulqr_FreeSolverPool(). The submitted solvers still belong to the caller.
+ *
+ * ## Typical Usage
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * SolverPool* pool = ulqr_NewSolverPool(8);
+ * for (int i = 0; i < nsolvers; ++i) {
+ *   ulqr_SolverPoolSubmit(pool, solvers[i], NULL, NULL);
+ * }
+ * ulqr_SolverPoolWait(pool);  // read the solutions
+ * ulqr_FreeSolverPool(&pool);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+typedef struct SolverPool SolverPool;
+
+/**
+ * @brief Start a new pool of worker threads
+ *
+ * @param nthreads Number of worker threads. If less than 1, one per processor.
+ * @return A new pool, or NULL if the threads couldn't be started
+ */
+SolverPool* ulqr_NewSolverPool(int nthreads);
+
+/**
+ * @brief Wait for the submitted solves to finish, then stop the threads and free the pool
+ *
+ * @post pool will be NULL
+ * @return 0 if successful
+ */
+int ulqr_FreeSolverPool(SolverPool** pool);
+
+/**
+ * @brief Number of worker threads
+ */
+int ulqr_SolverPoolSize(const SolverPool* pool);
+
+/**
+ * @brief Queue a solver to be solved by one of the workers
+ *
+ * Returns right away. The solver must not be used by the caller, or submitted again,
+ * until its solve is done, as reported by the callback or ulqr_SolverPoolWait().
+ * May be called from a callback.
+ *
+ * @param pool     An initialized pool
+ * @param solver   An initialized RiccatiSolver with the problem data
+ * @param callback Called on the worker thread once the solve is done. Can be NULL.
+ * @param userdata Passed to the callback
+ * @return 0 if successful, or -1 if the solve couldn't be queued
+ */
+int ulqr_SolverPoolSubmit(SolverPool* pool, RiccatiSolver* solver, SolverPoolCallback callback,
+                          void* userdata);
+
+/**
+ * @brief Wait for all the submitted solves to finish
+ *
+ * Must not be called from a callback.
+ *
+ * @param pool An initialized pool
+ * @return 0 if all the solves finished since the last call succeeded, or -1 if any failed
+ */
+int ulqr_SolverPoolWait(SolverPool* pool);
+
+/**@} */
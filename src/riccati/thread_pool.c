@@ -0,0 +1,144 @@
+#include "thread_pool.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+struct ThreadPool {
+  int nthreads;
+  pthread_t* workers;  ///< the nthreads - 1 started threads
+  pthread_mutex_t lock;
+  pthread_cond_t start;  ///< signaled when a batch is started, or the pool is stopped
+  pthread_cond_t done;   ///< signaled when the last worker is done with a batch
+
+  // Current batch, guarded by the lock
+  ThreadPoolTask task;
+  void* context;
+  int ntasks;
+  int next;             ///< next task to hand out
+  int nbusy;            ///< workers that haven't finished the batch
+  unsigned long batch;  ///< number of batches started
+  bool stop;
+};
+
+/* Run tasks of the current batch until there are none left. Called with the lock held. */
+static void RunTasks(ThreadPool* pool) {
+  while (pool->next < pool->ntasks) {
+    int index = pool->next++;
+    pthread_mutex_unlock(&pool->lock);
+    pool->task(pool->context, index);
+    pthread_mutex_lock(&pool->lock);
+  }
+}
+
+static void* Worker(void* arg) {
+  ThreadPool* pool = (ThreadPool*)arg;
+  unsigned long batch = 0;
+  pthread_mutex_lock(&pool->lock);
+  for (;;) {
+    while (pool->batch == batch && !pool->stop) {
+      pthread_cond_wait(&pool->start, &pool->lock);
+    }
+    if (pool->stop) {
+      break;
+    }
+    batch = pool->batch;
+    RunTasks(pool);
+    if (--pool->nbusy == 0) {
+      pthread_cond_signal(&pool->done);
+    }
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+
+/* Stop and join the first nstarted workers */
+static void StopWorkers(ThreadPool* pool, int nstarted) {
+  pthread_mutex_lock(&pool->lock);
+  pool->stop = true;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+  for (int i = 0; i < nstarted; ++i) {
+    pthread_join(pool->workers[i], NULL);
+  }
+}
+
+ThreadPool* ulqr_NewThreadPool(int nthreads) {
+  if (nthreads < 1) {
+    long nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+    nthreads = nprocs > 0 ? (int)nprocs : 1;
+  }
+  ThreadPool* pool = (ThreadPool*)malloc(sizeof(ThreadPool));
+  pthread_t* workers = (pthread_t*)malloc(nthreads * sizeof(pthread_t));
+  if (!pool || !workers) {
+    printf("ERROR: Failed to allocate memory for ThreadPool.\n");
+    free(pool);
+    free(workers);
+    return NULL;
+  }
+  pool->nthreads = nthreads;
+  pool->workers = workers;
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->start, NULL);
+  pthread_cond_init(&pool->done, NULL);
+  pool->task = NULL;
+  pool->context = NULL;
+  pool->ntasks = 0;
+  pool->next = 0;
+  pool->nbusy = 0;
+  pool->batch = 0;
+  pool->stop = false;
+
+  for (int i = 0; i < nthreads - 1; ++i) {
+    if (pthread_create(workers + i, NULL, Worker, pool) != 0) {
+      printf("ERROR: Failed to start the threads of ThreadPool.\n");
+      StopWorkers(pool, i);
+      ulqr_FreeThreadPool(&pool);
+      return NULL;
+    }
+  }
+  return pool;
+}
+
+int ulqr_FreeThreadPool(ThreadPool** pool_ptr) {
+  ThreadPool* pool = *pool_ptr;
+  if (!pool) {
+    return -1;
+  }
+  if (!pool->stop) {
+    StopWorkers(pool, pool->nthreads - 1);
+  }
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->start);
+  pthread_cond_destroy(&pool->done);
+  free(pool->workers);
+  free(pool);
+  *pool_ptr = NULL;
+  return 0;
+}
+
+int ulqr_ThreadPoolSize(const ThreadPool* pool) { return pool->nthreads; }
+
+int ulqr_ThreadPoolRun(ThreadPool* pool, int ntasks, ThreadPoolTask task, void* context) {
+  if (!pool || !task) {
+    return -1;
+  }
+  pthread_mutex_lock(&pool->lock);
+  pool->task = task;
+  pool->context = context;
+  pool->ntasks = ntasks;
+  pool->next = 0;
+  pool->nbusy = pool->nthreads - 1;
+  ++pool->batch;
+  pthread_cond_broadcast(&pool->start);
+
+  // The calling thread works on the batch too, then waits for the workers to finish theirs
+  RunTasks(pool);
+  while (pool->nbusy > 0) {
+    pthread_cond_wait(&pool->done, &pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return 0;
+}
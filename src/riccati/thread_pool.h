@@ -0,0 +1,69 @@
+/**
+ * @file thread_pool.h
+ * @author Brian Jackson (bjack205@gmail.com)
+ * @brief Minimal pool of worker threads for the parallel solvers
+ * @version 0.1
+ * @date 2022-02-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * @addtogroup riccati
+ * @{
+ */
+#pragma once
+
+/**
+ * @brief Task run by the pool
+ *
+ * @param context Pointer passed to ulqr_ThreadPoolRun()
+ * @param index   Index of the task, between 0 and the number of tasks
+ */
+typedef void (*ThreadPoolTask)(void* context, int index);
+
+/**
+ * @brief A fixed set of worker threads that run batches of independent tasks
+ *
+ * The threads are started once, when the pool is created, and sleep between batches,
+ * so a solve doesn't pay for creating threads. ulqr_ThreadPoolRun() hands out the tasks
+ * of a batch one at a time to whichever thread is free, including the calling thread,
+ * and returns once all of them are done.
+ *
+ * A pool only runs one batch at a time, and must not be used from more than one thread.
+ */
+typedef struct ThreadPool ThreadPool;
+
+/**
+ * @brief Start a new pool of threads
+ *
+ * Must be paired with a call to ulqr_FreeThreadPool().
+ *
+ * @param nthreads Number of threads that run tasks, including the one that calls
+ *                 ulqr_ThreadPoolRun(), so `nthreads - 1` threads are started.
+ *                 If less than 1, one per processor.
+ * @return A new pool, or NULL if the threads couldn't be started
+ */
+ThreadPool* ulqr_NewThreadPool(int nthreads);
+
+/**
+ * @brief Stop the threads and free the pool
+ *
+ * @post pool will be NULL
+ * @return 0 if successful
+ */
+int ulqr_FreeThreadPool(ThreadPool** pool);
+
+/**
+ * @brief Number of threads that run tasks, including the calling one
+ */
+int ulqr_ThreadPoolSize(const ThreadPool* pool);
+
+/**
+ * @brief Run a batch of tasks and wait for all of them to finish
+ *
+ * Calls `task(context, i)` for every `i` in `[0, ntasks)`, in no particular order.
+ *
+ * @return 0 if successful
+ */
+int ulqr_ThreadPoolRun(ThreadPool* pool, int ntasks, ThreadPoolTask task, void* context);
+
+/**@} */
@@ -0,0 +1,77 @@
+#include "arena.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+Arena slap_NewArena(int capacity) {
+  Arena arena = slap_InitArena(NULL, 0);
+  sfloat* data = (sfloat*)slap_AlignedAlloc(capacity * sizeof(sfloat));
+  if (data) {
+    arena = slap_InitArena(data, capacity);
+    arena.owns_data = true;
+  }
+  return arena;
+}
+
+Arena slap_InitArena(sfloat* data, int capacity) {
+  Arena arena = {data, capacity, 0, 0, false};
+  return arena;
+}
+
+int slap_FreeArena(Arena* arena) {
+  if (!arena || !arena->data) {
+    return -1;
+  }
+#ifdef SLAP_ARENA_DEBUG
+  fprintf(stderr, "Arena peak usage: %d of %d values.\n", arena->peak, arena->capacity);
+#endif
+  if (arena->owns_data) {
+    free(arena->data);
+  }
+  arena->data = NULL;
+  arena->capacity = 0;
+  arena->top = 0;
+  return 0;
+}
+
+sfloat* slap_ArenaAlloc(Arena* arena, int len) {
+  if (!arena || !arena->data || len < 0) {
+    return NULL;
+  }
+  int top = arena->top + slap_AlignedLength(len);
+  if (top > arena->capacity) {
+#ifdef SLAP_ARENA_DEBUG
+    fprintf(stderr, "ERROR: Arena out of memory. Needs %d of %d values.\n", top,
+            arena->capacity);
+#endif
+    return NULL;
+  }
+  sfloat* block = arena->data + arena->top;
+  arena->top = top;
+  if (top > arena->peak) {
+    arena->peak = top;
+  }
+  return block;
+}
+
+Matrix slap_ArenaMatrix(Arena* arena, int rows, int cols) {
+  Matrix mat = {rows, cols, slap_ArenaAlloc(arena, rows * cols), rows};
+  return mat;
+}
+
+SymMatrix slap_ArenaSymMatrix(Arena* arena, int n) {
+  SymMatrix mat = {n, slap_ArenaAlloc(arena, n * (n + 1) / 2)};
+  return mat;
+}
+
+int slap_ArenaPush(const Arena* arena) { return arena->top; }
+
+int slap_ArenaPop(Arena* arena, int mark) {
+  if (mark < 0 || mark > arena->top) {
+    return -1;
+  }
+  arena->top = mark;
+  return 0;
+}
+
+int slap_ArenaPeak(const Arena* arena) { return arena->peak; }
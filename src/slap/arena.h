@@ -0,0 +1,139 @@
+/**
+ * @file arena.h
+ * @author Brian Jackson (bjack205@gmail.com)
+ * @brief Bump-pointer allocator for temporary workspace
+ * @version 0.1
+ * @date 2022-02-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * @addtogroup LinearAlgebra
+ * @{
+ */
+#pragma once
+
+#include "matrix.h"
+#include "symmatrix.h"
+
+/**
+ * @brief A block of scratch memory that temporaries are carved out of in order
+ *
+ * Allocating from an arena just moves a pointer forward, so temporaries can be created
+ * inside a solve without any calls to the heap. Every allocation starts on a
+ * SLAP_ALIGNMENT boundary.
+ *
+ * Memory is never freed individually. Instead, a scope is opened with slap_ArenaPush(),
+ * which returns a mark, and everything allocated since is released at once by passing
+ * the mark to slap_ArenaPop(). Scopes nest like a stack:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * int mark = slap_ArenaPush(&arena);
+ * Matrix tmp = slap_ArenaMatrix(&arena, rows, cols);
+ * // ... use tmp ...
+ * slap_ArenaPop(&arena, mark);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * The arena records the largest amount of memory it has ever had in use, given by
+ * slap_ArenaPeak(), which can be used to size it. If the library is built with the
+ * `ULQR_ARENA_DEBUG` CMake option, the peak is also printed when the arena is freed.
+ *
+ * ## Methods
+ * - slap_NewArena()
+ * - slap_InitArena()
+ * - slap_FreeArena()
+ * - slap_ArenaAlloc()
+ * - slap_ArenaMatrix()
+ * - slap_ArenaSymMatrix()
+ * - slap_ArenaPush()
+ * - slap_ArenaPop()
+ * - slap_ArenaPeak()
+ */
+typedef struct {
+  sfloat* data;
+  int capacity;    ///< number of values in the arena
+  int top;         ///< number of values currently in use
+  int peak;        ///< largest value of `top` since the arena was created
+  bool owns_data;  ///< was the data allocated by the arena
+} Arena;
+
+/**
+ * @brief Allocate a new arena on the heap
+ *
+ * Must be followed by a call to slap_FreeArena().
+ *
+ * @param capacity Number of values the arena can hold
+ * @return A new arena. Has NULL data if the allocation failed.
+ */
+Arena slap_NewArena(int capacity);
+
+/**
+ * @brief Create an arena using existing memory
+ *
+ * The arena doesn't take ownership of the memory, which should be aligned to
+ * SLAP_ALIGNMENT bytes.
+ *
+ * @param data     Memory for the arena
+ * @param capacity Number of values in @p data
+ * @return A new arena
+ */
+Arena slap_InitArena(sfloat* data, int capacity);
+
+/**
+ * @brief Free the memory of an arena
+ *
+ * Only frees the data if it was allocated by slap_NewArena().
+ *
+ * @post [arena.data](Arena.data) will be `NULL`.
+ * @return 0 if successful
+ */
+int slap_FreeArena(Arena* arena);
+
+/**
+ * @brief Allocate a block of values from the arena
+ *
+ * The memory is not initialized.
+ *
+ * @param arena Initialized arena
+ * @param len   Number of values
+ * @return Pointer to the block, aligned to SLAP_ALIGNMENT bytes. NULL if the arena
+ *         doesn't have enough space left.
+ */
+sfloat* slap_ArenaAlloc(Arena* arena, int len);
+
+/**
+ * @brief Allocate a contiguous matrix from the arena
+ *
+ * @return A new matrix, with NULL data if the arena doesn't have enough space left.
+ */
+Matrix slap_ArenaMatrix(Arena* arena, int rows, int cols);
+
+/**
+ * @brief Allocate a symmetric matrix from the arena
+ *
+ * @return A new symmetric matrix, with NULL data if the arena doesn't have enough space left.
+ */
+SymMatrix slap_ArenaSymMatrix(Arena* arena, int n);
+
+/**
+ * @brief Open a new scope
+ *
+ * @return A mark to pass to slap_ArenaPop() to release everything allocated after it
+ */
+int slap_ArenaPush(const Arena* arena);
+
+/**
+ * @brief Close a scope, releasing everything allocated since the matching slap_ArenaPush()
+ *
+ * @param arena Initialized arena
+ * @param mark  Mark returned by slap_ArenaPush()
+ * @return 0 if successful, or -1 if the mark is invalid, e.g. because a later scope has
+ *         already been closed.
+ */
+int slap_ArenaPop(Arena* arena, int mark);
+
+/**
+ * @brief Largest number of values that have been in use at once
+ */
+int slap_ArenaPeak(const Arena* arena);
+
+/**@} */
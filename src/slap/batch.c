@@ -0,0 +1,174 @@
+#include "slap/batchmatrix.h"
+#include "slap/kernels.h"
+
+// The default batch sizes fill a 256-bit vector, so the AVX-512 variant uses those
+#define SLAP_SIMD_NO_AVX512
+#include "slap/simd.h"
+
+/*
+ * Every element of a batched matrix is a group of SLAP_BATCH_SIZE values, one per matrix,
+ * held in kBatchVecs vector registers. Each kernel is the textbook scalar algorithm with
+ * every scalar operation replaced by the corresponding operation on a group, so the work
+ * on the batch is always done with full vectors, no matter how small the matrices are.
+ */
+enum {
+  kBatchVecs = SLAP_BATCH_SIZE / SLAP_VLEN,
+};
+
+_Static_assert(SLAP_BATCH_SIZE % SLAP_VLEN == 0,
+               "SLAP_BATCH_SIZE must be a multiple of the SIMD width");
+
+typedef struct {
+  slap_Vec v[kBatchVecs];
+} Group;
+
+/* Offset to element [i,j] of a batched matrix with leading dimension ld */
+static inline int Index(int ld, int i, int j) { return (i + j * ld) * SLAP_BATCH_SIZE; }
+
+static inline Group GroupLoad(const sfloat* p) {
+  Group g;
+  for (int k = 0; k < kBatchVecs; ++k) {
+    g.v[k] = slap_VecLoad(p + k * SLAP_VLEN);
+  }
+  return g;
+}
+
+static inline void GroupStore(sfloat* p, Group g) {
+  for (int k = 0; k < kBatchVecs; ++k) {
+    slap_VecStore(p + k * SLAP_VLEN, g.v[k]);
+  }
+}
+
+static inline Group GroupBroadcast(sfloat x) {
+  Group g;
+  for (int k = 0; k < kBatchVecs; ++k) {
+    g.v[k] = slap_VecBroadcast(x);
+  }
+  return g;
+}
+
+/* a * b + c */
+static inline Group GroupFma(Group a, Group b, Group c) {
+  for (int k = 0; k < kBatchVecs; ++k) {
+    c.v[k] = slap_VecFma(a.v[k], b.v[k], c.v[k]);
+  }
+  return c;
+}
+
+/* c - a * b */
+static inline Group GroupFnma(Group a, Group b, Group c) {
+  for (int k = 0; k < kBatchVecs; ++k) {
+    c.v[k] = slap_VecFnma(a.v[k], b.v[k], c.v[k]);
+  }
+  return c;
+}
+
+static inline Group GroupMul(Group a, Group b) {
+  for (int k = 0; k < kBatchVecs; ++k) {
+    a.v[k] = slap_VecMul(a.v[k], b.v[k]);
+  }
+  return a;
+}
+
+static inline Group GroupDiv(Group a, Group b) {
+  for (int k = 0; k < kBatchVecs; ++k) {
+    a.v[k] = slap_VecDiv(a.v[k], b.v[k]);
+  }
+  return a;
+}
+
+static inline Group GroupSqrt(Group a) {
+  for (int k = 0; k < kBatchVecs; ++k) {
+    a.v[k] = slap_VecSqrt(a.v[k]);
+  }
+  return a;
+}
+
+void slap_BatchGemm(bool tA, bool tB, int m, int n, int k, sfloat alpha, const sfloat* A,
+                    int lda, const sfloat* B, int ldb, sfloat beta, sfloat* C, int ldc) {
+  // Strides between consecutive elements of a row of op(A) and a column of op(B)
+  const int a_row = (tA ? 1 : lda) * SLAP_BATCH_SIZE;
+  const int b_col = (tB ? ldb : 1) * SLAP_BATCH_SIZE;
+  Group a = GroupBroadcast(alpha);
+  Group b = GroupBroadcast(beta);
+  for (int j = 0; j < n; ++j) {
+    const sfloat* Bj = tB ? B + Index(ldb, j, 0) : B + Index(ldb, 0, j);
+    for (int i = 0; i < m; ++i) {
+      const sfloat* Ai = tA ? A + Index(lda, 0, i) : A + Index(lda, i, 0);
+      Group acc = GroupBroadcast(0.0);
+      for (int p = 0; p < k; ++p) {
+        acc = GroupFma(GroupLoad(Ai + p * a_row), GroupLoad(Bj + p * b_col), acc);
+      }
+      sfloat* Cij = C + Index(ldc, i, j);
+      if (beta == 0.0) {
+        GroupStore(Cij, GroupMul(acc, a));
+      } else {
+        GroupStore(Cij, GroupFma(acc, a, GroupMul(GroupLoad(Cij), b)));
+      }
+    }
+  }
+}
+
+int slap_BatchPotrf(int n, sfloat* A, int lda) {
+  int failed = 0;
+  for (int j = 0; j < n; ++j) {
+    // A[j:,j] -= L[j:,0:j] * L[j,0:j]'
+    for (int i = j; i < n; ++i) {
+      Group s = GroupLoad(A + Index(lda, i, j));
+      for (int p = 0; p < j; ++p) {
+        s = GroupFnma(GroupLoad(A + Index(lda, i, p)), GroupLoad(A + Index(lda, j, p)), s);
+      }
+      GroupStore(A + Index(lda, i, j), s);
+    }
+
+    // The matrices in the batch can't branch independently, so a failed pivot only gets
+    // recorded: its matrix fills up with NaNs while the others are factored as usual.
+    sfloat* Ajj = A + Index(lda, j, j);
+    for (int b = 0; b < SLAP_BATCH_SIZE; ++b) {
+      if (!(Ajj[b] > 0)) {
+        failed |= 1 << b;
+      }
+    }
+    Group ljj = GroupSqrt(GroupLoad(Ajj));
+    GroupStore(Ajj, ljj);
+    for (int i = j + 1; i < n; ++i) {
+      sfloat* Aij = A + Index(lda, i, j);
+      GroupStore(Aij, GroupDiv(GroupLoad(Aij), ljj));
+    }
+  }
+  return failed;
+}
+
+void slap_BatchTrsm(bool tL, int n, int nrhs, const sfloat* L, int ldl, sfloat* B, int ldb) {
+  for (int c = 0; c < nrhs; ++c) {
+    if (!tL) {
+      // Forward substitution
+      for (int i = 0; i < n; ++i) {
+        sfloat* xi = B + Index(ldb, i, c);
+        Group s = GroupLoad(xi);
+        for (int p = 0; p < i; ++p) {
+          s = GroupFnma(GroupLoad(L + Index(ldl, i, p)), GroupLoad(B + Index(ldb, p, c)), s);
+        }
+        GroupStore(xi, GroupDiv(s, GroupLoad(L + Index(ldl, i, i))));
+      }
+    } else {
+      // Back substitution with L', whose row i is column i of L
+      for (int i = n - 1; i >= 0; --i) {
+        sfloat* xi = B + Index(ldb, i, c);
+        Group s = GroupLoad(xi);
+        for (int p = i + 1; p < n; ++p) {
+          s = GroupFnma(GroupLoad(L + Index(ldl, p, i)), GroupLoad(B + Index(ldb, p, c)), s);
+        }
+        GroupStore(xi, GroupDiv(s, GroupLoad(L + Index(ldl, i, i))));
+      }
+    }
+  }
+}
+
+void slap_BatchAxpy(int len, sfloat alpha, const sfloat* x, sfloat* y) {
+  Group a = GroupBroadcast(alpha);
+  for (int i = 0; i < len; ++i) {
+    sfloat* yi = y + i * SLAP_BATCH_SIZE;
+    GroupStore(yi, GroupFma(GroupLoad(x + i * SLAP_BATCH_SIZE), a, GroupLoad(yi)));
+  }
+}
@@ -0,0 +1,93 @@
+#include "batchmatrix.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+BatchMatrix slap_NewBatchMatrix(int rows, int cols) {
+  size_t size = (size_t)rows * cols * SLAP_BATCH_SIZE * sizeof(sfloat);
+  sfloat* data = (sfloat*)slap_AlignedAlloc(size);
+  BatchMatrix mat = {rows, cols, data};
+  return mat;
+}
+
+int slap_FreeBatchMatrix(BatchMatrix* mat) {
+  if (mat) {
+    if (mat->data) {
+      free(mat->data);
+      mat->data = NULL;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+int slap_BatchMatrixNumElements(const BatchMatrix* mat) {
+  if (!mat) {
+    return -1;
+  }
+  return mat->rows * mat->cols * SLAP_BATCH_SIZE;
+}
+
+sfloat* slap_BatchMatrixGetElement(const BatchMatrix* mat, int b, int row, int col) {
+  if (!mat) {
+    return NULL;
+  }
+  if (b < 0 || b >= SLAP_BATCH_SIZE || row < 0 || row >= mat->rows || col < 0 ||
+      col >= mat->cols) {
+    return NULL;
+  }
+  return mat->data + (row + col * mat->rows) * SLAP_BATCH_SIZE + b;
+}
+
+int slap_BatchMatrixSetConst(BatchMatrix* mat, sfloat val) {
+  if (!mat) {
+    return -1;
+  }
+  int len = slap_BatchMatrixNumElements(mat);
+  for (int i = 0; i < len; ++i) {
+    mat->data[i] = val;
+  }
+  return 0;
+}
+
+int slap_BatchMatrixSetMatrix(BatchMatrix* dest, int b, const Matrix* src) {
+  if (dest->rows != src->rows || dest->cols != src->cols) {
+    fprintf(stderr, "Can't copy a (%d,%d) matrix into a batch of (%d,%d) matrices.\n",
+            src->rows, src->cols, dest->rows, dest->cols);
+    return -1;
+  }
+  if (b < 0 || b >= SLAP_BATCH_SIZE) {
+    fprintf(stderr, "Invalid index %d into a batch of %d matrices.\n", b, SLAP_BATCH_SIZE);
+    return -1;
+  }
+  int ld = slap_MatrixLeadingDim(src);
+  sfloat* dst = dest->data + b;
+  for (int j = 0; j < src->cols; ++j) {
+    for (int i = 0; i < src->rows; ++i) {
+      *dst = src->data[i + j * ld];
+      dst += SLAP_BATCH_SIZE;
+    }
+  }
+  return 0;
+}
+
+int slap_BatchMatrixGetMatrix(Matrix* dest, const BatchMatrix* src, int b) {
+  if (dest->rows != src->rows || dest->cols != src->cols) {
+    fprintf(stderr, "Can't copy from a batch of (%d,%d) matrices into a (%d,%d) matrix.\n",
+            src->rows, src->cols, dest->rows, dest->cols);
+    return -1;
+  }
+  if (b < 0 || b >= SLAP_BATCH_SIZE) {
+    fprintf(stderr, "Invalid index %d into a batch of %d matrices.\n", b, SLAP_BATCH_SIZE);
+    return -1;
+  }
+  int ld = slap_MatrixLeadingDim(dest);
+  const sfloat* s = src->data + b;
+  for (int j = 0; j < dest->cols; ++j) {
+    for (int i = 0; i < dest->rows; ++i) {
+      dest->data[i + j * ld] = *s;
+      s += SLAP_BATCH_SIZE;
+    }
+  }
+  return 0;
+}
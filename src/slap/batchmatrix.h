@@ -0,0 +1,131 @@
+/**
+ * @file batchmatrix.h
+ * @author Brian Jackson (bjack205@gmail.com)
+ * @brief Interleaved storage for a batch of independent, same-size matrices
+ * @version 0.1
+ * @date 2022-02-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * @addtogroup LinearAlgebra
+ * @{
+ */
+#pragma once
+
+#include "matrix.h"
+
+#ifndef SLAP_BATCH_SIZE
+/**
+ * @brief Number of matrices stored in a BatchMatrix
+ *
+ * Must be a multiple of the SIMD width, i.e. 4 or 8 with AVX2 in double precision, and
+ * 8 or 16 in single precision. Can be overridden at compile time, but must then be the
+ * same for the library and everything using it.
+ */
+#ifdef SLAP_USE_FLOAT
+#define SLAP_BATCH_SIZE 8
+#else
+#define SLAP_BATCH_SIZE 4
+#endif
+#endif
+
+/**
+ * @brief A batch of SLAP_BATCH_SIZE independent matrices of the same size
+ *
+ * The matrices are stored interleaved: the elements `[i,j]` of all the matrices in the
+ * batch are stored next to each other, such that element `[i,j]` of matrix `b` is at
+ * `data[(i + j * rows) * SLAP_BATCH_SIZE + b]`. In other words, it is a column-major
+ * matrix whose "elements" are short vectors, one entry per matrix in the batch.
+ *
+ * Small matrices can't fill a vector register along a row or column, but with this
+ * layout every operation vectorizes across the batch instead, doing the exact same
+ * work on each of the matrices with one instruction. The batched routines in linalg.h
+ * are therefore the most efficient way to work with many small problems at once.
+ *
+ * ## Initialization
+ * A new batch is allocated on the heap via
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * BatchMatrix mat = slap_NewBatchMatrix(rows, cols);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * which must be followed by a call to slap_FreeBatchMatrix(). The individual matrices
+ * are copied in and out with slap_BatchMatrixSetMatrix() and slap_BatchMatrixGetMatrix().
+ *
+ * ## Methods
+ * - slap_NewBatchMatrix()
+ * - slap_FreeBatchMatrix()
+ * - slap_BatchMatrixNumElements()
+ * - slap_BatchMatrixGetElement()
+ * - slap_BatchMatrixSetConst()
+ * - slap_BatchMatrixSetMatrix()
+ * - slap_BatchMatrixGetMatrix()
+ */
+typedef struct {
+  int rows;
+  int cols;
+  sfloat* data;
+} BatchMatrix;
+
+/**
+ * @brief Allocate a new batch of matrices on the heap
+ *
+ * The data is aligned to 32 bytes, but is not initialized. Must be followed by a call
+ * to slap_FreeBatchMatrix().
+ *
+ * @param rows number of rows of each matrix
+ * @param cols number of columns of each matrix
+ * @return A new batch of matrices
+ */
+BatchMatrix slap_NewBatchMatrix(int rows, int cols);
+
+/**
+ * @brief Free the data for a batch of matrices
+ *
+ * @param mat
+ * @post [mat.data](BatchMatrix.data) will be `NULL`.
+ * @return 0 if successful
+ */
+int slap_FreeBatchMatrix(BatchMatrix* mat);
+
+/**
+ * @brief Get the total number of values stored, i.e. `rows * cols * SLAP_BATCH_SIZE`.
+ *
+ * @param mat Any batch of matrices
+ * @return Number of stored elements
+ */
+int slap_BatchMatrixNumElements(const BatchMatrix* mat);
+
+/**
+ * @brief Get a pointer to element `[row,col]` of matrix @p b in the batch
+ *
+ * @return Pointer to the element, or `NULL` if any index is out of bounds.
+ */
+sfloat* slap_BatchMatrixGetElement(const BatchMatrix* mat, int b, int row, int col);
+
+/**
+ * @brief Set every element of every matrix in the batch to @p val
+ *
+ * @return 0 if successful
+ */
+int slap_BatchMatrixSetConst(BatchMatrix* mat, sfloat val);
+
+/**
+ * @brief Copy a matrix into slot @p b of the batch
+ *
+ * @param dest Batch of matrices the same size as @p src
+ * @param b    Index of the matrix in the batch, in `[0, SLAP_BATCH_SIZE)`
+ * @param src  Matrix to copy. Can be a view.
+ * @return 0 if successful
+ */
+int slap_BatchMatrixSetMatrix(BatchMatrix* dest, int b, const Matrix* src);
+
+/**
+ * @brief Copy slot @p b of the batch out into a matrix
+ *
+ * @param dest Matrix the same size as the matrices in @p src. Can be a view.
+ * @param src  Batch of matrices
+ * @param b    Index of the matrix in the batch, in `[0, SLAP_BATCH_SIZE)`
+ * @return 0 if successful
+ */
+int slap_BatchMatrixGetMatrix(Matrix* dest, const BatchMatrix* src, int b);
+
+/**@} */
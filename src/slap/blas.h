@@ -0,0 +1,86 @@
+/**
+ * @file blas.h
+ * @author Brian Jackson (bjack205@gmail.com)
+ * @brief Calls into an external BLAS/LAPACK library
+ * @version 0.1
+ * @date 2022-02-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * When slap is built with `ULQR_USE_BLAS`, the kernels hand problems whose dimensions
+ * all reach `SLAP_BLAS_MIN_SIZE` (64 by default) over to the BLAS/LAPACK found on the
+ * system, through the wrappers defined here. Smaller problems always use the built-in
+ * kernels, which avoid the call overhead and are faster at those sizes.
+ *
+ * The Fortran interface is used directly, since it is provided by every implementation,
+ * including the reference one.
+ *
+ * This header is internal to slap and should only be included by kernel source files.
+ *
+ * @ingroup LinearAlgebra
+ */
+#pragma once
+
+#ifdef SLAP_USE_BLAS
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "scalar.h"
+
+#ifndef SLAP_BLAS_MIN_SIZE
+#define SLAP_BLAS_MIN_SIZE 64
+#endif
+
+// Fortran interface. Character arguments are followed by their (hidden) lengths.
+void dgemm_(const char* transa, const char* transb, const int* m, const int* n, const int* k,
+            const double* alpha, const double* a, const int* lda, const double* b,
+            const int* ldb, const double* beta, double* c, const int* ldc, size_t transa_len,
+            size_t transb_len);
+void sgemm_(const char* transa, const char* transb, const int* m, const int* n, const int* k,
+            const float* alpha, const float* a, const int* lda, const float* b, const int* ldb,
+            const float* beta, float* c, const int* ldc, size_t transa_len, size_t transb_len);
+void dpotrf_(const char* uplo, const int* n, double* a, const int* lda, int* info,
+             size_t uplo_len);
+void spotrf_(const char* uplo, const int* n, float* a, const int* lda, int* info,
+             size_t uplo_len);
+void dtrsm_(const char* side, const char* uplo, const char* transa, const char* diag,
+            const int* m, const int* n, const double* alpha, const double* a, const int* lda,
+            double* b, const int* ldb, size_t side_len, size_t uplo_len, size_t transa_len,
+            size_t diag_len);
+void strsm_(const char* side, const char* uplo, const char* transa, const char* diag,
+            const int* m, const int* n, const float* alpha, const float* a, const int* lda,
+            float* b, const int* ldb, size_t side_len, size_t uplo_len, size_t transa_len,
+            size_t diag_len);
+
+#ifdef SLAP_USE_FLOAT
+#define SLAP_BLAS(name) s##name##_
+#else
+#define SLAP_BLAS(name) d##name##_
+#endif
+
+/** @brief slap_Gemm() using the external BLAS */
+static inline void slap_BlasGemm(bool tA, bool tB, int m, int n, int k, sfloat alpha,
+                                 const sfloat* A, int lda, const sfloat* B, int ldb, sfloat beta,
+                                 sfloat* C, int ldc) {
+  const char* transa = tA ? "T" : "N";
+  const char* transb = tB ? "T" : "N";
+  SLAP_BLAS(gemm)
+  (transa, transb, &m, &n, &k, &alpha, A, &lda, B, &ldb, &beta, C, &ldc, 1, 1);
+}
+
+/** @brief slap_Potrf() using the external LAPACK, with the same return value */
+static inline int slap_BlasPotrf(int n, sfloat* A, int lda) {
+  int info = 0;
+  SLAP_BLAS(potrf)("L", &n, A, &lda, &info, 1);
+  return info;
+}
+
+/** @brief slap_Trsm() using the external BLAS */
+static inline void slap_BlasTrsm(bool tL, int n, int nrhs, const sfloat* L, int ldl, sfloat* B,
+                                 int ldb) {
+  const sfloat one = 1.0;
+  SLAP_BLAS(trsm)("L", "L", tL ? "T" : "N", "N", &n, &nrhs, &one, L, &ldl, B, &ldb, 1, 1, 1, 1);
+}
+
+#endif  // SLAP_USE_BLAS
@@ -0,0 +1,192 @@
+#include <math.h>
+#include <string.h>
+
+#include "slap/blas.h"
+#include "slap/kernels.h"
+#include "slap/simd.h"
+
+enum {
+  kPotrfSmall = SLAP_VLEN > 8 ? SLAP_VLEN : 8,  ///< largest block factored in registers
+  kPotrfNB = 32,    ///< block size of the outer blocked factorization
+};
+
+static inline int MinInt(int a, int b) { return a < b ? a : b; }
+
+/*
+ * Factor an (n,n) block with n <= kPotrfSmall. The block is copied into a zero-padded
+ * local buffer so that every column is a fixed number of full vectors, and factored
+ * left-looking. Only the lower triangle is written back.
+ */
+static int PotrfSmall(int n, sfloat* A, int lda) {
+  enum { kNV = kPotrfSmall / SLAP_VLEN };
+  _Alignas(64) sfloat L[kPotrfSmall * kPotrfSmall];
+  memset(L, 0, sizeof(L));
+  for (int j = 0; j < n; ++j) {
+    for (int i = j; i < n; ++i) {
+      L[i + j * kPotrfSmall] = A[i + j * lda];
+    }
+  }
+
+  int info = 0;
+  int j = 0;
+  for (; j < n; ++j) {
+    sfloat* Lj = L + j * kPotrfSmall;
+    slap_Vec c[kNV];
+    for (int v = 0; v < kNV; ++v) {
+      c[v] = slap_VecLoad(Lj + v * SLAP_VLEN);
+    }
+    for (int k = 0; k < j; ++k) {
+      const sfloat* Lk = L + k * kPotrfSmall;
+      slap_Vec ljk = slap_VecBroadcast(-Lk[j]);
+      for (int v = 0; v < kNV; ++v) {
+        c[v] = slap_VecFma(slap_VecLoad(Lk + v * SLAP_VLEN), ljk, c[v]);
+      }
+    }
+    for (int v = 0; v < kNV; ++v) {
+      slap_VecStore(Lj + v * SLAP_VLEN, c[v]);
+    }
+    sfloat ljj = Lj[j];
+    if (ljj <= 0) {
+      info = j + 1;
+      break;
+    }
+    slap_Vec scale = slap_VecBroadcast(1.0 / sqrt(ljj));
+    for (int v = 0; v < kNV; ++v) {
+      slap_VecStore(Lj + v * SLAP_VLEN, slap_VecMul(c[v], scale));
+    }
+  }
+
+  // Write back the columns that were factored
+  for (int jj = 0; jj < j; ++jj) {
+    for (int i = jj; i < n; ++i) {
+      A[i + jj * lda] = L[i + jj * kPotrfSmall];
+    }
+  }
+  return info;
+}
+
+/*
+ * Solve X L' = B for the (m,n) block B, overwriting B, where L is an (n,n) lower-triangular
+ * factor. Each column of X is an axpy update down the rows of B.
+ */
+static void TrsmPanel(int m, int n, const sfloat* L, int ldl, sfloat* B, int ldb) {
+  for (int c = 0; c < n; ++c) {
+    sfloat* Bc = B + c * ldb;
+    for (int k = 0; k < c; ++k) {
+      const sfloat* Bk = B + k * ldb;
+      slap_Vec lck = slap_VecBroadcast(-L[c + k * ldl]);
+      int i = 0;
+      for (; i + SLAP_VLEN <= m; i += SLAP_VLEN) {
+        slap_VecStore(Bc + i, slap_VecFma(slap_VecLoad(Bk + i), lck, slap_VecLoad(Bc + i)));
+      }
+      if (i < m) {
+        int len = m - i;
+        slap_Vec x = slap_VecFma(slap_VecLoadPartial(Bk + i, len), lck,
+                                 slap_VecLoadPartial(Bc + i, len));
+        slap_VecStorePartial(Bc + i, x, len);
+      }
+    }
+    sfloat lcc_inv = 1.0 / L[c + c * ldl];
+    for (int i = 0; i < m; ++i) {
+      Bc[i] *= lcc_inv;
+    }
+  }
+}
+
+/*
+ * Left-looking blocked factorization. Each block column is updated with the columns to
+ * its left using GEMM, after which the diagonal block is factored and the panel below it
+ * is solved against the new diagonal factor.
+ */
+static int PotrfBlocked(int n, sfloat* A, int lda, int nb) {
+  sfloat W[kPotrfNB * kPotrfNB];
+  for (int j = 0; j < n; j += nb) {
+    int jb = MinInt(nb, n - j);
+    sfloat* A11 = A + j + j * lda;
+
+    // A11 -= A10 * A10', only touching the lower triangle
+    if (j > 0) {
+      slap_Gemm(false, true, jb, jb, j, 1.0, A + j, lda, A + j, lda, 0.0, W, nb);
+      for (int c = 0; c < jb; ++c) {
+        for (int i = c; i < jb; ++i) {
+          A11[i + c * lda] -= W[i + c * nb];
+        }
+      }
+    }
+
+    int info = jb <= kPotrfSmall ? PotrfSmall(jb, A11, lda)
+                                 : PotrfBlocked(jb, A11, lda, kPotrfSmall);
+    if (info) {
+      return j + info;
+    }
+
+    int mr = n - j - jb;
+    if (mr > 0) {
+      sfloat* A21 = A11 + jb;
+      if (j > 0) {
+        // A21 -= A20 * A10'
+        slap_Gemm(false, true, mr, jb, j, -1.0, A + j + jb, lda, A + j, lda, 1.0, A21, lda);
+      }
+      TrsmPanel(mr, jb, A11, lda, A21, lda);
+    }
+  }
+  return 0;
+}
+
+int slap_Potrf(int n, sfloat* A, int lda) {
+#ifdef SLAP_USE_BLAS
+  if (n >= SLAP_BLAS_MIN_SIZE) {
+    return slap_BlasPotrf(n, A, lda);
+  }
+#endif
+  if (n <= kPotrfSmall) {
+    return PotrfSmall(n, A, lda);
+  }
+  return PotrfBlocked(n, A, lda, kPotrfNB);
+}
+
+/*
+ * Apply the rotation that zeros x[0] against L[0,0] to the rest of the column of L and
+ * to x, for the m values below the diagonal
+ */
+static void RotateColumn(int m, sfloat sign_s, sfloat s, sfloat c, sfloat* Lj, sfloat* x) {
+  slap_Vec vsign_s = slap_VecBroadcast(sign_s);
+  slap_Vec vs = slap_VecBroadcast(s);
+  slap_Vec vc = slap_VecBroadcast(c);
+  slap_Vec vc_inv = slap_VecBroadcast(1.0 / c);
+  int i = 0;
+  for (; i + SLAP_VLEN <= m; i += SLAP_VLEN) {
+    slap_Vec xi = slap_VecLoad(x + i);
+    slap_Vec lij = slap_VecMul(slap_VecFma(xi, vsign_s, slap_VecLoad(Lj + i)), vc_inv);
+    slap_VecStore(Lj + i, lij);
+    slap_VecStore(x + i, slap_VecFnma(lij, vs, slap_VecMul(xi, vc)));
+  }
+  if (i < m) {
+    int len = m - i;
+    slap_Vec xi = slap_VecLoadPartial(x + i, len);
+    slap_Vec lij = slap_VecMul(slap_VecFma(xi, vsign_s, slap_VecLoadPartial(Lj + i, len)), vc_inv);
+    slap_VecStorePartial(Lj + i, lij, len);
+    slap_VecStorePartial(x + i, slap_VecFnma(lij, vs, slap_VecMul(xi, vc)), len);
+  }
+}
+
+int slap_CholUpdate(bool downdate, int n, int k, sfloat* L, int ldl, sfloat* X, int ldx) {
+  const sfloat sign = downdate ? -1.0 : 1.0;
+  for (int r = 0; r < k; ++r) {
+    sfloat* x = X + r * ldx;
+    for (int j = 0; j < n; ++j) {
+      sfloat* Lj = L + j + j * ldl;
+      sfloat ljj = Lj[0];
+      sfloat rr = ljj * ljj + sign * x[j] * x[j];
+      if (!(rr > 0)) {
+        return j + 1;
+      }
+      rr = sqrt(rr);
+      sfloat c = rr / ljj;
+      sfloat s = x[j] / ljj;
+      Lj[0] = rr;
+      RotateColumn(n - j - 1, sign * s, s, c, Lj + 1, x + j + 1);
+    }
+  }
+  return 0;
+}
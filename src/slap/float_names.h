@@ -0,0 +1,109 @@
+/**
+ * @file float_names.h
+ * @brief Maps the public slap symbols to the ones of the single-precision library
+ *
+ * Included by scalar.h when `SLAP_USE_FLOAT` is defined. Every function with external
+ * linkage must be listed here, which is checked by the `float_symbols` test.
+ */
+#pragma once
+
+#define slap_AddDiagonal slapf_AddDiagonal
+#define slap_AlignedAlloc slapf_AlignedAlloc
+#define slap_AlignedLength slapf_AlignedLength
+#define slap_ArenaAlloc slapf_ArenaAlloc
+#define slap_ArenaMatrix slapf_ArenaMatrix
+#define slap_ArenaPeak slapf_ArenaPeak
+#define slap_ArenaPop slapf_ArenaPop
+#define slap_ArenaPush slapf_ArenaPush
+#define slap_ArenaSymMatrix slapf_ArenaSymMatrix
+#define slap_BatchAxpy slapf_BatchAxpy
+#define slap_BatchCholeskyFactorize slapf_BatchCholeskyFactorize
+#define slap_BatchCholeskySolve slapf_BatchCholeskySolve
+#define slap_BatchGemm slapf_BatchGemm
+#define slap_BatchLowerTriBackSub slapf_BatchLowerTriBackSub
+#define slap_BatchMatrixAddition slapf_BatchMatrixAddition
+#define slap_BatchMatrixGetElement slapf_BatchMatrixGetElement
+#define slap_BatchMatrixGetMatrix slapf_BatchMatrixGetMatrix
+#define slap_BatchMatrixMultiply slapf_BatchMatrixMultiply
+#define slap_BatchMatrixNumElements slapf_BatchMatrixNumElements
+#define slap_BatchMatrixSetConst slapf_BatchMatrixSetConst
+#define slap_BatchMatrixSetMatrix slapf_BatchMatrixSetMatrix
+#define slap_BatchPotrf slapf_BatchPotrf
+#define slap_BatchTrsm slapf_BatchTrsm
+#define slap_CholUpdate slapf_CholUpdate
+#define slap_CholeskyDowndate slapf_CholeskyDowndate
+#define slap_CholeskyFactorize slapf_CholeskyFactorize
+#define slap_CholeskyFactorizeRegularized slapf_CholeskyFactorizeRegularized
+#define slap_CholeskySolve slapf_CholeskySolve
+#define slap_CholeskyUpdate slapf_CholeskyUpdate
+#define slap_DetectKernelIsa slapf_DetectKernelIsa
+#define slap_DotProduct slapf_DotProduct
+#define slap_FreeArena slapf_FreeArena
+#define slap_FreeBatchMatrix slapf_FreeBatchMatrix
+#define slap_FreeMatrix slapf_FreeMatrix
+#define slap_FreeSymMatrix slapf_FreeSymMatrix
+#define slap_Gemm slapf_Gemm
+#define slap_GetKernelIsa slapf_GetKernelIsa
+#define slap_InitArena slapf_InitArena
+#define slap_KernelIsaName slapf_KernelIsaName
+#define slap_KernelIsaSupported slapf_KernelIsaSupported
+#define slap_LUFactorize slapf_LUFactorize
+#define slap_LUSolve slapf_LUSolve
+#define slap_LowerTriBackSub slapf_LowerTriBackSub
+#define slap_LowerTriMultiply slapf_LowerTriMultiply
+#define slap_MatrixAddition slapf_MatrixAddition
+#define slap_MatrixCopy slapf_MatrixCopy
+#define slap_MatrixCopyFromArray slapf_MatrixCopyFromArray
+#define slap_MatrixCopyTranspose slapf_MatrixCopyTranspose
+#define slap_MatrixFlatten slapf_MatrixFlatten
+#define slap_MatrixFlattenToRow slapf_MatrixFlattenToRow
+#define slap_MatrixGetElement slapf_MatrixGetElement
+#define slap_MatrixGetElementTranspose slapf_MatrixGetElementTranspose
+#define slap_MatrixGetLinearIndex slapf_MatrixGetLinearIndex
+#define slap_MatrixIsContiguous slapf_MatrixIsContiguous
+#define slap_MatrixLeadingDim slapf_MatrixLeadingDim
+#define slap_MatrixMultiply slapf_MatrixMultiply
+#define slap_MatrixNormedDifference slapf_MatrixNormedDifference
+#define slap_MatrixNumElements slapf_MatrixNumElements
+#define slap_MatrixScale slapf_MatrixScale
+#define slap_MatrixScaleByConst slapf_MatrixScaleByConst
+#define slap_MatrixSetConst slapf_MatrixSetConst
+#define slap_MatrixSetElement slapf_MatrixSetElement
+#define slap_MatrixView slapf_MatrixView
+#define slap_NewArena slapf_NewArena
+#define slap_NewBatchMatrix slapf_NewBatchMatrix
+#define slap_NewMatrix slapf_NewMatrix
+#define slap_NewMatrixPadded slapf_NewMatrixPadded
+#define slap_NewMatrixZeros slapf_NewMatrixZeros
+#define slap_NewSymMatrix slapf_NewSymMatrix
+#define slap_OneNorm slapf_OneNorm
+#define slap_PaddedLeadingDim slapf_PaddedLeadingDim
+#define slap_Potrf slapf_Potrf
+#define slap_Pptrf slapf_Pptrf
+#define slap_Pptrs slapf_Pptrs
+#define slap_PrintMatrix slapf_PrintMatrix
+#define slap_PrintRowVector slapf_PrintRowVector
+#define slap_QuadraticForm slapf_QuadraticForm
+#define slap_SetKernelIsa slapf_SetKernelIsa
+#define slap_SetMatrixSize slapf_SetMatrixSize
+#define slap_Spmm slapf_Spmm
+#define slap_SymCholeskyFactorize slapf_SymCholeskyFactorize
+#define slap_SymCholeskySolve slapf_SymCholeskySolve
+#define slap_SymMatrixCopy slapf_SymMatrixCopy
+#define slap_SymMatrixGetElement slapf_SymMatrixGetElement
+#define slap_SymMatrixGetLinearIndex slapf_SymMatrixGetLinearIndex
+#define slap_SymMatrixMultiply slapf_SymMatrixMultiply
+#define slap_SymMatrixNumElements slapf_SymMatrixNumElements
+#define slap_SymMatrixPack slapf_SymMatrixPack
+#define slap_SymMatrixUnpack slapf_SymMatrixUnpack
+#define slap_SymQuadraticForm slapf_SymQuadraticForm
+#define slap_SymTripleProduct slapf_SymTripleProduct
+#define slap_SymmetricMatrixMultiply slapf_SymmetricMatrixMultiply
+#define slap_SymmetricRankKUpdate slapf_SymmetricRankKUpdate
+#define slap_SymmetricTripleProduct slapf_SymmetricTripleProduct
+#define slap_Syrk slapf_Syrk
+#define slap_Trmm slapf_Trmm
+#define slap_Trsm slapf_Trsm
+#define slap_TwoNorm slapf_TwoNorm
+#define slap_gemm_apack slapf_gemm_apack
+#define slap_gemm_bpack slapf_gemm_bpack
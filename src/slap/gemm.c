@@ -0,0 +1,312 @@
+#include <stdbool.h>
+
+#include "slap/blas.h"
+#include "slap/kernels.h"
+#include "slap/simd.h"
+
+enum {
+  kGemmMR = 2 * SLAP_VLEN,  ///< rows of C held in registers by the axpy-form kernels
+  kGemmNR = 4,              ///< columns of C held in registers by the axpy-form kernels
+  kDotMR = 4,               ///< rows of C computed at once by the dot-product kernel
+  kDotNR = 2,               ///< columns of C computed at once by the dot-product kernel
+  kGemmMC = 64,             ///< rows of op(A) packed at once (L2 block)
+  kGemmKC = 128,            ///< inner dimension packed at once (L1 block)
+  kGemmNC = 512,            ///< columns of op(B) packed at once
+  kGemmPackMin = 48,        ///< use the packed path once all dimensions reach this size
+};
+
+// Packing buffers for the blocked path, one set per thread. They are shared by all the
+// instruction-set variants of this file (see isa.h), so they are defined by the baseline.
+#ifdef SLAP_ISA_BASELINE
+_Thread_local _Alignas(64) sfloat slap_gemm_apack[kGemmMC * kGemmKC];
+_Thread_local _Alignas(64) sfloat slap_gemm_bpack[kGemmKC * kGemmNC];
+#else
+extern _Thread_local sfloat slap_gemm_apack[kGemmMC * kGemmKC];
+extern _Thread_local sfloat slap_gemm_bpack[kGemmKC * kGemmNC];
+#endif
+
+static inline int MinInt(int a, int b) { return a < b ? a : b; }
+
+/*
+ * Compute a (mr,nr) block of O += alpha * X * Y, holding the block in nv vector
+ * registers per column. X is read down its columns, X(i,p) = X[i + p * ldx], while
+ * Y(p,j) = Y[p * syp + j * syj] is broadcast. The output is O(i,j) = O[i * soi + j * soj].
+ *
+ * Covers C = A B and C = A B' directly, and C = A'B' as C' = B A.
+ */
+static inline void GemmTileAxpy(int nv, int mr, int nr, int k, sfloat alpha, const sfloat* X,
+                                int ldx, const sfloat* Y, int syp, int syj, sfloat* O, int soi,
+                                int soj) {
+  slap_Vec acc[2][kGemmNR];
+  int len[2];
+  for (int v = 0; v < nv; ++v) {
+    len[v] = MinInt(SLAP_VLEN, mr - v * SLAP_VLEN);
+    for (int jj = 0; jj < nr; ++jj) {
+      acc[v][jj] = slap_VecZero();
+    }
+  }
+
+  for (int p = 0; p < k; ++p) {
+    const sfloat* Xp = X + p * ldx;
+    const sfloat* Yp = Y + p * syp;
+    slap_Vec x[2];
+    for (int v = 0; v < nv; ++v) {
+      x[v] = slap_VecLoadPartial(Xp + v * SLAP_VLEN, len[v]);
+    }
+    for (int jj = 0; jj < nr; ++jj) {
+      slap_Vec y = slap_VecBroadcast(Yp[jj * syj]);
+      for (int v = 0; v < nv; ++v) {
+        acc[v][jj] = slap_VecFma(x[v], y, acc[v][jj]);
+      }
+    }
+  }
+
+  slap_Vec valpha = slap_VecBroadcast(alpha);
+  for (int jj = 0; jj < nr; ++jj) {
+    for (int v = 0; v < nv; ++v) {
+      sfloat* Oj = O + v * SLAP_VLEN * soi + jj * soj;
+      if (soi == 1) {
+        slap_Vec o = slap_VecLoadPartial(Oj, len[v]);
+        slap_VecStorePartial(Oj, slap_VecFma(acc[v][jj], valpha, o), len[v]);
+      } else {
+        sfloat tmp[SLAP_VLEN];
+        slap_VecStore(tmp, acc[v][jj]);
+        for (int l = 0; l < len[v]; ++l) {
+          Oj[l * soi] += alpha * tmp[l];
+        }
+      }
+    }
+  }
+}
+
+/*
+ * Compute a (mr,nr) block of C += alpha * A'B as a set of dot products, vectorized along
+ * the inner dimension, which is contiguous for both A' and B.
+ */
+static inline void GemmTileDot(int mr, int nr, int k, sfloat alpha, const sfloat* A, int lda,
+                               const sfloat* B, int ldb, sfloat* C, int ldc) {
+  slap_Vec acc[kDotMR][kDotNR];
+  for (int ii = 0; ii < mr; ++ii) {
+    for (int jj = 0; jj < nr; ++jj) {
+      acc[ii][jj] = slap_VecZero();
+    }
+  }
+
+  int p = 0;
+  for (; p + SLAP_VLEN <= k; p += SLAP_VLEN) {
+    slap_Vec b[kDotNR];
+    for (int jj = 0; jj < nr; ++jj) {
+      b[jj] = slap_VecLoad(B + p + jj * ldb);
+    }
+    for (int ii = 0; ii < mr; ++ii) {
+      slap_Vec a = slap_VecLoad(A + p + ii * lda);
+      for (int jj = 0; jj < nr; ++jj) {
+        acc[ii][jj] = slap_VecFma(a, b[jj], acc[ii][jj]);
+      }
+    }
+  }
+  if (p < k) {
+    int len = k - p;
+    slap_Vec b[kDotNR];
+    for (int jj = 0; jj < nr; ++jj) {
+      b[jj] = slap_VecLoadPartial(B + p + jj * ldb, len);
+    }
+    for (int ii = 0; ii < mr; ++ii) {
+      slap_Vec a = slap_VecLoadPartial(A + p + ii * lda, len);
+      for (int jj = 0; jj < nr; ++jj) {
+        acc[ii][jj] = slap_VecFma(a, b[jj], acc[ii][jj]);
+      }
+    }
+  }
+
+  for (int jj = 0; jj < nr; ++jj) {
+    for (int ii = 0; ii < mr; ++ii) {
+      C[ii + jj * ldc] += alpha * slap_VecSum(acc[ii][jj]);
+    }
+  }
+}
+
+/*
+ * Tile the output of O += alpha * X * Y with GemmTileAxpy. The full-size tile is called
+ * with constant dimensions so that it gets fully unrolled.
+ */
+static void GemmAxpy(int m, int n, int k, sfloat alpha, const sfloat* X, int ldx,
+                     const sfloat* Y, int syp, int syj, sfloat* O, int soi, int soj) {
+  for (int j = 0; j < n; j += kGemmNR) {
+    int nr = MinInt(kGemmNR, n - j);
+    for (int i = 0; i < m; i += kGemmMR) {
+      int mr = MinInt(kGemmMR, m - i);
+      const sfloat* Xi = X + i;
+      const sfloat* Yj = Y + j * syj;
+      sfloat* Oij = O + i * soi + j * soj;
+      if (mr == kGemmMR && nr == kGemmNR) {
+        GemmTileAxpy(2, kGemmMR, kGemmNR, k, alpha, Xi, ldx, Yj, syp, syj, Oij, soi, soj);
+      } else if (mr > SLAP_VLEN) {
+        GemmTileAxpy(2, mr, nr, k, alpha, Xi, ldx, Yj, syp, syj, Oij, soi, soj);
+      } else {
+        GemmTileAxpy(1, mr, nr, k, alpha, Xi, ldx, Yj, syp, syj, Oij, soi, soj);
+      }
+    }
+  }
+}
+
+static void GemmDot(int m, int n, int k, sfloat alpha, const sfloat* A, int lda,
+                    const sfloat* B, int ldb, sfloat* C, int ldc) {
+  for (int j = 0; j < n; j += kDotNR) {
+    int nr = MinInt(kDotNR, n - j);
+    for (int i = 0; i < m; i += kDotMR) {
+      int mr = MinInt(kDotMR, m - i);
+      const sfloat* Ai = A + i * lda;
+      const sfloat* Bj = B + j * ldb;
+      sfloat* Cij = C + i + j * ldc;
+      if (mr == kDotMR && nr == kDotNR) {
+        GemmTileDot(kDotMR, kDotNR, k, alpha, Ai, lda, Bj, ldb, Cij, ldc);
+      } else {
+        GemmTileDot(mr, nr, k, alpha, Ai, lda, Bj, ldb, Cij, ldc);
+      }
+    }
+  }
+}
+
+/*
+ * Copy an (mc,kc) block of op(A), with op(A)(i,p) = A[i * sai + p * sap], into row panels
+ * of height kGemmMR. Each panel is stored column by column and padded with zeros.
+ */
+static void GemmPackA(int mc, int kc, const sfloat* A, int sai, int sap, sfloat* Ap) {
+  for (int i = 0; i < mc; i += kGemmMR) {
+    int mr = MinInt(kGemmMR, mc - i);
+    for (int p = 0; p < kc; ++p) {
+      int ii = 0;
+      for (; ii < mr; ++ii) {
+        *Ap++ = A[(i + ii) * sai + p * sap];
+      }
+      for (; ii < kGemmMR; ++ii) {
+        *Ap++ = 0.0;
+      }
+    }
+  }
+}
+
+/*
+ * Copy a (kc,nc) block of op(B), with op(B)(p,j) = B[p * sbp + j * sbj], into column
+ * panels of width kGemmNR. Each panel is stored row by row and padded with zeros.
+ */
+static void GemmPackB(int kc, int nc, const sfloat* B, int sbp, int sbj, sfloat* Bp) {
+  for (int j = 0; j < nc; j += kGemmNR) {
+    int nr = MinInt(kGemmNR, nc - j);
+    for (int p = 0; p < kc; ++p) {
+      int jj = 0;
+      for (; jj < nr; ++jj) {
+        *Bp++ = B[p * sbp + (j + jj) * sbj];
+      }
+      for (; jj < kGemmNR; ++jj) {
+        *Bp++ = 0.0;
+      }
+    }
+  }
+}
+
+/*
+ * Multiply a packed row panel of op(A) with a packed column panel of op(B), adding
+ * alpha times the (mr,nr) upper-left corner of the result to C.
+ */
+static inline void GemmMicroKernel(int kc, sfloat alpha, const sfloat* Ap, const sfloat* Bp,
+                                   int mr, int nr, sfloat* C, int ldc) {
+  slap_Vec acc[2][kGemmNR];
+  for (int jj = 0; jj < kGemmNR; ++jj) {
+    acc[0][jj] = slap_VecZero();
+    acc[1][jj] = slap_VecZero();
+  }
+  for (int p = 0; p < kc; ++p) {
+    slap_Vec a0 = slap_VecLoad(Ap);
+    slap_Vec a1 = slap_VecLoad(Ap + SLAP_VLEN);
+    for (int jj = 0; jj < kGemmNR; ++jj) {
+      slap_Vec b = slap_VecBroadcast(Bp[jj]);
+      acc[0][jj] = slap_VecFma(a0, b, acc[0][jj]);
+      acc[1][jj] = slap_VecFma(a1, b, acc[1][jj]);
+    }
+    Ap += kGemmMR;
+    Bp += kGemmNR;
+  }
+
+  slap_Vec valpha = slap_VecBroadcast(alpha);
+  int len0 = MinInt(SLAP_VLEN, mr);
+  int len1 = mr - len0;
+  for (int jj = 0; jj < nr; ++jj) {
+    sfloat* Cj = C + jj * ldc;
+    slap_Vec c0 = slap_VecLoadPartial(Cj, len0);
+    slap_VecStorePartial(Cj, slap_VecFma(acc[0][jj], valpha, c0), len0);
+    if (len1 > 0) {
+      slap_Vec c1 = slap_VecLoadPartial(Cj + SLAP_VLEN, len1);
+      slap_VecStorePartial(Cj + SLAP_VLEN, slap_VecFma(acc[1][jj], valpha, c1), len1);
+    }
+  }
+}
+
+static void GemmPacked(bool tA, bool tB, int m, int n, int k, sfloat alpha, const sfloat* A,
+                       int lda, const sfloat* B, int ldb, sfloat* C, int ldc) {
+  int sai = tA ? lda : 1;
+  int sap = tA ? 1 : lda;
+  int sbp = tB ? ldb : 1;
+  int sbj = tB ? 1 : ldb;
+  for (int jc = 0; jc < n; jc += kGemmNC) {
+    int nc = MinInt(kGemmNC, n - jc);
+    for (int pc = 0; pc < k; pc += kGemmKC) {
+      int kc = MinInt(kGemmKC, k - pc);
+      GemmPackB(kc, nc, B + pc * sbp + jc * sbj, sbp, sbj, slap_gemm_bpack);
+      for (int ic = 0; ic < m; ic += kGemmMC) {
+        int mc = MinInt(kGemmMC, m - ic);
+        GemmPackA(mc, kc, A + ic * sai + pc * sap, sai, sap, slap_gemm_apack);
+        for (int jr = 0; jr < nc; jr += kGemmNR) {
+          int nr = MinInt(kGemmNR, nc - jr);
+          const sfloat* Bp = slap_gemm_bpack + jr * kc;
+          for (int ir = 0; ir < mc; ir += kGemmMR) {
+            int mr = MinInt(kGemmMR, mc - ir);
+            const sfloat* Ap = slap_gemm_apack + ir * kc;
+            sfloat* Cij = C + (ic + ir) + (jc + jr) * ldc;
+            GemmMicroKernel(kc, alpha, Ap, Bp, mr, nr, Cij, ldc);
+          }
+        }
+      }
+    }
+  }
+}
+
+static void GemmScale(int m, int n, sfloat beta, sfloat* C, int ldc) {
+  if (beta == 1.0) {
+    return;
+  }
+  for (int j = 0; j < n; ++j) {
+    sfloat* Cj = C + j * ldc;
+    for (int i = 0; i < m; ++i) {
+      Cj[i] = beta == 0.0 ? 0.0 : beta * Cj[i];
+    }
+  }
+}
+
+void slap_Gemm(bool tA, bool tB, int m, int n, int k, sfloat alpha, const sfloat* A, int lda,
+               const sfloat* B, int ldb, sfloat beta, sfloat* C, int ldc) {
+#ifdef SLAP_USE_BLAS
+  if (m >= SLAP_BLAS_MIN_SIZE && n >= SLAP_BLAS_MIN_SIZE && k >= SLAP_BLAS_MIN_SIZE) {
+    slap_BlasGemm(tA, tB, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+    return;
+  }
+#endif
+  GemmScale(m, n, beta, C, ldc);
+  if (alpha == 0.0 || k == 0) {
+    return;
+  }
+
+  if (m >= kGemmPackMin && n >= kGemmPackMin && k >= kGemmPackMin) {
+    GemmPacked(tA, tB, m, n, k, alpha, A, lda, B, ldb, C, ldc);
+  } else if (!tA && !tB) {
+    GemmAxpy(m, n, k, alpha, A, lda, B, 1, ldb, C, 1, ldc);
+  } else if (!tA && tB) {
+    GemmAxpy(m, n, k, alpha, A, lda, B, ldb, 1, C, 1, ldc);
+  } else if (tA && !tB) {
+    GemmDot(m, n, k, alpha, A, lda, B, ldb, C, ldc);
+  } else {
+    // C' = B A, where B is (n,k) and A is (k,m)
+    GemmAxpy(n, m, k, alpha, B, ldb, A, 1, lda, C, ldc, 1);
+  }
+}
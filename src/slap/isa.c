@@ -0,0 +1,149 @@
+#include "isa.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "kernel_table.h"
+#include "kernels.h"
+
+// Variants that were compiled, indexed by slap_KernelIsa
+static const slap_KernelTable* const kKernelTables[slap_kNumIsas] = {
+    &SLAP_ISA_NAME(kernels, baseline),
+#ifdef SLAP_HAVE_ISA_AVX2
+    &SLAP_ISA_NAME(kernels, avx2),
+#else
+    NULL,
+#endif
+#ifdef SLAP_HAVE_ISA_AVX512
+    &SLAP_ISA_NAME(kernels, avx512),
+#else
+    NULL,
+#endif
+};
+
+static const char* const kKernelIsaNames[slap_kNumIsas] = {"baseline", "avx2", "avx512"};
+
+// Selected variant, or NULL until the first kernel is called
+static _Atomic(const slap_KernelTable*) active_kernels = NULL;
+
+bool slap_KernelIsaSupported(enum slap_KernelIsa isa) {
+  if ((int)isa < 0 || isa >= slap_kNumIsas || !kKernelTables[isa]) {
+    return false;
+  }
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  switch (isa) {
+    case slap_kIsaAvx2:
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case slap_kIsaAvx512:
+      return __builtin_cpu_supports("avx512f");
+    default:
+      return true;
+  }
+#else
+  return isa == slap_kIsaBaseline;
+#endif
+}
+
+enum slap_KernelIsa slap_DetectKernelIsa(void) {
+  for (int isa = slap_kNumIsas - 1; isa > slap_kIsaBaseline; --isa) {
+    if (slap_KernelIsaSupported(isa)) {
+      return isa;
+    }
+  }
+  return slap_kIsaBaseline;
+}
+
+int slap_SetKernelIsa(enum slap_KernelIsa isa) {
+  if (!slap_KernelIsaSupported(isa)) {
+    return -1;
+  }
+  atomic_store_explicit(&active_kernels, kKernelTables[isa], memory_order_relaxed);
+  return 0;
+}
+
+static inline const slap_KernelTable* Kernels(void) {
+  const slap_KernelTable* kernels =
+      atomic_load_explicit(&active_kernels, memory_order_relaxed);
+  if (!kernels) {
+    // Racing threads all select the same variant
+    slap_SetKernelIsa(slap_DetectKernelIsa());
+    kernels = atomic_load_explicit(&active_kernels, memory_order_relaxed);
+  }
+  return kernels;
+}
+
+enum slap_KernelIsa slap_GetKernelIsa(void) {
+  const slap_KernelTable* kernels = Kernels();
+  int isa = 0;
+  while (kKernelTables[isa] != kernels) {
+    ++isa;
+  }
+  return isa;
+}
+
+const char* slap_KernelIsaName(enum slap_KernelIsa isa) {
+  if ((int)isa < 0 || isa >= slap_kNumIsas) {
+    return "unknown";
+  }
+  return kKernelIsaNames[isa];
+}
+
+/*
+ * Kernels, forwarded to the selected variant
+ */
+
+void slap_Gemm(bool tA, bool tB, int m, int n, int k, sfloat alpha, const sfloat* A, int lda,
+               const sfloat* B, int ldb, sfloat beta, sfloat* C, int ldc) {
+  Kernels()->Gemm(tA, tB, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+void slap_SymTripleProduct(bool mirror, int n, int k, sfloat alpha, const sfloat* X, int ldx,
+                           const sfloat* P, int ldp, sfloat beta, sfloat* C, int ldc) {
+  Kernels()->SymTripleProduct(mirror, n, k, alpha, X, ldx, P, ldp, beta, C, ldc);
+}
+
+void slap_Syrk(bool mirror, int n, int k, sfloat alpha, const sfloat* X, int ldx, sfloat beta,
+               sfloat* C, int ldc) {
+  Kernels()->Syrk(mirror, n, k, alpha, X, ldx, beta, C, ldc);
+}
+
+int slap_Potrf(int n, sfloat* A, int lda) { return Kernels()->Potrf(n, A, lda); }
+
+int slap_CholUpdate(bool downdate, int n, int k, sfloat* L, int ldl, sfloat* X, int ldx) {
+  return Kernels()->CholUpdate(downdate, n, k, L, ldl, X, ldx);
+}
+
+void slap_Trsm(bool tL, int n, int nrhs, const sfloat* L, int ldl, sfloat* B, int ldb) {
+  Kernels()->Trsm(tL, n, nrhs, L, ldl, B, ldb);
+}
+
+void slap_Trmm(bool tL, int n, int ncols, const sfloat* L, int ldl, sfloat* B, int ldb) {
+  Kernels()->Trmm(tL, n, ncols, L, ldl, B, ldb);
+}
+
+void slap_Spmm(int n, int nrhs, sfloat alpha, const sfloat* Ap, const sfloat* B, int ldb,
+               sfloat beta, sfloat* C, int ldc) {
+  Kernels()->Spmm(n, nrhs, alpha, Ap, B, ldb, beta, C, ldc);
+}
+
+int slap_Pptrf(int n, sfloat* Ap) { return Kernels()->Pptrf(n, Ap); }
+
+void slap_Pptrs(int n, int nrhs, const sfloat* Lp, sfloat* B, int ldb) {
+  Kernels()->Pptrs(n, nrhs, Lp, B, ldb);
+}
+
+void slap_BatchGemm(bool tA, bool tB, int m, int n, int k, sfloat alpha, const sfloat* A,
+                    int lda, const sfloat* B, int ldb, sfloat beta, sfloat* C, int ldc) {
+  Kernels()->BatchGemm(tA, tB, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+int slap_BatchPotrf(int n, sfloat* A, int lda) { return Kernels()->BatchPotrf(n, A, lda); }
+
+void slap_BatchTrsm(bool tL, int n, int nrhs, const sfloat* L, int ldl, sfloat* B, int ldb) {
+  Kernels()->BatchTrsm(tL, n, nrhs, L, ldl, B, ldb);
+}
+
+void slap_BatchAxpy(int len, sfloat alpha, const sfloat* x, sfloat* y) {
+  Kernels()->BatchAxpy(len, alpha, x, y);
+}
@@ -0,0 +1,75 @@
+/**
+ * @file isa.h
+ * @author Brian Jackson (bjack205@gmail.com)
+ * @brief Selection of the instruction set used by the slap kernels
+ * @version 0.1
+ * @date 2022-02-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * On x86 the kernels in kernels.h are compiled several times, once for each of the
+ * instruction sets in slap_KernelIsa, so that a single build runs on any x86-64 CPU and
+ * still uses the widest vectors available. The first call to a kernel picks the best
+ * variant supported by the CPU, which can be queried or overridden with the functions
+ * below, e.g. to compare the variants or to work around a problem with one of them.
+ *
+ * On other architectures only the baseline variant, compiled for the default target of
+ * the compiler, is available.
+ *
+ * The single-precision library keeps its own selection, which is set independently.
+ *
+ * @addtogroup LinearAlgebra
+ * @{
+ */
+#pragma once
+
+#include <stdbool.h>
+
+#include "scalar.h"
+
+/**
+ * @brief Instruction sets the kernels are compiled for
+ */
+enum slap_KernelIsa {
+  slap_kIsaBaseline = 0,  ///< SSE2 on x86-64, or the default target of the compiler
+  slap_kIsaAvx2,          ///< AVX2 with FMA
+  slap_kIsaAvx512,        ///< AVX-512 (AVX512F)
+  slap_kNumIsas,
+};
+
+/**
+ * @brief Get the best instruction set supported by both the CPU and the build
+ */
+enum slap_KernelIsa slap_DetectKernelIsa(void);
+
+/**
+ * @brief Check if the kernels can be run with the given instruction set
+ *
+ * @return true if the variant was compiled and the CPU supports it
+ */
+bool slap_KernelIsaSupported(enum slap_KernelIsa isa);
+
+/**
+ * @brief Get the instruction set used by the kernels
+ *
+ * Selects the one given by slap_DetectKernelIsa() if none has been selected yet.
+ */
+enum slap_KernelIsa slap_GetKernelIsa(void);
+
+/**
+ * @brief Set the instruction set used by the kernels
+ *
+ * Takes effect for all threads. It should not be changed while kernels are running on
+ * other threads, since the variants may round differently.
+ *
+ * @param isa Instruction set to use
+ * @return 0 if successful, or -1 if @p isa is not supported (see slap_KernelIsaSupported()).
+ */
+int slap_SetKernelIsa(enum slap_KernelIsa isa);
+
+/**
+ * @brief Get a short, human-readable name for an instruction set, e.g. "avx2"
+ */
+const char* slap_KernelIsaName(enum slap_KernelIsa isa);
+
+/**@} */
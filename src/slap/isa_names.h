@@ -0,0 +1,56 @@
+/**
+ * @file isa_names.h
+ * @brief Maps the slap kernels to the names of a single instruction-set variant
+ *
+ * Included by kernels.h. The kernel sources are compiled once per instruction set (see
+ * isa.h) with `SLAP_ISA` defined to its name, which is appended to the names of the
+ * kernels, e.g. slap_Gemm becomes slap_Gemm_avx2, or slapf_Gemm_avx2 in single precision.
+ * The kernels with the usual names are defined in isa.c and call the selected variant.
+ */
+#pragma once
+
+#include "scalar.h"
+
+#ifdef SLAP_USE_FLOAT
+#define SLAP_ISA_PREFIX slapf_
+#else
+#define SLAP_ISA_PREFIX slap_
+#endif
+
+#define SLAP_ISA_CONCAT_(prefix, name, isa) prefix##name##_##isa
+#define SLAP_ISA_CONCAT(prefix, name, isa) SLAP_ISA_CONCAT_(prefix, name, isa)
+
+/** @brief Name of the symbol @p name in the variant for the instruction set @p isa */
+#define SLAP_ISA_NAME(name, isa) SLAP_ISA_CONCAT(SLAP_ISA_PREFIX, name, isa)
+
+#ifdef SLAP_ISA
+#undef slap_Gemm
+#undef slap_SymTripleProduct
+#undef slap_Syrk
+#undef slap_Potrf
+#undef slap_CholUpdate
+#undef slap_Trsm
+#undef slap_Trmm
+#undef slap_Spmm
+#undef slap_Pptrf
+#undef slap_Pptrs
+#undef slap_BatchGemm
+#undef slap_BatchPotrf
+#undef slap_BatchTrsm
+#undef slap_BatchAxpy
+
+#define slap_Gemm SLAP_ISA_NAME(Gemm, SLAP_ISA)
+#define slap_SymTripleProduct SLAP_ISA_NAME(SymTripleProduct, SLAP_ISA)
+#define slap_Syrk SLAP_ISA_NAME(Syrk, SLAP_ISA)
+#define slap_Potrf SLAP_ISA_NAME(Potrf, SLAP_ISA)
+#define slap_CholUpdate SLAP_ISA_NAME(CholUpdate, SLAP_ISA)
+#define slap_Trsm SLAP_ISA_NAME(Trsm, SLAP_ISA)
+#define slap_Trmm SLAP_ISA_NAME(Trmm, SLAP_ISA)
+#define slap_Spmm SLAP_ISA_NAME(Spmm, SLAP_ISA)
+#define slap_Pptrf SLAP_ISA_NAME(Pptrf, SLAP_ISA)
+#define slap_Pptrs SLAP_ISA_NAME(Pptrs, SLAP_ISA)
+#define slap_BatchGemm SLAP_ISA_NAME(BatchGemm, SLAP_ISA)
+#define slap_BatchPotrf SLAP_ISA_NAME(BatchPotrf, SLAP_ISA)
+#define slap_BatchTrsm SLAP_ISA_NAME(BatchTrsm, SLAP_ISA)
+#define slap_BatchAxpy SLAP_ISA_NAME(BatchAxpy, SLAP_ISA)
+#endif
@@ -0,0 +1,20 @@
+#include "slap/kernel_table.h"
+
+#include "slap/kernels.h"
+
+const slap_KernelTable SLAP_ISA_NAME(kernels, SLAP_ISA) = {
+    slap_Gemm,
+    slap_SymTripleProduct,
+    slap_Syrk,
+    slap_Potrf,
+    slap_CholUpdate,
+    slap_Trsm,
+    slap_Trmm,
+    slap_Spmm,
+    slap_Pptrf,
+    slap_Pptrs,
+    slap_BatchGemm,
+    slap_BatchPotrf,
+    slap_BatchTrsm,
+    slap_BatchAxpy,
+};
@@ -0,0 +1,41 @@
+/**
+ * @file kernel_table.h
+ * @brief Table of the kernels compiled for one instruction set
+ *
+ * Every variant of the kernels defines one of these tables (see kernel_table.c), which
+ * isa.c uses to call the selected variant.
+ *
+ * This header is internal to slap.
+ */
+#pragma once
+
+#include <stdbool.h>
+
+#include "isa_names.h"
+#include "scalar.h"
+
+typedef struct {
+  void (*Gemm)(bool tA, bool tB, int m, int n, int k, sfloat alpha, const sfloat* A, int lda,
+               const sfloat* B, int ldb, sfloat beta, sfloat* C, int ldc);
+  void (*SymTripleProduct)(bool mirror, int n, int k, sfloat alpha, const sfloat* X, int ldx,
+                           const sfloat* P, int ldp, sfloat beta, sfloat* C, int ldc);
+  void (*Syrk)(bool mirror, int n, int k, sfloat alpha, const sfloat* X, int ldx, sfloat beta,
+               sfloat* C, int ldc);
+  int (*Potrf)(int n, sfloat* A, int lda);
+  int (*CholUpdate)(bool downdate, int n, int k, sfloat* L, int ldl, sfloat* X, int ldx);
+  void (*Trsm)(bool tL, int n, int nrhs, const sfloat* L, int ldl, sfloat* B, int ldb);
+  void (*Trmm)(bool tL, int n, int ncols, const sfloat* L, int ldl, sfloat* B, int ldb);
+  void (*Spmm)(int n, int nrhs, sfloat alpha, const sfloat* Ap, const sfloat* B, int ldb,
+               sfloat beta, sfloat* C, int ldc);
+  int (*Pptrf)(int n, sfloat* Ap);
+  void (*Pptrs)(int n, int nrhs, const sfloat* Lp, sfloat* B, int ldb);
+  void (*BatchGemm)(bool tA, bool tB, int m, int n, int k, sfloat alpha, const sfloat* A,
+                    int lda, const sfloat* B, int ldb, sfloat beta, sfloat* C, int ldc);
+  int (*BatchPotrf)(int n, sfloat* A, int lda);
+  void (*BatchTrsm)(bool tL, int n, int nrhs, const sfloat* L, int ldl, sfloat* B, int ldb);
+  void (*BatchAxpy)(int len, sfloat alpha, const sfloat* x, sfloat* y);
+} slap_KernelTable;
+
+extern const slap_KernelTable SLAP_ISA_NAME(kernels, baseline);
+extern const slap_KernelTable SLAP_ISA_NAME(kernels, avx2);
+extern const slap_KernelTable SLAP_ISA_NAME(kernels, avx512);
@@ -0,0 +1,298 @@
+/**
+ * @file kernels.h
+ * @author Brian Jackson (bjack205@gmail.com)
+ * @brief Dense kernels operating directly on column-major arrays
+ * @version 0.1
+ * @date 2022-02-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * These routines do the floating-point work behind the Matrix-level API in linalg.h.
+ * Like BLAS, they take raw pointers to column-major data along with a leading dimension,
+ * which is the distance in memory between the start of adjacent columns.
+ *
+ * If the library is built with the `ULQR_USE_BLAS` CMake option, slap_Gemm(), slap_Potrf()
+ * and slap_Trsm() call the BLAS/LAPACK found on the system instead once every dimension of
+ * the problem is at least `ULQR_BLAS_MIN_SIZE` (64 by default). Smaller problems always
+ * use the kernels here, since the overhead of the library call dominates at those sizes.
+ *
+ * On x86, each kernel is compiled for several instruction sets, and the calls are
+ * forwarded to the variant selected at runtime (see isa.h).
+ *
+ * Inline versions for very small matrices of a size known at compile time are in
+ * small_kernels.h.
+ *
+ * @ingroup LinearAlgebra
+ * @{
+ */
+#pragma once
+
+#include <stdbool.h>
+
+#include "isa_names.h"
+#include "scalar.h"
+
+/**
+ * @brief General matrix-matrix multiplication
+ *
+ * Computes
+ * \f[
+ * C = \alpha \, op(A) \, op(B) + \beta C
+ * \f]
+ * where \f$ op(X) \f$ is \f$ X \f$ or \f$ X^T \f$. Small problems are computed directly
+ * from the input data with register-blocked kernels, while larger ones are blocked for
+ * the L1 and L2 caches and packed into contiguous panels first.
+ *
+ * If @p beta is zero, @p C does not need to be initialized.
+ *
+ * @param tA    Should @p A be transposed
+ * @param tB    Should @p B be transposed
+ * @param m     Number of rows of \f$ op(A) \f$ and @p C
+ * @param n     Number of columns of \f$ op(B) \f$ and @p C
+ * @param k     Number of columns of \f$ op(A) \f$ and rows of \f$ op(B) \f$
+ * @param alpha Scalar on the \f$ op(A) op(B) \f$ term
+ * @param A     Data for A
+ * @param lda   Leading dimension of A
+ * @param B     Data for B
+ * @param ldb   Leading dimension of B
+ * @param beta  Scalar on the \f$ C \f$ term
+ * @param C     Data for C. Cannot alias @p A or @p B.
+ * @param ldc   Leading dimension of C
+ */
+void slap_Gemm(bool tA, bool tB, int m, int n, int k, sfloat alpha, const sfloat* A, int lda,
+               const sfloat* B, int ldb, sfloat beta, sfloat* C, int ldc);
+
+/**
+ * @brief Symmetric triple product
+ *
+ * Computes
+ * \f[
+ * C = \alpha X^T P X + \beta C
+ * \f]
+ * for a symmetric matrix \f$ P \f$, in a single pass. Only the lower triangle of
+ * \f$ C \f$ is computed: each block column of \f$ P X \f$ is formed once and multiplied
+ * only into the blocks of \f$ C \f$ on or below the diagonal, so the second product costs
+ * half of a general GEMM.
+ *
+ * @param mirror Copy the lower triangle of @p C into the upper triangle when done.
+ *               Otherwise the strict upper triangle is left untouched.
+ * @param n      Number of columns of @p X and the size of @p C
+ * @param k      Number of rows of @p X and the size of @p P
+ * @param alpha  Scalar on the \f$ X^T P X \f$ term
+ * @param X      Data for X
+ * @param ldx    Leading dimension of X
+ * @param P      Data for P. All of P is read.
+ * @param ldp    Leading dimension of P
+ * @param beta   Scalar on the \f$ C \f$ term
+ * @param C      Data for C. Cannot alias @p X or @p P.
+ * @param ldc    Leading dimension of C
+ */
+void slap_SymTripleProduct(bool mirror, int n, int k, sfloat alpha, const sfloat* X, int ldx,
+                           const sfloat* P, int ldp, sfloat beta, sfloat* C, int ldc);
+
+/**
+ * @brief Symmetric rank-k update
+ *
+ * Computes
+ * \f[
+ * C = \alpha X^T X + \beta C
+ * \f]
+ * computing only the lower triangle of \f$ C \f$, blocked the same way as
+ * slap_SymTripleProduct(). Costs half of the equivalent general GEMM.
+ *
+ * @param mirror Copy the lower triangle of @p C into the upper triangle when done.
+ *               Otherwise the strict upper triangle is left untouched.
+ * @param n      Number of columns of @p X and the size of @p C
+ * @param k      Number of rows of @p X
+ * @param alpha  Scalar on the \f$ X^T X \f$ term
+ * @param X      Data for X
+ * @param ldx    Leading dimension of X
+ * @param beta   Scalar on the \f$ C \f$ term
+ * @param C      Data for C. Cannot alias @p X.
+ * @param ldc    Leading dimension of C
+ */
+void slap_Syrk(bool mirror, int n, int k, sfloat alpha, const sfloat* X, int ldx, sfloat beta,
+               sfloat* C, int ldc);
+
+/**
+ * @brief Cholesky factorization of a symmetric positive-definite matrix
+ *
+ * Computes the lower-triangular factor \f$ L \f$ such that \f$ A = L L^T \f$, overwriting
+ * the lower triangle of @p A. Only the lower triangle of @p A is read, and the strict upper
+ * triangle is left untouched.
+ *
+ * Blocks of up to 8 columns (or one vector, if longer) are factored directly in vector
+ * registers. Larger matrices use
+ * a left-looking blocked algorithm whose updates are done with slap_Gemm().
+ *
+ * @param n   Size of the matrix
+ * @param A   Data for A
+ * @param lda Leading dimension of A
+ * @return 0 if successful. Otherwise the (1-based) index of the column with a
+ *         non-positive pivot, in which case the columns before it have been factored.
+ */
+int slap_Potrf(int n, sfloat* A, int lda);
+
+/**
+ * @brief Rank-k update or downdate of a Cholesky factor
+ *
+ * Given the lower-triangular factor \f$ L \f$ of \f$ A = L L^T \f$, as computed by
+ * slap_Potrf(), overwrites it with the factor of \f$ A + X X^T \f$, or of
+ * \f$ A - X X^T \f$ if @p downdate is true, in \f$ O(n^2 k) \f$ operations instead of
+ * the \f$ O(n^3) \f$ of a new factorization. Each column of @p X is applied as a sequence
+ * of Givens (update) or hyperbolic (downdate) rotations, one column of @p L at a time.
+ *
+ * @param downdate Subtract \f$ X X^T \f$ instead of adding it
+ * @param n   Size of @p L
+ * @param k   Number of columns of @p X
+ * @param L   Data for L. Only the lower triangle is read or written.
+ * @param ldl Leading dimension of L
+ * @param X   Data for the (n,k) matrix X. Overwritten.
+ * @param ldx Leading dimension of X
+ * @return 0 if successful. For a downdate, the (1-based) index of the column of @p L that
+ *         would have a non-positive diagonal if the result is not positive definite, in
+ *         which case @p L is left partially modified.
+ */
+int slap_CholUpdate(bool downdate, int n, int k, sfloat* L, int ldl, sfloat* X, int ldx);
+
+/**
+ * @brief Triangular matrix-matrix multiplication
+ *
+ * Computes \f$ B = L B \f$, or \f$ B = L^T B \f$ if @p tL is true, for a lower-triangular
+ * matrix \f$ L \f$, overwriting @p B. Only the lower triangle of @p L is read, so it
+ * takes half the operations of slap_Gemm() with a dense @p L.
+ *
+ * @param tL   Should @p L be transposed
+ * @param n    Size of @p L
+ * @param ncols Number of columns of @p B
+ * @param L    Data for L
+ * @param ldl  Leading dimension of L
+ * @param B    Data for the (n,ncols) matrix B
+ * @param ldb  Leading dimension of B
+ */
+void slap_Trmm(bool tL, int n, int ncols, const sfloat* L, int ldl, sfloat* B, int ldb);
+
+/**
+ * @brief Triangular solve with multiple right-hand sides
+ *
+ * Solves \f$ L X = B \f$, or \f$ L^T X = B \f$ if @p tL is true, for a lower-triangular
+ * matrix \f$ L \f$, overwriting @p B with the solution. Only the lower triangle of @p L
+ * is read.
+ *
+ * Up to four right-hand sides are solved together so that each load of @p L is shared
+ * between them. Triangles larger than 32 are split into diagonal blocks, with the
+ * off-diagonal blocks applied using slap_Gemm().
+ *
+ * @param tL   Should @p L be transposed
+ * @param n    Size of @p L
+ * @param nrhs Number of right-hand sides, i.e. columns of @p B
+ * @param L    Data for L
+ * @param ldl  Leading dimension of L
+ * @param B    Data for B
+ * @param ldb  Leading dimension of B
+ */
+void slap_Trsm(bool tL, int n, int nrhs, const sfloat* L, int ldl, sfloat* B, int ldb);
+
+/**
+ * @brief Multiplication by a symmetric matrix in packed storage
+ *
+ * Computes
+ * \f[
+ * C = \alpha A B + \beta C
+ * \f]
+ * where \f$ A \f$ is symmetric and stored in the packed lower format described in
+ * symmatrix.h. Each stored column of \f$ A \f$ is used twice per column of \f$ B \f$:
+ * once as a column, in an axpy update of \f$ C \f$, and once as a row, in a dot product
+ * with \f$ B \f$. Up to four columns of @p B share each load of @p Ap.
+ *
+ * If @p beta is zero, @p C does not need to be initialized.
+ *
+ * @param n     Size of @p A
+ * @param nrhs  Number of columns of @p B and @p C
+ * @param alpha Scalar on the \f$ A B \f$ term
+ * @param Ap    Packed data for A, of length `n * (n + 1) / 2`
+ * @param B     Data for B
+ * @param ldb   Leading dimension of B
+ * @param beta  Scalar on the \f$ C \f$ term
+ * @param C     Data for C. Cannot alias @p B.
+ * @param ldc   Leading dimension of C
+ */
+void slap_Spmm(int n, int nrhs, sfloat alpha, const sfloat* Ap, const sfloat* B, int ldb,
+               sfloat beta, sfloat* C, int ldc);
+
+/**
+ * @brief Cholesky factorization of a symmetric positive-definite matrix in packed storage
+ *
+ * Same as slap_Potrf(), but for a matrix in the packed lower format described in
+ * symmatrix.h. The factor overwrites @p Ap in the same format. The columns are factored
+ * left-looking, with every update an axpy over contiguous packed columns.
+ *
+ * @param n  Size of the matrix
+ * @param Ap Packed data for A
+ * @return 0 if successful. Otherwise the (1-based) index of the column with a
+ *         non-positive pivot, in which case the columns before it have been factored.
+ */
+int slap_Pptrf(int n, sfloat* Ap);
+
+/**
+ * @brief Solve a linear system with a packed Cholesky factor
+ *
+ * Solves \f$ L L^T X = B \f$, overwriting @p B with the solution, where \f$ L \f$ was
+ * computed by slap_Pptrf().
+ *
+ * @param n    Size of @p L
+ * @param nrhs Number of right-hand sides, i.e. columns of @p B
+ * @param Lp   Packed data for L
+ * @param B    Data for B
+ * @param ldb  Leading dimension of B
+ */
+void slap_Pptrs(int n, int nrhs, const sfloat* Lp, sfloat* B, int ldb);
+
+/*
+ * Batched kernels
+ *
+ * These operate on SLAP_BATCH_SIZE independent matrices at once, stored interleaved as
+ * described in batchmatrix.h. The leading dimensions are counted in elements of a single
+ * matrix, i.e. the distance between columns is `ld * SLAP_BATCH_SIZE` values. Every
+ * operation is vectorized across the batch, so they are efficient for matrices of any
+ * size, including those much smaller than a vector register.
+ */
+
+/**
+ * @brief Batched general matrix-matrix multiplication
+ *
+ * Same as slap_Gemm(), for every matrix in the batch.
+ */
+void slap_BatchGemm(bool tA, bool tB, int m, int n, int k, sfloat alpha, const sfloat* A,
+                    int lda, const sfloat* B, int ldb, sfloat beta, sfloat* C, int ldc);
+
+/**
+ * @brief Batched Cholesky factorization
+ *
+ * Same as slap_Potrf(), for every matrix in the batch. Since the matrices are factored
+ * together, a non-positive pivot doesn't stop the factorization. The factor of that
+ * matrix will contain NaNs, while those of the others are unaffected.
+ *
+ * @param n   Size of the matrices
+ * @param A   Data for the batch of matrices
+ * @param lda Leading dimension of A
+ * @return 0 if successful. Otherwise a bit mask of the matrices that failed, with bit
+ *         `b` set if matrix `b` of the batch is not positive definite.
+ */
+int slap_BatchPotrf(int n, sfloat* A, int lda);
+
+/**
+ * @brief Batched triangular solve with multiple right-hand sides
+ *
+ * Same as slap_Trsm(), for every matrix in the batch.
+ */
+void slap_BatchTrsm(bool tL, int n, int nrhs, const sfloat* L, int ldl, sfloat* B, int ldb);
+
+/**
+ * @brief Batched vector addition
+ *
+ * Computes \f$ y = \alpha x + y \f$ for @p len elements of every vector in the batch.
+ */
+void slap_BatchAxpy(int len, sfloat alpha, const sfloat* x, sfloat* y);
+
+/**@} */
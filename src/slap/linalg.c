@@ -1,50 +1,37 @@
 #include "linalg.h"
 
 #include "math.h"
+#include "slap/kernels.h"
 #include "slap/matrix.h"
-#include "stdio.h"
 
-int slap_MatrixAddition(Matrix* A, Matrix* B, double alpha) {
-  for (int i = 0; i < slap_MatrixNumElements(A); ++i) {
-    B->data[i] += alpha * A->data[i];
-  }
-  return 0;
-}
+static const sfloat kCholeskyShiftGrowth = 10;  ///< growth of the shift between retries
 
-int slap_MatrixScale(Matrix* A, double alpha) {
-  for (int i = 0; i < slap_MatrixNumElements(A); ++i) {
-    A->data[i] *= alpha;
+int slap_MatrixAddition(Matrix* A, Matrix* B, sfloat alpha) {
+  SLAP_CHECK(A->rows == B->rows && A->cols == B->cols);
+  int ldA = slap_MatrixLeadingDim(A);
+  int ldB = slap_MatrixLeadingDim(B);
+  for (int j = 0; j < A->cols; ++j) {
+    for (int i = 0; i < A->rows; ++i) {
+      B->data[i + j * ldB] += alpha * A->data[i + j * ldA];
+    }
   }
   return 0;
 }
 
-int slap_MatrixMultiply(Matrix* A, Matrix* B, Matrix* C, bool tA, bool tB, double alpha,
-                        double beta) {
-  int n;
-  int m;
-  if (tA) {
-    n = A->cols;
-    m = A->rows;
-  } else {
-    n = A->rows;
-    m = A->cols;
-  }
+int slap_MatrixScale(Matrix* A, sfloat alpha) { return slap_MatrixScaleByConst(A, alpha); }
+
+int slap_MatrixMultiply(Matrix* A, Matrix* B, Matrix* C, bool tA, bool tB, sfloat alpha,
+                        sfloat beta) {
+  int n = tA ? A->cols : A->rows;
+  int m = tA ? A->rows : A->cols;
   int p = tB ? B->rows : B->cols;
-  for (int i = 0; i < n; ++i) {
-    for (int j = 0; j < p; ++j) {
-      double* Cij = slap_MatrixGetElement(C, i, j);
-      *Cij *= beta;
-      for (int k = 0; k < m; ++k) {
-        double Aik = *slap_MatrixGetElementTranspose(A, i, k, tA);
-        double Bkj = *slap_MatrixGetElementTranspose(B, k, j, tB);
-        *Cij += alpha * Aik * Bkj;
-      }
-    }
-  }
+  SLAP_CHECK((tB ? B->cols : B->rows) == m && C->rows == n && C->cols == p);
+  slap_Gemm(tA, tB, n, p, m, alpha, A->data, slap_MatrixLeadingDim(A), B->data,
+            slap_MatrixLeadingDim(B), beta, C->data, slap_MatrixLeadingDim(C));
   return 0;
 }
 
-int slap_SymmetricMatrixMultiply(Matrix* Asym, Matrix* B, Matrix* C, double alpha, double beta) {
+int slap_SymmetricMatrixMultiply(Matrix* Asym, Matrix* B, Matrix* C, sfloat alpha, sfloat beta) {
   int n;
   int m;
   bool tA = false;
@@ -57,9 +44,10 @@ int slap_SymmetricMatrixMultiply(Matrix* Asym, Matrix* B, Matrix* C, double alph
     m = Asym->cols;
   }
   int p = tB ? B->rows : B->cols;
+  SLAP_CHECK(B->rows == m && C->rows == n && C->cols == p);
   for (int i = 0; i < n; ++i) {
     for (int j = 0; j < p; ++j) {
-      double* Cij = slap_MatrixGetElement(C, i, j);
+      sfloat* Cij = slap_MatrixAt(C, i, j);
       *Cij *= beta;
       for (int k = 0; k < m; ++k) {
         int row = i;
@@ -68,126 +56,297 @@ int slap_SymmetricMatrixMultiply(Matrix* Asym, Matrix* B, Matrix* C, double alph
           row = k;
           col = i;
         }
-        double Aik = *slap_MatrixGetElement(Asym, row, col);
-        double Bkj = *slap_MatrixGetElement(B, k, j);
+        sfloat Aik = *slap_MatrixAt(Asym, row, col);
+        sfloat Bkj = *slap_MatrixAt(B, k, j);
         *Cij += alpha * Aik * Bkj;
       }
     }
   }
   return 0;
+}
+
+int slap_SymmetricTripleProduct(Matrix* X, Matrix* P, Matrix* C, sfloat alpha, sfloat beta,
+                                bool mirror) {
+  SLAP_CHECK(X->rows == P->rows && P->rows == P->cols && C->rows == X->cols &&
+             C->cols == X->cols);
+  slap_SymTripleProduct(mirror, X->cols, X->rows, alpha, X->data, slap_MatrixLeadingDim(X),
+                        P->data, slap_MatrixLeadingDim(P), beta, C->data,
+                        slap_MatrixLeadingDim(C));
+  return 0;
+}
+
+int slap_SymmetricRankKUpdate(Matrix* X, Matrix* C, sfloat alpha, sfloat beta, bool mirror) {
+  SLAP_CHECK(C->rows == X->cols && C->cols == X->cols);
+  slap_Syrk(mirror, X->cols, X->rows, alpha, X->data, slap_MatrixLeadingDim(X), beta, C->data,
+            slap_MatrixLeadingDim(C));
   return 0;
 }
 
-int slap_AddDiagonal(Matrix* A, double alpha) {
+int slap_SymMatrixMultiply(const SymMatrix* A, Matrix* B, Matrix* C, sfloat alpha, sfloat beta) {
+  SLAP_CHECK(B->rows == A->n && C->rows == A->n && C->cols == B->cols);
+  slap_Spmm(A->n, B->cols, alpha, A->data, B->data, slap_MatrixLeadingDim(B), beta, C->data,
+            slap_MatrixLeadingDim(C));
+  return 0;
+}
+
+int slap_AddDiagonal(Matrix* A, sfloat alpha) {
   int n = A->rows;
+  SLAP_CHECK(n <= A->cols);
   for (int i = 0; i < n; ++i) {
-    double* Aii = slap_MatrixGetElement(A, i, i);
+    sfloat* Aii = slap_MatrixAt(A, i, i);
     *Aii += alpha;
   }
   return 0;
 }
 
 int slap_CholeskyFactorize(Matrix* A) {
-  int n = A->rows;
-  for (int j = 0; j < n; ++j) {
-    for (int k = 0; k < j; ++k) {
-      for (int i = j; i < n; ++i) {
-        double* Aij = slap_MatrixGetElement(A, i, j);
-        double Aik = *slap_MatrixGetElement(A, i, k);
-        double Ajk = *slap_MatrixGetElement(A, j, k);
-        *Aij -= Aik * Ajk;
-      }
-    }
-    double Ajj = *slap_MatrixGetElement(A, j, j);
-    if (Ajj <= 0) {
-      return slap_kCholeskyFail;
-    }
-    double ajj = sqrt(Ajj);
+  SLAP_CHECK(A->rows == A->cols);
+  int info = slap_Potrf(A->rows, A->data, slap_MatrixLeadingDim(A));
+  return info == 0 ? slap_kCholeskySuccess : slap_kCholeskyFail;
+}
 
-    for (int i = j; i < n; ++i) {
-      double* Aij = slap_MatrixGetElement(A, i, j);
-      *Aij /= ajj;
+int slap_CholeskyFactorizeRegularized(Matrix* L, const SymMatrix* A, sfloat shift_min,
+                                      sfloat shift_max, sfloat* shift, int* nretries) {
+  SLAP_CHECK(L->rows == A->n && L->cols == A->n);
+  *shift = 0.0;
+  *nretries = 0;
+  for (sfloat s = shift_min; s > 0 && s <= shift_max; s *= kCholeskyShiftGrowth) {
+    *shift = s;
+    ++*nretries;
+    slap_SymMatrixUnpack(L, A);
+    slap_AddDiagonal(L, s);
+    if (slap_CholeskyFactorize(L) == slap_kCholeskySuccess) {
+      return slap_kCholeskySuccess;
     }
   }
-  return slap_kCholeskySuccess;
+  return slap_kCholeskyFail;
+}
+
+int slap_CholeskyUpdate(Matrix* L, Matrix* X) {
+  SLAP_CHECK(L->rows == L->cols && X->rows == L->rows);
+  int info = slap_CholUpdate(false, L->rows, X->cols, L->data, slap_MatrixLeadingDim(L),
+                             X->data, slap_MatrixLeadingDim(X));
+  return info == 0 ? slap_kCholeskySuccess : slap_kCholeskyFail;
+}
+
+int slap_CholeskyDowndate(Matrix* L, Matrix* X) {
+  SLAP_CHECK(L->rows == L->cols && X->rows == L->rows);
+  int info = slap_CholUpdate(true, L->rows, X->cols, L->data, slap_MatrixLeadingDim(L),
+                             X->data, slap_MatrixLeadingDim(X));
+  return info == 0 ? slap_kCholeskySuccess : slap_kCholeskyFail;
 }
 
 int slap_LowerTriBackSub(Matrix* L, Matrix* b, bool istransposed) {
+  SLAP_CHECK(L->rows == L->cols && L->rows == b->rows);
+  slap_Trsm(istransposed, b->rows, b->cols, L->data, slap_MatrixLeadingDim(L), b->data,
+            slap_MatrixLeadingDim(b));
+  return 0;
+}
+
+int slap_LowerTriMultiply(Matrix* L, Matrix* B, bool istransposed) {
+  SLAP_CHECK(L->rows == L->cols && L->rows == B->rows);
+  slap_Trmm(istransposed, B->rows, B->cols, L->data, slap_MatrixLeadingDim(L), B->data,
+            slap_MatrixLeadingDim(B));
+  return 0;
+}
+
+int slap_CholeskySolve(Matrix* L, Matrix* b) {
   int n = b->rows;
-  int m = b->cols;
-  for (int j_ = 0; j_ < n; ++j_) {
-    int j = istransposed ? n - j_ - 1 : j_;
-    for (int k = 0; k < m; ++k) {
-      double* xjk = slap_MatrixGetElement(b, j, k);
-      double Ljj = *slap_MatrixGetElement(L, j, j);
-      *xjk /= Ljj;
-
-      for (int i_ = j_ + 1; i_ < n; ++i_) {
-        int i = istransposed ? i_ - (j_ + 1) : i_;
-        double* xik = slap_MatrixGetElement(b, i, k);
-        double Lij = *slap_MatrixGetElementTranspose(L, i, j, istransposed);
-        *xik -= Lij * (*xjk);
+  int nrhs = b->cols;
+  int ldl = slap_MatrixLeadingDim(L);
+  int ldb = slap_MatrixLeadingDim(b);
+  SLAP_CHECK(L->rows == L->cols && L->rows == n);
+  slap_Trsm(false, n, nrhs, L->data, ldl, b->data, ldb);
+  slap_Trsm(true, n, nrhs, L->data, ldl, b->data, ldb);
+  return 0;
+}
+
+int slap_SymCholeskyFactorize(SymMatrix* A) {
+  int info = slap_Pptrf(A->n, A->data);
+  return info == 0 ? slap_kCholeskySuccess : slap_kCholeskyFail;
+}
+
+int slap_SymCholeskySolve(const SymMatrix* L, Matrix* b) {
+  slap_Pptrs(L->n, b->cols, L->data, b->data, slap_MatrixLeadingDim(b));
+  return 0;
+}
+
+int slap_LUFactorize(Matrix* A, int* ipiv) {
+  SLAP_CHECK(A->rows == A->cols);
+  int n = A->rows;
+  for (int j = 0; j < n; ++j) {
+    // Pivot on the largest entry on or below the diagonal
+    int piv = j;
+    sfloat amax = fabs(*slap_MatrixAt(A, j, j));
+    for (int i = j + 1; i < n; ++i) {
+      sfloat a = fabs(*slap_MatrixAt(A, i, j));
+      if (a > amax) {
+        amax = a;
+        piv = i;
+      }
+    }
+    ipiv[j] = piv;
+    if (amax == 0.0) {
+      return -1;
+    }
+    if (piv != j) {
+      for (int c = 0; c < n; ++c) {
+        sfloat tmp = *slap_MatrixAt(A, j, c);
+        *slap_MatrixAt(A, j, c) = *slap_MatrixAt(A, piv, c);
+        *slap_MatrixAt(A, piv, c) = tmp;
+      }
+    }
+
+    // Column of L and update of the trailing submatrix
+    sfloat pivot = *slap_MatrixAt(A, j, j);
+    for (int i = j + 1; i < n; ++i) {
+      *slap_MatrixAt(A, i, j) /= pivot;
+    }
+    for (int c = j + 1; c < n; ++c) {
+      sfloat ajc = *slap_MatrixAt(A, j, c);
+      for (int i = j + 1; i < n; ++i) {
+        *slap_MatrixAt(A, i, c) -= *slap_MatrixAt(A, i, j) * ajc;
       }
     }
   }
   return 0;
 }
 
-int slap_CholeskySolve(Matrix* L, Matrix* b) {
-  slap_LowerTriBackSub(L, b, 0);
-  slap_LowerTriBackSub(L, b, 1);
+int slap_LUSolve(Matrix* LU, const int* ipiv, Matrix* b) {
+  SLAP_CHECK(LU->rows == LU->cols && LU->rows == b->rows);
+  int n = LU->rows;
+  for (int c = 0; c < b->cols; ++c) {
+    for (int i = 0; i < n; ++i) {
+      if (ipiv[i] != i) {
+        sfloat tmp = *slap_MatrixAt(b, i, c);
+        *slap_MatrixAt(b, i, c) = *slap_MatrixAt(b, ipiv[i], c);
+        *slap_MatrixAt(b, ipiv[i], c) = tmp;
+      }
+    }
+
+    // Unit lower-triangular solve, then upper-triangular solve
+    for (int j = 0; j < n; ++j) {
+      sfloat bj = *slap_MatrixAt(b, j, c);
+      for (int i = j + 1; i < n; ++i) {
+        *slap_MatrixAt(b, i, c) -= *slap_MatrixAt(LU, i, j) * bj;
+      }
+    }
+    for (int j = n - 1; j >= 0; --j) {
+      sfloat* bj = slap_MatrixAt(b, j, c);
+      *bj /= *slap_MatrixAt(LU, j, j);
+      for (int i = 0; i < j; ++i) {
+        *slap_MatrixAt(b, i, c) -= *slap_MatrixAt(LU, i, j) * (*bj);
+      }
+    }
+  }
   return 0;
 }
 
-double slap_TwoNorm(const Matrix* M) {
+sfloat slap_TwoNorm(const Matrix* M) {
   if (!M) {
     return -1;
   }
-  double norm = 0.0;
-  for (int i = 0; i < slap_MatrixNumElements(M); ++i) {
-    double x = M->data[i];
-    norm += x * x;
+  sfloat norm = 0.0;
+  int ld = slap_MatrixLeadingDim(M);
+  for (int j = 0; j < M->cols; ++j) {
+    for (int i = 0; i < M->rows; ++i) {
+      sfloat x = M->data[i + j * ld];
+      norm += x * x;
+    }
   }
   return sqrt(norm);
 }
 
-double slap_OneNorm(const Matrix* M) {
+sfloat slap_OneNorm(const Matrix* M) {
   if (!M) {
     return -1;
   }
-  double norm = 0.0;
-  for (int i = 0; i < slap_MatrixNumElements(M); ++i) {
-    double x = M->data[i];
-    norm += fabs(x);
+  sfloat norm = 0.0;
+  int ld = slap_MatrixLeadingDim(M);
+  for (int j = 0; j < M->cols; ++j) {
+    for (int i = 0; i < M->rows; ++i) {
+      sfloat x = M->data[i + j * ld];
+      norm += fabs(x);
+    }
   }
   return sqrt(norm);
 }
 
-double slap_DotProduct(const Matrix* x, const Matrix* y) {
+sfloat slap_DotProduct(const Matrix* x, const Matrix* y) {
   if ((x->rows != y->rows) || (x->cols != 1) || (y->cols != 1)) {
     return NAN;
   }
-  double out = 0.0;
+  sfloat out = 0.0;
   for (int i = 0; i < x->rows; ++i) {
-    double xi = x->data[i];
-    double yi = y->data[i];
+    sfloat xi = x->data[i];
+    sfloat yi = y->data[i];
     out += xi * yi;
   }
   return out;
 }
 
-double slap_QuadraticForm(const Matrix* x, const Matrix* A, const Matrix* y) {
+sfloat slap_QuadraticForm(const Matrix* x, const Matrix* A, const Matrix* y) {
   if ((x->rows != A->rows) || (y->rows != A->cols) || (x->cols != 1) || (y->cols != 1)) {
     return NAN;
   }
-  double out = 0.0;
+  sfloat out = 0.0;
   for (int i = 0; i < x->rows; ++i) {
     for (int j = 0; j < y->rows; ++j) {
-      double xi = x->data[i];
-      double yj = y->data[j];
-      double Aij = *slap_MatrixGetElement(A, i, j);
+      sfloat xi = x->data[i];
+      sfloat yj = y->data[j];
+      sfloat Aij = *slap_MatrixAt(A, i, j);
       out += xi * Aij * yj;
     }
   }
   return out;
 }
+
+sfloat slap_SymQuadraticForm(const Matrix* x, const SymMatrix* A) {
+  if ((x->rows != A->n) || (x->cols != 1)) {
+    return NAN;
+  }
+  sfloat out = 0.0;
+  const sfloat* Aj = A->data;
+  for (int j = 0; j < A->n; ++j) {
+    sfloat xj = x->data[j];
+    sfloat offdiag = 0.0;
+    for (int i = j + 1; i < A->n; ++i) {
+      offdiag += Aj[i - j] * x->data[i];
+    }
+    out += xj * (Aj[0] * xj + 2.0 * offdiag);
+    Aj += A->n - j;
+  }
+  return out;
+}
+
+int slap_BatchMatrixAddition(const BatchMatrix* A, BatchMatrix* B, sfloat alpha) {
+  SLAP_CHECK(A->rows == B->rows && A->cols == B->cols);
+  slap_BatchAxpy(A->rows * A->cols, alpha, A->data, B->data);
+  return 0;
+}
+
+int slap_BatchMatrixMultiply(const BatchMatrix* A, const BatchMatrix* B, BatchMatrix* C, bool tA,
+                             bool tB, sfloat alpha, sfloat beta) {
+  int n = tA ? A->cols : A->rows;
+  int m = tA ? A->rows : A->cols;
+  int p = tB ? B->rows : B->cols;
+  SLAP_CHECK((tB ? B->cols : B->rows) == m && C->rows == n && C->cols == p);
+  slap_BatchGemm(tA, tB, n, p, m, alpha, A->data, A->rows, B->data, B->rows, beta, C->data,
+                 C->rows);
+  return 0;
+}
+
+int slap_BatchCholeskyFactorize(BatchMatrix* A) {
+  return slap_BatchPotrf(A->rows, A->data, A->rows);
+}
+
+int slap_BatchCholeskySolve(const BatchMatrix* L, BatchMatrix* b) {
+  slap_BatchTrsm(false, b->rows, b->cols, L->data, L->rows, b->data, b->rows);
+  slap_BatchTrsm(true, b->rows, b->cols, L->data, L->rows, b->data, b->rows);
+  return 0;
+}
+
+int slap_BatchLowerTriBackSub(const BatchMatrix* L, BatchMatrix* b, bool istransposed) {
+  slap_BatchTrsm(istransposed, b->rows, b->cols, L->data, L->rows, b->data, b->rows);
+  return 0;
+}
@@ -11,7 +11,11 @@
  * @{
  *
  */
+#pragma once
+
+#include "batchmatrix.h"
 #include "matrix.h"
+#include "symmatrix.h"
 
 /**
  * @brief Flag for a successful Cholesky decomposition,
@@ -41,7 +45,7 @@ static const int slap_kCholeskyFail = -1;
  * @param[in]    alpha scalar factor on A
  * @return       0 if successful
  */
-int slap_MatrixAddition(Matrix* A, Matrix* B, double alpha);
+int slap_MatrixAddition(Matrix* A, Matrix* B, sfloat alpha);
 
 /**
  * @brief Scale a matrix by a constant
@@ -50,7 +54,7 @@ int slap_MatrixAddition(Matrix* A, Matrix* B, double alpha);
  * @param alpha scalar multiplier
  * @return      0 if successful
  */
-int slap_MatrixScale(Matrix* A, double alpha);
+int slap_MatrixScale(Matrix* A, sfloat alpha);
 
 /**
  * @brief Matrix multiplication
@@ -66,10 +70,11 @@ int slap_MatrixScale(Matrix* A, double alpha);
  * @param[in]    tB    Should @p B be transposed
  * @param[in]    alpha scalar on the \f$ A B \f$ term
  * @param[in]    beta  scalar on the \f$ C \f$ term. Set to zero for pure
- *                     matrix multiplication.
+ *                     matrix multiplication, in which case @p C does not need to be
+ *                     initialized.
  */
-int slap_MatrixMultiply(Matrix* A, Matrix* B, Matrix* C, bool tA, bool tB, double alpha,
-                        double beta);
+int slap_MatrixMultiply(Matrix* A, Matrix* B, Matrix* C, bool tA, bool tB, sfloat alpha,
+                        sfloat beta);
 
 /**
  * @brief A shortcut to perform transposed matrix multiplication
@@ -103,7 +108,66 @@ int slap_MatrixTransposeMultiply(Matrix* A, Matrix* B, Matrix* C);
  * @param[in]    alpha
  * @param[in]    beta
  */
-int slap_SymmetricMatrixMultiply(Matrix* Asym, Matrix* B, Matrix* C, double alpha, double beta);
+int slap_SymmetricMatrixMultiply(Matrix* Asym, Matrix* B, Matrix* C, sfloat alpha, sfloat beta);
+
+/**
+ * @brief Symmetric triple product with an accumulator
+ *
+ * Computes
+ * \f[
+ * C = \alpha X^T P X + \beta C
+ * \f]
+ * for a symmetric matrix \f$ P \f$, computing only the lower triangle of the result.
+ * See slap_SymTripleProduct().
+ *
+ * @param[in]    X      Matrix of size (k,n)
+ * @param[in]    P      Symmetric matrix of size (k,k)
+ * @param[inout] C      Symmetric matrix of size (n,n)
+ * @param[in]    alpha  scalar on the \f$ X^T P X \f$ term
+ * @param[in]    beta   scalar on the \f$ C \f$ term
+ * @param[in]    mirror copy the lower triangle of @p C into its upper triangle. If false,
+ *                      the strict upper triangle of @p C is not modified.
+ * @return 0 if successful
+ */
+int slap_SymmetricTripleProduct(Matrix* X, Matrix* P, Matrix* C, sfloat alpha, sfloat beta,
+                                bool mirror);
+
+/**
+ * @brief Symmetric rank-k update
+ *
+ * Computes
+ * \f[
+ * C = \alpha X^T X + \beta C
+ * \f]
+ * computing only the lower triangle of the result. See slap_Syrk().
+ *
+ * @param[in]    X      Matrix of size (k,n)
+ * @param[inout] C      Symmetric matrix of size (n,n)
+ * @param[in]    alpha  scalar on the \f$ X^T X \f$ term
+ * @param[in]    beta   scalar on the \f$ C \f$ term
+ * @param[in]    mirror copy the lower triangle of @p C into its upper triangle. If false,
+ *                      the strict upper triangle of @p C is not modified.
+ * @return 0 if successful
+ */
+int slap_SymmetricRankKUpdate(Matrix* X, Matrix* C, sfloat alpha, sfloat beta, bool mirror);
+
+/**
+ * @brief Matrix multiplication with a symmetric matrix in packed storage
+ *
+ * Perform the following computation
+ * \f[
+ * C = \alpha A B + \beta C
+ * \f]
+ * See slap_Spmm().
+ *
+ * @param[in]    A     Symmetric matrix of size n
+ * @param[in]    B     Matrix of size (n,p)
+ * @param[inout] C     Matrix of size (n,p)
+ * @param[in]    alpha scalar on the \f$ A B \f$ term
+ * @param[in]    beta  scalar on the \f$ C \f$ term
+ * @return 0 if successful
+ */
+int slap_SymMatrixMultiply(const SymMatrix* A, Matrix* B, Matrix* C, sfloat alpha, sfloat beta);
 
 /**
  * @brief Add a constant value to the diagonal of a matrix
@@ -112,7 +176,7 @@ int slap_SymmetricMatrixMultiply(Matrix* Asym, Matrix* B, Matrix* C, double alph
  * @param[in]    alpha scalar to add to the diagonal
  * @return 0 if successful
  */
-int slap_AddDiagonal(Matrix* A, double alpha);
+int slap_AddDiagonal(Matrix* A, sfloat alpha);
 
 /**
  * @brief Perform a Cholesky decomposition
@@ -125,17 +189,118 @@ int slap_AddDiagonal(Matrix* A, double alpha);
  */
 int slap_CholeskyFactorize(Matrix* A);
 
+/**
+ * @brief Perform a Cholesky decomposition of a matrix with its diagonal shifted
+ *
+ * Factors \f$ A + s I \f$ for the smallest shift \f$ s \f$ of @p shift_min, growing
+ * tenfold, that makes it positive definite, up to @p shift_max. Each shift is applied to
+ * the whole diagonal and factored from scratch with slap_CholeskyFactorize(), so on
+ * success \f$ L L^T = A + s I \f$ for the single shift returned in @p shift.
+ *
+ * Each retry therefore costs a full \f$ O(n^3) \f$ factorization, on top of the failed
+ * one that led to the call. The columns factored before a failure can't be kept, since
+ * the shift changes their diagonal too. With the tenfold growth, a shift of
+ * \f$ 10^k \f$ times @p shift_min costs \f$ k + 1 \f$ factorizations.
+ *
+ * Meant as the fallback for when slap_CholeskyFactorize() fails on @p A, which is why
+ * the unshifted matrix isn't tried.
+ *
+ * @param[out] L         a square matrix of the same size as @p A. Stores the factor in
+ *                       its lower triangle upon completion.
+ * @param[in]  A         a symmetric matrix
+ * @param[in]  shift_min first shift tried. Must be positive.
+ * @param[in]  shift_max largest shift allowed
+ * @param[out] shift     shift of the factored matrix, or the last one tried on failure
+ * @param[out] nretries  number of shifts tried
+ * @return slap_kCholeskySuccess if successful, and slap_kCholeskyFail if even the largest
+ *         shift didn't make the matrix positive definite.
+ */
+int slap_CholeskyFactorizeRegularized(Matrix* L, const SymMatrix* A, sfloat shift_min,
+                                      sfloat shift_max, sfloat* shift, int* nretries);
+
+/**
+ * @brief Update a Cholesky decomposition for a low-rank change
+ *
+ * Overwrites the factor @p L of \f$ A \f$ with the factor of \f$ A + X X^T \f$, which
+ * is cheaper than factoring the new matrix when @p X has only a few columns.
+ * See slap_CholUpdate().
+ *
+ * @param[inout] L A square matrix whose Cholesky decomposition is stored in the lower
+ *                 triangular portion of the matrix, e.g. by slap_CholeskyFactorize()
+ * @param[inout] X A matrix with the same number of rows as @p L. Overwritten.
+ * @return slap_kCholeskySuccess
+ */
+int slap_CholeskyUpdate(Matrix* L, Matrix* X);
+
+/**
+ * @brief Downdate a Cholesky decomposition for a low-rank change
+ *
+ * Same as slap_CholeskyUpdate(), for \f$ A - X X^T \f$.
+ *
+ * @param[inout] L A square matrix whose Cholesky decomposition is stored in the lower
+ *                 triangular portion of the matrix
+ * @param[inout] X A matrix with the same number of rows as @p L. Overwritten.
+ * @return slap_kCholeskySuccess if successful, and slap_kCholeskyFail if
+ *         \f$ A - X X^T \f$ isn't positive definite, in which case @p L is invalid.
+ */
+int slap_CholeskyDowndate(Matrix* L, Matrix* X);
+
 /**
  * @brief Solve a linear system of equation with a precomputed Cholesky decomposition.
  *
  * @param[in]    A A square matrix whose Cholesky decomposition is stored in the lower
  *               triangular portion of the matrix
- * @param[inout] b The right-hand-side vector. Stores the solution upon completion of the
- *               function.
+ * @param[inout] b The right-hand-side vector, or a matrix with one right-hand side per
+ *               column. Stores the solution upon completion of the function.
  * @return 0 if successful
  */
 int slap_CholeskySolve(Matrix* A, Matrix* b);
 
+/**
+ * @brief Perform a Cholesky decomposition of a symmetric matrix in packed storage
+ *
+ * The lower-triangular factor overwrites @p A, in the same packed format.
+ *
+ * @param  A a symmetric matrix
+ * @return slap_kCholeskySuccess if successful, and slap_kCholeskyFail if not.
+ */
+int slap_SymCholeskyFactorize(SymMatrix* A);
+
+/**
+ * @brief Solve a linear system of equation with a packed Cholesky decomposition.
+ *
+ * @param[in]    L A symmetric matrix factored by slap_SymCholeskyFactorize()
+ * @param[inout] b The right-hand-side vector, or a matrix with one right-hand side per
+ *               column. Stores the solution upon completion of the function.
+ * @return 0 if successful
+ */
+int slap_SymCholeskySolve(const SymMatrix* L, Matrix* b);
+
+/**
+ * @brief LU factorization of a general square matrix, with partial pivoting
+ *
+ * Computes \f$ P A = L U \f$ in place, storing the strict lower triangle of the unit
+ * lower-triangular \f$ L \f$ and the upper triangle of \f$ U \f$ in @p A. Meant for
+ * the occasional small nonsymmetric system, so it is a simple unblocked loop.
+ *
+ * @param[inout] A    A square matrix. Stores the factors upon completion.
+ * @param[out]   ipiv Array of length `A->rows`. Row `i` was swapped with row `ipiv[i]`
+ *                    at step `i`.
+ * @return 0 if successful, or -1 if the matrix is singular
+ */
+int slap_LUFactorize(Matrix* A, int* ipiv);
+
+/**
+ * @brief Solve a linear system of equations with an LU factorization
+ *
+ * @param[in]    LU   A matrix factored by slap_LUFactorize()
+ * @param[in]    ipiv The pivots from slap_LUFactorize()
+ * @param[inout] b    The right-hand-side vector, or a matrix with one right-hand side per
+ *                    column. Stores the solution upon completion of the function.
+ * @return 0 if successful
+ */
+int slap_LUSolve(Matrix* LU, const int* ipiv, Matrix* b);
+
 /**
  * @brief Solve a linear system of equation for a lower triangular matrix
  *
@@ -157,13 +322,26 @@ int slap_CholeskySolve(Matrix* A, Matrix* b);
  */
 int slap_LowerTriBackSub(Matrix* L, Matrix* b, bool istransposed);
 
+/**
+ * @brief Multiply by a lower-triangular matrix
+ *
+ * Computes \f$ B = L B \f$, or \f$ B = L^T B \f$ if @p istransposed is true, in place.
+ * Only the lower triangle of @p L is read. See slap_Trmm().
+ *
+ * @param[in]    L            A lower-triangular matrix
+ * @param[inout] B            A matrix with as many rows as @p L
+ * @param        istransposed Should @p L be transposed
+ * @return 0 if successful
+ */
+int slap_LowerTriMultiply(Matrix* L, Matrix* B, bool istransposed);
+
 /**
  * @brief Evaluate the 2-norm of a matrix or vector
  *
  * @param M Matrix with valid data
  * @return 2-norm, or -1 if error
  */
-double slap_TwoNorm(const Matrix* M);
+sfloat slap_TwoNorm(const Matrix* M);
 
 /**
  * @brief Evaluat the 1-norm of a matrix or vector
@@ -171,7 +349,7 @@ double slap_TwoNorm(const Matrix* M);
  * @param M Matrix with valid data
  * @return 1-norm of the matrix, or -1 if error.
  */
-double slap_OneNorm(const Matrix* M);
+sfloat slap_OneNorm(const Matrix* M);
 
 /**
  * @brief Calculate the dot product of two vectors
@@ -180,7 +358,7 @@ double slap_OneNorm(const Matrix* M);
  * @param y A vector of length n
  * @return Dot product of x,y. NAN if invalid.
  */
-double slap_DotProduct(const Matrix* x, const Matrix* y);
+sfloat slap_DotProduct(const Matrix* x, const Matrix* y);
 
 /**
  * @brief Calculate the scaled inner product \f$ x^T A y \f$
@@ -190,6 +368,78 @@ double slap_DotProduct(const Matrix* x, const Matrix* y);
  * @param y A vector of length m
  * @return The dot product, or NAN if invalid.
  */
-double slap_QuadraticForm(const Matrix* x, const Matrix* A, const Matrix* y);
+sfloat slap_QuadraticForm(const Matrix* x, const Matrix* A, const Matrix* y);
+
+/**
+ * @brief Calculate the quadratic form \f$ x^T A x \f$ for a symmetric matrix
+ *
+ * @param x A vector of length n
+ * @param A A symmetric matrix of size n
+ * @return The quadratic form, or NAN if invalid.
+ */
+sfloat slap_SymQuadraticForm(const Matrix* x, const SymMatrix* A);
+
+/*
+ * Batched routines
+ *
+ * These apply the same operation to every matrix of a BatchMatrix, vectorized across
+ * the batch. See batchmatrix.h.
+ */
+
+/**
+ * @brief Batched matrix addition
+ *
+ * Computes \f$ B = B + \alpha A \f$ for every matrix in the batch.
+ *
+ * @param[in]    A     Batch of matrices
+ * @param[inout] B     Batch of matrices of the same size as @p A
+ * @param[in]    alpha scalar on @p A
+ * @return 0 if successful
+ */
+int slap_BatchMatrixAddition(const BatchMatrix* A, BatchMatrix* B, sfloat alpha);
+
+/**
+ * @brief Batched matrix multiplication
+ *
+ * Computes \f$ C = \alpha op(A) op(B) + \beta C \f$ for every matrix in the batch.
+ * See slap_MatrixMultiply().
+ *
+ * @return 0 if successful
+ */
+int slap_BatchMatrixMultiply(const BatchMatrix* A, const BatchMatrix* B, BatchMatrix* C, bool tA,
+                             bool tB, sfloat alpha, sfloat beta);
+
+/**
+ * @brief Batched Cholesky decomposition
+ *
+ * Factors every matrix in the batch, storing each factor in its lower triangle.
+ * See slap_BatchPotrf().
+ *
+ * @param  A batch of square symmetric matrices
+ * @return slap_kCholeskySuccess if every matrix was factored, and otherwise a bit mask
+ *         with bit `b` set if matrix `b` of the batch is not positive definite.
+ */
+int slap_BatchCholeskyFactorize(BatchMatrix* A);
+
+/**
+ * @brief Solve a batch of linear systems with precomputed Cholesky decompositions.
+ *
+ * @param[in]    L batch of matrices factored by slap_BatchCholeskyFactorize()
+ * @param[inout] b batch of right-hand sides. Stores the solutions upon completion.
+ * @return 0 if successful
+ */
+int slap_BatchCholeskySolve(const BatchMatrix* L, BatchMatrix* b);
+
+/**
+ * @brief Solve a batch of lower-triangular systems
+ *
+ * Same as slap_LowerTriBackSub(), for every matrix in the batch.
+ *
+ * @param[in]          L batch of lower-triangular matrices
+ * @param[inout]       b batch of right-hand sides. Stores the solutions upon completion.
+ * @param istransposed Should @p L be transposed when solving the system of equations.
+ * @return 0 if successful
+ */
+int slap_BatchLowerTriBackSub(const BatchMatrix* L, BatchMatrix* b, bool istransposed);
 
 /**@} */
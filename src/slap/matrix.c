@@ -10,24 +10,58 @@
 #include <stdlib.h>
 #include <string.h>
 
+void* slap_AlignedAlloc(size_t size) {
+  // aligned_alloc requires a multiple of the alignment
+  size_t aligned_size = (size + SLAP_ALIGNMENT - 1) / SLAP_ALIGNMENT * SLAP_ALIGNMENT;
+  return aligned_alloc(SLAP_ALIGNMENT, aligned_size > 0 ? aligned_size : SLAP_ALIGNMENT);
+}
+
+int slap_AlignedLength(int len) {
+  const int align = SLAP_ALIGNMENT / sizeof(sfloat);
+  return (len + align - 1) / align * align;
+}
+
+int slap_PaddedLeadingDim(int rows) {
+  const int pad = SLAP_PADDING / sizeof(sfloat);
+  return (rows + pad - 1) / pad * pad;
+}
+
 Matrix slap_NewMatrix(int rows, int cols) {
-  double* data = (double*)malloc(rows * cols * sizeof(double));
-  Matrix mat = {rows, cols, data};
+  sfloat* data = (sfloat*)slap_AlignedAlloc(rows * cols * sizeof(sfloat));
+  Matrix mat = {rows, cols, data, rows};
   return mat;
 }
 
 Matrix slap_NewMatrixZeros(int rows, int cols) {
-  double* data = (double*)calloc(rows * cols, sizeof(double));
-  Matrix mat = {rows, cols, data};
+  size_t size = rows * cols * sizeof(sfloat);
+  sfloat* data = (sfloat*)slap_AlignedAlloc(size);
+  if (data) {
+    memset(data, 0, size);
+  }
+  Matrix mat = {rows, cols, data, rows};
+  return mat;
+}
+
+Matrix slap_NewMatrixPadded(int rows, int cols) {
+  int ld = slap_PaddedLeadingDim(rows);
+  size_t size = ld * cols * sizeof(sfloat);
+  sfloat* data = (sfloat*)slap_AlignedAlloc(size);
+  if (data) {
+    memset(data, 0, size);
+  }
+  Matrix mat = {rows, cols, data, ld};
   return mat;
 }
 
-int slap_MatrixSetConst(Matrix* mat, double val) {
+int slap_MatrixSetConst(Matrix* mat, sfloat val) {
   if (!mat) {
     return -1;
   }
-  for (int i = 0; i < slap_MatrixNumElements(mat); ++i) {
-    mat->data[i] = val;
+  int ld = slap_MatrixLeadingDim(mat);
+  for (int j = 0; j < mat->cols; ++j) {
+    for (int i = 0; i < mat->rows; ++i) {
+      mat->data[i + j * ld] = val;
+    }
   }
   return 0;
 }
@@ -50,6 +84,28 @@ int slap_MatrixNumElements(const Matrix* mat) {
   return mat->rows * mat->cols;
 }
 
+int slap_MatrixLeadingDim(const Matrix* mat) { return mat->ld > 0 ? mat->ld : mat->rows; }
+
+bool slap_MatrixIsContiguous(const Matrix* mat) {
+  return mat->cols <= 1 || slap_MatrixLeadingDim(mat) == mat->rows;
+}
+
+Matrix slap_MatrixView(const Matrix* mat, int row, int col, int rows, int cols) {
+  Matrix view = {rows, cols, NULL, 0};
+  if (!mat) {
+    return view;
+  }
+  if (row < 0 || col < 0 || rows < 0 || cols < 0 || row + rows > mat->rows ||
+      col + cols > mat->cols) {
+    fprintf(stderr, "Block of size (%d,%d) at (%d,%d) doesn't fit in a (%d,%d) matrix.\n", rows,
+            cols, row, col, mat->rows, mat->cols);
+    return view;
+  }
+  view.ld = slap_MatrixLeadingDim(mat);
+  view.data = mat->data + row + col * view.ld;
+  return view;
+}
+
 int slap_MatrixGetLinearIndex(const Matrix* mat, int row, int col) {
   if (!mat) {
     return -1;
@@ -57,18 +113,18 @@ int slap_MatrixGetLinearIndex(const Matrix* mat, int row, int col) {
   if (row < 0 || col < 0) {
     return -1;
   }
-  return row + mat->rows * col;
+  return row + slap_MatrixLeadingDim(mat) * col;
 }
 
-double* slap_MatrixGetElement(const Matrix* mat, int row, int col) {
+sfloat* slap_MatrixGetElement(const Matrix* mat, int row, int col) {
   if (!mat) {
     return NULL;
   }
   return mat->data + slap_MatrixGetLinearIndex(mat, row, col);
 }
 
-double* slap_MatrixGetElementTranspose(const Matrix* mat, int row, int col, bool istranposed) {
-  double* out;
+sfloat* slap_MatrixGetElementTranspose(const Matrix* mat, int row, int col, bool istranposed) {
+  sfloat* out;
   if (!istranposed) {
     out = slap_MatrixGetElement(mat, row, col);
   } else {
@@ -79,7 +135,7 @@ double* slap_MatrixGetElementTranspose(const Matrix* mat, int row, int col, bool
   return out;
 }
 
-int slap_MatrixSetElement(Matrix* mat, int row, int col, double val) {
+int slap_MatrixSetElement(Matrix* mat, int row, int col, sfloat val) {
   if (!mat) {
     return -1;
   }
@@ -100,17 +156,27 @@ int slap_MatrixCopy(Matrix* dest, Matrix* src) {
     fprintf(stderr, "Can't copy matrices of different sizes.\n");
     return -1;
   }
-  memcpy(dest->data, src->data, slap_MatrixNumElements(dest) * sizeof(double));  // NOLINT
+  if (slap_MatrixIsContiguous(dest) && slap_MatrixIsContiguous(src)) {
+    memcpy(dest->data, src->data, slap_MatrixNumElements(dest) * sizeof(sfloat));  // NOLINT
+    return 0;
+  }
+  int ld_dest = slap_MatrixLeadingDim(dest);
+  int ld_src = slap_MatrixLeadingDim(src);
+  for (int j = 0; j < src->cols; ++j) {
+    memcpy(dest->data + j * ld_dest, src->data + j * ld_src, src->rows * sizeof(sfloat));
+  }
   return 0;
 }
 
-int slap_MatrixCopyFromArray(Matrix* mat, const double* data) {
+int slap_MatrixCopyFromArray(Matrix* mat, const sfloat* data) {
   if (!mat) {
     return -1;
   }
-  int len = slap_MatrixNumElements(mat);
-  for (int i = 0; i < len; ++i) {
-    mat->data[i] = data[i];
+  int ld = slap_MatrixLeadingDim(mat);
+  for (int j = 0; j < mat->cols; ++j) {
+    for (int i = 0; i < mat->rows; ++i) {
+      mat->data[i + j * ld] = data[i + j * mat->rows];
+    }
   }
   return 0;
 }
@@ -134,17 +200,20 @@ int slap_MatrixCopyTranspose(Matrix* dest, Matrix* src) {
   return 0;
 }
 
-int slap_MatrixScaleByConst(Matrix* mat, double alpha) {
+int slap_MatrixScaleByConst(Matrix* mat, sfloat alpha) {
   if (!mat) {
     return -1;
   }
-  for (int i = 0; i < slap_MatrixNumElements(mat); ++i) {
-    mat->data[i] *= alpha;
+  int ld = slap_MatrixLeadingDim(mat);
+  for (int j = 0; j < mat->cols; ++j) {
+    for (int i = 0; i < mat->rows; ++i) {
+      mat->data[i + j * ld] *= alpha;
+    }
   }
   return 0;
 }
 
-double slap_MatrixNormedDifference(Matrix* A, Matrix* B) {
+sfloat slap_MatrixNormedDifference(Matrix* A, Matrix* B) {
   if (!A || !B) {
     return INFINITY;
   }
@@ -154,10 +223,14 @@ double slap_MatrixNormedDifference(Matrix* A, Matrix* B) {
     return INFINITY;
   }
 
-  double diff = 0;
-  for (int i = 0; i < slap_MatrixNumElements(A); ++i) {
-    double d = A->data[i] - B->data[i];
-    diff += d * d;
+  sfloat diff = 0;
+  int ldA = slap_MatrixLeadingDim(A);
+  int ldB = slap_MatrixLeadingDim(B);
+  for (int j = 0; j < A->cols; ++j) {
+    for (int i = 0; i < A->rows; ++i) {
+      sfloat d = A->data[i + j * ldA] - B->data[i + j * ldB];
+      diff += d * d;
+    }
   }
   return sqrt(diff);
 }
@@ -166,9 +239,14 @@ int slap_MatrixFlatten(Matrix* mat) {
   if (!mat) {
     return -1;
   }
+  if (!slap_MatrixIsContiguous(mat)) {
+    fprintf(stderr, "Can't flatten a matrix whose columns aren't contiguous.\n");
+    return -1;
+  }
   int size = slap_MatrixNumElements(mat);
   mat->rows = size;
   mat->cols = 1;
+  mat->ld = size;
   return 0;
 }
 
@@ -176,9 +254,14 @@ int slap_MatrixFlattenToRow(Matrix* mat) {
   if (!mat) {
     return -1;
   }
+  if (!slap_MatrixIsContiguous(mat)) {
+    fprintf(stderr, "Can't flatten a matrix whose columns aren't contiguous.\n");
+    return -1;
+  }
   int size = slap_MatrixNumElements(mat);
   mat->rows = 1;
   mat->cols = size;
+  mat->ld = 1;
   return 0;
 }
 
@@ -200,8 +283,10 @@ int slap_PrintRowVector(const Matrix* mat) {
     return -1;
   }
   printf("[ ");
-  for (int i = 0; i < slap_MatrixNumElements(mat); ++i) {
-    printf("% 6.*g ", PRECISION, mat->data[i]);
+  for (int col = 0; col < mat->cols; ++col) {
+    for (int row = 0; row < mat->rows; ++row) {
+      printf("% 6.*g ", PRECISION, *slap_MatrixGetElement(mat, row, col));
+    }
   }
   printf("]\n");
   return 0;
@@ -217,5 +302,6 @@ int slap_SetMatrixSize(Matrix* mat, int rows, int cols) {
   }
   mat->rows = rows;
   mat->cols = cols;
+  mat->ld = rows;
   return 0;
 }
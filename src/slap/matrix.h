@@ -13,14 +13,58 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
+
+#include "scalar.h"
+
+#ifdef SLAP_CHECK_BOUNDS
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @brief Abort with a message if @p cond is false
+ *
+ * Used for the index and size checks of the inline accessors and the hot linear algebra
+ * routines, which are only compiled in when `SLAP_CHECK_BOUNDS` is defined. The CMake
+ * option `ULQR_CHECK_BOUNDS` defines it, and it is always on for Debug builds.
+ */
+#define SLAP_CHECK(cond)                                                             \
+  ((cond) ? (void)0                                                                  \
+          : (fprintf(stderr, "%s:%d: slap check failed: %s\n", __FILE__, __LINE__, #cond), \
+             abort()))
+#else
+#define SLAP_CHECK(cond) ((void)0)
+#endif
+
+#ifndef SLAP_ALIGNMENT
+/**
+ * @brief Alignment, in bytes, of the data allocated by slap
+ *
+ * One cache line, so that separately-allocated blocks never share one.
+ */
+#define SLAP_ALIGNMENT 64
+#endif
+
+#ifndef SLAP_PADDING
+/**
+ * @brief Columns of padded matrices are a multiple of this many bytes (see
+ * slap_NewMatrixPadded())
+ *
+ * One AVX2 vector by default. Can also be set to 64, i.e. one cache line or AVX-512 vector.
+ */
+#define SLAP_PADDING 32
+#endif
 
 /**
- * @brief Represents a matrix of double-precision data
+ * @brief Represents a matrix of floating-point data (see sfloat)
  *
  * Simple wrapper around an arbitrary pointer to the underlying data.
- * The data is assumed to be stored in a contiguous block of memory.
  * The data is interpreted column-wise, such that `data[1]` is element `[1,0]` of the
- * matrix.
+ * matrix. Element `[i,j]` is stored at `data[i + j * ld]`, where the leading dimension
+ * `ld` is the distance in memory between the start of adjacent columns. For a matrix
+ * stored in a contiguous block of memory, `ld` is equal to the number of rows, while
+ * a larger leading dimension describes a block of a larger matrix (see slap_MatrixView()).
+ * Every slap routine respects the leading dimension.
  *
  * ## Initialization
  * A Matrix can be initialized a few ways. The easiest is via `NewMatrix`:
@@ -29,15 +73,26 @@
  * Matrix mat = slap_NewMatrix(rows, cols);
  * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
  * which allocates a new block of memory on the heap. It must be followed by a call to
- * FreeMatrix().
+ * FreeMatrix(). All the memory allocated by slap is aligned to SLAP_ALIGNMENT bytes.
+ * slap_NewMatrixPadded() also pads each column, so that every column is aligned.
  *
  * If the data for the matrix is already stored in an array, the default brace initializer
  * can be used:
  *
  * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
- * double data[6] = {1,2,3,4,5,6};
- * Matrix mat = {2, 3, data};
+ * sfloat data[6] = {1,2,3,4,5,6};
+ * Matrix mat = {2, 3, data, 2};
  * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * where the last entry is the leading dimension. A leading dimension of zero is
+ * interpreted as a contiguous matrix.
+ *
+ * ## Views
+ * A block of an existing matrix can be used in place, without copying, with
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * Matrix block = slap_MatrixView(&mat, row, col, rows, cols);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * The view shares the data of the original matrix, so it must not be freed.
  *
  * ## Methods
  * The following methods are defined for the Matrix type:
@@ -49,11 +104,14 @@
  * - MatrixScaleByConst()
  *
  * ### Indexing operations
+ * - MatrixView()
+ * - MatrixLeadingDim()
  * - MatrixNumElements()
  * - MatrixGetLinearIndex()
  * - MatrixGetElement()
  * - MatrixGetElementTranspose()
  * - MatrixSetElement()
+ * - slap_MatrixAt()
  *
  * ### Copying
  * - MatrixCopy()
@@ -71,13 +129,14 @@
 typedef struct {
   int rows;
   int cols;
-  double* data;
+  sfloat* data;
+  int ld;  ///< leading dimension. Zero is the same as `rows`.
 } Matrix;
 
 /**
  * @brief Allocate a new matrix on the heap
  *
- * Data will not be initialized. Wrapper around a call to `malloc`.
+ * Data will not be initialized. Wrapper around a call to slap_AlignedAlloc().
  * Must be followed by a call to `FreeMatrix`.
  *
  * @param rows number of rows in the matrix
@@ -89,7 +148,6 @@ Matrix slap_NewMatrix(int rows, int cols);
 /**
  * @brief Allocate a new matrix on the heap, initialized with zeros
  *
- * Data will not be initialized. Wrapper around a call to `malloc`.
  * Must be followed by a call to `FreeMatrix`.
  *
  * @param rows number of rows in the matrix
@@ -98,6 +156,46 @@ Matrix slap_NewMatrix(int rows, int cols);
  */
 Matrix slap_NewMatrixZeros(int rows, int cols);
 
+/**
+ * @brief Allocate a new matrix on the heap with padded columns, initialized with zeros
+ *
+ * The leading dimension is given by slap_PaddedLeadingDim(), so that every column starts
+ * on a SLAP_PADDING-byte boundary and never straddles more cache lines than it needs to.
+ * The matrix is not contiguous unless the number of rows is already a multiple of the
+ * padding. Must be followed by a call to `FreeMatrix`.
+ *
+ * @param rows number of rows in the matrix
+ * @param cols number of columns in the matrix
+ * @return A new matrix
+ */
+Matrix slap_NewMatrixPadded(int rows, int cols);
+
+/**
+ * @brief Allocate memory aligned to SLAP_ALIGNMENT bytes
+ *
+ * The size is rounded up to a multiple of the alignment. The memory should be released
+ * with `free`.
+ *
+ * @param size Number of bytes to allocate
+ * @return Pointer to the memory, or NULL if the allocation failed
+ */
+void* slap_AlignedAlloc(size_t size);
+
+/**
+ * @brief Round a length up so that a block of @p len values is a multiple of SLAP_ALIGNMENT
+ *
+ * Used to lay out several blocks in a single allocation, each starting on an aligned
+ * boundary.
+ */
+int slap_AlignedLength(int len);
+
+/**
+ * @brief Leading dimension of a padded matrix with @p rows rows
+ *
+ * Rounds @p rows up so that each column is a multiple of SLAP_PADDING bytes.
+ */
+int slap_PaddedLeadingDim(int rows);
+
 /**
  * @brief Sets all of the elements in a matrix to a single value
  *
@@ -105,7 +203,7 @@ Matrix slap_NewMatrixZeros(int rows, int cols);
  * @param val Value to which each element will be set
  * @return 0 if successful
  */
-int slap_MatrixSetConst(Matrix* mat, double val);
+int slap_MatrixSetConst(Matrix* mat, sfloat val);
 
 /**
  * @brief Free the data for a matrix
@@ -127,6 +225,46 @@ int slap_FreeMatrix(Matrix* mat);
  */
 int slap_MatrixNumElements(const Matrix* mat);
 
+/**
+ * @brief Get the leading dimension of a matrix
+ *
+ * @param mat Any matrix
+ * @return Distance in memory between the start of adjacent columns
+ */
+int slap_MatrixLeadingDim(const Matrix* mat);
+
+/**
+ * @brief Check if the columns of a matrix are adjacent in memory
+ *
+ * @param mat Any matrix
+ * @return true if the leading dimension is equal to the number of rows, or if the matrix
+ *         only has one column
+ */
+bool slap_MatrixIsContiguous(const Matrix* mat);
+
+/**
+ * @brief Create a view of a block of a matrix
+ *
+ * The view refers to the data of @p mat, with the same leading dimension, so any changes
+ * to the view are reflected in @p mat. It should NOT be passed to slap_FreeMatrix().
+ *
+ * ## Example
+ * For a matrix `AB` of size `(n, n+m)`, storing \f$ [A \; B] \f$:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * Matrix A = slap_MatrixView(&AB, 0, 0, n, n);
+ * Matrix B = slap_MatrixView(&AB, 0, n, n, m);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * @param mat  Parent matrix
+ * @param row  Row of @p mat with the first row of the block
+ * @param col  Column of @p mat with the first column of the block
+ * @param rows Number of rows in the block
+ * @param cols Number of columns in the block
+ * @return A matrix referring to the block. Has NULL data if the block doesn't fit inside
+ *         @p mat.
+ */
+Matrix slap_MatrixView(const Matrix* mat, int row, int col, int rows, int cols);
+
 /**
  * @brief Get the linear index for a given row and column in the matrix
  *
@@ -154,7 +292,7 @@ int slap_MatrixGetLinearIndex(const Matrix* mat, int row, int col);
  * @param istranposed Are the indicies for the transpose of A?
  * @return            Pointer to the data at the given element.
  */
-double* slap_MatrixGetElementTranspose(const Matrix* mat, int row, int col, bool istranposed);
+sfloat* slap_MatrixGetElementTranspose(const Matrix* mat, int row, int col, bool istranposed);
 
 /**
  * @brief The a matrix element to a given value
@@ -165,7 +303,7 @@ double* slap_MatrixGetElementTranspose(const Matrix* mat, int row, int col, bool
  * @param val Value to which the element should be set
  * @return    0 if successful
  */
-int slap_MatrixSetElement(Matrix* mat, int row, int col, double val);
+int slap_MatrixSetElement(Matrix* mat, int row, int col, sfloat val);
 
 /**
  * @brief Get the element of a matrix given row, column indices
@@ -175,7 +313,24 @@ int slap_MatrixSetElement(Matrix* mat, int row, int col, double val);
  * @param col Column index
  * @return A pointer to the element of the matrix. NULL for invalid input.
  */
-double* slap_MatrixGetElement(const Matrix* mat, int row, int col);
+sfloat* slap_MatrixGetElement(const Matrix* mat, int row, int col);
+
+/**
+ * @brief Get the element of a matrix without any checks
+ *
+ * Inline version of slap_MatrixGetElement() for inner loops, where the call and the
+ * checks would cost more than the arithmetic. The indices are only checked when
+ * `SLAP_CHECK_BOUNDS` is defined.
+ *
+ * @param mat Matrix with initialized data
+ * @param row Row index, in `[0, rows)`
+ * @param col Column index, in `[0, cols)`
+ * @return A pointer to the element of the matrix
+ */
+static inline sfloat* slap_MatrixAt(const Matrix* mat, int row, int col) {
+  SLAP_CHECK(row >= 0 && row < mat->rows && col >= 0 && col < mat->cols);
+  return mat->data + row + col * (mat->ld > 0 ? mat->ld : mat->rows);
+}
 
 /**
  * @brief Copy a matrix to another matrix, transposed
@@ -203,7 +358,7 @@ int slap_MatrixCopy(Matrix* dest, Matrix* src);
  * mat.cols.
  * @return 0 if successful
  */
-int slap_MatrixCopyFromArray(Matrix* mat, const double* data);
+int slap_MatrixCopyFromArray(Matrix* mat, const sfloat* data);
 
 /**
  * @brief Scale a matrix by a constant factor
@@ -212,7 +367,7 @@ int slap_MatrixCopyFromArray(Matrix* mat, const double* data);
  * @param alpha scalar by which to multiply the matrix
  * @return 0 if successsful
  */
-int slap_MatrixScaleByConst(Matrix* mat, double alpha);
+int slap_MatrixScaleByConst(Matrix* mat, sfloat alpha);
 
 /**
  * @brief Return the normed difference between 2 matrices of the same size
@@ -223,7 +378,7 @@ int slap_MatrixScaleByConst(Matrix* mat, double alpha);
  * @param B A matrix of dimension (m,n)
  * @return
  */
-double slap_MatrixNormedDifference(Matrix* A, Matrix* B);
+sfloat slap_MatrixNormedDifference(Matrix* A, Matrix* B);
 
 /**
  * @brief Flatten a 2D matrix to a column vector
@@ -231,7 +386,7 @@ double slap_MatrixNormedDifference(Matrix* A, Matrix* B);
  * Changes the row and column data so that the matrix is now a column vector. The
  * underlying data is unchanged.
  *
- * @param mat Matrix to be flattened.
+ * @param mat Matrix to be flattened. Must be contiguous.
  * @return 0 if successful
  */
 int slap_MatrixFlatten(Matrix* mat);
@@ -242,7 +397,7 @@ int slap_MatrixFlatten(Matrix* mat);
  * Changes the row and column data so that the matrix is now a row vector. The
  * underlying data is unchanged.
  *
- * @param mat Matrix to be flattened
+ * @param mat Matrix to be flattened. Must be contiguous.
  * @return 0 if successful
  */
 int slap_MatrixFlattenToRow(Matrix* mat);
@@ -271,6 +426,7 @@ int slap_PrintRowVector(const Matrix* mat);
  * @brief Set the dimensions of the matrix
  *
  * Note that this does not change the underlying data, only it's interpretation.
+ * The matrix is assumed to be contiguous, i.e. the leading dimension is set to @p rows.
  *
  * @param mat  Matrix
  * @param rows New number of rows
@@ -0,0 +1,171 @@
+#include <math.h>
+
+#include "slap/kernels.h"
+#include "slap/simd.h"
+
+enum {
+  kPackedNR = 4,  ///< columns of the right-hand side sharing each load of a packed column
+};
+
+static inline int MinInt(int a, int b) { return a < b ? a : b; }
+
+/* Offset to the start (i.e. the diagonal) of column j of a packed matrix of size n */
+static inline int PackedColumn(int n, int j) { return j * (2 * n - j + 1) / 2; }
+
+/* y += alpha * x */
+static inline void Axpy(int len, sfloat alpha, const sfloat* x, sfloat* y) {
+  slap_Vec a = slap_VecBroadcast(alpha);
+  int i = 0;
+  for (; i + SLAP_VLEN <= len; i += SLAP_VLEN) {
+    slap_VecStore(y + i, slap_VecFma(slap_VecLoad(x + i), a, slap_VecLoad(y + i)));
+  }
+  if (i < len) {
+    int rem = len - i;
+    slap_Vec v = slap_VecFma(slap_VecLoadPartial(x + i, rem), a, slap_VecLoadPartial(y + i, rem));
+    slap_VecStorePartial(y + i, v, rem);
+  }
+}
+
+/*
+ * C += alpha * A * B for nr <= kPackedNR columns of B. The strictly-lower part of column j
+ * of A multiplies B[j,:] into the rows of C below j, and, as row j of the upper triangle,
+ * is dotted with the rows of B below j to add to C[j,:].
+ */
+static inline void SpmmTile(int nr, int n, sfloat alpha, const sfloat* Ap, const sfloat* B,
+                            int ldb, sfloat* C, int ldc) {
+  const sfloat* Aj = Ap;
+  for (int j = 0; j < n; ++j) {
+    slap_Vec x[kPackedNR];
+    slap_Vec acc[kPackedNR];
+    for (int jj = 0; jj < nr; ++jj) {
+      sfloat bj = alpha * B[j + jj * ldb];
+      C[j + jj * ldc] += Aj[0] * bj;
+      x[jj] = slap_VecBroadcast(bj);
+      acc[jj] = slap_VecZero();
+    }
+    const sfloat* a = Aj + 1;
+    int len = n - j - 1;
+    int r = 0;
+    for (; r + SLAP_VLEN <= len; r += SLAP_VLEN) {
+      slap_Vec l = slap_VecLoad(a + r);
+      for (int jj = 0; jj < nr; ++jj) {
+        sfloat* Crj = C + (j + 1 + r) + jj * ldc;
+        slap_VecStore(Crj, slap_VecFma(l, x[jj], slap_VecLoad(Crj)));
+        acc[jj] = slap_VecFma(l, slap_VecLoad(B + (j + 1 + r) + jj * ldb), acc[jj]);
+      }
+    }
+    if (r < len) {
+      int rem = len - r;
+      slap_Vec l = slap_VecLoadPartial(a + r, rem);
+      for (int jj = 0; jj < nr; ++jj) {
+        sfloat* Crj = C + (j + 1 + r) + jj * ldc;
+        slap_VecStorePartial(Crj, slap_VecFma(l, x[jj], slap_VecLoadPartial(Crj, rem)), rem);
+        acc[jj] = slap_VecFma(l, slap_VecLoadPartial(B + (j + 1 + r) + jj * ldb, rem), acc[jj]);
+      }
+    }
+    for (int jj = 0; jj < nr; ++jj) {
+      C[j + jj * ldc] += alpha * slap_VecSum(acc[jj]);
+    }
+    Aj += n - j;
+  }
+}
+
+void slap_Spmm(int n, int nrhs, sfloat alpha, const sfloat* Ap, const sfloat* B, int ldb,
+               sfloat beta, sfloat* C, int ldc) {
+  if (beta != 1.0) {
+    for (int j = 0; j < nrhs; ++j) {
+      sfloat* Cj = C + j * ldc;
+      for (int i = 0; i < n; ++i) {
+        Cj[i] = beta == 0.0 ? 0.0 : beta * Cj[i];
+      }
+    }
+  }
+  for (int j = 0; j < nrhs; j += kPackedNR) {
+    int nr = MinInt(kPackedNR, nrhs - j);
+    if (nr == kPackedNR) {
+      SpmmTile(kPackedNR, n, alpha, Ap, B + j * ldb, ldb, C + j * ldc, ldc);
+    } else {
+      SpmmTile(nr, n, alpha, Ap, B + j * ldb, ldb, C + j * ldc, ldc);
+    }
+  }
+}
+
+int slap_Pptrf(int n, sfloat* Ap) {
+  sfloat* Lj = Ap;
+  for (int j = 0; j < n; ++j) {
+    int len = n - j;
+
+    // L[j:,j] -= L[j:,0:j] * L[j,0:j]'
+    const sfloat* Lk = Ap;
+    for (int k = 0; k < j; ++k) {
+      const sfloat* Ljk = Lk + (j - k);
+      Axpy(len, -Ljk[0], Ljk, Lj);
+      Lk += n - k;
+    }
+
+    sfloat ljj = Lj[0];
+    if (ljj <= 0) {
+      return j + 1;
+    }
+    sfloat scale = 1.0 / sqrt(ljj);
+    for (int i = 0; i < len; ++i) {
+      Lj[i] *= scale;
+    }
+    Lj += len;
+  }
+  return 0;
+}
+
+/* Solve L L' X = B for nr <= kPackedNR columns of B */
+static inline void PptrsTile(int nr, int n, const sfloat* Lp, sfloat* B, int ldb) {
+  // Forward substitution, eliminating each solved row from the rows below it
+  const sfloat* Li = Lp;
+  for (int i = 0; i < n; ++i) {
+    for (int jj = 0; jj < nr; ++jj) {
+      sfloat* Bj = B + jj * ldb;
+      Bj[i] /= Li[0];
+      Axpy(n - i - 1, -Bj[i], Li + 1, Bj + i + 1);
+    }
+    Li += n - i;
+  }
+
+  // Back substitution, with each row a dot product with the rows already solved
+  for (int i = n - 1; i >= 0; --i) {
+    Li = Lp + PackedColumn(n, i);
+    slap_Vec acc[kPackedNR];
+    for (int jj = 0; jj < nr; ++jj) {
+      acc[jj] = slap_VecZero();
+    }
+    const sfloat* a = Li + 1;
+    int len = n - i - 1;
+    int r = 0;
+    for (; r + SLAP_VLEN <= len; r += SLAP_VLEN) {
+      slap_Vec l = slap_VecLoad(a + r);
+      for (int jj = 0; jj < nr; ++jj) {
+        acc[jj] = slap_VecFma(l, slap_VecLoad(B + (i + 1 + r) + jj * ldb), acc[jj]);
+      }
+    }
+    if (r < len) {
+      int rem = len - r;
+      slap_Vec l = slap_VecLoadPartial(a + r, rem);
+      for (int jj = 0; jj < nr; ++jj) {
+        acc[jj] = slap_VecFma(l, slap_VecLoadPartial(B + (i + 1 + r) + jj * ldb, rem), acc[jj]);
+      }
+    }
+    for (int jj = 0; jj < nr; ++jj) {
+      sfloat* Bij = B + i + jj * ldb;
+      *Bij = (*Bij - slap_VecSum(acc[jj])) / Li[0];
+    }
+  }
+}
+
+void slap_Pptrs(int n, int nrhs, const sfloat* Lp, sfloat* B, int ldb) {
+  for (int j = 0; j < nrhs; j += kPackedNR) {
+    int nr = MinInt(kPackedNR, nrhs - j);
+    if (nr == kPackedNR) {
+      PptrsTile(kPackedNR, n, Lp, B + j * ldb, ldb);
+    } else {
+      PptrsTile(nr, n, Lp, B + j * ldb, ldb);
+    }
+  }
+}
@@ -0,0 +1,37 @@
+/**
+ * @file scalar.h
+ * @author Brian Jackson (bjack205@gmail.com)
+ * @brief Floating-point type used for all the numerical data
+ * @version 0.1
+ * @date 2022-02-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * The libraries are built in double precision by default. Defining `SLAP_USE_FLOAT`
+ * builds everything in single precision instead, which halves the memory traffic and
+ * doubles the number of values in each vector register, and is the only option with
+ * hardware support on many microcontrollers.
+ *
+ * The single-precision builds are the `slapf` and `riccatif` libraries, whose public
+ * symbols use the `slapf_` and `ulqrf_` prefixes so that they can be installed and linked
+ * alongside the double-precision ones. Code using them should define `SLAP_USE_FLOAT`
+ * (the CMake targets do this automatically) and keep using the usual names, which are
+ * mapped to the prefixed ones by float_names.h.
+ *
+ * @addtogroup LinearAlgebra
+ * @{
+ */
+#pragma once
+
+#ifdef SLAP_USE_FLOAT
+#include "float_names.h"
+
+/** @brief Floating-point type of all matrix data */
+typedef float sfloat;
+#else
+
+/** @brief Floating-point type of all matrix data */
+typedef double sfloat;
+#endif
+
+/**@} */
@@ -0,0 +1,378 @@
+/**
+ * @file simd.h
+ * @author Brian Jackson (bjack205@gmail.com)
+ * @brief Thin wrappers around the SIMD intrinsics used by the slap kernels
+ * @version 0.1
+ * @date 2022-02-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * The kernels are written against the small set of vector operations defined here, so
+ * that they compile to the widest instructions the compiler targets: AVX-512, AVX2/FMA,
+ * SSE2, or plain scalar code on other architectures. `SLAP_VLEN` is the number of values
+ * held by a single slap_Vec, which is twice as many in single precision (see scalar.h).
+ *
+ * On x86 the kernels are compiled once for each of these instruction sets and the one
+ * used is picked at runtime (see isa.h). Kernels that can't use 512-bit vectors, like the
+ * batched ones whose data layout is tied to the batch size, define `SLAP_SIMD_NO_AVX512`
+ * before including this header to get 256-bit vectors in the AVX-512 build.
+ *
+ * This header is internal to slap and should only be included by kernel source files.
+ *
+ * @ingroup LinearAlgebra
+ */
+#pragma once
+
+#include "scalar.h"
+
+#if defined(__AVX512F__) && !defined(SLAP_SIMD_NO_AVX512)
+#include <immintrin.h>
+
+#ifdef SLAP_USE_FLOAT
+#define SLAP_VLEN 16
+
+typedef __m512 slap_Vec;
+
+static inline slap_Vec slap_VecZero(void) { return _mm512_setzero_ps(); }
+static inline slap_Vec slap_VecBroadcast(sfloat x) { return _mm512_set1_ps(x); }
+static inline slap_Vec slap_VecLoad(const sfloat* x) { return _mm512_loadu_ps(x); }
+static inline void slap_VecStore(sfloat* x, slap_Vec v) { _mm512_storeu_ps(x, v); }
+static inline slap_Vec slap_VecMul(slap_Vec a, slap_Vec b) { return _mm512_mul_ps(a, b); }
+static inline slap_Vec slap_VecDiv(slap_Vec a, slap_Vec b) { return _mm512_div_ps(a, b); }
+static inline slap_Vec slap_VecSqrt(slap_Vec a) { return _mm512_sqrt_ps(a); }
+
+/** @brief Returns a * b + c */
+static inline slap_Vec slap_VecFma(slap_Vec a, slap_Vec b, slap_Vec c) {
+  return _mm512_fmadd_ps(a, b, c);
+}
+
+/** @brief Returns c - a * b */
+static inline slap_Vec slap_VecFnma(slap_Vec a, slap_Vec b, slap_Vec c) {
+  return _mm512_fnmadd_ps(a, b, c);
+}
+
+/** @brief Mask selecting the first @p len lanes, 0 <= len <= SLAP_VLEN */
+static inline __mmask16 slap_VecMask(int len) { return (__mmask16)((1u << len) - 1); }
+
+/** @brief Load the first @p len entries of @p x, setting the remaining lanes to zero */
+static inline slap_Vec slap_VecLoadPartial(const sfloat* x, int len) {
+  return _mm512_maskz_loadu_ps(slap_VecMask(len), x);
+}
+
+/** @brief Store the first @p len lanes of @p v, leaving the rest of @p x untouched */
+static inline void slap_VecStorePartial(sfloat* x, slap_Vec v, int len) {
+  _mm512_mask_storeu_ps(x, slap_VecMask(len), v);
+}
+
+/** @brief Sum of all the lanes */
+static inline sfloat slap_VecSum(slap_Vec v) { return _mm512_reduce_add_ps(v); }
+
+#else
+
+#define SLAP_VLEN 8
+
+typedef __m512d slap_Vec;
+
+static inline slap_Vec slap_VecZero(void) { return _mm512_setzero_pd(); }
+static inline slap_Vec slap_VecBroadcast(double x) { return _mm512_set1_pd(x); }
+static inline slap_Vec slap_VecLoad(const double* x) { return _mm512_loadu_pd(x); }
+static inline void slap_VecStore(double* x, slap_Vec v) { _mm512_storeu_pd(x, v); }
+static inline slap_Vec slap_VecMul(slap_Vec a, slap_Vec b) { return _mm512_mul_pd(a, b); }
+static inline slap_Vec slap_VecDiv(slap_Vec a, slap_Vec b) { return _mm512_div_pd(a, b); }
+static inline slap_Vec slap_VecSqrt(slap_Vec a) { return _mm512_sqrt_pd(a); }
+
+/** @brief Returns a * b + c */
+static inline slap_Vec slap_VecFma(slap_Vec a, slap_Vec b, slap_Vec c) {
+  return _mm512_fmadd_pd(a, b, c);
+}
+
+/** @brief Returns c - a * b */
+static inline slap_Vec slap_VecFnma(slap_Vec a, slap_Vec b, slap_Vec c) {
+  return _mm512_fnmadd_pd(a, b, c);
+}
+
+/** @brief Mask selecting the first @p len lanes, 0 <= len <= SLAP_VLEN */
+static inline __mmask8 slap_VecMask(int len) { return (__mmask8)((1u << len) - 1); }
+
+/** @brief Load the first @p len entries of @p x, setting the remaining lanes to zero */
+static inline slap_Vec slap_VecLoadPartial(const double* x, int len) {
+  return _mm512_maskz_loadu_pd(slap_VecMask(len), x);
+}
+
+/** @brief Store the first @p len lanes of @p v, leaving the rest of @p x untouched */
+static inline void slap_VecStorePartial(double* x, slap_Vec v, int len) {
+  _mm512_mask_storeu_pd(x, slap_VecMask(len), v);
+}
+
+/** @brief Sum of all the lanes */
+static inline double slap_VecSum(slap_Vec v) { return _mm512_reduce_add_pd(v); }
+
+#endif  // SLAP_USE_FLOAT
+
+#elif defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#include <stdint.h>
+
+#ifdef SLAP_USE_FLOAT
+#define SLAP_VLEN 8
+
+typedef __m256 slap_Vec;
+
+static inline slap_Vec slap_VecZero(void) { return _mm256_setzero_ps(); }
+static inline slap_Vec slap_VecBroadcast(sfloat x) { return _mm256_set1_ps(x); }
+static inline slap_Vec slap_VecLoad(const sfloat* x) { return _mm256_loadu_ps(x); }
+static inline void slap_VecStore(sfloat* x, slap_Vec v) { _mm256_storeu_ps(x, v); }
+static inline slap_Vec slap_VecMul(slap_Vec a, slap_Vec b) { return _mm256_mul_ps(a, b); }
+static inline slap_Vec slap_VecDiv(slap_Vec a, slap_Vec b) { return _mm256_div_ps(a, b); }
+static inline slap_Vec slap_VecSqrt(slap_Vec a) { return _mm256_sqrt_ps(a); }
+
+/** @brief Returns a * b + c */
+static inline slap_Vec slap_VecFma(slap_Vec a, slap_Vec b, slap_Vec c) {
+  return _mm256_fmadd_ps(a, b, c);
+}
+
+/** @brief Returns c - a * b */
+static inline slap_Vec slap_VecFnma(slap_Vec a, slap_Vec b, slap_Vec c) {
+  return _mm256_fnmadd_ps(a, b, c);
+}
+
+/** @brief Mask selecting the first @p len lanes, 0 <= len <= SLAP_VLEN */
+static inline __m256i slap_VecMask(int len) {
+  static const int32_t mask_table[2 * SLAP_VLEN] = {-1, -1, -1, -1, -1, -1, -1, -1,
+                                                    0,  0,  0,  0,  0,  0,  0,  0};
+  return _mm256_loadu_si256((const __m256i*)(mask_table + SLAP_VLEN - len));
+}
+
+/** @brief Load the first @p len entries of @p x, setting the remaining lanes to zero */
+static inline slap_Vec slap_VecLoadPartial(const sfloat* x, int len) {
+  if (len == SLAP_VLEN) {
+    return _mm256_loadu_ps(x);
+  }
+  return _mm256_maskload_ps(x, slap_VecMask(len));
+}
+
+/** @brief Store the first @p len lanes of @p v, leaving the rest of @p x untouched */
+static inline void slap_VecStorePartial(sfloat* x, slap_Vec v, int len) {
+  if (len == SLAP_VLEN) {
+    _mm256_storeu_ps(x, v);
+  } else {
+    _mm256_maskstore_ps(x, slap_VecMask(len), v);
+  }
+}
+
+/** @brief Sum of all the lanes */
+static inline sfloat slap_VecSum(slap_Vec v) {
+  __m128 lo = _mm256_castps256_ps128(v);
+  __m128 hi = _mm256_extractf128_ps(v, 1);
+  lo = _mm_add_ps(lo, hi);
+  lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+  lo = _mm_add_ss(lo, _mm_movehdup_ps(lo));
+  return _mm_cvtss_f32(lo);
+}
+
+#else
+
+#define SLAP_VLEN 4
+
+typedef __m256d slap_Vec;
+
+static inline slap_Vec slap_VecZero(void) { return _mm256_setzero_pd(); }
+static inline slap_Vec slap_VecBroadcast(double x) { return _mm256_set1_pd(x); }
+static inline slap_Vec slap_VecLoad(const double* x) { return _mm256_loadu_pd(x); }
+static inline void slap_VecStore(double* x, slap_Vec v) { _mm256_storeu_pd(x, v); }
+static inline slap_Vec slap_VecMul(slap_Vec a, slap_Vec b) { return _mm256_mul_pd(a, b); }
+static inline slap_Vec slap_VecDiv(slap_Vec a, slap_Vec b) { return _mm256_div_pd(a, b); }
+static inline slap_Vec slap_VecSqrt(slap_Vec a) { return _mm256_sqrt_pd(a); }
+
+/** @brief Returns a * b + c */
+static inline slap_Vec slap_VecFma(slap_Vec a, slap_Vec b, slap_Vec c) {
+  return _mm256_fmadd_pd(a, b, c);
+}
+
+/** @brief Returns c - a * b */
+static inline slap_Vec slap_VecFnma(slap_Vec a, slap_Vec b, slap_Vec c) {
+  return _mm256_fnmadd_pd(a, b, c);
+}
+
+/** @brief Mask selecting the first @p len lanes, 0 <= len <= SLAP_VLEN */
+static inline __m256i slap_VecMask(int len) {
+  static const int64_t mask_table[2 * SLAP_VLEN] = {-1, -1, -1, -1, 0, 0, 0, 0};
+  return _mm256_loadu_si256((const __m256i*)(mask_table + SLAP_VLEN - len));
+}
+
+/** @brief Load the first @p len entries of @p x, setting the remaining lanes to zero */
+static inline slap_Vec slap_VecLoadPartial(const double* x, int len) {
+  if (len == SLAP_VLEN) {
+    return _mm256_loadu_pd(x);
+  }
+  return _mm256_maskload_pd(x, slap_VecMask(len));
+}
+
+/** @brief Store the first @p len lanes of @p v, leaving the rest of @p x untouched */
+static inline void slap_VecStorePartial(double* x, slap_Vec v, int len) {
+  if (len == SLAP_VLEN) {
+    _mm256_storeu_pd(x, v);
+  } else {
+    _mm256_maskstore_pd(x, slap_VecMask(len), v);
+  }
+}
+
+/** @brief Sum of all the lanes */
+static inline double slap_VecSum(slap_Vec v) {
+  __m128d lo = _mm256_castpd256_pd128(v);
+  __m128d hi = _mm256_extractf128_pd(v, 1);
+  lo = _mm_add_pd(lo, hi);
+  __m128d swapped = _mm_unpackhi_pd(lo, lo);
+  return _mm_cvtsd_f64(_mm_add_sd(lo, swapped));
+}
+
+#endif  // SLAP_USE_FLOAT
+
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+
+/*
+ * SSE2 is part of every x86-64 CPU, so this is the baseline. There are no fused
+ * multiply-adds or masked loads, so those are emulated.
+ */
+#ifdef SLAP_USE_FLOAT
+#define SLAP_VLEN 4
+
+typedef __m128 slap_Vec;
+
+static inline slap_Vec slap_VecZero(void) { return _mm_setzero_ps(); }
+static inline slap_Vec slap_VecBroadcast(sfloat x) { return _mm_set1_ps(x); }
+static inline slap_Vec slap_VecLoad(const sfloat* x) { return _mm_loadu_ps(x); }
+static inline void slap_VecStore(sfloat* x, slap_Vec v) { _mm_storeu_ps(x, v); }
+static inline slap_Vec slap_VecMul(slap_Vec a, slap_Vec b) { return _mm_mul_ps(a, b); }
+static inline slap_Vec slap_VecDiv(slap_Vec a, slap_Vec b) { return _mm_div_ps(a, b); }
+static inline slap_Vec slap_VecSqrt(slap_Vec a) { return _mm_sqrt_ps(a); }
+
+/** @brief Returns a * b + c */
+static inline slap_Vec slap_VecFma(slap_Vec a, slap_Vec b, slap_Vec c) {
+  return _mm_add_ps(_mm_mul_ps(a, b), c);
+}
+
+/** @brief Returns c - a * b */
+static inline slap_Vec slap_VecFnma(slap_Vec a, slap_Vec b, slap_Vec c) {
+  return _mm_sub_ps(c, _mm_mul_ps(a, b));
+}
+
+/** @brief Load the first @p len entries of @p x, setting the remaining lanes to zero */
+static inline slap_Vec slap_VecLoadPartial(const sfloat* x, int len) {
+  switch (len) {
+    case 0:
+      return _mm_setzero_ps();
+    case 1:
+      return _mm_load_ss(x);
+    case 2:
+      return _mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)x));
+    case 3:
+      return _mm_movelh_ps(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)x)),
+                           _mm_load_ss(x + 2));
+    default:
+      return _mm_loadu_ps(x);
+  }
+}
+
+/** @brief Store the first @p len lanes of @p v, leaving the rest of @p x untouched */
+static inline void slap_VecStorePartial(sfloat* x, slap_Vec v, int len) {
+  switch (len) {
+    case 0:
+      break;
+    case 1:
+      _mm_store_ss(x, v);
+      break;
+    case 2:
+      _mm_storel_epi64((__m128i*)x, _mm_castps_si128(v));
+      break;
+    case 3:
+      _mm_storel_epi64((__m128i*)x, _mm_castps_si128(v));
+      _mm_store_ss(x + 2, _mm_movehl_ps(v, v));
+      break;
+    default:
+      _mm_storeu_ps(x, v);
+  }
+}
+
+/** @brief Sum of all the lanes */
+static inline sfloat slap_VecSum(slap_Vec v) {
+  __m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+  __m128 sums = _mm_add_ps(v, shuf);
+  shuf = _mm_movehl_ps(shuf, sums);
+  return _mm_cvtss_f32(_mm_add_ss(sums, shuf));
+}
+
+#else
+
+#define SLAP_VLEN 2
+
+typedef __m128d slap_Vec;
+
+static inline slap_Vec slap_VecZero(void) { return _mm_setzero_pd(); }
+static inline slap_Vec slap_VecBroadcast(double x) { return _mm_set1_pd(x); }
+static inline slap_Vec slap_VecLoad(const double* x) { return _mm_loadu_pd(x); }
+static inline void slap_VecStore(double* x, slap_Vec v) { _mm_storeu_pd(x, v); }
+static inline slap_Vec slap_VecMul(slap_Vec a, slap_Vec b) { return _mm_mul_pd(a, b); }
+static inline slap_Vec slap_VecDiv(slap_Vec a, slap_Vec b) { return _mm_div_pd(a, b); }
+static inline slap_Vec slap_VecSqrt(slap_Vec a) { return _mm_sqrt_pd(a); }
+
+/** @brief Returns a * b + c */
+static inline slap_Vec slap_VecFma(slap_Vec a, slap_Vec b, slap_Vec c) {
+  return _mm_add_pd(_mm_mul_pd(a, b), c);
+}
+
+/** @brief Returns c - a * b */
+static inline slap_Vec slap_VecFnma(slap_Vec a, slap_Vec b, slap_Vec c) {
+  return _mm_sub_pd(c, _mm_mul_pd(a, b));
+}
+
+/** @brief Load the first @p len entries of @p x, setting the remaining lanes to zero */
+static inline slap_Vec slap_VecLoadPartial(const double* x, int len) {
+  if (len == SLAP_VLEN) {
+    return _mm_loadu_pd(x);
+  }
+  return len ? _mm_load_sd(x) : _mm_setzero_pd();
+}
+
+/** @brief Store the first @p len lanes of @p v, leaving the rest of @p x untouched */
+static inline void slap_VecStorePartial(double* x, slap_Vec v, int len) {
+  if (len == SLAP_VLEN) {
+    _mm_storeu_pd(x, v);
+  } else if (len) {
+    _mm_store_sd(x, v);
+  }
+}
+
+/** @brief Sum of all the lanes */
+static inline double slap_VecSum(slap_Vec v) {
+  return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+#endif  // SLAP_USE_FLOAT
+
+#else
+#include <math.h>
+
+#define SLAP_VLEN 1
+
+typedef sfloat slap_Vec;
+
+static inline slap_Vec slap_VecZero(void) { return 0.0; }
+static inline slap_Vec slap_VecBroadcast(sfloat x) { return x; }
+static inline slap_Vec slap_VecLoad(const sfloat* x) { return *x; }
+static inline void slap_VecStore(sfloat* x, slap_Vec v) { *x = v; }
+static inline slap_Vec slap_VecMul(slap_Vec a, slap_Vec b) { return a * b; }
+static inline slap_Vec slap_VecDiv(slap_Vec a, slap_Vec b) { return a / b; }
+static inline slap_Vec slap_VecSqrt(slap_Vec a) { return sqrt(a); }
+static inline slap_Vec slap_VecFma(slap_Vec a, slap_Vec b, slap_Vec c) { return a * b + c; }
+static inline slap_Vec slap_VecFnma(slap_Vec a, slap_Vec b, slap_Vec c) { return c - a * b; }
+static inline slap_Vec slap_VecLoadPartial(const sfloat* x, int len) { return len ? *x : 0.0; }
+static inline void slap_VecStorePartial(sfloat* x, slap_Vec v, int len) {
+  if (len) {
+    *x = v;
+  }
+}
+static inline sfloat slap_VecSum(slap_Vec v) { return v; }
+
+#endif
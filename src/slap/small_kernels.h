@@ -0,0 +1,224 @@
+/**
+ * @file small_kernels.h
+ * @author Brian Jackson (bjack205@gmail.com)
+ * @brief Inline kernels for small matrices whose dimensions are known at compile time
+ * @version 0.1
+ * @date 2022-02-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * Simple loop versions of the kernels in kernels.h, defined in the header so that they
+ * can be inlined into the caller. When they are called with compile-time constant sizes,
+ * as in the fixed-dimension build of the Riccati solver, the compiler sees every trip
+ * count and can fully unroll and vectorize the loops. For small matrices this removes
+ * the loop overhead and the dispatch through the kernel table, which dominate the cost
+ * of the general kernels at those sizes.
+ *
+ * With runtime sizes they are correct, but slower than the kernels in kernels.h for all
+ * but the smallest matrices. Like those, they take raw pointers to column-major data
+ * along with a leading dimension. Symmetric matrices in the packed format of
+ * symmatrix.h are passed as a pointer to the packed data.
+ *
+ * @ingroup LinearAlgebra
+ * @{
+ */
+#pragma once
+
+#include <math.h>
+#include <stdbool.h>
+
+#include "scalar.h"
+
+#if defined(__clang__)
+#define SLAP_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__)
+#define SLAP_UNROLL _Pragma("GCC unroll 16")
+#else
+/** @brief Asks the compiler to fully unroll the following loop */
+#define SLAP_UNROLL
+#endif
+
+/** @brief Offset to element `[i,j]`, with `i >= j`, of a packed symmetric matrix of size n */
+static inline int slap_SmallPackedIndex(int n, int i, int j) {
+  return i + j * (2 * n - j - 1) / 2;
+}
+
+/** @brief Same as slap_Gemm() */
+static inline void slap_SmallGemm(bool tA, bool tB, int m, int n, int k, sfloat alpha,
+                                  const sfloat* A, int lda, const sfloat* B, int ldb,
+                                  sfloat beta, sfloat* C, int ldc) {
+  for (int j = 0; j < n; ++j) {
+    sfloat* Cj = C + j * ldc;
+    SLAP_UNROLL
+    for (int i = 0; i < m; ++i) {
+      Cj[i] = beta == 0 ? 0 : beta * Cj[i];
+    }
+    for (int l = 0; l < k; ++l) {
+      sfloat b = alpha * (tB ? B[j + l * ldb] : B[l + j * ldb]);
+      SLAP_UNROLL
+      for (int i = 0; i < m; ++i) {
+        Cj[i] += (tA ? A[l + i * lda] : A[i + l * lda]) * b;
+      }
+    }
+  }
+}
+
+/** @brief Same as slap_Syrk() */
+static inline void slap_SmallSyrk(bool mirror, int n, int k, sfloat alpha, const sfloat* X,
+                                  int ldx, sfloat beta, sfloat* C, int ldc) {
+  for (int j = 0; j < n; ++j) {
+    const sfloat* Xj = X + j * ldx;
+    for (int i = j; i < n; ++i) {
+      const sfloat* Xi = X + i * ldx;
+      sfloat sum = 0;
+      SLAP_UNROLL
+      for (int l = 0; l < k; ++l) {
+        sum += Xi[l] * Xj[l];
+      }
+      sfloat* Cij = C + i + j * ldc;
+      *Cij = alpha * sum + (beta == 0 ? 0 : beta * (*Cij));
+      if (mirror) {
+        C[j + i * ldc] = *Cij;
+      }
+    }
+  }
+}
+
+/** @brief Same as slap_Spmm() */
+static inline void slap_SmallSpmm(int n, int nrhs, sfloat alpha, const sfloat* Ap,
+                                  const sfloat* B, int ldb, sfloat beta, sfloat* C, int ldc) {
+  for (int j = 0; j < nrhs; ++j) {
+    const sfloat* Bj = B + j * ldb;
+    sfloat* Cj = C + j * ldc;
+    SLAP_UNROLL
+    for (int i = 0; i < n; ++i) {
+      Cj[i] = beta == 0 ? 0 : beta * Cj[i];
+    }
+    const sfloat* Al = Ap;
+    for (int l = 0; l < n; ++l) {
+      // Column l of the lower triangle, which is also row l of the upper triangle
+      sfloat b = alpha * Bj[l];
+      sfloat dot = 0;
+      Cj[l] += Al[0] * b;
+      SLAP_UNROLL
+      for (int i = l + 1; i < n; ++i) {
+        Cj[i] += Al[i - l] * b;
+        dot += Al[i - l] * Bj[i];
+      }
+      Cj[l] += alpha * dot;
+      Al += n - l;
+    }
+  }
+}
+
+/** @brief Same as slap_Potrf() */
+static inline int slap_SmallPotrf(int n, sfloat* A, int lda) {
+  for (int j = 0; j < n; ++j) {
+    sfloat* Aj = A + j * lda;
+    for (int l = 0; l < j; ++l) {
+      const sfloat* Al = A + l * lda;
+      sfloat ajl = Al[j];
+      SLAP_UNROLL
+      for (int i = j; i < n; ++i) {
+        Aj[i] -= Al[i] * ajl;
+      }
+    }
+    if (Aj[j] <= 0) {
+      return j + 1;
+    }
+    sfloat scale = 1 / sqrt(Aj[j]);
+    SLAP_UNROLL
+    for (int i = j; i < n; ++i) {
+      Aj[i] *= scale;
+    }
+  }
+  return 0;
+}
+
+/** @brief Same as slap_Trsm() */
+static inline void slap_SmallTrsm(bool tL, int n, int nrhs, const sfloat* L, int ldl, sfloat* B,
+                                  int ldb) {
+  for (int j = 0; j < nrhs; ++j) {
+    sfloat* Bj = B + j * ldb;
+    if (!tL) {
+      for (int l = 0; l < n; ++l) {
+        const sfloat* Ll = L + l * ldl;
+        Bj[l] /= Ll[l];
+        SLAP_UNROLL
+        for (int i = l + 1; i < n; ++i) {
+          Bj[i] -= Ll[i] * Bj[l];
+        }
+      }
+    } else {
+      for (int i = n - 1; i >= 0; --i) {
+        const sfloat* Li = L + i * ldl;
+        sfloat sum = Bj[i];
+        SLAP_UNROLL
+        for (int l = i + 1; l < n; ++l) {
+          sum -= Li[l] * Bj[l];
+        }
+        Bj[i] = sum / Li[i];
+      }
+    }
+  }
+}
+
+/** @brief Expand a packed symmetric matrix into both triangles of a dense one */
+static inline void slap_SmallSymUnpack(int n, const sfloat* Ap, sfloat* A, int lda) {
+  for (int j = 0; j < n; ++j) {
+    SLAP_UNROLL
+    for (int i = j; i < n; ++i) {
+      sfloat a = Ap[slap_SmallPackedIndex(n, i, j)];
+      A[i + j * lda] = a;
+      A[j + i * lda] = a;
+    }
+  }
+}
+
+/** @brief Copy the lower triangle of a dense matrix into packed storage */
+static inline void slap_SmallSymPack(int n, const sfloat* A, int lda, sfloat* Ap) {
+  for (int j = 0; j < n; ++j) {
+    SLAP_UNROLL
+    for (int i = j; i < n; ++i) {
+      Ap[slap_SmallPackedIndex(n, i, j)] = A[i + j * lda];
+    }
+  }
+}
+
+/** @brief Same as slap_CholeskyFactorizeRegularized(), for a packed @p Ap */
+static inline int slap_SmallPotrfRegularized(int n, const sfloat* Ap, sfloat* L, int ldl,
+                                             sfloat shift_min, sfloat shift_max, sfloat* shift,
+                                             int* nretries) {
+  *shift = 0;
+  *nretries = 0;
+  for (sfloat s = shift_min; s > 0 && s <= shift_max; s *= 10) {
+    *shift = s;
+    ++*nretries;
+    slap_SmallSymUnpack(n, Ap, L, ldl);
+    for (int i = 0; i < n; ++i) {
+      L[i + i * ldl] += s;
+    }
+    if (slap_SmallPotrf(n, L, ldl) == 0) {
+      return 0;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Scaled matrix addition \f$ B = \alpha A + \beta B \f$
+ *
+ * Covers copies, with @p beta equal to zero, in which case @p B is not read.
+ */
+static inline void slap_SmallAxpby(int m, int n, sfloat alpha, const sfloat* A, int lda,
+                                   sfloat beta, sfloat* B, int ldb) {
+  for (int j = 0; j < n; ++j) {
+    SLAP_UNROLL
+    for (int i = 0; i < m; ++i) {
+      sfloat b = beta == 0 ? 0 : beta * B[i + j * ldb];
+      B[i + j * ldb] = alpha * A[i + j * lda] + b;
+    }
+  }
+}
+
+/**@} */
@@ -0,0 +1,106 @@
+#include <stdbool.h>
+
+#include "slap/kernels.h"
+
+enum {
+  kSymNB = 16,   ///< columns of the output computed per block column
+  kSymKC = 256,  ///< rows of P X held in the workspace at once
+};
+
+static inline int MinInt(int a, int b) { return a < b ? a : b; }
+
+void slap_SymTripleProduct(bool mirror, int n, int k, sfloat alpha, const sfloat* X, int ldx,
+                           const sfloat* P, int ldp, sfloat beta, sfloat* C, int ldc) {
+  sfloat W[kSymKC * kSymNB];
+  sfloat D[kSymNB * kSymNB];
+
+  // Scale the lower triangle
+  if (beta != 1.0) {
+    for (int j = 0; j < n; ++j) {
+      for (int i = j; i < n; ++i) {
+        sfloat* Cij = C + i + j * ldc;
+        *Cij = beta == 0.0 ? 0.0 : beta * (*Cij);
+      }
+    }
+  }
+
+  // Each block of P X is computed once and used for every block of C on or below the
+  // diagonal in the same block column
+  for (int j = 0; j < n; j += kSymNB) {
+    int jb = MinInt(kSymNB, n - j);
+    const sfloat* Xj = X + j * ldx;
+    for (int p = 0; p < k; p += kSymKC) {
+      int pb = MinInt(kSymKC, k - p);
+      const sfloat* Xpj = Xj + p;
+
+      // W = P[p:p+pb,:] * X[:,j:j+jb]
+      slap_Gemm(false, false, pb, jb, k, 1.0, P + p, ldp, Xj, ldx, 0.0, W, kSymKC);
+
+      // Diagonal block, only keeping the lower triangle
+      slap_Gemm(true, false, jb, jb, pb, alpha, Xpj, ldx, W, kSymKC, 0.0, D, kSymNB);
+      for (int c = 0; c < jb; ++c) {
+        for (int i = c; i < jb; ++i) {
+          C[(j + i) + (j + c) * ldc] += D[i + c * kSymNB];
+        }
+      }
+
+      // Blocks below the diagonal
+      int mb = n - j - jb;
+      if (mb > 0) {
+        slap_Gemm(true, false, mb, jb, pb, alpha, Xpj + jb * ldx, ldx, W, kSymKC, 1.0,
+                  C + (j + jb) + j * ldc, ldc);
+      }
+    }
+  }
+
+  if (mirror) {
+    for (int j = 0; j < n; ++j) {
+      for (int i = j + 1; i < n; ++i) {
+        C[j + i * ldc] = C[i + j * ldc];
+      }
+    }
+  }
+}
+
+void slap_Syrk(bool mirror, int n, int k, sfloat alpha, const sfloat* X, int ldx, sfloat beta,
+               sfloat* C, int ldc) {
+  sfloat D[kSymNB * kSymNB];
+
+  // Scale the lower triangle
+  if (beta != 1.0) {
+    for (int j = 0; j < n; ++j) {
+      for (int i = j; i < n; ++i) {
+        sfloat* Cij = C + i + j * ldc;
+        *Cij = beta == 0.0 ? 0.0 : beta * (*Cij);
+      }
+    }
+  }
+
+  for (int j = 0; j < n; j += kSymNB) {
+    int jb = MinInt(kSymNB, n - j);
+    const sfloat* Xj = X + j * ldx;
+
+    // Diagonal block, only keeping the lower triangle
+    slap_Gemm(true, false, jb, jb, k, alpha, Xj, ldx, Xj, ldx, 0.0, D, kSymNB);
+    for (int c = 0; c < jb; ++c) {
+      for (int i = c; i < jb; ++i) {
+        C[(j + i) + (j + c) * ldc] += D[i + c * kSymNB];
+      }
+    }
+
+    // Blocks below the diagonal
+    int mb = n - j - jb;
+    if (mb > 0) {
+      slap_Gemm(true, false, mb, jb, k, alpha, Xj + jb * ldx, ldx, Xj, ldx, 1.0,
+                C + (j + jb) + j * ldc, ldc);
+    }
+  }
+
+  if (mirror) {
+    for (int j = 0; j < n; ++j) {
+      for (int i = j + 1; i < n; ++i) {
+        C[j + i * ldc] = C[i + j * ldc];
+      }
+    }
+  }
+}
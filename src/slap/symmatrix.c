@@ -0,0 +1,96 @@
+#include "symmatrix.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+SymMatrix slap_NewSymMatrix(int n) {
+  sfloat* data = (sfloat*)slap_AlignedAlloc(n * (n + 1) / 2 * sizeof(sfloat));
+  SymMatrix mat = {n, data};
+  return mat;
+}
+
+int slap_FreeSymMatrix(SymMatrix* mat) {
+  if (mat) {
+    if (mat->data) {
+      free(mat->data);
+      mat->data = NULL;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+int slap_SymMatrixNumElements(const SymMatrix* mat) {
+  if (!mat) {
+    return -1;
+  }
+  return mat->n * (mat->n + 1) / 2;
+}
+
+int slap_SymMatrixGetLinearIndex(const SymMatrix* mat, int row, int col) {
+  if (!mat) {
+    return -1;
+  }
+  if (row < 0 || col < 0) {
+    return -1;
+  }
+  if (row < col) {
+    int tmp = row;
+    row = col;
+    col = tmp;
+  }
+  return row + col * (2 * mat->n - col - 1) / 2;
+}
+
+sfloat* slap_SymMatrixGetElement(const SymMatrix* mat, int row, int col) {
+  if (!mat) {
+    return NULL;
+  }
+  return mat->data + slap_SymMatrixGetLinearIndex(mat, row, col);
+}
+
+int slap_SymMatrixCopy(SymMatrix* dest, const SymMatrix* src) {
+  if (dest->n != src->n) {
+    fprintf(stderr, "Can't copy symmetric matrices of different sizes: %d and %d.\n", dest->n,
+            src->n);
+    return -1;
+  }
+  memcpy(dest->data, src->data, slap_SymMatrixNumElements(src) * sizeof(sfloat));
+  return 0;
+}
+
+int slap_SymMatrixPack(SymMatrix* dest, const Matrix* src) {
+  int n = dest->n;
+  if (src->rows != n || src->cols != n) {
+    fprintf(stderr, "Can't pack a (%d,%d) matrix into a symmetric matrix of size %d.\n",
+            src->rows, src->cols, n);
+    return -1;
+  }
+  int ld = slap_MatrixLeadingDim(src);
+  sfloat* col = dest->data;
+  for (int j = 0; j < n; ++j) {
+    memcpy(col, src->data + j + j * ld, (n - j) * sizeof(sfloat));
+    col += n - j;
+  }
+  return 0;
+}
+
+int slap_SymMatrixUnpack(Matrix* dest, const SymMatrix* src) {
+  int n = src->n;
+  if (dest->rows != n || dest->cols != n) {
+    fprintf(stderr, "Can't unpack a symmetric matrix of size %d into a (%d,%d) matrix.\n", n,
+            dest->rows, dest->cols);
+    return -1;
+  }
+  int ld = slap_MatrixLeadingDim(dest);
+  const sfloat* col = src->data;
+  for (int j = 0; j < n; ++j) {
+    memcpy(dest->data + j + j * ld, col, (n - j) * sizeof(sfloat));
+    for (int i = j + 1; i < n; ++i) {
+      dest->data[j + i * ld] = col[i - j];
+    }
+    col += n - j;
+  }
+  return 0;
+}
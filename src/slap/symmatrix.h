@@ -0,0 +1,152 @@
+/**
+ * @file symmatrix.h
+ * @author Brian Jackson (bjack205@gmail.com)
+ * @brief Symmetric matrix type using packed storage
+ * @version 0.1
+ * @date 2022-02-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * @addtogroup LinearAlgebra
+ * @{
+ */
+#pragma once
+
+#include "matrix.h"
+
+/**
+ * @brief Represents a symmetric matrix of floating-point data (see sfloat) in packed storage
+ *
+ * Only the lower triangle of the matrix is stored, column by column, so an (n,n)
+ * matrix only needs `n * (n + 1) / 2` values instead of `n * n`. Column `j` starts
+ * with the diagonal element `[j,j]`, followed by the `n - j - 1` elements below it,
+ * such that element `[i,j]` with `i >= j` is stored at `data[i + j * (2n - j - 1) / 2]`.
+ * This is the same layout as the "packed lower" format used by LAPACK.
+ *
+ * ## Initialization
+ * A new symmetric matrix is allocated on the heap via
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * SymMatrix mat = slap_NewSymMatrix(n);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * which must be followed by a call to slap_FreeSymMatrix(). Data that is already packed
+ * can be wrapped with the brace initializer:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * sfloat data[3] = {1,2,3};  // [1 2; 2 3]
+ * SymMatrix mat = {2, data};
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * ## Methods
+ * - slap_NewSymMatrix()
+ * - slap_FreeSymMatrix()
+ * - slap_SymMatrixNumElements()
+ * - slap_SymMatrixGetLinearIndex()
+ * - slap_SymMatrixGetElement()
+ * - slap_SymMatrixAt()
+ * - slap_SymMatrixCopy()
+ * - slap_SymMatrixPack()
+ * - slap_SymMatrixUnpack()
+ *
+ * The linear algebra routines for packed matrices are in linalg.h.
+ */
+typedef struct {
+  int n;
+  sfloat* data;
+} SymMatrix;
+
+/**
+ * @brief Allocate a new symmetric matrix on the heap
+ *
+ * Data will not be initialized. Must be followed by a call to slap_FreeSymMatrix().
+ *
+ * @param n size of the matrix
+ * @return A new symmetric matrix
+ */
+SymMatrix slap_NewSymMatrix(int n);
+
+/**
+ * @brief Free the data for a symmetric matrix
+ *
+ * @param mat
+ * @post [mat.data](SymMatrix.data) will be `NULL`.
+ * @return 0 if successful
+ */
+int slap_FreeSymMatrix(SymMatrix* mat);
+
+/**
+ * @brief Get the number of elements actually stored, i.e. `n * (n + 1) / 2`.
+ *
+ * @param mat Any symmetric matrix
+ * @return Number of stored elements
+ */
+int slap_SymMatrixNumElements(const SymMatrix* mat);
+
+/**
+ * @brief Get the linear index of an element in the packed data
+ *
+ * Since the matrix is symmetric, @p row and @p col can refer to either triangle.
+ *
+ * @param mat Symmetric matrix
+ * @param row Row index
+ * @param col Column index
+ * @return Linear index corresponding to `row` and `col`. Returns -1 for a bad input.
+ */
+int slap_SymMatrixGetLinearIndex(const SymMatrix* mat, int row, int col);
+
+/**
+ * @brief Get an element of a symmetric matrix
+ *
+ * Elements `[i,j]` and `[j,i]` share the same storage.
+ *
+ * @param mat Symmetric matrix with initialized data
+ * @param row Row index
+ * @param col Column index
+ * @return A pointer to the element of the matrix. NULL for invalid input.
+ */
+sfloat* slap_SymMatrixGetElement(const SymMatrix* mat, int row, int col);
+
+/**
+ * @brief Get an element of a symmetric matrix without any checks
+ *
+ * Inline version of slap_SymMatrixGetElement(). The indices are only checked when
+ * `SLAP_CHECK_BOUNDS` is defined.
+ *
+ * @param mat Symmetric matrix with initialized data
+ * @param row Row index, in `[0, n)`
+ * @param col Column index, in `[0, n)`
+ * @return A pointer to the element of the matrix
+ */
+static inline sfloat* slap_SymMatrixAt(const SymMatrix* mat, int row, int col) {
+  SLAP_CHECK(row >= 0 && row < mat->n && col >= 0 && col < mat->n);
+  int i = row < col ? col : row;
+  int j = row < col ? row : col;
+  return mat->data + i + j * (2 * mat->n - j - 1) / 2;
+}
+
+/**
+ * @brief Copy a symmetric matrix to another of the same size
+ *
+ * @param dest a symmetric matrix of size n
+ * @param src  a symmetric matrix of size n
+ * @return 0 if successful
+ */
+int slap_SymMatrixCopy(SymMatrix* dest, const SymMatrix* src);
+
+/**
+ * @brief Pack the lower triangle of a dense matrix
+ *
+ * @param dest Symmetric matrix of size n
+ * @param src  Square matrix of size (n,n). Only the lower triangle is read.
+ * @return 0 if successful
+ */
+int slap_SymMatrixPack(SymMatrix* dest, const Matrix* src);
+
+/**
+ * @brief Expand a symmetric matrix into a dense matrix, filling both triangles
+ *
+ * @param dest Square matrix of size (n,n)
+ * @param src  Symmetric matrix of size n
+ * @return 0 if successful
+ */
+int slap_SymMatrixUnpack(Matrix* dest, const SymMatrix* src);
+
+/**@}*/
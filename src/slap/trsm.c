@@ -0,0 +1,182 @@
+#include <stdbool.h>
+
+#include "slap/blas.h"
+#include "slap/kernels.h"
+#include "slap/simd.h"
+
+enum {
+  kTrsmNR = 4,   ///< right-hand sides solved together, sharing each load of L
+  kTrsmNB = 32,  ///< size of the diagonal blocks for larger triangles
+};
+
+static inline int MinInt(int a, int b) { return a < b ? a : b; }
+
+/*
+ * Forward substitution L X = B for nr <= kTrsmNR columns of B. Once row i of X is known,
+ * it is eliminated from the rows below with one axpy per column, all reusing the same
+ * vector loads of column i of L.
+ */
+static inline void TrsmLowerTile(int nr, int n, const sfloat* L, int ldl, sfloat* B, int ldb) {
+  for (int i = 0; i < n; ++i) {
+    const sfloat* Li = L + i * ldl;
+    slap_Vec x[kTrsmNR];
+    for (int jj = 0; jj < nr; ++jj) {
+      sfloat* Bij = B + i + jj * ldb;
+      *Bij /= Li[i];
+      x[jj] = slap_VecBroadcast(-*Bij);
+    }
+    int r = i + 1;
+    for (; r + SLAP_VLEN <= n; r += SLAP_VLEN) {
+      slap_Vec l = slap_VecLoad(Li + r);
+      for (int jj = 0; jj < nr; ++jj) {
+        sfloat* Brj = B + r + jj * ldb;
+        slap_VecStore(Brj, slap_VecFma(l, x[jj], slap_VecLoad(Brj)));
+      }
+    }
+    if (r < n) {
+      int len = n - r;
+      slap_Vec l = slap_VecLoadPartial(Li + r, len);
+      for (int jj = 0; jj < nr; ++jj) {
+        sfloat* Brj = B + r + jj * ldb;
+        slap_VecStorePartial(Brj, slap_VecFma(l, x[jj], slap_VecLoadPartial(Brj, len)), len);
+      }
+    }
+  }
+}
+
+/*
+ * Back substitution L' X = B for nr <= kTrsmNR columns of B. Row i of X is the dot product
+ * of column i of L with the rows of X already solved below it.
+ */
+static inline void TrsmLowerTransposeTile(int nr, int n, const sfloat* L, int ldl, sfloat* B,
+                                          int ldb) {
+  for (int i = n - 1; i >= 0; --i) {
+    const sfloat* Li = L + i * ldl;
+    slap_Vec acc[kTrsmNR];
+    for (int jj = 0; jj < nr; ++jj) {
+      acc[jj] = slap_VecZero();
+    }
+    int r = i + 1;
+    for (; r + SLAP_VLEN <= n; r += SLAP_VLEN) {
+      slap_Vec l = slap_VecLoad(Li + r);
+      for (int jj = 0; jj < nr; ++jj) {
+        acc[jj] = slap_VecFma(l, slap_VecLoad(B + r + jj * ldb), acc[jj]);
+      }
+    }
+    if (r < n) {
+      int len = n - r;
+      slap_Vec l = slap_VecLoadPartial(Li + r, len);
+      for (int jj = 0; jj < nr; ++jj) {
+        acc[jj] = slap_VecFma(l, slap_VecLoadPartial(B + r + jj * ldb, len), acc[jj]);
+      }
+    }
+    for (int jj = 0; jj < nr; ++jj) {
+      sfloat* Bij = B + i + jj * ldb;
+      *Bij = (*Bij - slap_VecSum(acc[jj])) / Li[i];
+    }
+  }
+}
+
+static void TrsmUnblocked(bool tL, int n, int nrhs, const sfloat* L, int ldl, sfloat* B,
+                          int ldb) {
+  for (int j = 0; j < nrhs; j += kTrsmNR) {
+    int nr = MinInt(kTrsmNR, nrhs - j);
+    sfloat* Bj = B + j * ldb;
+    if (tL) {
+      if (nr == kTrsmNR) {
+        TrsmLowerTransposeTile(kTrsmNR, n, L, ldl, Bj, ldb);
+      } else {
+        TrsmLowerTransposeTile(nr, n, L, ldl, Bj, ldb);
+      }
+    } else {
+      if (nr == kTrsmNR) {
+        TrsmLowerTile(kTrsmNR, n, L, ldl, Bj, ldb);
+      } else {
+        TrsmLowerTile(nr, n, L, ldl, Bj, ldb);
+      }
+    }
+  }
+}
+
+void slap_Trsm(bool tL, int n, int nrhs, const sfloat* L, int ldl, sfloat* B, int ldb) {
+#ifdef SLAP_USE_BLAS
+  if (n >= SLAP_BLAS_MIN_SIZE) {
+    slap_BlasTrsm(tL, n, nrhs, L, ldl, B, ldb);
+    return;
+  }
+#endif
+  if (n <= kTrsmNB) {
+    TrsmUnblocked(tL, n, nrhs, L, ldl, B, ldb);
+    return;
+  }
+
+  if (!tL) {
+    // Solve each diagonal block, then eliminate it from the rows below with GEMM
+    for (int k = 0; k < n; k += kTrsmNB) {
+      int kb = MinInt(kTrsmNB, n - k);
+      const sfloat* Lkk = L + k + k * ldl;
+      TrsmUnblocked(false, kb, nrhs, Lkk, ldl, B + k, ldb);
+      int mr = n - k - kb;
+      if (mr > 0) {
+        slap_Gemm(false, false, mr, nrhs, kb, -1.0, Lkk + kb, ldl, B + k, ldb, 1.0, B + k + kb,
+                  ldb);
+      }
+    }
+  } else {
+    // Work up from the bottom, first removing the rows of X that are already known
+    int k = ((n - 1) / kTrsmNB) * kTrsmNB;
+    for (; k >= 0; k -= kTrsmNB) {
+      int kb = MinInt(kTrsmNB, n - k);
+      const sfloat* Lkk = L + k + k * ldl;
+      int mr = n - k - kb;
+      if (mr > 0) {
+        slap_Gemm(true, false, kb, nrhs, mr, -1.0, Lkk + kb, ldl, B + k + kb, ldb, 1.0, B + k,
+                  ldb);
+      }
+      TrsmUnblocked(true, kb, nrhs, Lkk, ldl, B + k, ldb);
+    }
+  }
+}
+
+void slap_Trmm(bool tL, int n, int ncols, const sfloat* L, int ldl, sfloat* B, int ldb) {
+  for (int j = 0; j < ncols; ++j) {
+    sfloat* Bj = B + j * ldb;
+    if (tL) {
+      // Row i of L'B only needs the rows of B from i down, so work from the top
+      for (int i = 0; i < n; ++i) {
+        const sfloat* Li = L + i + i * ldl;
+        const sfloat* b = Bj + i;
+        int m = n - i;
+        slap_Vec acc = slap_VecZero();
+        int r = 0;
+        for (; r + SLAP_VLEN <= m; r += SLAP_VLEN) {
+          acc = slap_VecFma(slap_VecLoad(Li + r), slap_VecLoad(b + r), acc);
+        }
+        if (r < m) {
+          acc = slap_VecFma(slap_VecLoadPartial(Li + r, m - r),
+                            slap_VecLoadPartial(b + r, m - r), acc);
+        }
+        Bj[i] = slap_VecSum(acc);
+      }
+    } else {
+      // Row i of LB only needs the rows of B up to i, so work up from the bottom
+      for (int l = n - 1; l >= 0; --l) {
+        const sfloat* Ll = L + l + l * ldl;
+        sfloat bl = Bj[l];
+        Bj[l] = Ll[0] * bl;
+        sfloat* b = Bj + l + 1;
+        int m = n - l - 1;
+        slap_Vec x = slap_VecBroadcast(bl);
+        int r = 0;
+        for (; r + SLAP_VLEN <= m; r += SLAP_VLEN) {
+          slap_VecStore(b + r, slap_VecFma(slap_VecLoad(Ll + 1 + r), x, slap_VecLoad(b + r)));
+        }
+        if (r < m) {
+          slap_Vec y = slap_VecFma(slap_VecLoadPartial(Ll + 1 + r, m - r), x,
+                                   slap_VecLoadPartial(b + r, m - r));
+          slap_VecStorePartial(b + r, y, m - r);
+        }
+      }
+    }
+  }
+}
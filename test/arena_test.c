@@ -0,0 +1,98 @@
+#include "slap/arena.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "simpletest/simpletest.h"
+#include "slap/matrix.h"
+
+static bool IsAligned(const void* ptr) { return (uintptr_t)ptr % SLAP_ALIGNMENT == 0; }
+
+void TestArenaAlloc() {
+  int block = slap_AlignedLength(1);
+  Arena arena = slap_NewArena(4 * block);
+  TEST(arena.data != NULL);
+  TEST(arena.owns_data);
+  TEST(IsAligned(arena.data));
+
+  // Every allocation is aligned, even if the previous one wasn't a multiple of the alignment
+  sfloat* a = slap_ArenaAlloc(&arena, 1);
+  sfloat* b = slap_ArenaAlloc(&arena, block + 1);
+  TEST(a == arena.data);
+  TEST(b == arena.data + block);
+  TEST(IsAligned(b));
+  TEST(arena.top == 3 * block);
+
+  // Out of memory
+  TEST(slap_ArenaAlloc(&arena, block + 1) == NULL);
+  TEST(arena.top == 3 * block);
+  sfloat* c = slap_ArenaAlloc(&arena, block);
+  TEST(c == arena.data + 3 * block);
+  TEST(slap_ArenaAlloc(&arena, 1) == NULL);
+  TEST(slap_ArenaAlloc(&arena, -1) == NULL);
+
+  TEST(slap_FreeArena(&arena) == 0);
+  TEST(arena.data == NULL);
+  TEST(slap_FreeArena(&arena) == -1);
+  TEST(slap_ArenaAlloc(&arena, 1) == NULL);
+}
+
+void TestArenaScopes() {
+  Arena arena = slap_NewArena(1000);
+  Matrix A = slap_ArenaMatrix(&arena, 3, 4);
+  TEST(A.rows == 3 && A.cols == 4 && A.ld == 3);
+  int used = arena.top;
+
+  // Nested scopes release in reverse order
+  int outer = slap_ArenaPush(&arena);
+  Matrix B = slap_ArenaMatrix(&arena, 10, 10);
+  int inner = slap_ArenaPush(&arena);
+  SymMatrix S = slap_ArenaSymMatrix(&arena, 10);
+  TEST(S.n == 10);
+  TEST(S.data == B.data + slap_AlignedLength(100));
+  int peak = arena.top;
+  TEST(slap_ArenaPop(&arena, inner) == 0);
+  TEST(slap_ArenaPop(&arena, outer) == 0);
+  TEST(arena.top == used);
+
+  // Memory is reused by the next scope, without changing the peak
+  outer = slap_ArenaPush(&arena);
+  Matrix C = slap_ArenaMatrix(&arena, 2, 2);
+  TEST(C.data == B.data);
+  TEST(slap_ArenaPeak(&arena) == peak);
+  TEST(slap_ArenaPop(&arena, outer) == 0);
+
+  // A mark past the top has already been popped
+  TEST(slap_ArenaPop(&arena, inner) == -1);
+  TEST(slap_ArenaPop(&arena, -1) == -1);
+
+  // Too big for what's left
+  Matrix D = slap_ArenaMatrix(&arena, 1000, 1);
+  TEST(D.data == NULL);
+  slap_FreeArena(&arena);
+}
+
+void TestArenaExternalData() {
+  int len = 2 * slap_AlignedLength(5);
+  sfloat* data = (sfloat*)slap_AlignedAlloc(len * sizeof(sfloat));
+  Arena arena = slap_InitArena(data, len);
+  TEST(!arena.owns_data);
+  TEST(slap_ArenaAlloc(&arena, 5) == data);
+  TEST(slap_ArenaAlloc(&arena, 5) == data + len / 2);
+  TEST(slap_ArenaAlloc(&arena, 1) == NULL);
+  TEST(slap_ArenaPeak(&arena) == len);
+
+  // Doesn't free memory it doesn't own
+  TEST(slap_FreeArena(&arena) == 0);
+  TEST(arena.data == NULL);
+  data[0] = 1.0;
+  free(data);
+}
+
+int main() {
+  TestArenaAlloc();
+  TestArenaScopes();
+  TestArenaExternalData();
+  PrintTestResult();
+  return TestResult();
+}
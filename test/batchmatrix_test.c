@@ -0,0 +1,222 @@
+#include "slap/batchmatrix.h"
+
+#include <math.h>
+#include <stddef.h>
+
+#include "simpletest/simpletest.h"
+#include "slap/linalg.h"
+#include "slap/matrix.h"
+
+// Fills matrix b of the batch with a different, deterministic set of values per matrix
+void FillBatch(BatchMatrix* A, double scale) {
+  for (int b = 0; b < SLAP_BATCH_SIZE; ++b) {
+    for (int j = 0; j < A->cols; ++j) {
+      for (int i = 0; i < A->rows; ++i) {
+        *slap_BatchMatrixGetElement(A, b, i, j) = sin(scale * (i + 3 * j) + b);
+      }
+    }
+  }
+}
+
+// Batch of symmetric positive-definite matrices of size n
+BatchMatrix RandomSPDBatch(int n) {
+  BatchMatrix A = slap_NewBatchMatrix(n, n);
+  Matrix A1 = slap_NewMatrix(n, n);
+  Matrix Ab = slap_NewMatrix(n, n);
+  for (int b = 0; b < SLAP_BATCH_SIZE; ++b) {
+    for (int i = 0; i < n * n; ++i) {
+      A1.data[i] = cos(0.7 * i + b);
+    }
+    slap_MatrixMultiply(&A1, &A1, &Ab, 1, 0, 1.0, 0.0);
+    slap_AddDiagonal(&Ab, 0.5);
+    slap_BatchMatrixSetMatrix(&A, b, &Ab);
+  }
+  slap_FreeMatrix(&A1);
+  slap_FreeMatrix(&Ab);
+  return A;
+}
+
+// Largest difference between the matrices in a batch and their dense counterparts
+double BatchError(const BatchMatrix* A, Matrix* dense) {
+  double err = 0.0;
+  Matrix Ab = slap_NewMatrix(A->rows, A->cols);
+  for (int b = 0; b < SLAP_BATCH_SIZE; ++b) {
+    slap_BatchMatrixGetMatrix(&Ab, A, b);
+    err = fmax(err, slap_MatrixNormedDifference(&Ab, dense + b));
+  }
+  slap_FreeMatrix(&Ab);
+  return err;
+}
+
+void BatchLayoutTest() {
+  BatchMatrix A = slap_NewBatchMatrix(3, 2);
+  TEST(slap_BatchMatrixNumElements(&A) == 6 * SLAP_BATCH_SIZE);
+  TEST(((size_t)A.data) % 32 == 0);
+  for (int i = 0; i < slap_BatchMatrixNumElements(&A); ++i) {
+    A.data[i] = i;
+  }
+  TEST(*slap_BatchMatrixGetElement(&A, 0, 0, 0) == 0);
+  TEST(*slap_BatchMatrixGetElement(&A, 1, 0, 0) == 1);
+  TEST(*slap_BatchMatrixGetElement(&A, 0, 1, 0) == SLAP_BATCH_SIZE);
+  TEST(*slap_BatchMatrixGetElement(&A, 2, 1, 1) == 4 * SLAP_BATCH_SIZE + 2);
+  TEST(slap_BatchMatrixGetElement(&A, SLAP_BATCH_SIZE, 0, 0) == NULL);
+  TEST(slap_BatchMatrixGetElement(&A, 0, 3, 0) == NULL);
+
+  // Round trip through a view
+  double data[12] = {1, 2, 3, 0, 4, 5, 6, 0, 7, 8, 9, 0};  // NOLINT
+  Matrix M = {4, 3, data, 4};
+  Matrix V = slap_MatrixView(&M, 0, 1, 3, 2);
+  Matrix B = slap_NewMatrixZeros(3, 2);
+  slap_BatchMatrixSetConst(&A, 0.0);
+  TEST(slap_BatchMatrixSetMatrix(&A, 1, &V) == 0);
+  TEST(*slap_BatchMatrixGetElement(&A, 1, 2, 1) == 9);
+  TEST(*slap_BatchMatrixGetElement(&A, 0, 2, 1) == 0);
+  TEST(slap_BatchMatrixGetMatrix(&B, &A, 1) == 0);
+  TEST(slap_MatrixNormedDifference(&B, &V) < 1e-12);
+
+  // Bad sizes and indices
+  TEST(slap_BatchMatrixSetMatrix(&A, 0, &M) == -1);
+  TEST(slap_BatchMatrixSetMatrix(&A, -1, &V) == -1);
+  TEST(slap_BatchMatrixGetMatrix(&M, &A, 0) == -1);
+
+  slap_FreeBatchMatrix(&A);
+  slap_FreeMatrix(&B);
+  TEST(A.data == NULL);
+}
+
+void BatchMultiplyTest() {
+  const int sizes[][3] = {{1, 1, 1}, {4, 2, 4}, {6, 4, 7}, {12, 12, 12}, {5, 9, 3}};
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+    for (int t = 0; t < 4; ++t) {
+      bool tA = t & 1;
+      bool tB = t & 2;
+      int m = sizes[s][0];
+      int n = sizes[s][1];
+      int k = sizes[s][2];
+      BatchMatrix A = tA ? slap_NewBatchMatrix(k, m) : slap_NewBatchMatrix(m, k);
+      BatchMatrix B = tB ? slap_NewBatchMatrix(n, k) : slap_NewBatchMatrix(k, n);
+      BatchMatrix C = slap_NewBatchMatrix(m, n);
+      FillBatch(&A, 0.3);
+      FillBatch(&B, 0.8);
+      FillBatch(&C, 1.1);
+
+      Matrix Ab = slap_NewMatrix(A.rows, A.cols);
+      Matrix Bb = slap_NewMatrix(B.rows, B.cols);
+      Matrix Cans[SLAP_BATCH_SIZE];
+      for (int b = 0; b < SLAP_BATCH_SIZE; ++b) {
+        Cans[b] = slap_NewMatrix(m, n);
+        slap_BatchMatrixGetMatrix(&Ab, &A, b);
+        slap_BatchMatrixGetMatrix(&Bb, &B, b);
+        slap_BatchMatrixGetMatrix(Cans + b, &C, b);
+        slap_MatrixMultiply(&Ab, &Bb, Cans + b, tA, tB, 0.5, -1.5);
+      }
+      TEST(slap_BatchMatrixMultiply(&A, &B, &C, tA, tB, 0.5, -1.5) == 0);
+      TEST(BatchError(&C, Cans) < 1e-12);
+
+      // beta = 0 shouldn't read C
+      slap_BatchMatrixSetConst(&C, NAN);
+      for (int b = 0; b < SLAP_BATCH_SIZE; ++b) {
+        slap_BatchMatrixGetMatrix(&Ab, &A, b);
+        slap_BatchMatrixGetMatrix(&Bb, &B, b);
+        slap_MatrixMultiply(&Ab, &Bb, Cans + b, tA, tB, 1.0, 0.0);
+      }
+      slap_BatchMatrixMultiply(&A, &B, &C, tA, tB, 1.0, 0.0);
+      TEST(BatchError(&C, Cans) < 1e-12);
+
+      // C = C + 2 C
+      slap_BatchMatrixAddition(&C, &C, 2.0);
+      for (int b = 0; b < SLAP_BATCH_SIZE; ++b) {
+        slap_MatrixScale(Cans + b, 3.0);
+      }
+      TEST(BatchError(&C, Cans) < 1e-12);
+
+      slap_FreeBatchMatrix(&A);
+      slap_FreeBatchMatrix(&B);
+      slap_FreeBatchMatrix(&C);
+      slap_FreeMatrix(&Ab);
+      slap_FreeMatrix(&Bb);
+      for (int b = 0; b < SLAP_BATCH_SIZE; ++b) {
+        slap_FreeMatrix(Cans + b);
+      }
+    }
+  }
+}
+
+void BatchCholeskyTest() {
+  const int sizes[] = {1, 2, 4, 7, 12};
+  const int nrhs = 3;
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+    int n = sizes[s];
+    BatchMatrix A = RandomSPDBatch(n);
+    BatchMatrix L = slap_NewBatchMatrix(n, n);
+    BatchMatrix x = slap_NewBatchMatrix(n, nrhs);
+    BatchMatrix y = slap_NewBatchMatrix(n, nrhs);
+    BatchMatrix b = slap_NewBatchMatrix(n, nrhs);
+    FillBatch(&b, 0.9);
+    for (int i = 0; i < slap_BatchMatrixNumElements(&A); ++i) {
+      L.data[i] = A.data[i];
+    }
+    for (int i = 0; i < slap_BatchMatrixNumElements(&b); ++i) {
+      x.data[i] = b.data[i];
+      y.data[i] = b.data[i];
+    }
+
+    // Factor should match the dense one in the lower triangle
+    TEST(slap_BatchCholeskyFactorize(&L) == slap_kCholeskySuccess);
+    Matrix Ld = slap_NewMatrix(n, n);
+    double err = 0.0;
+    for (int k = 0; k < SLAP_BATCH_SIZE; ++k) {
+      slap_BatchMatrixGetMatrix(&Ld, &A, k);
+      slap_CholeskyFactorize(&Ld);
+      for (int j = 0; j < n; ++j) {
+        for (int i = j; i < n; ++i) {
+          double diff =
+              *slap_BatchMatrixGetElement(&L, k, i, j) - *slap_MatrixGetElement(&Ld, i, j);
+          err = fmax(err, fabs(diff));
+        }
+      }
+    }
+    TEST(err < 1e-10);
+
+    // A x = b
+    slap_BatchCholeskySolve(&L, &x);
+    slap_BatchMatrixMultiply(&A, &x, &b, false, false, 1.0, -1.0);
+    for (int i = 0; i < slap_BatchMatrixNumElements(&b); ++i) {
+      TEST(fabs(b.data[i]) < 1e-8);
+    }
+
+    // Two triangular solves are the same as the Cholesky solve
+    slap_BatchLowerTriBackSub(&L, &y, false);
+    slap_BatchLowerTriBackSub(&L, &y, true);
+    for (int i = 0; i < slap_BatchMatrixNumElements(&y); ++i) {
+      TEST(fabs(y.data[i] - x.data[i]) < 1e-12);
+    }
+
+    // Only the indefinite matrix should fail
+    for (int i = 0; i < slap_BatchMatrixNumElements(&A); ++i) {
+      L.data[i] = A.data[i];
+    }
+    *slap_BatchMatrixGetElement(&L, 1, n - 1, n - 1) = -1.0;
+    TEST(slap_BatchCholeskyFactorize(&L) == 1 << 1);
+    TEST(isnan(*slap_BatchMatrixGetElement(&L, 1, n - 1, n - 1)));
+    slap_BatchMatrixGetMatrix(&Ld, &A, 0);
+    slap_CholeskyFactorize(&Ld);
+    TESTAPPROX(*slap_BatchMatrixGetElement(&L, 0, n - 1, n - 1),
+               *slap_MatrixGetElement(&Ld, n - 1, n - 1), 1e-10);
+
+    slap_FreeBatchMatrix(&A);
+    slap_FreeBatchMatrix(&L);
+    slap_FreeBatchMatrix(&x);
+    slap_FreeBatchMatrix(&y);
+    slap_FreeBatchMatrix(&b);
+    slap_FreeMatrix(&Ld);
+  }
+}
+
+int main() {
+  BatchLayoutTest();
+  BatchMultiplyTest();
+  BatchCholeskyTest();
+  PrintTestResult();
+  return TestResult();
+}
@@ -0,0 +1,20 @@
+# Checks that every global symbol defined by the single-precision libraries has the
+# slapf_ or ulqrf_ prefix, i.e. that they can be linked alongside the double-precision
+# ones. Run in script mode with NM set to the nm executable and LIBS to the libraries.
+foreach(lib ${LIBS})
+  execute_process(
+    COMMAND ${NM} -g --defined-only ${lib}
+    OUTPUT_VARIABLE symbols
+    RESULT_VARIABLE result
+  )
+  if (NOT result EQUAL 0)
+    message(FATAL_ERROR "Failed to read the symbols of ${lib}")
+  endif()
+  string(REGEX MATCHALL "[^\n]+ [A-Z] [^\n]+" definitions "${symbols}")
+  foreach(definition ${definitions})
+    string(REGEX REPLACE ".* [A-Z] " "" symbol "${definition}")
+    if (NOT symbol MATCHES "^(slapf|ulqrf)_")
+      message(SEND_ERROR "${lib} defines ${symbol}, which is missing from float_names.h")
+    endif()
+  endforeach()
+endforeach()
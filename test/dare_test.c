@@ -0,0 +1,125 @@
+#include "riccati/dare.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include "riccati/riccati_solve.h"
+#include "riccati/riccati_solver.h"
+#include "simpletest/simpletest.h"
+#include "slap/linalg.h"
+#include "slap/matrix.h"
+#include "test_utils.h"
+
+/* Difference between two packed symmetric matrices */
+static double SymMatrixDifference(SymMatrix* A, SymMatrix* B) {
+  int nsym = A->n * (A->n + 1) / 2;
+  Matrix a = {nsym, 1, A->data, 0};
+  Matrix b = {nsym, 1, B->data, 0};
+  return slap_MatrixNormedDifference(&a, &b);
+}
+
+/* Residual of P = Q + A'P (A + B K), for the solution of the DARE */
+static double DAREResidual(DARESolver* dare, Matrix* A, Matrix* B, SymMatrix* Q) {
+  int n = dare->nstates;
+  Matrix P = slap_NewMatrix(n, n);
+  Matrix Acl = slap_NewMatrix(n, n);
+  Matrix res = slap_NewMatrix(n, n);
+  slap_SymMatrixUnpack(&P, &dare->P);
+  slap_MatrixCopy(&Acl, A);
+  slap_MatrixMultiply(B, &dare->K, &Acl, false, false, 1.0, 1.0);
+  slap_SymMatrixUnpack(&res, Q);
+  slap_MatrixMultiply(&P, &Acl, &dare->T1, false, false, 1.0, 0.0);
+  slap_MatrixMultiply(A, &dare->T1, &res, true, false, 1.0, 1.0);
+  double err = slap_MatrixNormedDifference(&res, &P) / slap_TwoNorm(&P);
+  slap_FreeMatrix(&P);
+  slap_FreeMatrix(&Acl);
+  slap_FreeMatrix(&res);
+  return err;
+}
+
+void TestSolveDARE() {
+  // A is close to the identity, so the backward pass takes a long horizon to converge
+  const int nstates = 4;
+  const int ninputs = 2;
+  RiccatiSolver* solver = RandomLQRProblem(nstates, ninputs, 10);
+  Matrix* A = ulqr_GetA(solver, 0);
+  Matrix* B = ulqr_GetB(solver, 0);
+  SymMatrix* Q = ulqr_GetQ(solver, 0);
+  DARESolver* dare = ulqr_NewDARESolver(nstates, ninputs);
+  TEST(dare->nstates == nstates);
+  TEST(dare->ninputs == ninputs);
+  TEST(ulqr_SolveDARE(dare, A, B, Q, ulqr_GetR(solver, 0)) == 0);
+  TEST(dare->iters > 0);
+  TEST(dare->iters < 20);
+  TEST(DAREResidual(dare, A, B, Q) < 1e-10);
+
+  // Too few iterations
+  dare->max_iters = 2;
+  TEST(ulqr_SolveDARE(dare, A, B, Q, ulqr_GetR(solver, 0)) == -1);
+  dare->max_iters = 50;
+
+  // R isn't positive definite
+  SymMatrix* R = ulqr_GetR(solver, 0);
+  R->data[0] = -1.0;
+  TEST(ulqr_SolveDARE(dare, A, B, Q, R) == -1);
+
+  // Wrong size
+  SymMatrix Q_small = {nstates - 1, Q->data};
+  TEST(ulqr_SolveDARE(dare, A, B, &Q_small, ulqr_GetR(solver, 1)) == -1);
+
+  ulqr_FreeDARESolver(&dare);
+  TEST(dare == NULL);
+  ulqr_FreeRiccatiSolver(&solver);
+}
+
+void TestBackwardPassLimit() {
+  // Damping A makes the backward pass converge within the horizon
+  const int nhorizon = 400;
+  RiccatiSolver* solver = RandomLQRProblem(4, 2, nhorizon);
+  for (int k = 0; k < nhorizon - 1; ++k) {
+    slap_MatrixScaleByConst(ulqr_GetA(solver, k), 0.9);
+  }
+  DARESolver* dare = ulqr_NewDARESolver(4, 2);
+  TEST(ulqr_SolveDARE(dare, ulqr_GetA(solver, 0), ulqr_GetB(solver, 0), ulqr_GetQ(solver, 0),
+                      ulqr_GetR(solver, 0)) == 0);
+  TEST(ulqr_BackwardPass(solver) == 0);
+  TEST(SymMatrixDifference(ulqr_GetCostToGoHessian(solver, 0), &dare->P) < 1e-9);
+  TEST(slap_MatrixNormedDifference(ulqr_GetFeedbackGain(solver, 0), &dare->K) < 1e-9);
+
+  // With the steady-state terminal cost, the cost-to-go is the same at every knot point
+  TEST(ulqr_SetDARETerminalCost(solver, dare) == 0);
+  TEST(ulqr_SolveRiccati(solver) == 0);
+  double err = 0.0;
+  for (int k = 0; k < nhorizon - 1; ++k) {
+    err = fmax(err, SymMatrixDifference(ulqr_GetCostToGoHessian(solver, k), &dare->P));
+    err = fmax(err, slap_MatrixNormedDifference(ulqr_GetFeedbackGain(solver, k), &dare->K));
+  }
+  TEST(err < 1e-9);
+  TEST(KKTResidual(solver) < 1e-8);
+
+  // so without affine terms, which the DARE doesn't cover, the backward pass reuses it
+  // right away
+  for (int k = 0; k < nhorizon; ++k) {
+    slap_MatrixSetConst(ulqr_Getq(solver, k), 0.0);
+    slap_MatrixSetConst(ulqr_Getr(solver, k), 0.0);
+    slap_MatrixSetConst(ulqr_Getf(solver, k), 0.0);
+  }
+  solver->steady_state_tol = 1e-10;
+  TEST(ulqr_SolveRiccati(solver) == 0);
+  TEST(solver->steady_state_count >= nhorizon - 4);
+  TEST(KKTResidual(solver) < 1e-8);
+
+  RiccatiSolver* other = RandomLQRProblem(5, 2, nhorizon);
+  TEST(ulqr_SetDARETerminalCost(other, dare) == -1);
+
+  ulqr_FreeDARESolver(&dare);
+  ulqr_FreeRiccatiSolver(&solver);
+  ulqr_FreeRiccatiSolver(&other);
+}
+
+int main() {
+  TestSolveDARE();
+  TestBackwardPassLimit();
+  PrintTestResult();
+  return TestResult();
+}
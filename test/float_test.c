@@ -0,0 +1,124 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "riccati/riccati_solve.h"
+#include "riccati/riccati_solver.h"
+#include "simpletest/simpletest.h"
+#include "slap/linalg.h"
+#include "slap/matrix.h"
+#include "test_utils.h"
+
+// Single-precision machine epsilon
+static const double kEps = 1.1920929e-7;
+
+void FloatTypesTest() {
+  Matrix A = slap_NewMatrix(2, 2);
+  TEST(sizeof(sfloat) == sizeof(float));
+  TEST(sizeof(*A.data) == sizeof(float));
+  slap_FreeMatrix(&A);
+}
+
+// Compares the float kernels against the same computation done in double precision
+void FloatLinalgTest() {
+  const int sizes[] = {3, 8, 13, 50};
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+    int n = sizes[s];
+    Matrix X = slap_NewMatrix(n, n);
+    Matrix A = slap_NewMatrix(n, n);
+    Matrix b = slap_NewMatrix(n, 1);
+    Matrix x = slap_NewMatrix(n, 1);
+    for (int i = 0; i < n * n; ++i) {
+      X.data[i] = sin(0.9 * i + s);
+    }
+    for (int i = 0; i < n; ++i) {
+      b.data[i] = cos(1.1 * i);
+    }
+
+    // A = X'X + n I is well-conditioned
+    slap_MatrixMultiply(&X, &X, &A, 1, 0, 1.0, 0.0);
+    slap_AddDiagonal(&A, n);
+    double err = 0.0;
+    for (int j = 0; j < n; ++j) {
+      for (int i = 0; i < n; ++i) {
+        double aij = i == j ? n : 0.0;
+        double scale = aij;  // the usual bound on the rounding error of a dot product
+        for (int k = 0; k < n; ++k) {
+          aij += (double)X.data[k + i * n] * (double)X.data[k + j * n];
+          scale += fabs((double)X.data[k + i * n] * (double)X.data[k + j * n]);
+        }
+        err = fmax(err, fabs(aij - A.data[i + j * n]) / scale);
+      }
+    }
+    TEST(err < n * kEps);
+
+    // A x = b
+    slap_MatrixCopy(&x, &b);
+    TEST(slap_CholeskyFactorize(&A) == slap_kCholeskySuccess);
+    slap_CholeskySolve(&A, &x);
+    slap_MatrixMultiply(&X, &X, &A, 1, 0, 1.0, 0.0);
+    slap_AddDiagonal(&A, n);
+    double res = 0.0;
+    for (int i = 0; i < n; ++i) {
+      double ri = -b.data[i];
+      for (int j = 0; j < n; ++j) {
+        ri += (double)A.data[i + j * n] * (double)x.data[j];
+      }
+      res = fmax(res, fabs(ri));
+    }
+    TEST(res < 10 * n * kEps);
+
+    slap_FreeMatrix(&X);
+    slap_FreeMatrix(&A);
+    slap_FreeMatrix(&b);
+    slap_FreeMatrix(&x);
+  }
+}
+
+void FloatRiccatiTest() {
+  const int sizes[][3] = {{4, 2, 11}, {6, 3, 20}, {12, 4, 30}};
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+    RiccatiSolver* solver = RandomLQRProblem(sizes[s][0], sizes[s][1], sizes[s][2]);
+    TEST(ulqr_SolveRiccati(solver) == 0);
+    double res = KKTResidual(solver);
+    printf("KKT residual for (n,m,N) = (%d,%d,%d): %g\n", sizes[s][0], sizes[s][1], sizes[s][2],
+           res);
+    TEST(res < 2e-4);  // about 1000 eps times the size of the dual variables
+    ulqr_FreeRiccatiSolver(&solver);
+  }
+}
+
+void FloatSqrtRiccatiTest() {
+  // Includes a long horizon, over which the cost-to-go converges
+  const int sizes[][3] = {{4, 2, 11}, {6, 3, 20}, {12, 4, 30}, {6, 3, 500}};
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+    RiccatiSolver* solver = RandomLQRProblem(sizes[s][0], sizes[s][1], sizes[s][2]);
+    RiccatiSolver* solver_sqrt = RandomLQRProblem(sizes[s][0], sizes[s][1], sizes[s][2]);
+    solver_sqrt->sqrt_backward_pass = true;
+    TEST(ulqr_SolveRiccati(solver) == 0);
+    TEST(ulqr_SolveRiccati(solver_sqrt) == 0);
+    double res = KKTResidual(solver_sqrt);
+    printf("Square-root KKT residual for (n,m,N) = (%d,%d,%d): %g\n", sizes[s][0], sizes[s][1],
+           sizes[s][2], res);
+    TEST(res < 1e-3);
+
+    // Both passes agree to within the conditioning of the gains
+    double err = 0.0;
+    for (int k = 0; k < solver->nhorizon - 1; ++k) {
+      Matrix* Kd = ulqr_GetGains(solver, k);
+      err = fmax(err, slap_MatrixNormedDifference(Kd, ulqr_GetGains(solver_sqrt, k)) /
+                          slap_TwoNorm(Kd));
+    }
+    TEST(err < 1000 * kEps);
+    ulqr_FreeRiccatiSolver(&solver);
+    ulqr_FreeRiccatiSolver(&solver_sqrt);
+  }
+}
+
+int main() {
+  FloatTypesTest();
+  FloatLinalgTest();
+  FloatRiccatiTest();
+  FloatSqrtRiccatiTest();
+  PrintTestResult();
+  return TestResult();
+}
@@ -0,0 +1,134 @@
+#include "slap/isa.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "simpletest/simpletest.h"
+#include "slap/batchmatrix.h"
+#include "slap/kernels.h"
+
+enum {
+  kM = 70,  // large enough for the packed GEMM and the blocked Cholesky
+  kK = 53,
+  kNrhs = 7,
+  kBatchN = 5,
+  kOutputSize = 2 * kM * kM + kM * kNrhs + kM * (kM + 1) / 2 + kM * kNrhs +
+                2 * kBatchN * kBatchN * SLAP_BATCH_SIZE,
+};
+
+/*
+ * Run a few kernels on the same data, copying all the results to out. Covers ragged
+ * edges for every vector length.
+ */
+void RunKernels(double* out) {
+  double A[kM * kK];
+  double B[kK * kM];
+  double S[kM * kM];
+  double X[kM * kNrhs];
+  for (int i = 0; i < kM * kK; ++i) {
+    A[i] = sin(0.37 * i);
+    B[i] = cos(0.51 * i);
+  }
+  for (int i = 0; i < kM * kNrhs; ++i) {
+    X[i] = cos(1.3 * i);
+  }
+
+  // GEMM, transposed and not
+  slap_Gemm(false, false, kM, kM, kK, 1.5, A, kM, B, kK, 0.0, out, kM);
+  out += kM * kM;
+
+  // Cholesky factorization and solve of an SPD matrix
+  slap_Gemm(false, true, kM, kM, kK, 1.0, A, kM, A, kM, 0.0, S, kM);
+  for (int i = 0; i < kM; ++i) {
+    S[i + i * kM] += 1.0;
+  }
+  double Ap[kM * (kM + 1) / 2];
+  for (int j = 0, k = 0; j < kM; ++j) {
+    for (int i = j; i < kM; ++i) {
+      Ap[k++] = S[i + j * kM];
+    }
+  }
+  TEST(slap_Potrf(kM, S, kM) == 0);
+  memcpy(out, S, sizeof(S));
+  out += kM * kM;
+  memcpy(out, X, sizeof(X));
+  slap_Trsm(false, kM, kNrhs, S, kM, out, kM);
+  slap_Trsm(true, kM, kNrhs, S, kM, out, kM);
+  out += kM * kNrhs;
+
+  // Packed Cholesky
+  TEST(slap_Pptrf(kM, Ap) == 0);
+  memcpy(out, Ap, sizeof(Ap));
+  out += kM * (kM + 1) / 2;
+  memcpy(out, X, sizeof(X));
+  slap_Pptrs(kM, kNrhs, Ap, out, kM);
+  out += kM * kNrhs;
+
+  // Batched GEMM and Cholesky
+  const int nb = kBatchN * kBatchN * SLAP_BATCH_SIZE;
+  double Ab[kBatchN * kBatchN * SLAP_BATCH_SIZE];
+  for (int i = 0; i < nb; ++i) {
+    Ab[i] = sin(0.7 * i);
+  }
+  slap_BatchGemm(false, true, kBatchN, kBatchN, kBatchN, 1.0, Ab, kBatchN, Ab, kBatchN, 0.0,
+                 out, kBatchN);
+  for (int i = 0; i < kBatchN; ++i) {
+    for (int b = 0; b < SLAP_BATCH_SIZE; ++b) {
+      out[(i + i * kBatchN) * SLAP_BATCH_SIZE + b] += 1.0;
+    }
+  }
+  memcpy(out + nb, out, nb * sizeof(double));
+  TEST(slap_BatchPotrf(kBatchN, out + nb, kBatchN) == 0);
+}
+
+void SelectionTest() {
+  enum slap_KernelIsa best = slap_DetectKernelIsa();
+  TEST(slap_KernelIsaSupported(best));
+  TEST(slap_KernelIsaSupported(slap_kIsaBaseline));
+  TEST(slap_GetKernelIsa() == best);
+  printf("Kernels use %s\n", slap_KernelIsaName(best));
+
+  TEST(slap_SetKernelIsa(slap_kNumIsas) == -1);
+  TEST(!slap_KernelIsaSupported(slap_kNumIsas));
+  TEST(strcmp(slap_KernelIsaName(slap_kIsaAvx2), "avx2") == 0);
+  for (int isa = 0; isa < slap_kNumIsas; ++isa) {
+    if (slap_KernelIsaSupported(isa)) {
+      TEST(slap_SetKernelIsa(isa) == 0);
+      TEST(slap_GetKernelIsa() == (enum slap_KernelIsa)isa);
+    } else {
+      enum slap_KernelIsa current = slap_GetKernelIsa();
+      TEST(slap_SetKernelIsa(isa) == -1);
+      TEST(slap_GetKernelIsa() == current);
+    }
+  }
+  slap_SetKernelIsa(best);
+}
+
+void VariantsAgreeTest() {
+  static double expected[kOutputSize];
+  static double actual[kOutputSize];
+  TEST(slap_SetKernelIsa(slap_kIsaBaseline) == 0);
+  RunKernels(expected);
+  for (int isa = slap_kIsaBaseline + 1; isa < slap_kNumIsas; ++isa) {
+    if (!slap_KernelIsaSupported(isa)) {
+      continue;
+    }
+    slap_SetKernelIsa(isa);
+    memset(actual, 0, sizeof(actual));
+    RunKernels(actual);
+    double err = 0.0;
+    for (int i = 0; i < kOutputSize; ++i) {
+      err = fmax(err, fabs(actual[i] - expected[i]) / (1.0 + fabs(expected[i])));
+    }
+    TEST(err < 1e-10);
+  }
+  slap_SetKernelIsa(slap_DetectKernelIsa());
+}
+
+int main() {
+  SelectionTest();
+  VariantsAgreeTest();
+  PrintTestResult();
+  return TestResult();
+}
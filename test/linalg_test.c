@@ -1,5 +1,7 @@
 #include "slap/linalg.h"
 
+#include <math.h>
+
 #include "simpletest/simpletest.h"
 #include "slap/matrix.h"
 
@@ -34,8 +36,8 @@ int MatMul() {
   // Matrix-vector
   double xdata[4] = {1, 2, 3, 4};
   double bdata[3] = {40, 40, 40};
-  Matrix x = {4, 1, xdata};
-  Matrix bans = {3, 1, bdata};
+  Matrix x = {4, 1, xdata, 4};
+  Matrix bans = {3, 1, bdata, 3};
   Matrix b = slap_NewMatrix(3, 1);
   slap_MatrixMultiply(&A, &x, &b, 0, 0, 1.0, 0.0);
   TEST(slap_MatrixNormedDifference(&b, &bans) < 1e-6);
@@ -51,6 +53,63 @@ int MatMul() {
   return 1;
 }
 
+// Reference implementation of C = alpha * op(A) * op(B) + beta * C
+void NaiveMatMul(Matrix* A, Matrix* B, Matrix* C, bool tA, bool tB, double alpha, double beta) {
+  int n = tA ? A->cols : A->rows;
+  int m = tA ? A->rows : A->cols;
+  int p = tB ? B->rows : B->cols;
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < p; ++j) {
+      double Cij = 0.0;
+      for (int k = 0; k < m; ++k) {
+        Cij += *slap_MatrixGetElementTranspose(A, i, k, tA) *
+               *slap_MatrixGetElementTranspose(B, k, j, tB);
+      }
+      double* C_ij = slap_MatrixGetElement(C, i, j);
+      *C_ij = alpha * Cij + beta * (*C_ij);
+    }
+  }
+}
+
+void MatMulSizesTest() {
+  // Covers the register-blocked kernels, their edge cases, and the packed path
+  const int sizes[][3] = {{1, 1, 1}, {3, 5, 2},    {4, 4, 4},    {8, 4, 9},
+                          {13, 7, 6}, {2, 11, 17}, {50, 51, 49}, {70, 130, 140}};
+  const double alpha = 1.5;
+  const double beta = -0.5;
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+    int n = sizes[s][0];
+    int m = sizes[s][1];
+    int p = sizes[s][2];
+    for (int t = 0; t < 4; ++t) {
+      bool tA = t & 1;
+      bool tB = t & 2;
+      Matrix A = tA ? slap_NewMatrix(m, n) : slap_NewMatrix(n, m);
+      Matrix B = tB ? slap_NewMatrix(p, m) : slap_NewMatrix(m, p);
+      Matrix C = slap_NewMatrix(n, p);
+      Matrix Cans = slap_NewMatrix(n, p);
+      for (int i = 0; i < n * m; ++i) {
+        A.data[i] = sin(0.3 * i + t);
+      }
+      for (int i = 0; i < m * p; ++i) {
+        B.data[i] = cos(0.7 * i - s);
+      }
+      for (int i = 0; i < n * p; ++i) {
+        C.data[i] = 0.1 * i;
+        Cans.data[i] = C.data[i];
+      }
+      slap_MatrixMultiply(&A, &B, &C, tA, tB, alpha, beta);
+      NaiveMatMul(&A, &B, &Cans, tA, tB, alpha, beta);
+      TEST(slap_MatrixNormedDifference(&C, &Cans) < 1e-10 * (1 + slap_TwoNorm(&Cans)));
+
+      slap_FreeMatrix(&A);
+      slap_FreeMatrix(&B);
+      slap_FreeMatrix(&C);
+      slap_FreeMatrix(&Cans);
+    }
+  }
+}
+
 int SymMatMulTest() {
   // clang-format off
   double Adata[9] = {1,2,3, 4,5,6, 7,8,9};
@@ -58,10 +117,10 @@ int SymMatMulTest() {
   double Cdata[6] = {3,6,9, 12,11,10};
   double Ddata[6] = {34,72,102, 56,92,116};
   // clang-format on
-  Matrix A = {3, 3, Adata};
-  Matrix B = {3, 2, Bdata};
-  Matrix C = {3, 2, Cdata};
-  Matrix D = {3, 2, Ddata};
+  Matrix A = {3, 3, Adata, 3};
+  Matrix B = {3, 2, Bdata, 3};
+  Matrix C = {3, 2, Cdata, 3};
+  Matrix D = {3, 2, Ddata, 3};
   slap_SymmetricMatrixMultiply(&A, &B, &C, 1.0, 2.0);
   TEST(slap_MatrixNormedDifference(&C, &D) < 1e-6);
   return 1;
@@ -74,10 +133,10 @@ int MatAddTest() {
   double Cdata[6] = {3,6,9, 12,11,10};
   double Ddata[6] = {1,2,3, 4,1,-2};
   // clang-format on
-  Matrix A = {2, 3, Adata};
-  Matrix B = {2, 3, Bdata};
-  Matrix C = {2, 3, Cdata};
-  Matrix D = {2, 3, Ddata};
+  Matrix A = {2, 3, Adata, 2};
+  Matrix B = {2, 3, Bdata, 2};
+  Matrix C = {2, 3, Cdata, 2};
+  Matrix D = {2, 3, Ddata, 2};
   slap_MatrixAddition(&A, &B, 1.0);
   TEST(slap_MatrixNormedDifference(&B, &C) < 1e-6);
 
@@ -91,8 +150,8 @@ int MatScale() {
   // clang-format off
   double Adata[6] = {1,2,3, 4,5,6};
   double Bdata[6] = {3,6,9, 12,15,18};
-  Matrix A = {2, 3, Adata};
-  Matrix B = {2, 3, Bdata};
+  Matrix A = {2, 3, Adata, 2};
+  Matrix B = {2, 3, Bdata, 2};
   // clang-format on
   slap_MatrixScale(&A, 3);
   TEST(slap_MatrixNormedDifference(&A, &B) < 1e-6);
@@ -136,6 +195,211 @@ int CholeskyFactorizeTest() {
   return 1;
 }
 
+void CholeskySizesTest() {
+  // Covers the register kernel, the blocked algorithm, and its nested diagonal blocks
+  const int sizes[] = {1, 2, 5, 8, 9, 17, 33, 60, 75};
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+    int n = sizes[s];
+    Matrix A1 = slap_NewMatrix(n, n);
+    Matrix A = slap_NewMatrix(n, n);
+    Matrix L = slap_NewMatrix(n, n);
+    Matrix LLt = slap_NewMatrix(n, n);
+    for (int i = 0; i < n * n; ++i) {
+      A1.data[i] = sin(1.1 * i + s);
+    }
+    slap_MatrixMultiply(&A1, &A1, &A, 1, 0, 1.0, 0.0);
+    slap_AddDiagonal(&A, 0.5);
+    slap_MatrixCopy(&L, &A);
+    if (n > 1) {
+      slap_MatrixSetElement(&L, 0, n - 1, 42.0);
+    }
+    int res = slap_CholeskyFactorize(&L);
+    TEST(res == slap_kCholeskySuccess);
+
+    // Upper triangle should be untouched
+    if (n > 1) {
+      TEST(*slap_MatrixGetElement(&L, 0, n - 1) == 42.0);
+    }
+    for (int j = 0; j < n; ++j) {
+      for (int i = 0; i < j; ++i) {
+        slap_MatrixSetElement(&L, i, j, 0.0);
+      }
+    }
+    slap_MatrixMultiply(&L, &L, &LLt, 0, 1, 1.0, 0.0);
+    TEST(slap_MatrixNormedDifference(&LLt, &A) < 1e-10 * slap_TwoNorm(&A));
+
+    // Make the matrix indefinite at the last column
+    slap_MatrixCopy(&L, &A);
+    slap_MatrixSetElement(&L, n - 1, n - 1, -1.0);
+    res = slap_CholeskyFactorize(&L);
+    TEST(res == slap_kCholeskyFail);
+
+    slap_FreeMatrix(&A1);
+    slap_FreeMatrix(&A);
+    slap_FreeMatrix(&L);
+    slap_FreeMatrix(&LLt);
+  }
+}
+
+void RegularizedCholeskyTest() {
+  const int sizes[] = {1, 3, 9, 17};
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+    int n = sizes[s];
+    Matrix A1 = slap_NewMatrix(n, n);
+    Matrix A = slap_NewMatrix(n, n);
+    Matrix L = slap_NewMatrix(n, n);
+    Matrix LLt = slap_NewMatrix(n, n);
+    SymMatrix Asym = slap_NewSymMatrix(n);
+    for (int i = 0; i < n * n; ++i) {
+      A1.data[i] = sin(1.3 * i + s);
+    }
+    slap_MatrixMultiply(&A1, &A1, &A, 1, 0, 1.0, 0.0);
+    slap_AddDiagonal(&A, 0.5);
+
+    // Indefinite in the middle, where the plain factorization fails
+    int j_bad = n / 2;
+    *slap_MatrixAt(&A, j_bad, j_bad) = -1.0;
+    slap_SymMatrixPack(&Asym, &A);
+    slap_MatrixCopy(&L, &A);
+    TEST(slap_CholeskyFactorize(&L) == slap_kCholeskyFail);
+
+    // The same shift is applied to every column, including the ones before the bad pivot
+    sfloat shift = 0.0;
+    int nretries = -1;
+    int res = slap_CholeskyFactorizeRegularized(&L, &Asym, 1e-6, 1e6, &shift, &nretries);
+    TEST(res == slap_kCholeskySuccess);
+    TEST(shift > 0.0);
+    TEST(nretries > 0);
+    TESTAPPROX(shift, 1e-6 * pow(10, nretries - 1), 1e-6 * shift);
+    for (int j = 0; j < n; ++j) {
+      for (int i = 0; i < j; ++i) {
+        *slap_MatrixAt(&L, i, j) = 0.0;
+      }
+    }
+    slap_MatrixMultiply(&L, &L, &LLt, 0, 1, 1.0, 0.0);
+    slap_AddDiagonal(&A, shift);
+    TEST(slap_MatrixNormedDifference(&LLt, &A) < 1e-10 * slap_TwoNorm(&A));
+    slap_AddDiagonal(&A, -shift);
+
+    // The smallest shift is used: the previous one leaves the matrix indefinite
+    if (nretries > 1) {
+      slap_MatrixCopy(&L, &A);
+      slap_AddDiagonal(&L, shift / 10);
+      TEST(slap_CholeskyFactorize(&L) == slap_kCholeskyFail);
+    }
+
+    // Fails if the shift can't grow large enough, or regularization is disabled
+    res = slap_CholeskyFactorizeRegularized(&L, &Asym, 1e-6, 1e-3, &shift, &nretries);
+    TEST(res == slap_kCholeskyFail);
+    TEST(shift <= 1e-3);
+    res = slap_CholeskyFactorizeRegularized(&L, &Asym, 1e-6, 0.0, &shift, &nretries);
+    TEST(res == slap_kCholeskyFail);
+    TEST(nretries == 0);
+
+    slap_FreeMatrix(&A1);
+    slap_FreeMatrix(&A);
+    slap_FreeMatrix(&L);
+    slap_FreeMatrix(&LLt);
+    slap_FreeSymMatrix(&Asym);
+  }
+}
+
+void CholeskyUpdateTest() {
+  const int sizes[][2] = {{1, 1}, {3, 1}, {5, 2}, {9, 3}, {17, 4}};
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+    int n = sizes[s][0];
+    int k = sizes[s][1];
+    Matrix A1 = slap_NewMatrix(n, n);
+    Matrix A = slap_NewMatrix(n, n);
+    Matrix X = slap_NewMatrix(n, k);
+    Matrix Xcopy = slap_NewMatrix(n, k);
+    Matrix L = slap_NewMatrix(n, n);
+    Matrix Lref = slap_NewMatrix(n, n);
+    for (int i = 0; i < n * n; ++i) {
+      A1.data[i] = sin(0.9 * i + s);
+    }
+    for (int i = 0; i < n * k; ++i) {
+      X.data[i] = cos(1.7 * i + s);
+    }
+    slap_MatrixMultiply(&A1, &A1, &A, 1, 0, 1.0, 0.0);
+    slap_AddDiagonal(&A, 0.5);
+    slap_MatrixCopy(&L, &A);
+    slap_CholeskyFactorize(&L);
+
+    // Update, compared against the factor of A + X X'
+    slap_MatrixCopy(&Xcopy, &X);
+    TEST(slap_CholeskyUpdate(&L, &Xcopy) == slap_kCholeskySuccess);
+    slap_MatrixCopy(&Lref, &A);
+    slap_MatrixMultiply(&X, &X, &Lref, 0, 1, 1.0, 1.0);
+    slap_CholeskyFactorize(&Lref);
+    for (int j = 0; j < n; ++j) {
+      for (int i = j; i < n; ++i) {
+        TESTAPPROX(*slap_MatrixAt(&L, i, j), *slap_MatrixAt(&Lref, i, j), 1e-10);
+      }
+    }
+
+    // Downdating recovers the original factor
+    slap_MatrixCopy(&Xcopy, &X);
+    TEST(slap_CholeskyDowndate(&L, &Xcopy) == slap_kCholeskySuccess);
+    slap_MatrixCopy(&Lref, &A);
+    slap_CholeskyFactorize(&Lref);
+    for (int j = 0; j < n; ++j) {
+      for (int i = j; i < n; ++i) {
+        TESTAPPROX(*slap_MatrixAt(&L, i, j), *slap_MatrixAt(&Lref, i, j), 1e-9);
+      }
+    }
+
+    // Downdating by too much fails
+    slap_MatrixCopy(&Xcopy, &X);
+    slap_MatrixScaleByConst(&Xcopy, 1e3);
+    TEST(slap_CholeskyDowndate(&L, &Xcopy) == slap_kCholeskyFail);
+
+    slap_FreeMatrix(&A1);
+    slap_FreeMatrix(&A);
+    slap_FreeMatrix(&X);
+    slap_FreeMatrix(&Xcopy);
+    slap_FreeMatrix(&L);
+    slap_FreeMatrix(&Lref);
+  }
+}
+
+void TriMultiplyTest() {
+  const int sizes[][2] = {{1, 1}, {3, 2}, {9, 1}, {17, 5}};
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+    int n = sizes[s][0];
+    int ncols = sizes[s][1];
+    Matrix L = slap_NewMatrix(n, n);
+    Matrix Ldense = slap_NewMatrix(n, n);
+    Matrix B = slap_NewMatrix(n, ncols);
+    Matrix C = slap_NewMatrix(n, ncols);
+    for (int i = 0; i < n * n; ++i) {
+      L.data[i] = sin(0.7 * i + s);
+    }
+    for (int i = 0; i < n * ncols; ++i) {
+      B.data[i] = cos(1.3 * i);
+    }
+
+    // The upper triangle should be ignored
+    slap_MatrixCopy(&Ldense, &L);
+    for (int j = 1; j < n; ++j) {
+      for (int i = 0; i < j; ++i) {
+        *slap_MatrixAt(&Ldense, i, j) = 0.0;
+      }
+    }
+    for (int t = 0; t < 2; ++t) {
+      bool tL = t == 1;
+      slap_MatrixCopy(&C, &B);
+      slap_LowerTriMultiply(&L, &C, tL);
+      slap_MatrixMultiply(&Ldense, &B, &C, tL, 0, -1.0, 1.0);
+      TEST(slap_TwoNorm(&C) < 1e-12 * n);
+    }
+    slap_FreeMatrix(&L);
+    slap_FreeMatrix(&Ldense);
+    slap_FreeMatrix(&B);
+    slap_FreeMatrix(&C);
+  }
+}
+
 int TriBackSubTest() {
   int n = 3;
   double Ldata[9] = {1, 2, 5, 0, 1, 6, 0, 0, 7};
@@ -143,10 +407,10 @@ int TriBackSubTest() {
   double ydata[3] = {-2.0, 7.0, -3.142857142857143};
   double xdata[3] = {-19.142857142857142, 9.693877551020408, -0.4489795918367347};
 
-  Matrix L = {n, n, Ldata};
-  Matrix b = {n, 1, bdata};
-  Matrix y = {n, 1, ydata};
-  Matrix x = {n, 1, xdata};
+  Matrix L = {n, n, Ldata, n};
+  Matrix b = {n, 1, bdata, n};
+  Matrix y = {n, 1, ydata, n};
+  Matrix x = {n, 1, xdata, n};
   slap_LowerTriBackSub(&L, &b, 0);
   TEST(slap_MatrixNormedDifference(&b, &y) < 1e-6);
 
@@ -156,6 +420,43 @@ int TriBackSubTest() {
   return 1;
 }
 
+void CholeskySolveSizesTest() {
+  // Exercises the multi right-hand-side tiles and the blocked triangular solves
+  const int sizes[][2] = {{1, 1}, {3, 7}, {8, 4}, {10, 11}, {40, 3}, {70, 41}};
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+    int n = sizes[s][0];
+    int m = sizes[s][1];
+    Matrix A1 = slap_NewMatrix(n, n);
+    Matrix A = slap_NewMatrix(n, n);
+    Matrix L = slap_NewMatrix(n, n);
+    Matrix b = slap_NewMatrix(n, m);
+    Matrix x = slap_NewMatrix(n, m);
+    Matrix Ax = slap_NewMatrix(n, m);
+    for (int i = 0; i < n * n; ++i) {
+      A1.data[i] = cos(0.9 * i - s);
+    }
+    for (int i = 0; i < n * m; ++i) {
+      b.data[i] = sin(0.4 * i) + 1.0;
+    }
+    slap_MatrixMultiply(&A1, &A1, &A, 1, 0, 1.0, 0.0);
+    slap_AddDiagonal(&A, 1.0);
+    slap_MatrixCopy(&L, &A);
+    slap_MatrixCopy(&x, &b);
+
+    slap_CholeskyFactorize(&L);
+    slap_CholeskySolve(&L, &x);
+    slap_MatrixMultiply(&A, &x, &Ax, 0, 0, 1.0, 0.0);
+    TEST(slap_MatrixNormedDifference(&Ax, &b) < 1e-8 * slap_TwoNorm(&b));
+
+    slap_FreeMatrix(&A1);
+    slap_FreeMatrix(&A);
+    slap_FreeMatrix(&L);
+    slap_FreeMatrix(&b);
+    slap_FreeMatrix(&x);
+    slap_FreeMatrix(&Ax);
+  }
+}
+
 int CholeskySolveTest() {
   int n = 10;
   int m = 1;
@@ -206,13 +507,205 @@ int CholeskySolveTest() {
   return 1;
 }
 
+void SymTripleProductTest() {
+  const int sizes[][2] = {{1, 1}, {4, 3}, {5, 9}, {17, 20}, {40, 33}};
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+    int n = sizes[s][0];
+    int k = sizes[s][1];
+    Matrix X = slap_NewMatrix(k, n);
+    Matrix P1 = slap_NewMatrix(k, k);
+    Matrix P = slap_NewMatrix(k, k);
+    Matrix PX = slap_NewMatrix(k, n);
+    Matrix C = slap_NewMatrix(n, n);
+    Matrix Cans = slap_NewMatrix(n, n);
+    for (int i = 0; i < n * k; ++i) {
+      X.data[i] = sin(0.6 * i + s);
+    }
+    for (int i = 0; i < k * k; ++i) {
+      P1.data[i] = cos(0.2 * i);
+    }
+    slap_MatrixMultiply(&P1, &P1, &P, 1, 0, 1.0, 0.0);
+    for (int j = 0; j < n; ++j) {
+      for (int i = 0; i < n; ++i) {
+        double val = 1.0 + i + j;
+        slap_MatrixSetElement(&C, i, j, val);
+        slap_MatrixSetElement(&Cans, i, j, val);
+      }
+    }
+
+    // Cans = 2 X'PX - C
+    slap_MatrixMultiply(&P, &X, &PX, 0, 0, 1.0, 0.0);
+    slap_MatrixMultiply(&X, &PX, &Cans, 1, 0, 2.0, -1.0);
+    slap_SymmetricTripleProduct(&X, &P, &C, 2.0, -1.0, true);
+    TEST(slap_MatrixNormedDifference(&C, &Cans) < 1e-10 * slap_TwoNorm(&Cans));
+
+    // Without mirroring, the strict upper triangle is left alone
+    slap_MatrixSetConst(&C, -3.0);
+    slap_SymmetricTripleProduct(&X, &P, &C, 1.0, 0.0, false);
+    if (n > 1) {
+      TEST(*slap_MatrixGetElement(&C, 0, n - 1) == -3.0);
+    }
+    slap_MatrixMultiply(&X, &PX, &Cans, 1, 0, 1.0, 0.0);
+    TESTAPPROX(*slap_MatrixGetElement(&C, n - 1, 0), *slap_MatrixGetElement(&Cans, n - 1, 0),
+               1e-10);
+
+    slap_FreeMatrix(&X);
+    slap_FreeMatrix(&P1);
+    slap_FreeMatrix(&P);
+    slap_FreeMatrix(&PX);
+    slap_FreeMatrix(&C);
+    slap_FreeMatrix(&Cans);
+  }
+}
+
+void SymmetricRankKUpdateTest() {
+  const int sizes[][2] = {{1, 1}, {4, 3}, {5, 9}, {17, 2}, {40, 33}};
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+    int n = sizes[s][0];
+    int k = sizes[s][1];
+    Matrix X = slap_NewMatrix(k, n);
+    Matrix C = slap_NewMatrix(n, n);
+    Matrix Cans = slap_NewMatrix(n, n);
+    for (int i = 0; i < n * k; ++i) {
+      X.data[i] = sin(0.7 * i + s);
+    }
+    for (int j = 0; j < n; ++j) {
+      for (int i = 0; i < n; ++i) {
+        double val = 1.0 + i + j;
+        slap_MatrixSetElement(&C, i, j, val);
+        slap_MatrixSetElement(&Cans, i, j, val);
+      }
+    }
+
+    // Cans = C - X'X
+    slap_MatrixMultiply(&X, &X, &Cans, 1, 0, -1.0, 1.0);
+    slap_SymmetricRankKUpdate(&X, &C, -1.0, 1.0, true);
+    TEST(slap_MatrixNormedDifference(&C, &Cans) < 1e-10 * slap_TwoNorm(&Cans));
+
+    // Without mirroring, the strict upper triangle is left alone
+    slap_MatrixSetConst(&C, -3.0);
+    slap_SymmetricRankKUpdate(&X, &C, 2.0, 0.0, false);
+    if (n > 1) {
+      TEST(*slap_MatrixGetElement(&C, 0, n - 1) == -3.0);
+    }
+    slap_MatrixMultiply(&X, &X, &Cans, 1, 0, 2.0, 0.0);
+    TESTAPPROX(*slap_MatrixGetElement(&C, n - 1, 0), *slap_MatrixGetElement(&Cans, n - 1, 0),
+               1e-10);
+
+    slap_FreeMatrix(&X);
+    slap_FreeMatrix(&C);
+    slap_FreeMatrix(&Cans);
+  }
+}
+
+void LUTest() {
+  const int n = 7;
+  const int nrhs = 3;
+  Matrix A = slap_NewMatrix(n, n);
+  Matrix LU = slap_NewMatrix(n, n);
+  Matrix X = slap_NewMatrix(n, nrhs);
+  Matrix B = slap_NewMatrix(n, nrhs);
+  int ipiv[7];
+
+  // Nonsymmetric, with a zero on the diagonal so that it needs pivoting
+  for (int i = 0; i < n * n; ++i) {
+    A.data[i] = sin(0.7 * i * i + 0.3);
+  }
+  slap_MatrixSetElement(&A, 0, 0, 0.0);
+  for (int i = 0; i < n * nrhs; ++i) {
+    X.data[i] = cos(0.4 * i);
+  }
+  slap_MatrixMultiply(&A, &X, &B, 0, 0, 1.0, 0.0);
+  slap_MatrixCopy(&LU, &A);
+  TEST(slap_LUFactorize(&LU, ipiv) == 0);
+  TEST(slap_LUSolve(&LU, ipiv, &B) == 0);
+  TEST(slap_MatrixNormedDifference(&B, &X) < 1e-10);
+
+  // Singular
+  slap_MatrixSetConst(&LU, 1.0);
+  TEST(slap_LUFactorize(&LU, ipiv) == -1);
+
+  slap_FreeMatrix(&A);
+  slap_FreeMatrix(&LU);
+  slap_FreeMatrix(&X);
+  slap_FreeMatrix(&B);
+}
+
+void StridedViewsTest() {
+  // Blocks of a larger matrix, surrounded by entries that should never be touched
+  const int m = 7;
+  const int n = 9;
+  const int k = 6;
+  const double sentinel = 1234.5;
+  Matrix W = slap_NewMatrix(m + k + 3, n + k + m + 2);
+  slap_MatrixSetConst(&W, sentinel);
+  Matrix A = slap_MatrixView(&W, 1, 0, m, k);
+  Matrix B = slap_MatrixView(&W, m + 2, 1, k, n);
+  Matrix C = slap_MatrixView(&W, 0, n + 1, m, n);
+  Matrix S = slap_MatrixView(&W, m + 1, n + 2, m, m);
+  Matrix x = slap_MatrixView(&W, 0, 2 * n + 1, m, 2);
+  int nviews = 0;
+  Matrix* views[] = {&A, &B, &C, &S, &x};
+  for (int v = 0; v < 5; ++v) {
+    for (int j = 0; j < views[v]->cols; ++j) {
+      for (int i = 0; i < views[v]->rows; ++i) {
+        slap_MatrixSetElement(views[v], i, j, sin(1.7 * nviews++));
+      }
+    }
+  }
+
+  // Dense copies
+  Matrix Ad = slap_NewMatrix(m, k);
+  Matrix Bd = slap_NewMatrix(k, n);
+  Matrix Cd = slap_NewMatrix(m, n);
+  Matrix Sd = slap_NewMatrix(m, m);
+  Matrix xd = slap_NewMatrix(m, 2);
+  slap_MatrixCopy(&Ad, &A);
+  slap_MatrixCopy(&Bd, &B);
+  slap_MatrixCopy(&Cd, &C);
+  slap_MatrixCopy(&xd, &x);
+
+  slap_MatrixMultiply(&A, &B, &C, 0, 0, 1.5, -0.5);
+  slap_MatrixMultiply(&Ad, &Bd, &Cd, 0, 0, 1.5, -0.5);
+  TEST(slap_MatrixNormedDifference(&C, &Cd) < 1e-12);
+
+  // Symmetric positive definite block, factored and solved in place
+  slap_MatrixMultiply(&C, &C, &S, 0, 1, 1.0, 0.0);
+  slap_AddDiagonal(&S, 1.0);
+  slap_MatrixCopy(&Sd, &S);
+  TEST(slap_CholeskyFactorize(&S) == slap_kCholeskySuccess);
+  TEST(slap_CholeskyFactorize(&Sd) == slap_kCholeskySuccess);
+  slap_CholeskySolve(&S, &x);
+  slap_CholeskySolve(&Sd, &xd);
+  TEST(slap_MatrixNormedDifference(&x, &xd) < 1e-10);
+
+  slap_MatrixAddition(&x, &xd, -1.0);
+  TEST(slap_TwoNorm(&xd) < 1e-10);
+  TESTAPPROX(slap_TwoNorm(&A), slap_TwoNorm(&Ad), 1e-12);
+  TESTAPPROX(slap_OneNorm(&B), slap_OneNorm(&Bd), 1e-12);
+
+  // Everything outside of the blocks is unchanged
+  int nsentinel = 0;
+  for (int i = 0; i < slap_MatrixNumElements(&W); ++i) {
+    nsentinel += W.data[i] == sentinel;
+  }
+  TEST(nsentinel == slap_MatrixNumElements(&W) - nviews);
+
+  slap_FreeMatrix(&W);
+  slap_FreeMatrix(&Ad);
+  slap_FreeMatrix(&Bd);
+  slap_FreeMatrix(&Cd);
+  slap_FreeMatrix(&Sd);
+  slap_FreeMatrix(&xd);
+}
+
 void TestQuadForm() {
   double xdata[3] = {1, 2, 3};
   double ydata[2] = {4, 5};
   double Adata[6] = {1, 1, 1, 2, 2, 2};
-  Matrix x = {3, 1, xdata};
-  Matrix y = {2, 1, ydata};
-  Matrix A = {3, 2, Adata};
+  Matrix x = {3, 1, xdata, 3};
+  Matrix y = {2, 1, ydata, 2};
+  Matrix A = {3, 2, Adata, 3};
   Matrix Ay = slap_NewMatrix(3, 1);
   slap_MatrixMultiply(&A, &y, &Ay, 0, 0, 1.0, 0.0);
   double val_dot = slap_DotProduct(&x, &Ay);
@@ -226,12 +719,22 @@ void TestQuadForm() {
 
 void AllTests() {
   MatMul();
+  MatMulSizesTest();
   MatAddTest();
   MatScale();
   CholeskyFactorizeTest();
+  CholeskySizesTest();
+  RegularizedCholeskyTest();
+  CholeskyUpdateTest();
   TriBackSubTest();
+  TriMultiplyTest();
   CholeskySolveTest();
+  CholeskySolveSizesTest();
   SymMatMulTest();
+  SymTripleProductTest();
+  SymmetricRankKUpdateTest();
+  LUTest();
+  StridedViewsTest();
 #ifdef USE_EIGEN
   printf("Using Eigen library for comparisons.\n");
 #endif
@@ -1,4 +1,5 @@
 #include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -14,14 +15,18 @@ double B[2] = {1, 2};        // NOLINT
 double f[2] = {4, 5};        // NOLINT
 double Q[4] = {2, 0, 0, 2};  // NOLINT
 double R[1] = {0.1};         // NOLINT
+double Qp[3] = {2, 0, 2};    // NOLINT
+double Rp[1] = {0.1};        // NOLINT
 double H[2] = {0, 0.1};      // NOLINT
 double q[2] = {0.1, 0.2};    // NOLINT
 double r[1] = {-0.6};        // NOLINT
 double c = 12.5;             // NOLINT
 
 void SetLQRData(LQRData* lqrdata) {
-  slap_MatrixCopyFromArray(&lqrdata->Q, Q);
-  slap_MatrixCopyFromArray(&lqrdata->R, R);
+  Matrix Qmat = {2, 2, Q, 2};
+  Matrix Rmat = {1, 1, R, 1};
+  slap_SymMatrixPack(&lqrdata->Q, &Qmat);
+  slap_SymMatrixPack(&lqrdata->R, &Rmat);
   slap_MatrixCopyFromArray(&lqrdata->H, H);
   slap_MatrixCopyFromArray(&lqrdata->q, q);
   slap_MatrixCopyFromArray(&lqrdata->r, r);
@@ -50,12 +55,8 @@ void TestInitializeLQRData() {
   mat = lqrdata->f;
   TEST(mat.rows == nstates);
   TEST(mat.cols == 1);
-  mat = lqrdata->Q;
-  TEST(mat.rows == nstates);
-  TEST(mat.cols == nstates);
-  mat = lqrdata->R;
-  TEST(mat.rows == ninputs);
-  TEST(mat.cols == ninputs);
+  TEST(lqrdata->Q.n == nstates);
+  TEST(lqrdata->R.n == ninputs);
   mat = lqrdata->H;
   TEST(mat.rows == ninputs);
   TEST(mat.cols == nstates);
@@ -71,32 +72,29 @@ void TestInitializeLQRData() {
   TEST(lqrdata->d.rows == ninputs);
   TEST(lqrdata->d.cols == 1);
 
-  TEST(lqrdata->P.rows == nstates);
-  TEST(lqrdata->P.cols == nstates);
+  TEST(lqrdata->P.n == nstates);
   TEST(lqrdata->p.rows == nstates);
   TEST(lqrdata->p.cols == 1);
 
-  TEST(lqrdata->Qxx.rows == nstates);
-  TEST(lqrdata->Qxx.cols == nstates);
+  TEST(lqrdata->Qxx.n == nstates);
   TEST(lqrdata->Qux.rows == ninputs);
   TEST(lqrdata->Qux.cols == nstates);
-  TEST(lqrdata->Quu.rows == ninputs);
-  TEST(lqrdata->Quu.cols == ninputs);
+  TEST(lqrdata->Quu.n == ninputs);
 
   TEST(lqrdata->y.rows == nstates);
   TEST(lqrdata->y.cols == 1);
-  TEST((lqrdata->y.data + nstates) - (lqrdata->Q.data) + 1 == LQRDataSize(nstates, ninputs));
+  TEST(lqrdata->y.data + nstates <= lqrdata->Q.data + LQRDataSize(nstates, ninputs));
 
   const double tol = 1e-8;
   SetLQRData(lqrdata);
-  TEST(SumOfSquaredError(Q, lqrdata->Q.data, nstates * nstates) < tol);
-  TEST(SumOfSquaredError(R, lqrdata->R.data, ninputs * ninputs) < tol);
-  TEST(SumOfSquaredError(H, lqrdata->H.data, nstates * ninputs) < tol);
+  TEST(SumOfSquaredError(Qp, lqrdata->Q.data, slap_SymMatrixNumElements(&lqrdata->Q)) < tol);
+  TEST(SumOfSquaredError(Rp, lqrdata->R.data, slap_SymMatrixNumElements(&lqrdata->R)) < tol);
+  TEST(MatrixArrayError(&lqrdata->H, H) < tol);
   TEST(SumOfSquaredError(q, lqrdata->q.data, nstates * 1) < tol);
   TEST(SumOfSquaredError(r, lqrdata->r.data, ninputs * 1) < tol);
   TEST(fabs(c - *lqrdata->c) < tol);
-  TEST(SumOfSquaredError(A, lqrdata->A.data, nstates * nstates) < tol);
-  TEST(SumOfSquaredError(B, lqrdata->B.data, nstates * ninputs) < tol);
+  TEST(MatrixArrayError(&lqrdata->A, A) < tol);
+  TEST(MatrixArrayError(&lqrdata->B, B) < tol);
   TEST(SumOfSquaredError(f, lqrdata->f.data, nstates * 1) < tol);
 
   // Test passing in bad pointer
@@ -131,14 +129,14 @@ void TestLQRDataCopy() {
   ulqr_CopyLQRData(data1, data0);
 
   const double tol = 1e-8;
-  TEST(SumOfSquaredError(Q, data1->Q.data, nstates * nstates) < tol);
-  TEST(SumOfSquaredError(R, data1->R.data, ninputs * ninputs) < tol);
-  TEST(SumOfSquaredError(H, data1->H.data, nstates * ninputs) < tol);
+  TEST(SumOfSquaredError(Qp, data1->Q.data, slap_SymMatrixNumElements(&data1->Q)) < tol);
+  TEST(SumOfSquaredError(Rp, data1->R.data, slap_SymMatrixNumElements(&data1->R)) < tol);
+  TEST(MatrixArrayError(&data1->H, H) < tol);
   TEST(SumOfSquaredError(q, data1->q.data, nstates * 1) < tol);
   TEST(SumOfSquaredError(r, data1->r.data, ninputs * 1) < tol);
   TEST(fabs(c - *data1->c) < tol);
-  TEST(SumOfSquaredError(A, data1->A.data, nstates * nstates) < tol);
-  TEST(SumOfSquaredError(B, data1->B.data, nstates * ninputs) < tol);
+  TEST(MatrixArrayError(&data1->A, A) < tol);
+  TEST(MatrixArrayError(&data1->B, B) < tol);
   TEST(SumOfSquaredError(f, data1->f.data, nstates * 1) < tol);
 
   free(lqrdata);
@@ -153,11 +151,26 @@ void TestLQRDataArray() {
   const int ninputs = 2;
   int lqrdata_size = LQRDataSize(nstates, ninputs);
   LQRData* lqrdata = (LQRData*)malloc(nhorizon * sizeof(LQRData));
-  double* data = (double*)calloc(lqrdata_size * nhorizon, sizeof(double));
+  double* data = (double*)slap_AlignedAlloc(lqrdata_size * nhorizon * sizeof(double));
+  memset(data, 0, lqrdata_size * nhorizon * sizeof(double));
   for (int k = 0; k < nhorizon; ++k) {
     ulqr_InitializeLQRData(lqrdata + k, nstates, ninputs, data + k * lqrdata_size);
   }
 
+  // Every block starts on a cache line
+  for (int k = 0; k < nhorizon; ++k) {
+    LQRData* d = lqrdata + k;
+    const double* blocks[] = {d->Q.data, d->R.data,   d->H.data,   d->q.data,   d->r.data,
+                              d->c,      d->AB.data,  d->f.data,   d->Kd.data,  d->P.data,
+                              d->p.data, d->Qxx.data, d->Quu.data, d->Qux.data, d->Qx.data,
+                              d->Qu.data, d->y.data};
+    for (int i = 0; i < (int)(sizeof(blocks) / sizeof(blocks[0])); ++i) {
+      TEST((uintptr_t)blocks[i] % SLAP_ALIGNMENT == 0);
+    }
+    TEST(d->Kd.ld == d->Qux.ld);
+    TEST(d->AB.ld >= nstates);
+  }
+
   double c = 0.0;
   for (int k = 0; k < 2; ++k) {
     c += *(lqrdata + k)->c;
@@ -168,10 +181,50 @@ void TestLQRDataArray() {
   free(data);
 }
 
+void TestLQRDataCompare() {
+  const int nstates = 2;
+  const int ninputs = 1;
+  int datasize = LQRDataSize(nstates, ninputs);
+  LQRData lqrdata[2];
+  double* data = (double*)slap_AlignedAlloc(2 * datasize * sizeof(double));
+  memset(data, 0, 2 * datasize * sizeof(double));
+  ulqr_InitializeLQRData(lqrdata + 0, nstates, ninputs, data);
+  ulqr_InitializeLQRData(lqrdata + 1, nstates, ninputs, data + datasize);
+  SetLQRData(lqrdata + 0);
+  SetLQRData(lqrdata + 1);
+  TEST(ulqr_IsLQRProblemEqual(lqrdata + 0, lqrdata + 1));
+
+  // The constant cost doesn't matter, the rest of the data does
+  *lqrdata[1].c = 0.0;
+  TEST(ulqr_IsLQRProblemEqual(lqrdata + 0, lqrdata + 1));
+  lqrdata[1].f.data[1] += 1e-14;
+  TEST(!ulqr_IsLQRProblemEqual(lqrdata + 0, lqrdata + 1));
+  lqrdata[1].f.data[1] = f[1];
+  *slap_SymMatrixAt(&lqrdata[1].R, 0, 0) = 1.0;
+  TEST(!ulqr_IsLQRProblemEqual(lqrdata + 0, lqrdata + 1));
+
+  // Only the values computed by the backward pass are copied
+  slap_MatrixSetConst(&lqrdata[0].Kd, 3.0);
+  slap_MatrixSetConst(&lqrdata[0].p, 4.0);
+  *slap_SymMatrixAt(&lqrdata[0].P, 1, 0) = 5.0;
+  lqrdata[0].reg_shift = 0.5;
+  lqrdata[0].reg_retries = 2;
+  TEST(ulqr_CopyLQRSolution(lqrdata + 1, lqrdata + 0) == 0);
+  TEST(*slap_MatrixAt(&lqrdata[1].Kd, 0, nstates) == 3.0);
+  TEST(lqrdata[1].p.data[1] == 4.0);
+  TEST(*slap_SymMatrixAt(&lqrdata[1].P, 1, 0) == 5.0);
+  TEST(lqrdata[1].reg_shift == 0.5);
+  TEST(lqrdata[1].reg_retries == 2);
+  TEST(*slap_SymMatrixAt(&lqrdata[1].R, 0, 0) == 1.0);
+
+  free(data);
+}
+
 int main() {
   // TestInitializeLQRData();
   // TestLQRDataCopy();
   TestLQRDataArray();
+  TestLQRDataCompare();
   PrintTestResult();
   return TestResult();
 }
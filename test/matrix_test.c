@@ -1,6 +1,8 @@
 #include "slap/matrix.h"
 
 #include <math.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #include "simpletest/simpletest.h"
 
@@ -9,10 +11,35 @@ int TestNewMatrix() {
   TEST(mat.rows == 5);
   TEST(mat.cols == 4);
   TEST(slap_MatrixNumElements(&mat) == 20);
+  TEST((uintptr_t)mat.data % SLAP_ALIGNMENT == 0);
   slap_FreeMatrix(&mat);
   return 1;
 }
 
+int TestNewMatrixPadded() {
+  const int pad = SLAP_PADDING / sizeof(double);
+  Matrix mat = slap_NewMatrixPadded(pad + 1, 3);
+  TEST(mat.rows == pad + 1);
+  TEST(mat.cols == 3);
+  TEST(mat.ld == 2 * pad);
+  TEST(!slap_MatrixIsContiguous(&mat));
+  for (int j = 0; j < mat.cols; ++j) {
+    TEST((uintptr_t)(mat.data + j * mat.ld) % SLAP_PADDING == 0);
+  }
+  double sum = 0.0;
+  for (int i = 0; i < mat.ld * mat.cols; ++i) {
+    sum += fabs(mat.data[i]);
+  }
+  TEST(sum == 0.0);
+  slap_FreeMatrix(&mat);
+
+  TEST(slap_PaddedLeadingDim(pad) == pad);
+  TEST(slap_PaddedLeadingDim(1) == pad);
+  TEST(slap_AlignedLength(0) == 0);
+  TEST(slap_AlignedLength(1) * sizeof(double) == SLAP_ALIGNMENT);
+  return 1;
+}
+
 int SetConst() {
   Matrix mat = slap_NewMatrix(3, 4);
   slap_MatrixSetConst(&mat, 5.0);
@@ -36,6 +63,11 @@ int GetIndex() {
   TEST(*slap_MatrixGetElement(&mat, 1, 0) == 1);
   TEST(*slap_MatrixGetElement(&mat, 0, 1) == 3);
   TEST(*slap_MatrixGetElement(&mat, 2, 3) == 11);
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      TEST(slap_MatrixAt(&mat, i, j) == slap_MatrixGetElement(&mat, i, j));
+    }
+  }
   slap_FreeMatrix(&mat);
   return 1;
 }
@@ -82,12 +114,78 @@ int CopyTranspose() {
   return 1;
 }
 
+int MatrixViews() {
+  Matrix mat = slap_NewMatrix(5, 6);
+  for (int i = 0; i < slap_MatrixNumElements(&mat); ++i) {
+    mat.data[i] = i;
+  }
+  TEST(slap_MatrixLeadingDim(&mat) == 5);
+  TEST(slap_MatrixIsContiguous(&mat));
+
+  // Interior block
+  Matrix view = slap_MatrixView(&mat, 1, 2, 3, 2);
+  TEST(view.rows == 3);
+  TEST(view.cols == 2);
+  TEST(slap_MatrixLeadingDim(&view) == 5);
+  TEST(!slap_MatrixIsContiguous(&view));
+  TEST(*slap_MatrixGetElement(&view, 0, 0) == 11);
+  TEST(*slap_MatrixGetElement(&view, 2, 1) == 18);
+  TEST(*slap_MatrixAt(&view, 2, 1) == 18);
+
+  // Operations on the view only touch the block
+  slap_MatrixSetConst(&view, -1.0);
+  for (int j = 0; j < mat.cols; ++j) {
+    for (int i = 0; i < mat.rows; ++i) {
+      bool inside = i >= 1 && i < 4 && j >= 2 && j < 4;
+      TEST(*slap_MatrixGetElement(&mat, i, j) == (inside ? -1.0 : i + 5 * j));
+    }
+  }
+  slap_MatrixScaleByConst(&view, 2.0);
+  TEST(*slap_MatrixGetElement(&mat, 3, 3) == -2.0);
+  TEST(*slap_MatrixGetElement(&mat, 4, 3) == 19);
+
+  // Copy between a view and a contiguous matrix
+  Matrix dense = slap_NewMatrix(3, 2);
+  Matrix other = slap_MatrixView(&mat, 0, 4, 3, 2);
+  slap_MatrixCopy(&dense, &other);
+  TEST(dense.data[0] == 20);
+  TEST(dense.data[5] == 27);
+  slap_MatrixCopy(&view, &dense);
+  TEST(slap_MatrixNormedDifference(&view, &other) < 1e-12);
+  double data[6] = {1, 2, 3, 4, 5, 6};  // NOLINT
+  slap_MatrixCopyFromArray(&view, data);
+  TEST(*slap_MatrixGetElement(&mat, 1, 3) == 4);
+
+  // Views of views
+  Matrix col = slap_MatrixView(&view, 0, 1, 3, 1);
+  TEST(slap_MatrixIsContiguous(&col));
+  TEST(col.data[2] == 6);
+  TEST(slap_MatrixFlatten(&view) == -1);
+
+  // Blocks outside the matrix
+  Matrix bad = slap_MatrixView(&mat, 3, 0, 3, 1);
+  TEST(bad.data == NULL);
+  bad = slap_MatrixView(&mat, 0, 5, 1, 2);
+  TEST(bad.data == NULL);
+
+  // A leading dimension of zero is contiguous
+  Matrix brace = {3, 2, data, 0};
+  TEST(slap_MatrixLeadingDim(&brace) == 3);
+  TEST(*slap_MatrixGetElement(&brace, 0, 1) == 4);
+
+  slap_FreeMatrix(&mat);
+  slap_FreeMatrix(&dense);
+  return 1;
+}
+
 int main() {
   TestNewMatrix();
+  TestNewMatrixPadded();
   SetConst();
   GetIndex();
   TestPrintMatrix();
   CopyMatrix();
   CopyTranspose();
+  MatrixViews();
   return TestResult();
 }
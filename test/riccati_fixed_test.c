@@ -0,0 +1,104 @@
+#include <stdio.h>
+
+#include "riccati/riccati_solve.h"
+#include "riccati/riccati_solver.h"
+#include "simpletest/simpletest.h"
+#include "slap/linalg.h"
+#include "slap/matrix.h"
+#include "slap/symmatrix.h"
+#include "test_utils.h"
+
+enum {
+  kNstates = ULQR_FIXED_NSTATES,
+  kNinputs = ULQR_FIXED_NINPUTS,
+  kNhorizon = ULQR_FIXED_NHORIZON,
+};
+
+void TestFixedSolve() {
+  RiccatiSolver* solver = RandomLQRProblem(kNstates, kNinputs, kNhorizon);
+  TEST(solver != NULL);
+  int out = ulqr_SolveRiccati(solver);
+  TEST(out == 0);
+  TEST(KKTResidual(solver) < 1e-10);
+  TEST(solver->scratch.top == 0);
+
+  // Cost-to-go Hessian should be positive definite
+  SymMatrix P = slap_NewSymMatrix(kNstates);
+  slap_SymMatrixCopy(&P, ulqr_GetCostToGoHessian(solver, 0));
+  TEST(slap_SymCholeskyFactorize(&P) == slap_kCholeskySuccess);
+  slap_FreeSymMatrix(&P);
+
+  // Solving again should give the same answer
+  Matrix x = slap_NewMatrix(kNstates, 1);
+  slap_MatrixCopy(&x, ulqr_GetState(solver, kNhorizon - 1));
+  ulqr_SolveRiccati(solver);
+  TEST(slap_MatrixNormedDifference(&x, ulqr_GetState(solver, kNhorizon - 1)) < 1e-12);
+  slap_FreeMatrix(&x);
+  ulqr_FreeRiccatiSolver(&solver);
+}
+
+void TestFixedStorage() {
+  // Only problems of the fixed size
+  TEST(ulqr_NewRiccatiSolver(kNstates + 1, kNinputs, kNhorizon) == NULL);
+  TEST(ulqr_NewRiccatiSolver(kNstates, kNinputs, kNhorizon - 1) == NULL);
+
+  // Only one solver at a time, which can be created again once freed
+  RiccatiSolver* solver = ulqr_NewRiccatiSolver(kNstates, kNinputs, kNhorizon);
+  TEST(solver != NULL);
+  TEST(ulqr_NewRiccatiSolver(kNstates, kNinputs, kNhorizon) == NULL);
+  ulqr_FreeRiccatiSolver(&solver);
+  TEST(solver == NULL);
+  solver = ulqr_NewRiccatiSolver(kNstates, kNinputs, kNhorizon);
+  TEST(solver != NULL);
+
+  // Memory is cleared when reused
+  TEST(slap_OneNorm(ulqr_GetA(solver, 0)) == 0.0);
+  ulqr_FreeRiccatiSolver(&solver);
+}
+
+void TestFixedRegularization() {
+  RiccatiSolver* solver = RandomLQRProblem(kNstates, kNinputs, kNhorizon);
+  const int k_bad = kNhorizon - 3;
+  SymMatrix* R = ulqr_GetR(solver, k_bad);
+  for (int i = 0; i < kNinputs; ++i) {
+    *slap_SymMatrixAt(R, i, i) = -0.5;
+  }
+  TEST(ulqr_SolveRiccati(solver) == -1);
+  TEST(solver->scratch.top == 0);
+  solver->reg_max = 1e8;
+  TEST(ulqr_SolveRiccati(solver) == 0);
+  TEST(ulqr_GetRegularizationRetries(solver, k_bad) > 0);
+  TEST(ulqr_GetRegularizationRetries(solver, k_bad - 1) == 0);
+  TEST(ulqr_GetRegularizationRetries(solver, k_bad + 1) == 0);
+  ulqr_FreeRiccatiSolver(&solver);
+}
+
+void TestFixedSqrtBackwardPass() {
+  RiccatiSolver* solver = RandomLQRProblem(kNstates, kNinputs, kNhorizon);
+  TEST(solver->cost_factors == NULL);
+  TEST(ulqr_SolveRiccati(solver) == 0);
+  TEST(solver->cost_factors == NULL);
+
+  // The factors of Q and R only have static storage if the build enables the square-root
+  // backward pass
+  solver->sqrt_backward_pass = true;
+#ifdef ULQR_FIXED_SQRT_BACKWARD_PASS
+  TEST(ulqr_SolveRiccati(solver) == 0);
+  TEST(solver->cost_factors != NULL);
+  TEST(KKTResidual(solver) < 1e-10);
+#else
+  TEST(ulqr_SolveRiccati(solver) == -1);
+  TEST(solver->cost_factors == NULL);
+#endif
+  TEST(solver->scratch.top == 0);
+  ulqr_FreeRiccatiSolver(&solver);
+}
+
+int main() {
+  TestFixedSolve();
+  TestFixedRegularization();
+  TestFixedSqrtBackwardPass();
+  TestFixedStorage();
+  PrintTestResult();
+  return TestResult();
+}
@@ -0,0 +1,147 @@
+#include "riccati/riccati_mixed.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include "riccati/riccati_solve.h"
+#include "riccati/riccati_solver.h"
+#include "simpletest/simpletest.h"
+#include "slap/linalg.h"
+#include "slap/matrix.h"
+#include "test_utils.h"
+
+void TestSolveRiccatiMixed() {
+  const int sizes[][3] = {{4, 2, 11}, {6, 3, 20}, {12, 4, 30}, {20, 10, 15}};
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+    int nstates = sizes[s][0];
+    int nhorizon = sizes[s][2];
+    RiccatiSolver* solver = RandomLQRProblem(nstates, sizes[s][1], nhorizon);
+    RiccatiSolver* solver_ref = RandomLQRProblem(nstates, sizes[s][1], nhorizon);
+    MixedRiccatiSolver* mixed = ulqr_NewMixedRiccatiSolver(solver);
+    TEST(mixed != NULL);
+
+    // The tolerance is relative to the right-hand side, whose norm is a few here
+    mixed->tolerance = 1e-11;
+    TEST(ulqr_SolveRiccatiMixed(mixed) == 0);
+    printf("(n,m,N) = (%d,%d,%d): residual %g after %d refinements\n", nstates, sizes[s][1],
+           nhorizon, mixed->residual, mixed->refinements);
+    TEST(mixed->residual < 1e-10);
+    TEST(KKTResidual(solver) < 1e-10);
+    TEST(mixed->refinements >= 1);
+    TEST(mixed->refinements <= 5);
+
+    // Same solution as the double-precision solve
+    ulqr_SolveRiccati(solver_ref);
+    double err = 0.0;
+    for (int k = 0; k < nhorizon; ++k) {
+      err = fmax(err, slap_MatrixNormedDifference(ulqr_GetState(solver, k),
+                                                  ulqr_GetState(solver_ref, k)));
+      err = fmax(err, slap_MatrixNormedDifference(ulqr_GetDual(solver, k),
+                                                  ulqr_GetDual(solver_ref, k)));
+    }
+    TEST(err < 1e-9);
+
+    // Without refinement the solution is only as good as the single-precision gains
+    mixed->max_refinements = 0;
+    TEST(ulqr_SolveRiccatiMixed(mixed) == -1);
+    TEST(mixed->refinements == 0);
+    TEST(mixed->residual > 1e-10);
+    TEST(mixed->residual < 1e-3);
+
+    ulqr_FreeMixedRiccatiSolver(&mixed);
+    TEST(mixed == NULL);
+    ulqr_FreeRiccatiSolver(&solver);
+    ulqr_FreeRiccatiSolver(&solver_ref);
+  }
+}
+
+void TestMixedRelativeTolerance() {
+  const int nstates = 6;
+  const int ninputs = 3;
+  const int nhorizon = 20;
+  RiccatiSolver* solver_ref = RandomLQRProblem(nstates, ninputs, nhorizon);
+  ulqr_SolveRiccati(solver_ref);
+
+  // Scaling the right-hand side scales the solution, and the residual along with it
+  const double scales[] = {1e-8, 1e8};
+  for (int s = 0; s < 2; ++s) {
+    double scale = scales[s];
+    RiccatiSolver* solver = RandomLQRProblem(nstates, ninputs, nhorizon);
+    slap_MatrixScaleByConst(&solver->x0, scale);
+    for (int k = 0; k < nhorizon; ++k) {
+      slap_MatrixScaleByConst(ulqr_Getq(solver, k), scale);
+      if (k < nhorizon - 1) {
+        slap_MatrixScaleByConst(ulqr_Getr(solver, k), scale);
+        slap_MatrixScaleByConst(ulqr_Getf(solver, k), scale);
+      }
+    }
+    MixedRiccatiSolver* mixed = ulqr_NewMixedRiccatiSolver(solver);
+    TEST(ulqr_SolveRiccatiMixed(mixed) == 0);
+    TEST(mixed->refinements >= 1);
+    TEST(mixed->refinements <= 5);
+    TEST(mixed->residual < 1e-10 * scale);
+
+    double err = 0.0;
+    for (int k = 0; k < nhorizon; ++k) {
+      Matrix* x = ulqr_GetState(solver, k);
+      slap_MatrixScaleByConst(x, 1.0 / scale);
+      err = fmax(err, slap_MatrixNormedDifference(x, ulqr_GetState(solver_ref, k)));
+    }
+    TEST(err < 1e-9);
+
+    ulqr_FreeMixedRiccatiSolver(&mixed);
+    ulqr_FreeRiccatiSolver(&solver);
+  }
+  ulqr_FreeRiccatiSolver(&solver_ref);
+}
+
+void TestMixedRegularized() {
+  RiccatiSolver* solver = RandomLQRProblem(4, 2, 11);
+  RiccatiSolver* solver_ref = RandomLQRProblem(4, 2, 11);
+  const int k_bad = 3;
+  RiccatiSolver* solvers[2] = {solver, solver_ref};
+  for (int j = 0; j < 2; ++j) {
+    SymMatrix* R = ulqr_GetR(solvers[j], k_bad);
+    for (int i = 0; i < R->n; ++i) {
+      *slap_SymMatrixAt(R, i, i) = -0.5;
+    }
+  }
+  MixedRiccatiSolver* mixed = ulqr_NewMixedRiccatiSolver(solver);
+
+  // Fails without regularization, as the double-precision solve does
+  TEST(ulqr_SolveRiccatiMixed(mixed) == -1);
+
+  // The single-precision backward pass picks up the settings of the wrapped solver
+  solver->reg_max = 1e8;
+  solver_ref->reg_max = 1e8;
+  TEST(ulqr_SolveRiccatiMixed(mixed) == 0);
+  TEST(ulqr_SolveRiccati(solver_ref) == 0);
+  TEST(mixed->refinements <= 5);
+  for (int k = 0; k < solver->nhorizon - 1; ++k) {
+    double shift = ulqr_GetRegularizationShift(solver, k);
+    double shift_ref = ulqr_GetRegularizationShift(solver_ref, k);
+    TEST(ulqr_GetRegularizationRetries(solver, k) == ulqr_GetRegularizationRetries(solver_ref, k));
+    TEST(fabs(shift - shift_ref) <= 1e-6 * shift_ref);
+    TEST((shift > 0) == (k == k_bad));
+  }
+
+  // Same regularized problem, up to the rounding of the shift to single precision
+  double err = 0.0;
+  for (int k = 0; k < solver->nhorizon; ++k) {
+    err = fmax(err, slap_MatrixNormedDifference(ulqr_GetState(solver, k),
+                                                ulqr_GetState(solver_ref, k)));
+  }
+  TEST(err < 1e-5);
+
+  ulqr_FreeMixedRiccatiSolver(&mixed);
+  ulqr_FreeRiccatiSolver(&solver);
+  ulqr_FreeRiccatiSolver(&solver_ref);
+}
+
+int main() {
+  TestSolveRiccatiMixed();
+  TestMixedRelativeTolerance();
+  TestMixedRegularized();
+  PrintTestResult();
+  return TestResult();
+}
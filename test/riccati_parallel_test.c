@@ -0,0 +1,161 @@
+#include "riccati/riccati_parallel.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include "riccati/riccati_solve.h"
+#include "riccati/riccati_solver.h"
+#include "simpletest/simpletest.h"
+#include "slap/linalg.h"
+#include "slap/matrix.h"
+#include "test_utils.h"
+
+void TestSolveRiccatiParallel() {
+  const int sizes[][3] = {{4, 2, 11}, {6, 3, 50}, {12, 4, 101}, {20, 10, 40}, {3, 5, 3}};
+  const int threads[] = {1, 2, 3, 4, 7};
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+    int nstates = sizes[s][0];
+    int ninputs = sizes[s][1];
+    int nhorizon = sizes[s][2];
+    RiccatiSolver* solver = RandomLQRProblem(nstates, ninputs, nhorizon);
+    RiccatiSolver* solver_ref = RandomLQRProblem(nstates, ninputs, nhorizon);
+    TEST(ulqr_SolveRiccati(solver_ref) == 0);
+    double scale = slap_TwoNorm(ulqr_GetDual(solver_ref, 0));
+
+    for (int t = 0; t < (int)(sizeof(threads) / sizeof(threads[0])); ++t) {
+      ParallelRiccatiSolver* par = ulqr_NewParallelRiccatiSolver(solver, threads[t]);
+      TEST(par != NULL);
+      TEST(par->nthreads == threads[t]);
+      TEST(par->nsegments == (threads[t] < nhorizon ? threads[t] : nhorizon));
+
+      // Solving twice gives the same answer, since nothing is left over from the first one
+      for (int i = 0; i < 2; ++i) {
+        TEST(ulqr_SolveRiccatiParallel(par) == 0);
+        TEST(KKTResidual(solver) < 1e-12 * scale);
+        TEST(SolutionDifference(solver, solver_ref) < 1e-11 * scale);
+      }
+
+      // Every segment has the gains and cost-to-go of the full problem
+      double err = 0.0;
+      for (int k = 0; k < nhorizon - 1; ++k) {
+        err = fmax(err, slap_MatrixNormedDifference(ulqr_GetGains(solver, k),
+                                                    ulqr_GetGains(solver_ref, k)));
+        SymMatrix* P = ulqr_GetCostToGoHessian(solver, k);
+        SymMatrix* P_ref = ulqr_GetCostToGoHessian(solver_ref, k);
+        Matrix Pvec = {slap_SymMatrixNumElements(P), 1, P->data, 0};
+        Matrix Pvec_ref = {slap_SymMatrixNumElements(P_ref), 1, P_ref->data, 0};
+        err = fmax(err, slap_MatrixNormedDifference(&Pvec, &Pvec_ref) / slap_TwoNorm(&Pvec_ref));
+      }
+      TEST(err < 1e-9);
+
+      // so the sequential forward pass from another initial state gives the same solution
+      Matrix x0 = slap_NewMatrix(nstates, 1);
+      Matrix x1 = slap_NewMatrix(nstates, 1);
+      slap_MatrixCopy(&x0, &solver->x0);
+      slap_MatrixCopy(&x1, ulqr_GetState(solver_ref, 1));
+      ulqr_SetInitialState(solver, x1.data);
+      ulqr_SetInitialState(solver_ref, x1.data);
+      ulqr_ForwardPass(solver);
+      ulqr_ForwardPass(solver_ref);
+      TEST(SolutionDifference(solver, solver_ref) < 1e-9 * scale);
+      ulqr_SetInitialState(solver, x0.data);
+      ulqr_SetInitialState(solver_ref, x0.data);
+      ulqr_ForwardPass(solver_ref);
+      slap_FreeMatrix(&x0);
+      slap_FreeMatrix(&x1);
+
+      ulqr_FreeParallelRiccatiSolver(&par);
+      TEST(par == NULL);
+    }
+    ulqr_FreeRiccatiSolver(&solver);
+    ulqr_FreeRiccatiSolver(&solver_ref);
+  }
+}
+
+void TestParallelRegularization() {
+  RiccatiSolver* solver = RandomLQRProblem(6, 3, 40);
+  const int k_bad = 17;
+  SymMatrix* R = ulqr_GetR(solver, k_bad);
+  for (int i = 0; i < R->n; ++i) {
+    *slap_SymMatrixAt(R, i, i) = -0.5;
+  }
+  ParallelRiccatiSolver* par = ulqr_NewParallelRiccatiSolver(solver, 4);
+
+  // Fails without regularization, in the backward pass of one of the segments
+  TEST(ulqr_SolveRiccatiParallel(par) == -1);
+
+  solver->reg_max = 1e8;
+  TEST(ulqr_SolveRiccatiParallel(par) == 0);
+  TEST(ulqr_GetRegularizationShift(solver, k_bad) > 0.5 - 1e-3);
+  TEST(isfinite(slap_OneNorm(ulqr_GetState(solver, solver->nhorizon - 1))));
+  ulqr_FreeParallelRiccatiSolver(&par);
+  ulqr_FreeRiccatiSolver(&solver);
+}
+
+void TestForwardPassParallel() {
+  const int sizes[][3] = {{4, 2, 300}, {12, 4, 1000}, {3, 5, 8}, {30, 2, 200}};
+  const int threads[] = {1, 2, 3, 4, 7, 16};
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+    int nstates = sizes[s][0];
+    int ninputs = sizes[s][1];
+    int nhorizon = sizes[s][2];
+    RiccatiSolver* solver = RandomLQRProblem(nstates, ninputs, nhorizon);
+    RiccatiSolver* solver_ref = RandomLQRProblem(nstates, ninputs, nhorizon);
+    TEST(ulqr_SolveRiccati(solver_ref) == 0);
+    TEST(ulqr_BackwardPass(solver) == 0);
+    double scale = slap_TwoNorm(ulqr_GetDual(solver_ref, 0));
+
+    for (int t = 0; t < (int)(sizeof(threads) / sizeof(threads[0])); ++t) {
+      ParallelRiccatiSolver* par = ulqr_NewParallelRiccatiSolver(solver, threads[t]);
+      par->forward_min_horizon = 0;
+
+      // Every state is overwritten, not just the first one of each chunk
+      for (int k = 0; k < nhorizon; ++k) {
+        slap_MatrixSetConst(ulqr_GetState(solver, k), NAN);
+      }
+      TEST(ulqr_ForwardPassParallel(par) == 0);
+      TEST(SolutionDifference(solver, solver_ref) < 1e-11 * scale);
+      ulqr_FreeParallelRiccatiSolver(&par);
+    }
+    ulqr_FreeRiccatiSolver(&solver);
+    ulqr_FreeRiccatiSolver(&solver_ref);
+  }
+
+  // After a parallel solve, which leaves the gains of the full problem
+  RiccatiSolver* solver = RandomLQRProblem(12, 4, 1000);
+  RiccatiSolver* solver_ref = RandomLQRProblem(12, 4, 1000);
+  TEST(ulqr_SolveRiccati(solver_ref) == 0);
+  double scale = slap_TwoNorm(ulqr_GetDual(solver_ref, 0));
+  ParallelRiccatiSolver* par = ulqr_NewParallelRiccatiSolver(solver, 7);
+  par->forward_min_horizon = 0;
+  TEST(ulqr_SolveRiccatiParallel(par) == 0);
+  for (int k = 0; k < solver->nhorizon; ++k) {
+    slap_MatrixSetConst(ulqr_GetState(solver, k), NAN);
+  }
+  TEST(ulqr_ForwardPassParallel(par) == 0);
+  TEST(SolutionDifference(solver, solver_ref) < 1e-9 * scale);
+  ulqr_FreeParallelRiccatiSolver(&par);
+  ulqr_FreeRiccatiSolver(&solver);
+  ulqr_FreeRiccatiSolver(&solver_ref);
+
+  // Short horizons just run the sequential forward pass
+  solver = RandomLQRProblem(4, 2, 50);
+  solver_ref = RandomLQRProblem(4, 2, 50);
+  TEST(ulqr_SolveRiccati(solver_ref) == 0);
+  TEST(ulqr_BackwardPass(solver) == 0);
+  par = ulqr_NewParallelRiccatiSolver(solver, 4);
+  TEST(par->forward_min_horizon > solver->nhorizon);
+  TEST(ulqr_ForwardPassParallel(par) == 0);
+  TEST(SolutionDifference(solver, solver_ref) == 0.0);
+  ulqr_FreeParallelRiccatiSolver(&par);
+  ulqr_FreeRiccatiSolver(&solver);
+  ulqr_FreeRiccatiSolver(&solver_ref);
+}
+
+int main() {
+  TestSolveRiccatiParallel();
+  TestParallelRegularization();
+  TestForwardPassParallel();
+  PrintTestResult();
+  return TestResult();
+}
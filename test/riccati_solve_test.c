@@ -0,0 +1,289 @@
+#include "riccati/riccati_solve.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include "riccati/riccati_solver.h"
+#include "simpletest/simpletest.h"
+#include "slap/linalg.h"
+#include "slap/matrix.h"
+#include "test_utils.h"
+
+void TestSolveRiccati() {
+  const int sizes[][3] = {{4, 2, 11}, {6, 3, 20}, {3, 5, 8}, {20, 10, 15}};
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+    RiccatiSolver* solver = RandomLQRProblem(sizes[s][0], sizes[s][1], sizes[s][2]);
+    int out = ulqr_SolveRiccati(solver);
+    TEST(out == 0);
+    TEST(KKTResidual(solver) < 1e-10);
+
+    // All the scratch memory should have been released
+    TEST(solver->scratch.top == 0);
+    TEST(slap_ArenaPeak(&solver->scratch) > 0);
+    TEST(slap_ArenaPeak(&solver->scratch) <= solver->scratch.capacity);
+
+    // Cost-to-go Hessian should be positive definite
+    SymMatrix P = slap_NewSymMatrix(solver->nstates);
+    slap_SymMatrixCopy(&P, ulqr_GetCostToGoHessian(solver, 0));
+    TEST(slap_SymCholeskyFactorize(&P) == slap_kCholeskySuccess);
+    slap_FreeSymMatrix(&P);
+
+    // Solving again should give the same answer
+    Matrix x = slap_NewMatrix(solver->nstates, 1);
+    slap_MatrixCopy(&x, ulqr_GetState(solver, solver->nhorizon - 1));
+    ulqr_SolveRiccati(solver);
+    TEST(slap_MatrixNormedDifference(&x, ulqr_GetState(solver, solver->nhorizon - 1)) < 1e-12);
+    slap_FreeMatrix(&x);
+
+    ulqr_FreeRiccatiSolver(&solver);
+  }
+}
+
+void TestRegularizedSolve() {
+  RiccatiSolver* solver = RandomLQRProblem(4, 2, 11);
+  const int k_bad = 3;
+  SymMatrix* R = ulqr_GetR(solver, k_bad);
+  for (int i = 0; i < R->n; ++i) {
+    *slap_SymMatrixAt(R, i, i) = -0.5;
+  }
+
+  // Fails without regularization
+  TEST(ulqr_SolveRiccati(solver) == -1);
+  TEST(solver->scratch.top == 0);
+
+  // Only the indefinite knot point is shifted
+  solver->reg_max = 1e8;
+  TEST(ulqr_SolveRiccati(solver) == 0);
+  for (int k = 0; k < solver->nhorizon - 1; ++k) {
+    if (k == k_bad) {
+      TEST(ulqr_GetRegularizationRetries(solver, k) > 0);
+      TEST(ulqr_GetRegularizationShift(solver, k) > 0.5 - 1e-3);
+    } else {
+      TEST(ulqr_GetRegularizationRetries(solver, k) == 0);
+      TEST(ulqr_GetRegularizationShift(solver, k) == 0.0);
+    }
+  }
+
+  // The gains are those of Quu + s I, with the reported shift on every input
+  Matrix Quu = slap_NewMatrix(2, 2);
+  Matrix res = slap_NewMatrix(2, 4);
+  slap_SymMatrixUnpack(&Quu, ulqr_GetQuu(solver, k_bad));
+  slap_AddDiagonal(&Quu, ulqr_GetRegularizationShift(solver, k_bad));
+  slap_MatrixCopy(&res, ulqr_GetQux(solver, k_bad));
+  slap_MatrixMultiply(&Quu, ulqr_GetFeedbackGain(solver, k_bad), &res, 0, 0, 1.0, 1.0);
+  TEST(slap_TwoNorm(&res) < 1e-10 * slap_TwoNorm(ulqr_GetQux(solver, k_bad)));
+  TEST(isfinite(slap_OneNorm(ulqr_GetState(solver, solver->nhorizon - 1))));
+  slap_FreeMatrix(&Quu);
+  slap_FreeMatrix(&res);
+  ulqr_FreeRiccatiSolver(&solver);
+}
+
+/* Difference between two packed symmetric matrices */
+static double SymMatrixDifference(SymMatrix* A, SymMatrix* B) {
+  int nsym = slap_SymMatrixNumElements(A);
+  Matrix a = {nsym, 1, A->data, 0};
+  Matrix b = {nsym, 1, B->data, 0};
+  return slap_MatrixNormedDifference(&a, &b);
+}
+
+/* Largest difference between the backward passes of two solvers */
+static double BackwardPassDifference(RiccatiSolver* solver, RiccatiSolver* solver_ref) {
+  double err = 0.0;
+  for (int k = 0; k < solver->nhorizon - 1; ++k) {
+    err = fmax(err, slap_MatrixNormedDifference(ulqr_GetGains(solver, k),
+                                                ulqr_GetGains(solver_ref, k)));
+    err = fmax(err, slap_MatrixNormedDifference(ulqr_GetCostToGoGradient(solver, k),
+                                                ulqr_GetCostToGoGradient(solver_ref, k)));
+    err = fmax(err, slap_MatrixNormedDifference(ulqr_GetQux(solver, k),
+                                                ulqr_GetQux(solver_ref, k)));
+    err = fmax(err, SymMatrixDifference(ulqr_GetCostToGoHessian(solver, k),
+                                        ulqr_GetCostToGoHessian(solver_ref, k)));
+    err = fmax(err, SymMatrixDifference(ulqr_GetQxx(solver, k), ulqr_GetQxx(solver_ref, k)));
+    err = fmax(err, SymMatrixDifference(ulqr_GetQuu(solver, k), ulqr_GetQuu(solver_ref, k)));
+  }
+  return err;
+}
+
+void TestSqrtBackwardPass() {
+  const int sizes[][3] = {{4, 2, 11}, {6, 3, 20}, {3, 5, 8}, {20, 10, 15}};
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+    RiccatiSolver* solver = RandomLQRProblem(sizes[s][0], sizes[s][1], sizes[s][2]);
+    RiccatiSolver* solver_sqrt = RandomLQRProblem(sizes[s][0], sizes[s][1], sizes[s][2]);
+    solver_sqrt->sqrt_backward_pass = true;
+    TEST(ulqr_SolveRiccati(solver) == 0);
+    TEST(ulqr_SolveRiccati(solver_sqrt) == 0);
+    TEST(KKTResidual(solver_sqrt) < 1e-10);
+
+    // Only the square-root backward pass allocates the factors of Q and R
+    TEST(solver->cost_factors == NULL);
+    TEST(solver_sqrt->cost_factors != NULL);
+    TEST(solver_sqrt->scratch.top == 0);
+    TEST(slap_ArenaPeak(&solver_sqrt->scratch) <= solver_sqrt->scratch.capacity);
+
+    // Same gains, cost-to-go and action-value Hessians as the usual backward pass
+    TEST(BackwardPassDifference(solver_sqrt, solver) < 1e-10);
+
+    // Solving again reuses the cached factors of Q and R
+    TEST(ulqr_SolveRiccati(solver_sqrt) == 0);
+    TEST(BackwardPassDifference(solver_sqrt, solver) < 1e-10);
+
+    // which are computed again when the costs change
+    int k = solver->nhorizon / 2;
+    *slap_SymMatrixAt(ulqr_GetQ(solver, k), 0, 0) += 1.0;
+    *slap_SymMatrixAt(ulqr_GetQ(solver_sqrt, k), 0, 0) += 1.0;
+    *slap_SymMatrixAt(ulqr_GetR(solver, k - 1), 0, 0) *= 2.0;
+    *slap_SymMatrixAt(ulqr_GetR(solver_sqrt, k - 1), 0, 0) *= 2.0;
+    TEST(ulqr_SolveRiccati(solver) == 0);
+    TEST(ulqr_SolveRiccati(solver_sqrt) == 0);
+    TEST(BackwardPassDifference(solver_sqrt, solver) < 1e-10);
+    ulqr_FreeRiccatiSolver(&solver);
+    ulqr_FreeRiccatiSolver(&solver_sqrt);
+  }
+
+  // Failures release the scratch memory, whether the arena runs out or R is indefinite
+  RiccatiSolver* solver = RandomLQRProblem(4, 2, 11);
+  solver->sqrt_backward_pass = true;
+  int capacity = solver->scratch.capacity;
+  solver->scratch.capacity = slap_AlignedLength(solver->nstates);
+  TEST(ulqr_SolveRiccati(solver) == -1);
+  TEST(solver->scratch.top == 0);
+  solver->scratch.capacity = capacity;
+  sfloat R00 = ulqr_GetR(solver, 3)->data[0];
+  ulqr_GetR(solver, 3)->data[0] = -1.0;
+  TEST(ulqr_SolveRiccati(solver) == -1);
+  TEST(solver->scratch.top == 0);
+  TEST(!solver->cost_factors_valid[2 * 3 + 1]);
+  ulqr_GetR(solver, 3)->data[0] = R00;
+  TEST(ulqr_SolveRiccati(solver) == 0);
+  for (int k = 0; k < 2 * solver->nhorizon - 1; ++k) {
+    TEST(solver->cost_factors_valid[k]);  // There is no R at the last knot point
+  }
+
+  // Setting the cost clears the flags of the cached factors
+  Matrix Q = slap_NewMatrix(4, 4);
+  Matrix R = slap_NewMatrix(2, 2);
+  slap_SymMatrixUnpack(&Q, ulqr_GetQ(solver, 0));
+  slap_SymMatrixUnpack(&R, ulqr_GetR(solver, 0));
+  TEST(ulqr_SetCost(solver, Q.data, R.data, NULL, NULL, NULL, 0.0, 2, 5) == 0);
+  for (int k = 0; k < solver->nhorizon - 1; ++k) {
+    bool set = k >= 2 && k < 5;
+    TEST(solver->cost_factors_valid[2 * k] == !set);
+    TEST(solver->cost_factors_valid[2 * k + 1] == !set);
+  }
+  TEST(ulqr_SolveRiccati(solver) == 0);
+  TEST(KKTResidual(solver) < 1e-10);
+  slap_FreeMatrix(&Q);
+  slap_FreeMatrix(&R);
+  ulqr_FreeRiccatiSolver(&solver);
+}
+
+void TestForwardPassBatch() {
+  const int sizes[][3] = {{4, 2, 11}, {6, 3, 20}, {3, 5, 8}, {20, 10, 15}};
+  const int nbatch = 7;
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+    int n = sizes[s][0];
+    int m = sizes[s][1];
+    int N = sizes[s][2];
+    RiccatiSolver* solver = RandomLQRProblem(n, m, N);
+    TEST(ulqr_BackwardPass(solver) == 0);
+
+    Matrix X0 = slap_NewMatrix(n, nbatch);
+    Matrix X = slap_NewMatrix(n, nbatch * N);
+    Matrix U = slap_NewMatrix(m, nbatch * (N - 1));
+    Matrix Y = slap_NewMatrix(n, nbatch * N);
+    for (int i = 0; i < n * nbatch; ++i) {
+      X0.data[i] = sin(0.7 * i + 0.2);
+    }
+    TEST(ulqr_ForwardPassBatch(solver, &X0, &X, &U, &Y) == 0);
+
+    // Each column is the trajectory of the sequential forward pass from its initial state
+    double err = 0.0;
+    for (int j = 0; j < nbatch; ++j) {
+      ulqr_SetInitialState(solver, X0.data + j * n);
+      ulqr_ForwardPass(solver);
+      for (int k = 0; k < N; ++k) {
+        Matrix x = slap_MatrixView(&X, 0, k * nbatch + j, n, 1);
+        Matrix y = slap_MatrixView(&Y, 0, k * nbatch + j, n, 1);
+        err = fmax(err, slap_MatrixNormedDifference(&x, ulqr_GetState(solver, k)));
+        err = fmax(err, slap_MatrixNormedDifference(&y, ulqr_GetDual(solver, k)));
+        if (k < N - 1) {
+          Matrix u = slap_MatrixView(&U, 0, k * nbatch + j, m, 1);
+          err = fmax(err, slap_MatrixNormedDifference(&u, ulqr_GetInput(solver, k)));
+        }
+      }
+    }
+    TEST(err < 1e-10);
+
+    // The duals are optional, and the sizes are checked
+    TEST(ulqr_ForwardPassBatch(solver, &X0, &X, &U, NULL) == 0);
+    Matrix X_short = slap_MatrixView(&X, 0, 0, n, nbatch * (N - 1));
+    TEST(ulqr_ForwardPassBatch(solver, &X0, &X_short, &U, NULL) == -1);
+
+    slap_FreeMatrix(&X0);
+    slap_FreeMatrix(&X);
+    slap_FreeMatrix(&U);
+    slap_FreeMatrix(&Y);
+    ulqr_FreeRiccatiSolver(&solver);
+  }
+}
+
+/* Largest difference between the gains of two solvers */
+static double GainDifference(RiccatiSolver* solver, RiccatiSolver* solver_ref) {
+  double err = 0.0;
+  for (int k = 0; k < solver->nhorizon - 1; ++k) {
+    err = fmax(err, slap_MatrixNormedDifference(ulqr_GetGains(solver, k),
+                                                ulqr_GetGains(solver_ref, k)));
+  }
+  return err;
+}
+
+void TestSteadyState() {
+  // The random problems are time-invariant, apart from the terminal cost, and damping A
+  // on every knot point makes the recursion converge within a couple hundred steps
+  const int nhorizon = 400;
+  RiccatiSolver* solver = RandomLQRProblem(4, 2, nhorizon);
+  RiccatiSolver* solver_ref = RandomLQRProblem(4, 2, nhorizon);
+  for (int k = 0; k < nhorizon - 1; ++k) {
+    slap_MatrixScaleByConst(ulqr_GetA(solver, k), 0.9);
+    slap_MatrixScaleByConst(ulqr_GetA(solver_ref, k), 0.9);
+  }
+  solver->steady_state_tol = 1e-12;
+  TEST(ulqr_SolveRiccati(solver) == 0);
+  TEST(ulqr_SolveRiccati(solver_ref) == 0);
+  TEST(solver_ref->steady_state_count == 0);
+  TEST(solver->steady_state_count > 100);
+  TEST(GainDifference(solver, solver_ref) < 1e-9);
+  TEST(KKTResidual(solver) < 1e-8);
+  int count = solver->steady_state_count;
+
+  // A different knot point restarts the recursion, which converges again before it
+  const int k_tv = 250;
+  *slap_MatrixAt(ulqr_GetA(solver, k_tv), 0, 1) += 0.1;
+  *slap_MatrixAt(ulqr_GetA(solver_ref, k_tv), 0, 1) += 0.1;
+  TEST(ulqr_SolveRiccati(solver) == 0);
+  TEST(ulqr_SolveRiccati(solver_ref) == 0);
+  TEST(solver->steady_state_count > 50);
+  TEST(solver->steady_state_count < count);
+  TEST(slap_MatrixNormedDifference(ulqr_GetGains(solver, k_tv), ulqr_GetGains(solver_ref, k_tv)) <
+       1e-9);
+  TEST(GainDifference(solver, solver_ref) < 1e-9);
+
+  // Also in the square-root backward pass
+  solver->sqrt_backward_pass = true;
+  TEST(ulqr_SolveRiccati(solver) == 0);
+  TEST(solver->steady_state_count > 50);
+  TEST(GainDifference(solver, solver_ref) < 1e-9);
+
+  ulqr_FreeRiccatiSolver(&solver);
+  ulqr_FreeRiccatiSolver(&solver_ref);
+}
+
+int main() {
+  TestSolveRiccati();
+  TestRegularizedSolve();
+  TestSqrtBackwardPass();
+  TestForwardPassBatch();
+  TestSteadyState();
+  PrintTestResult();
+  return TestResult();
+}
@@ -13,6 +13,8 @@ const int ninputs = 2;
 const int nhorizon = 5;
 const double Q[9] = {1, 0, 0, 0, 0.5, 0, 0, 0, 0.4};
 const double R[4] = {0.1, 0, 0, 0.2};
+const double Qp[6] = {1, 0, 0, 0.5, 0, 0.4};
+const double Rp[3] = {0.1, 0, 0.2};
 const double H[6] = {0.1, 0, 0, 0.2, 0, 0};
 const double q[3] = {-0.1, -0.2, -0.3};
 const double r[2] = {0.1, 0.2};
@@ -49,17 +51,18 @@ void TestSetCost() {
   int out = ulqr_SetCost(solver, Q, R, H, q, r, c, 0, 2);
   TEST(out == kOk);
   const double tol = 1e-8;
+  const double zeros[6] = {0};
   for (int k = 0; k < 2; ++k) {
-    TEST(SumOfSquaredError(ulqr_GetQ(solver, k)->data, Q, nstates * nstates) < tol);
-    TEST(SumOfSquaredError(ulqr_GetR(solver, k)->data, R, ninputs * ninputs) < tol);
-    TEST(SumOfSquaredError(ulqr_GetH(solver, k)->data, H, ninputs * nstates) < tol);
+    TEST(SumOfSquaredError(ulqr_GetQ(solver, k)->data, Qp, 6) < tol);
+    TEST(SumOfSquaredError(ulqr_GetR(solver, k)->data, Rp, 3) < tol);
+    TEST(MatrixArrayError(ulqr_GetH(solver, k), H) < tol);
     TEST(SumOfSquaredError(ulqr_Getq(solver, k)->data, q, nstates) < tol);
     TEST(SumOfSquaredError(ulqr_Getr(solver, k)->data, r, ninputs) < tol);
     TESTAPPROX(ulqr_Getc(solver, k), c, tol);
   }
   for (int k = 2; k < nhorizon; ++k) {
-    TEST(slap_OneNorm(ulqr_GetQ(solver, k)) < tol);
-    TEST(slap_OneNorm(ulqr_GetR(solver, k)) < tol);
+    TEST(SumOfSquaredError(ulqr_GetQ(solver, k)->data, zeros, 6) < tol);
+    TEST(SumOfSquaredError(ulqr_GetR(solver, k)->data, zeros, 3) < tol);
     TEST(slap_OneNorm(ulqr_GetH(solver, k)) < tol);
     TEST(slap_OneNorm(ulqr_Getq(solver, k)) < tol);
     TEST(slap_OneNorm(ulqr_Getr(solver, k)) < tol);
@@ -69,8 +72,8 @@ void TestSetCost() {
   out = ulqr_SetCost(solver, Q, R, NULL, NULL, NULL, 0, 2, nhorizon);
   TEST(out == kOk);
   for (int k = 0; k < nhorizon; ++k) {
-    TEST(SumOfSquaredError(ulqr_GetQ(solver, k)->data, Q, nstates * nstates) < tol);
-    TEST(SumOfSquaredError(ulqr_GetR(solver, k)->data, R, ninputs * ninputs) < tol);
+    TEST(SumOfSquaredError(ulqr_GetQ(solver, k)->data, Qp, 6) < tol);
+    TEST(SumOfSquaredError(ulqr_GetR(solver, k)->data, Rp, 3) < tol);
   }
   for (int k = 2; k < nhorizon; ++k) {
     TEST(slap_OneNorm(ulqr_GetH(solver, k)) < tol);
@@ -104,20 +107,21 @@ void TestRiccatiGetters() {
     TEST(ulqr_GetB(solver, k)->cols == ninputs);
     TEST(ulqr_Getf(solver, k)->rows == nstates);
     TEST(ulqr_Getf(solver, k)->cols == 1);
+    TEST(ulqr_GetAB(solver, k)->cols == nstates + ninputs);
+    TEST(ulqr_GetAB(solver, k)->data == ulqr_GetA(solver, k)->data);
     TEST(ulqr_GetFeedbackGain(solver, k)->rows == ninputs);
     TEST(ulqr_GetFeedbackGain(solver, k)->cols == nstates);
     TEST(ulqr_GetFeedforwardGain(solver, k)->rows == ninputs);
     TEST(ulqr_GetFeedforwardGain(solver, k)->cols == 1);
-    TEST(ulqr_GetCostToGoHessian(solver, k)->rows == nstates);
-    TEST(ulqr_GetCostToGoHessian(solver, k)->cols == nstates);
+    TEST(ulqr_GetGains(solver, k)->cols == nstates + 1);
+    TEST(ulqr_GetGains(solver, k)->data == ulqr_GetFeedbackGain(solver, k)->data);
+    TEST(ulqr_GetCostToGoHessian(solver, k)->n == nstates);
     TEST(ulqr_GetCostToGoGradient(solver, k)->rows == nstates);
     TEST(ulqr_GetCostToGoGradient(solver, k)->cols == 1);
-    TEST(ulqr_GetQxx(solver, k)->rows == nstates);
-    TEST(ulqr_GetQxx(solver, k)->cols == nstates);
+    TEST(ulqr_GetQxx(solver, k)->n == nstates);
     TEST(ulqr_GetQux(solver, k)->rows == ninputs);
     TEST(ulqr_GetQux(solver, k)->cols == nstates);
-    TEST(ulqr_GetQuu(solver, k)->rows == ninputs);
-    TEST(ulqr_GetQuu(solver, k)->cols == ninputs);
+    TEST(ulqr_GetQuu(solver, k)->n == ninputs);
     TEST(ulqr_GetQx(solver, k)->rows == nstates);
     TEST(ulqr_GetQx(solver, k)->cols == 1);
     TEST(ulqr_GetQu(solver, k)->rows == ninputs);
@@ -136,8 +140,8 @@ void TestSetDynamics() {
   TEST(out == kOk);
   const double tol = 1e-8;
   for (int k = 0; k < 3; ++k) {
-    TEST(SumOfSquaredError(ulqr_GetA(solver, k)->data, A, nstates * nstates) < tol);
-    TEST(SumOfSquaredError(ulqr_GetB(solver, k)->data, B, nstates * ninputs) < tol);
+    TEST(MatrixArrayError(ulqr_GetA(solver, k), A) < tol);
+    TEST(MatrixArrayError(ulqr_GetB(solver, k), B) < tol);
     TEST(SumOfSquaredError(ulqr_Getf(solver, k)->data, f, nstates) < tol);
   }
 
@@ -150,8 +154,8 @@ void TestSetDynamics() {
   out = ulqr_SetDynamics(solver, A, B, NULL, 0, nhorizon);
   TEST(out == kOk);
   for (int k = 0; k < nhorizon; ++k) {
-    TEST(SumOfSquaredError(ulqr_GetA(solver, k)->data, A, nstates * nstates) < tol);
-    TEST(SumOfSquaredError(ulqr_GetB(solver, k)->data, B, nstates * ninputs) < tol);
+    TEST(MatrixArrayError(ulqr_GetA(solver, k), A) < tol);
+    TEST(MatrixArrayError(ulqr_GetB(solver, k), B) < tol);
     if (k >= 3) {
       TESTAPPROX(slap_OneNorm(ulqr_Getf(solver, k)), 0.0, tol);
     }
@@ -0,0 +1,104 @@
+#include "riccati/solver_pool.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "riccati/riccati_solve.h"
+#include "riccati/riccati_solver.h"
+#include "simpletest/simpletest.h"
+#include "slap/matrix.h"
+#include "test_utils.h"
+
+#define NSOLVERS 40
+
+typedef struct {
+  atomic_int ndone;
+  int status[NSOLVERS];
+  RiccatiSolver* solvers[NSOLVERS];
+} SolveRecord;
+
+static void RecordSolve(RiccatiSolver* solver, int status, void* userdata) {
+  SolveRecord* record = (SolveRecord*)userdata;
+  for (int i = 0; i < NSOLVERS; ++i) {
+    if (record->solvers[i] == solver) {
+      record->status[i] = status;
+    }
+  }
+  atomic_fetch_add(&record->ndone, 1);
+}
+
+void TestSolverPool() {
+  // Mixed sizes, so the workers have to steal from each other and grow their scratch
+  const int sizes[][3] = {{4, 2, 11}, {20, 10, 60}, {6, 3, 50}, {3, 5, 3}, {12, 4, 101}};
+  const int nsizes = sizeof(sizes) / sizeof(sizes[0]);
+  SolveRecord record;
+  atomic_init(&record.ndone, 0);
+  RiccatiSolver* solvers_ref[NSOLVERS];
+  for (int i = 0; i < NSOLVERS; ++i) {
+    const int* size = sizes[i % nsizes];
+    record.solvers[i] = RandomLQRProblem(size[0], size[1], size[2]);
+    record.status[i] = 1;
+    solvers_ref[i] = RandomLQRProblem(size[0], size[1], size[2]);
+    ulqr_SolveRiccati(solvers_ref[i]);
+  }
+  sfloat* P_work_data = record.solvers[0]->P_work.data;
+
+  SolverPool* pool = ulqr_NewSolverPool(3);
+  TEST(pool != NULL);
+  TEST(ulqr_SolverPoolSize(pool) == 3);
+  for (int i = 0; i < NSOLVERS; ++i) {
+    TEST(ulqr_SolverPoolSubmit(pool, record.solvers[i], RecordSolve, &record) == 0);
+  }
+  TEST(ulqr_SolverPoolWait(pool) == 0);
+  TEST(atomic_load(&record.ndone) == NSOLVERS);
+  for (int i = 0; i < NSOLVERS; ++i) {
+    RiccatiSolver* solver = record.solvers[i];
+    TEST(record.status[i] == 0);
+    TEST(SolutionDifference(solver, solvers_ref[i]) < 1e-12);
+    TEST(solver->t_solve_ms >= solver->t_backward_pass_ms);
+    TEST(solver->t_solve_ms >= solver->t_forward_pass_ms);
+  }
+
+  // The solvers get their own workspace back
+  TEST(record.solvers[0]->P_work.data == P_work_data);
+
+  // A failed solve is reported by its callback and the next wait
+  SymMatrix* R = ulqr_GetR(record.solvers[3], 1);
+  for (int i = 0; i < R->n; ++i) {
+    *slap_SymMatrixAt(R, i, i) = -0.5;
+  }
+  atomic_store(&record.ndone, 0);
+  for (int i = 0; i < NSOLVERS; ++i) {
+    ulqr_SolverPoolSubmit(pool, record.solvers[i], RecordSolve, &record);
+  }
+  TEST(ulqr_SolverPoolWait(pool) == -1);
+  TEST(atomic_load(&record.ndone) == NSOLVERS);
+  TEST(record.status[3] == -1);
+  TEST(record.status[4] == 0);
+
+  // Nothing left over from the failure, and no callback is needed
+  ulqr_SolverPoolSubmit(pool, record.solvers[4], NULL, NULL);
+  TEST(ulqr_SolverPoolWait(pool) == 0);
+
+  // Freeing the pool waits for the queued solves
+  for (int i = 0; i < NSOLVERS; ++i) {
+    if (i != 3) {
+      ulqr_SolverPoolSubmit(pool, record.solvers[i], NULL, NULL);
+    }
+  }
+  TEST(ulqr_FreeSolverPool(&pool) == 0);
+  TEST(pool == NULL);
+  for (int i = 0; i < NSOLVERS; ++i) {
+    if (i != 3) {
+      TEST(SolutionDifference(record.solvers[i], solvers_ref[i]) < 1e-12);
+    }
+    ulqr_FreeRiccatiSolver(&record.solvers[i]);
+    ulqr_FreeRiccatiSolver(&solvers_ref[i]);
+  }
+}
+
+int main() {
+  TestSolverPool();
+  PrintTestResult();
+  return TestResult();
+}
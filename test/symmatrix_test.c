@@ -0,0 +1,156 @@
+#include "slap/symmatrix.h"
+
+#include <math.h>
+#include <stddef.h>
+
+#include "simpletest/simpletest.h"
+#include "slap/linalg.h"
+#include "slap/matrix.h"
+
+// Dense symmetric positive-definite matrix of size n
+Matrix RandomSPDMatrix(int n, int seed) {
+  Matrix A1 = slap_NewMatrix(n, n);
+  Matrix A = slap_NewMatrix(n, n);
+  for (int i = 0; i < n * n; ++i) {
+    A1.data[i] = sin(0.9 * i + seed);
+  }
+  slap_MatrixMultiply(&A1, &A1, &A, 1, 0, 1.0, 0.0);
+  slap_AddDiagonal(&A, 0.5);
+  slap_FreeMatrix(&A1);
+  return A;
+}
+
+void PackUnpackTest() {
+  double data[9] = {1, 2, 3, 2, 4, 5, 3, 5, 6};  // NOLINT
+  Matrix A = {3, 3, data, 3};
+  SymMatrix S = slap_NewSymMatrix(3);
+  TEST(slap_SymMatrixNumElements(&S) == 6);
+  slap_SymMatrixPack(&S, &A);
+  for (int i = 0; i < 6; ++i) {
+    TEST(S.data[i] == i + 1);
+  }
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      TEST(*slap_SymMatrixGetElement(&S, i, j) == *slap_MatrixGetElement(&A, i, j));
+      TEST(slap_SymMatrixAt(&S, i, j) == slap_SymMatrixGetElement(&S, i, j));
+    }
+  }
+  TEST(slap_SymMatrixGetLinearIndex(&S, 1, 2) == 4);
+  TEST(slap_SymMatrixGetLinearIndex(&S, 2, 1) == 4);
+  TEST(slap_SymMatrixGetLinearIndex(&S, -1, 1) == -1);
+
+  Matrix B = slap_NewMatrixZeros(3, 3);
+  slap_SymMatrixUnpack(&B, &S);
+  TEST(slap_MatrixNormedDifference(&A, &B) < 1e-12);
+
+  // Bad sizes
+  Matrix C = slap_NewMatrix(3, 2);
+  TEST(slap_SymMatrixPack(&S, &C) == -1);
+  TEST(slap_SymMatrixUnpack(&C, &S) == -1);
+  SymMatrix T = slap_NewSymMatrix(2);
+  TEST(slap_SymMatrixCopy(&T, &S) == -1);
+
+  slap_FreeSymMatrix(&S);
+  slap_FreeSymMatrix(&T);
+  slap_FreeMatrix(&B);
+  slap_FreeMatrix(&C);
+  TEST(S.data == NULL);
+}
+
+void SymMatrixMultiplyTest() {
+  const int sizes[] = {1, 3, 4, 7, 13, 30};
+  const int nrhs[] = {1, 3, 4, 9};
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+    for (int t = 0; t < (int)(sizeof(nrhs) / sizeof(nrhs[0])); ++t) {
+      int n = sizes[s];
+      int p = nrhs[t];
+      Matrix A = RandomSPDMatrix(n, s);
+      SymMatrix S = slap_NewSymMatrix(n);
+      Matrix B = slap_NewMatrix(n, p);
+      Matrix C = slap_NewMatrix(n, p);
+      Matrix Cans = slap_NewMatrix(n, p);
+      for (int i = 0; i < n * p; ++i) {
+        B.data[i] = cos(0.3 * i + t);
+        C.data[i] = sin(0.7 * i);
+      }
+      slap_MatrixCopy(&Cans, &C);
+      slap_SymMatrixPack(&S, &A);
+
+      slap_SymMatrixMultiply(&S, &B, &C, 0.5, -2.0);
+      slap_MatrixMultiply(&A, &B, &Cans, 0, 0, 0.5, -2.0);
+      TEST(slap_MatrixNormedDifference(&C, &Cans) < 1e-10 * slap_TwoNorm(&Cans));
+
+      // beta = 0 shouldn't read C
+      slap_MatrixSetConst(&C, NAN);
+      slap_SymMatrixMultiply(&S, &B, &C, 1.0, 0.0);
+      slap_MatrixMultiply(&A, &B, &Cans, 0, 0, 1.0, 0.0);
+      TEST(slap_MatrixNormedDifference(&C, &Cans) < 1e-10 * slap_TwoNorm(&Cans));
+
+      if (p == 1) {
+        double xAx = slap_SymQuadraticForm(&B, &S);
+        TESTAPPROX(xAx, slap_QuadraticForm(&B, &A, &B), 1e-10 * fabs(xAx));
+      }
+
+      slap_FreeMatrix(&A);
+      slap_FreeSymMatrix(&S);
+      slap_FreeMatrix(&B);
+      slap_FreeMatrix(&C);
+      slap_FreeMatrix(&Cans);
+    }
+  }
+}
+
+void SymCholeskyTest() {
+  const int sizes[] = {1, 2, 5, 8, 17, 40};
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); ++s) {
+    int n = sizes[s];
+    const int nrhs = 5;
+    Matrix A = RandomSPDMatrix(n, s);
+    Matrix L = slap_NewMatrix(n, n);
+    SymMatrix S = slap_NewSymMatrix(n);
+    Matrix b = slap_NewMatrix(n, nrhs);
+    Matrix x = slap_NewMatrix(n, nrhs);
+    for (int i = 0; i < n * nrhs; ++i) {
+      b.data[i] = cos(1.3 * i);
+    }
+    slap_MatrixCopy(&x, &b);
+
+    // Packed factor should match the dense one
+    slap_SymMatrixPack(&S, &A);
+    slap_MatrixCopy(&L, &A);
+    TEST(slap_SymCholeskyFactorize(&S) == slap_kCholeskySuccess);
+    slap_CholeskyFactorize(&L);
+    double err = 0.0;
+    for (int j = 0; j < n; ++j) {
+      for (int i = j; i < n; ++i) {
+        double diff = *slap_SymMatrixGetElement(&S, i, j) - *slap_MatrixGetElement(&L, i, j);
+        err = fmax(err, fabs(diff));
+      }
+    }
+    TEST(err < 1e-10);
+
+    // A x = b
+    slap_SymCholeskySolve(&S, &x);
+    slap_MatrixMultiply(&A, &x, &b, 0, 0, 1.0, -1.0);
+    TEST(slap_TwoNorm(&b) < 1e-8);
+
+    // Indefinite
+    slap_SymMatrixPack(&S, &A);
+    *slap_SymMatrixGetElement(&S, n - 1, n - 1) = -1.0;
+    TEST(slap_SymCholeskyFactorize(&S) == slap_kCholeskyFail);
+
+    slap_FreeMatrix(&A);
+    slap_FreeMatrix(&L);
+    slap_FreeSymMatrix(&S);
+    slap_FreeMatrix(&b);
+    slap_FreeMatrix(&x);
+  }
+}
+
+int main() {
+  PackUnpackTest();
+  SymMatrixMultiplyTest();
+  SymCholeskyTest();
+  PrintTestResult();
+  return TestResult();
+}
@@ -1,11 +1,13 @@
 #include "test_utils.h"
 
 #include <math.h>
+#include <stddef.h>
 
 #include "riccati/riccati_solver.h"
+#include "slap/linalg.h"
 #include "slap/matrix.h"
 
-double SumOfSquaredError(const double* x, const double* y, int len) {
+double SumOfSquaredError(const sfloat* x, const sfloat* y, int len) {
   double err = 0;
   for (int i = 0; i < len; ++i) {
     double diff = x[i] - y[i];
@@ -14,6 +16,18 @@ double SumOfSquaredError(const double* x, const double* y, int len) {
   return sqrt(err);
 }
 
+double MatrixArrayError(const Matrix* mat, const sfloat* data) {
+  int ld = slap_MatrixLeadingDim(mat);
+  double err = 0;
+  for (int j = 0; j < mat->cols; ++j) {
+    for (int i = 0; i < mat->rows; ++i) {
+      double diff = mat->data[i + j * ld] - data[i + j * mat->rows];
+      err += diff * diff;
+    }
+  }
+  return sqrt(err);
+}
+
 void DiscreteDoubleIntegratorDynamics(double h, double dim, Matrix* A, Matrix* B) {
   int nstates = 2 * dim;
   slap_MatrixSetConst(A, 0.0);
@@ -43,7 +57,7 @@ RiccatiSolver* DoubleIntegratorProblem() {
   Matrix A = slap_NewMatrix(nstates, nstates);
   Matrix B = slap_NewMatrix(nstates, ninputs);
   DiscreteDoubleIntegratorDynamics(h, dim, &A, &B);
-  const double f[4] = {
+  const sfloat f[4] = {
       1,
       -1,
       0,
@@ -53,3 +67,109 @@ RiccatiSolver* DoubleIntegratorProblem() {
 
   return solver;
 }
+
+RiccatiSolver* RandomLQRProblem(int nstates, int ninputs, int nhorizon) {
+  RiccatiSolver* solver = ulqr_NewRiccatiSolver(nstates, ninputs, nhorizon);
+  Matrix A = slap_NewMatrix(nstates, nstates);
+  Matrix B = slap_NewMatrix(nstates, ninputs);
+  Matrix f = slap_NewMatrix(nstates, 1);
+  Matrix Q = slap_NewMatrixZeros(nstates, nstates);
+  Matrix R = slap_NewMatrixZeros(ninputs, ninputs);
+  Matrix q = slap_NewMatrix(nstates, 1);
+  Matrix r = slap_NewMatrix(ninputs, 1);
+  Matrix x0 = slap_NewMatrix(nstates, 1);
+
+  // Deterministic "random" data, with A close to the identity
+  for (int i = 0; i < nstates * nstates; ++i) {
+    A.data[i] = 0.05 * sin(1.3 * i + 0.4);
+  }
+  slap_AddDiagonal(&A, 1.0);
+  for (int i = 0; i < nstates * ninputs; ++i) {
+    B.data[i] = 0.1 * cos(0.7 * i);
+  }
+  for (int i = 0; i < nstates; ++i) {
+    f.data[i] = 0.01 * sin(2.1 * i);
+    q.data[i] = 0.1 * cos(1.7 * i);
+    x0.data[i] = sin(0.9 * i + 1.0);
+    slap_MatrixSetElement(&Q, i, i, 1.0 + 0.1 * i);
+  }
+  for (int i = 0; i < ninputs; ++i) {
+    r.data[i] = 0.01 * sin(i + 0.5);
+    slap_MatrixSetElement(&R, i, i, 0.1 + 0.01 * i);
+  }
+  ulqr_SetDynamics(solver, A.data, B.data, f.data, 0, nhorizon - 1);
+  ulqr_SetCost(solver, Q.data, R.data, NULL, q.data, r.data, 0.0, 0, nhorizon);
+  ulqr_SetInitialState(solver, x0.data);
+
+  slap_FreeMatrix(&A);
+  slap_FreeMatrix(&B);
+  slap_FreeMatrix(&f);
+  slap_FreeMatrix(&Q);
+  slap_FreeMatrix(&R);
+  slap_FreeMatrix(&q);
+  slap_FreeMatrix(&r);
+  slap_FreeMatrix(&x0);
+  return solver;
+}
+
+double KKTResidual(RiccatiSolver* solver) {
+  int nstates = solver->nstates;
+  int ninputs = solver->ninputs;
+  int nhorizon = solver->nhorizon;
+  Matrix rx = slap_NewMatrix(nstates, 1);
+  Matrix ru = slap_NewMatrix(ninputs, 1);
+  double res = 0.0;
+
+  // Initial condition
+  slap_MatrixCopy(&rx, ulqr_GetState(solver, 0));
+  slap_MatrixAddition(&solver->x0, &rx, -1.0);
+  res = fmax(res, slap_TwoNorm(&rx));
+
+  for (int k = 0; k < nhorizon; ++k) {
+    Matrix* x = ulqr_GetState(solver, k);
+    Matrix* y = ulqr_GetDual(solver, k);
+
+    // Stationarity wrt x: Q x + q + A'y_next - y = 0
+    slap_MatrixCopy(&rx, ulqr_Getq(solver, k));
+    slap_SymMatrixMultiply(ulqr_GetQ(solver, k), x, &rx, 1.0, 1.0);
+    slap_MatrixAddition(y, &rx, -1.0);
+    if (k < nhorizon - 1) {
+      Matrix* u = ulqr_GetInput(solver, k);
+      Matrix* yn = ulqr_GetDual(solver, k + 1);
+      slap_MatrixMultiply(ulqr_GetA(solver, k), yn, &rx, 1, 0, 1.0, 1.0);
+      res = fmax(res, slap_TwoNorm(&rx));
+
+      // Stationarity wrt u: R u + r + B'y_next = 0
+      slap_MatrixCopy(&ru, ulqr_Getr(solver, k));
+      slap_SymMatrixMultiply(ulqr_GetR(solver, k), u, &ru, 1.0, 1.0);
+      slap_MatrixMultiply(ulqr_GetB(solver, k), yn, &ru, 1, 0, 1.0, 1.0);
+      res = fmax(res, slap_TwoNorm(&ru));
+
+      // Dynamics: A x + B u + f - x_next = 0
+      slap_MatrixCopy(&rx, ulqr_Getf(solver, k));
+      slap_MatrixMultiply(ulqr_GetA(solver, k), x, &rx, 0, 0, 1.0, 1.0);
+      slap_MatrixMultiply(ulqr_GetB(solver, k), u, &rx, 0, 0, 1.0, 1.0);
+      slap_MatrixAddition(ulqr_GetState(solver, k + 1), &rx, -1.0);
+    }
+    res = fmax(res, slap_TwoNorm(&rx));
+  }
+
+  slap_FreeMatrix(&rx);
+  slap_FreeMatrix(&ru);
+  return res;
+}
+
+double SolutionDifference(RiccatiSolver* solver, RiccatiSolver* solver_ref) {
+  double err = 0.0;
+  for (int k = 0; k < solver->nhorizon; ++k) {
+    err = fmax(err, slap_MatrixNormedDifference(ulqr_GetState(solver, k),
+                                                ulqr_GetState(solver_ref, k)));
+    err = fmax(err, slap_MatrixNormedDifference(ulqr_GetDual(solver, k),
+                                                ulqr_GetDual(solver_ref, k)));
+    if (k < solver->nhorizon - 1) {
+      err = fmax(err, slap_MatrixNormedDifference(ulqr_GetInput(solver, k),
+                                                  ulqr_GetInput(solver_ref, k)));
+    }
+  }
+  return err;
+}
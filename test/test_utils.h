@@ -1,8 +1,18 @@
 #pragma once
 
 #include "riccati/riccati_solver.h"
-double SumOfSquaredError(const double* x, const double* y, int len);
+double SumOfSquaredError(const sfloat* x, const sfloat* y, int len);
+
+// Same as SumOfSquaredError, for a matrix with any leading dimension and a column-major array
+double MatrixArrayError(const Matrix* mat, const sfloat* data);
 
 void DiscreteDoubleIntegratorDynamics(double h, double dim, Matrix* A, Matrix* B);
 
 RiccatiSolver* DoubleIntegratorProblem();
+
+RiccatiSolver* RandomLQRProblem(int nstates, int ninputs, int nhorizon);
+
+double KKTResidual(RiccatiSolver* solver);
+
+// Largest difference between the states, inputs and duals of two solvers
+double SolutionDifference(RiccatiSolver* solver, RiccatiSolver* solver_ref);